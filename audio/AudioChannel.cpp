@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "AudioChannel.h"
 #include "AudioSample.h"
+#include "MixerKernels.h"
 
 namespace Pentagram {
 
@@ -98,24 +99,47 @@ void AudioChannel::playSample(AudioSample *sample_, int loop_, int priority_, bo
 
 }
 
-void AudioChannel::resampleAndMix(sint16 *stream, uint32 bytes)
+void AudioChannel::resampleAndMix(sint32 *mix, uint32 samples)
 {
 	if (!sample || paused) return;
 
+	uint32 frames = stereo ? samples/2 : samples;
+
 	// Update fp_speed
 	fp_speed = (pitch_shift*sample->getRate())/sample_rate;
 
-	// Get and Mix data
+	// Mono volume
+	int volume = (rvol + lvol)/2;
+
+	while (frames) {
+		uint32 count = frames;
+		if (count > MIX_BLOCK) count = MIX_BLOCK;
+
+		uint32 done = resample(block, count);
+		if (stereo) {
+			MixerKernels::mixMonoToStereo(mix, block, done, lvol, rvol);
+			mix += 2*done;
+		} else {
+			MixerKernels::mixMono(mix, block, done, volume);
+			mix += done;
+		}
+
+		// Sample ended
+		if (done != count) return;
+		frames -= count;
+	}
+}
+
+uint32 AudioChannel::resample(sint32 *out, uint32 count)
+{
+	uint32 left = count;
+
+	// Get data
 	do
 	{
-		// 8 bit resampling
-		if (sample->getBits()==8) {
-			// Mono resampling required
-			if (!sample->isStereo() && stereo)
-				resampleFrameM8toS(stream,bytes);
-			if (!sample->isStereo() && !stereo)
-				resampleFrameM8toM(stream,bytes);
-		}
+		// 8 bit mono resampling
+		if (sample->getBits()==8 && !sample->isStereo())
+			resampleFrameM8(out,left);
 		// 16 bit resampling (or not)
 		/*
 		else
@@ -125,35 +149,21 @@ void AudioChannel::resampleAndMix(sint16 *stream, uint32 bytes)
 
 			do {
 				int c = *(src++);
-				c = (c|(c << 8))-32768;
-
-				int lresult = *(stream+0) + c;
-				int rresult = *(stream+1) + c;
-
-				// Enforce range in case of an "overshot". Shouldn't happen since we
-				// scale down already, but safe is safe.
-				if (lresult < -32768) lresult = -32768;
-				else if (lresult > 32767) lresult = 32767;
-
-				if (rresult < -32768) rresult = -32768;
-				else if (rresult > 32767) rresult = 32767;
-
-				*stream++ = lresult;
-				*stream++ = rresult;
-				bytes -= 4;
-			} while (bytes!=0 && src != src_end);
+				*out++ = (c|(c << 8))-32768;
+				left--;
+			} while (left!=0 && src != src_end);
 
 			position = frame0_size - (src_end - src);
 		}
 		*/
 
 		// We ran out of data
-		if (bytes || (position == frame0_size)) {
+		if (left || (position == frame0_size)) {
 
 			// No more data
 			if (!frame1_size) {
 				sample = 0;
-				return;
+				return count - left;
 			}
 
 			// Invert evenodd
@@ -166,7 +176,9 @@ void AudioChannel::resampleAndMix(sint16 *stream, uint32 bytes)
 			DecompressNextFrame();
 		}
 
-	} while (bytes!=0);
+	} while (left!=0);
+
+	return count;
 }
 
 // Decompress a frame
@@ -184,8 +196,8 @@ void AudioChannel::DecompressNextFrame()
 	}
 }
 
-// Resample a frame of mono 8bit unsigned to Stereo 16bit
-void AudioChannel::resampleFrameM8toS(sint16 *&stream, uint32 &bytes)
+// Resample a frame of mono 8bit unsigned to 32bit
+void AudioChannel::resampleFrameM8(sint32 *&out, uint32 &count)
 {
 	uint8 *src = playdata + decompressor_size + (frame_size*frame_evenodd);
 	uint8 *src2 = playdata + decompressor_size + (frame_size*(1-frame_evenodd));
@@ -195,8 +207,6 @@ void AudioChannel::resampleFrameM8toS(sint16 *&stream, uint32 &bytes)
 
 	src += position;
 
-	int result;
-	
 	do {
 		// Add a new src sample (if required)
 		if (fp_pos >= 0x10000)
@@ -217,85 +227,15 @@ void AudioChannel::resampleFrameM8toS(sint16 *&stream, uint32 &bytes)
 			fp_pos -= 0x10000;
 		}
 
-		if (fp_pos < 0x10000) do {
-			// Do the interpolation
-			result = interp_l.interpolate(fp_pos);
-
-			int lresult = *(stream+0) + (result*lvol)/256;
-			int rresult = *(stream+1) + (result*rvol)/256;
-
-			// Enforce range in case of an "overshot". Shouldn't happen since we
-			// scale down already, but safe is safe.
-			if (lresult < -32768) lresult = -32768;
-			else if (lresult > 32767) lresult = 32767;
-
-			if (rresult < -32768) rresult = -32768;
-			else if (rresult > 32767) rresult = 32767;
-
-			*stream++ = lresult;
-			*stream++ = rresult;
-			bytes -= 4;
+		// Do the interpolation. The mixer applies the volume and
+		// clamps the result.
+		while (fp_pos < 0x10000 && count!=0) {
+			*out++ = interp_l.interpolate(fp_pos);
+			count--;
 			fp_pos += fp_speed;
-
-		} while (fp_pos < 0x10000 && bytes!=0);
-
-	} while (bytes!=0 && src != src_end);
-	
-	position = frame0_size - (src_end - src);
-}
-
-// Resample a frame of mono 8bit unsigned to Mono 16bit
-void AudioChannel::resampleFrameM8toM(sint16 *&stream, uint32 &bytes)
-{
-	uint8 *src = playdata + decompressor_size + (frame_size*frame_evenodd);
-	uint8 *src2 = playdata + decompressor_size + (frame_size*(1-frame_evenodd));
-
-	uint8 *src_end = src + frame0_size;
-	uint8 *src2_end = src2 + frame1_size;
-
-	src += position;
-
-	int result;
-	int volume = (rvol + lvol)/2;
-	
-	do {
-		// Add a new src sample (if required)
-		if (fp_pos >= 0x10000)
-		{
-			if (src+2 < src_end) {
-				int c = *(src+2);
-				c = (c|(c << 8))-32768;
-				interp_l.feedData(RANGE_REDUX(c));
-			} else if (src2 < src2_end) {
-				int c = *(src2);
-				c = (c|(c << 8))-32768;
-				interp_l.feedData(RANGE_REDUX(c));
-				src2++;
-			} else {
-				interp_l.feedData();
-			}
-			src++;
-			fp_pos -= 0x10000;
 		}
 
-		if (fp_pos < 0x10000) do {
-			// Do the interpolation
-			result = (interp_l.interpolate(fp_pos)*volume)/256;
-
-			result += *stream;
-
-			// Enforce range in case of an "overshot". Shouldn't happen since we
-			// scale down already, but safe is safe.
-			if (result < -32768) result = -32768;
-			else if (result > 32767) result = 32767;
-
-			*stream++ = result;
-			bytes -= 2;
-			fp_pos += fp_speed;
-
-		} while (fp_pos < 0x10000 && bytes!=0);
-
-	} while (bytes!=0 && src != src_end);
+	} while (count!=0 && src != src_end);
 	
 	position = frame0_size - (src_end - src);
 }
@@ -56,9 +56,13 @@ public:
 	void stop() { sample = 0; }
 
 	void playSample(AudioSample *sample, int loop, int priority, bool paused, uint32 pitch_shift, int lvol, int rvol);
-	void resampleAndMix(sint16 *stream, uint32 bytes);
+
+	//! Mix the sample into a buffer of 32 bit samples (interleaved if
+	//! stereo). The caller clamps the buffer to 16 bit.
+	void resampleAndMix(sint32 *mix, uint32 samples);
 
 	bool isPlaying() { return sample != 0; }
+	AudioSample *getSample() const { return sample; }
 
 	void setPitchShift(int pitch_shift_) { pitch_shift = pitch_shift_; }
 	uint32 getPitchShift() const { return pitch_shift; }
@@ -170,10 +174,16 @@ private:
 	int					fp_pos;
 	int					fp_speed;
 
-	void resampleFrameM8toS(sint16 *&samples, uint32 &bytes);
-	void resampleFrameM8toM(sint16 *&samples, uint32 &bytes);
+	//! Resample the next count samples into out, at full volume.
+	//! Returns the number of samples written, less than count if the
+	//! sample ended.
+	uint32 resample(sint32 *out, uint32 count);
 
+	void resampleFrameM8(sint32 *&out, uint32 &count);
 
+	// Resampled samples are collected in blocks before they're mixed
+	enum { MIX_BLOCK = 256 };
+	sint32				block[MIX_BLOCK];
 
 };
 
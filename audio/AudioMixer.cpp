@@ -23,10 +23,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "AudioProcess.h"
 #include "MusicProcess.h"
 #include "AudioChannel.h"
+#include "RawAudioSample.h"
+#include "MixerKernels.h"
 
 #include "MidiDriver.h"
 
 #include <SDL.h>
+#include <algorithm>
 
 namespace Pentagram {
 
@@ -73,6 +76,9 @@ AudioMixer::AudioMixer(int sample_rate_, bool stereo_, int num_channels_) :
 		for (int i=0;i<num_channels;i++)
 			channels[i] = new AudioChannel(sample_rate,stereo);
 
+		// Allocate the mix buffer now, not in the audio callback
+		mixbuffer.resize(obtained.samples * obtained.channels);
+
 		// Unlock it
 		Unlock();
 
@@ -182,6 +188,21 @@ bool AudioMixer::isPlaying(int chan)
 	return playing;
 }
 
+bool AudioMixer::isPlayingSample(AudioSample *sample)
+{
+	if (!channels || !audio_ok) return false;
+
+	Lock();
+
+		bool playing = false;
+		for (int i=0;i<num_channels;i++)
+			if (channels[i]->getSample() == sample) playing = true;
+
+	Unlock();
+
+	return playing;
+}
+
 void AudioMixer::stopSample(int chan)
 {
 	if (chan > num_channels || chan < 0 || !channels || !audio_ok) return;
@@ -254,8 +275,34 @@ void AudioMixer::MixAudio(sint16 *stream, uint32 bytes)
 	if (midi_driver && midi_driver->isSampleProducer())
 		midi_driver->produceSamples(stream, bytes);
 
-	if (channels) for (int i=0;i<num_channels;i++)
-		if (channels[i]->isPlaying()) channels[i]->resampleAndMix(stream,bytes);
+	if (channels)
+		MixChannels(channels, num_channels, stream, bytes, mixbuffer);
+}
+
+void AudioMixer::MixChannels(AudioChannel **chans, int count,
+							 sint16 *stream, uint32 bytes,
+							 std::vector<sint32> &mixbuffer)
+{
+	int i;
+	for (i=0;i<count;i++)
+		if (chans[i]->isPlaying() && !chans[i]->isPaused()) break;
+
+	// Nothing to add
+	if (i == count) return;
+
+	uint32 samples = bytes/2;
+	if (mixbuffer.size() < samples) mixbuffer.resize(samples);
+	sint32 *mix = &mixbuffer[0];
+
+	// Mix on top of the midi output (or silence), and only clamp the sum
+	MixerKernels::widen(mix, stream, samples);
+
+	for (;i<count;i++) {
+		if (!chans[i]->isPlaying()) continue;
+		chans[i]->resampleAndMix(mix, samples);
+	}
+
+	MixerKernels::narrow(stream, mix, samples);
 }
 
 void AudioMixer::openMidiOutput()
@@ -299,4 +346,68 @@ void AudioMixer::closeMidiOutput()
 	Unlock();
 }
 
+void AudioMixer::ConCmd_benchmark(const Console::ArgvType &argv)
+{
+	if (argv.size() > 3) {
+		pout << "usage: AudioMixer::benchmark [channels] [seconds]" << std::endl;
+		return;
+	}
+
+	int numchans = 8;
+	int seconds = 10;
+	if (argv.size() > 1) numchans = static_cast<int>(strtol(argv[1].c_str(), 0, 0));
+	if (argv.size() > 2) seconds = static_cast<int>(strtol(argv[2].c_str(), 0, 0));
+	if (numchans < 1) numchans = 1;
+	if (seconds < 1) seconds = 1;
+
+	// Mix at the rate the game runs at, but off-line, with channels of
+	// our own
+	uint32 rate = 22050;
+	bool stereo = true;
+	if (the_audio_mixer && the_audio_mixer->audio_ok) {
+		rate = the_audio_mixer->sample_rate;
+		stereo = the_audio_mixer->stereo;
+	}
+
+	// One second of 8 bit sound, like the sound effects
+	const uint32 srcrate = 11025;
+	uint8 *data = new uint8[srcrate];
+	for (uint32 i = 0; i < srcrate; ++i)
+		data[i] = static_cast<uint8>(128 + ((i * 7) & 0x3F) - ((i / 13) & 0x1F));
+	RawAudioSample sample(data, srcrate, srcrate, false, false);
+
+	AudioChannel **chans = new AudioChannel*[numchans];
+	for (int i = 0; i < numchans; ++i) {
+		chans[i] = new AudioChannel(rate, stereo);
+		// Vary the pitch and panning a bit
+		chans[i]->playSample(&sample, -1, 0, false, 0x10000 + i*0x400,
+							 256 - (i*16)%128, 128 + (i*16)%128);
+	}
+
+	const uint32 frames = 1024;
+	uint32 samples = frames * (stereo ? 2 : 1);
+	std::vector<sint16> stream(samples);
+	std::vector<sint32> mixbuffer(samples);
+
+	uint32 callbacks = (seconds * rate + frames - 1) / frames;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (uint32 c = 0; c < callbacks; ++c) {
+		std::fill(stream.begin(), stream.end(), 0);
+		MixChannels(chans, numchans, &stream[0], samples*2, mixbuffer);
+	}
+	Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+	for (int i = 0; i < numchans; ++i)
+		delete chans[i];
+	delete [] chans;
+
+	double ms = elapsed * 1000.0 / SDL_GetPerformanceFrequency();
+	con.Printf("AudioMixer: mixed %d channels for %d seconds (%u Hz %s, %s) "
+			   "in %.2f ms\n", numchans, seconds, rate,
+			   stereo ? "stereo" : "mono", MixerKernels::getName(), ms);
+	con.Printf("AudioMixer: %.1f us per %u frame callback, %.3f%% of real "
+			   "time\n", ms * 1000.0 / callbacks, frames,
+			   ms / (seconds * 10.0));
+}
+
 };
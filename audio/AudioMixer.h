@@ -18,6 +18,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef AUDIOMIXER_H_INCLUDED
 #define AUDIOMIXER_H_INCLUDED
 
+#include <vector>
+
 class MidiDriver;
 
 namespace Pentagram {
@@ -39,6 +41,7 @@ public:
 
 	int				playSample(AudioSample *sample, int loop, int priority, bool paused, uint32 pitch_shift, int lvol, int rvol);
 	bool			isPlaying(int chan);
+	bool			isPlayingSample(AudioSample *sample);
 	void			stopSample(int chan);
 	
 	void			setPaused(int chan, bool paused);
@@ -50,6 +53,9 @@ public:
 	void			openMidiOutput();
 	void			closeMidiOutput();
 
+	//! "AudioMixer::benchmark" console command
+	static void		ConCmd_benchmark(const Console::ArgvType &argv);
+
 private:
 	bool			audio_ok;
 	uint32			sample_rate;
@@ -65,6 +71,14 @@ private:
 
 	void			MixAudio(sint16 *stream, uint32 bytes);
 
+	//! Mix the playing channels into stream, using mixbuffer to hold
+	//! 32 bit samples until they're all added up
+	static void		MixChannels(AudioChannel **chans, int count,
+								sint16 *stream, uint32 bytes,
+								std::vector<sint32> &mixbuffer);
+
+	std::vector<sint32>	mixbuffer;
+
 	static AudioMixer* the_audio_mixer;
 
 	void			Lock();
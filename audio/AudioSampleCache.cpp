@@ -0,0 +1,304 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#include "pent_include.h"
+#include "AudioSampleCache.h"
+#include "RawAudioSample.h"
+#include "AudioMixer.h"
+
+#include <vector>
+
+namespace Pentagram {
+
+AudioSampleCache* AudioSampleCache::audiosamplecache = 0;
+
+AudioSampleCache::AudioSampleCache(uint32 maxsize_)
+	: maxsize(maxsize_), cursize(0),
+	  hits(0), misses(0), decoded(0), evictions(0),
+	  thread(0), current(0), quit(false)
+{
+	assert(audiosamplecache == 0);
+	audiosamplecache = this;
+
+	mutex = SDL_CreateMutex();
+	jobcond = SDL_CreateCond();
+	idlecond = SDL_CreateCond();
+
+	if (maxsize) {
+		thread = SDL_CreateThread(threadMain_Static, "AudioSampleCache",
+								  static_cast<void*>(this));
+		if (!thread)
+			perr << "AudioSampleCache: could not create thread: "
+				 << SDL_GetError() << std::endl;
+	}
+}
+
+AudioSampleCache::~AudioSampleCache()
+{
+	if (thread) {
+		SDL_mutexP(mutex);
+		quit = true;
+		SDL_CondSignal(jobcond);
+		SDL_mutexV(mutex);
+		SDL_WaitThread(thread, 0);
+	}
+
+	std::list<Job>::iterator j;
+	for (j = done.begin(); j != done.end(); ++j)
+		delete j->decoded;
+
+	while (!samples.empty())
+		remove(samples.begin());
+
+	SDL_DestroyCond(idlecond);
+	SDL_DestroyCond(jobcond);
+	SDL_DestroyMutex(mutex);
+
+	audiosamplecache = 0;
+}
+
+AudioSample* AudioSampleCache::getSample(const SoundFlex* flex, uint32 index,
+										 AudioSample* source)
+{
+	if (!thread || !source) return 0;
+
+	collect();
+
+	Key key;
+	key.flex = flex;
+	key.index = index;
+
+	std::map<Key, Entry>::iterator it = samples.find(key);
+	if (it != samples.end()) {
+		hits++;
+		lru.splice(lru.begin(), lru, it->second.lru);
+		return it->second.sample;
+	}
+
+	misses++;
+	if (requested.find(key) == requested.end()) {
+		Job job;
+		job.key = key;
+		job.source = source;
+		job.decoded = 0;
+		job.size = 0;
+
+		SDL_mutexP(mutex);
+		queue.push_back(job);
+		SDL_CondSignal(jobcond);
+		SDL_mutexV(mutex);
+
+		requested.insert(key);
+	}
+
+	return 0;
+}
+
+void AudioSampleCache::forget(const SoundFlex* flex, uint32 index)
+{
+	forgetMatching(flex, index);
+}
+
+void AudioSampleCache::forget(const SoundFlex* flex)
+{
+	forgetMatching(flex, 0xFFFFFFFF);
+}
+
+void AudioSampleCache::forgetMatching(const SoundFlex* flex, uint32 index)
+{
+	if (!thread) return;
+
+	SDL_mutexP(mutex);
+
+	std::list<Job>::iterator j;
+	for (j = queue.begin(); j != queue.end(); ) {
+		if (j->key.matches(flex, index))
+			j = queue.erase(j);
+		else
+			++j;
+	}
+
+	// The source sample is about to be deleted
+	while (current && current->key.matches(flex, index))
+		SDL_CondWait(idlecond, mutex);
+
+	for (j = done.begin(); j != done.end(); ) {
+		if (j->key.matches(flex, index)) {
+			delete j->decoded;
+			j = done.erase(j);
+		} else
+			++j;
+	}
+
+	SDL_mutexV(mutex);
+
+	std::set<Key>::iterator r;
+	for (r = requested.begin(); r != requested.end(); ) {
+		if (r->matches(flex, index))
+			requested.erase(r++);
+		else
+			++r;
+	}
+
+	std::map<Key, Entry>::iterator it;
+	for (it = samples.begin(); it != samples.end(); ) {
+		if (it->first.matches(flex, index))
+			remove(it++);
+		else
+			++it;
+	}
+}
+
+void AudioSampleCache::collect()
+{
+	std::list<Job> finished;
+
+	SDL_mutexP(mutex);
+	finished.splice(finished.begin(), done);
+	SDL_mutexV(mutex);
+
+	if (finished.empty()) return;
+
+	std::list<Job>::iterator j;
+	for (j = finished.begin(); j != finished.end(); ++j) {
+		requested.erase(j->key);
+		if (!j->decoded) continue;
+
+		Entry entry;
+		entry.sample = j->decoded;
+		entry.size = j->size;
+		entry.lru = lru.insert(lru.begin(), j->key);
+		samples[j->key] = entry;
+		cursize += j->size;
+		decoded++;
+	}
+
+	evict();
+}
+
+void AudioSampleCache::evict()
+{
+	AudioMixer* mixer = AudioMixer::get_instance();
+
+	std::list<Key>::iterator k = lru.end();
+	while (cursize > maxsize && k != lru.begin()) {
+		--k;
+		std::map<Key, Entry>::iterator it = samples.find(*k);
+		assert(it != samples.end());
+
+		// Can't delete a sample from under an AudioChannel
+		if (mixer && mixer->isPlayingSample(it->second.sample))
+			continue;
+
+		// remove() erases k, so continue from the one after it
+		++k;
+		remove(it);
+		evictions++;
+	}
+}
+
+void AudioSampleCache::remove(std::map<Key, Entry>::iterator it)
+{
+	lru.erase(it->second.lru);
+	cursize -= it->second.size;
+	delete it->second.sample;
+	samples.erase(it);
+}
+
+AudioSample* AudioSampleCache::decode(const AudioSample* source, uint32& size)
+{
+	// AudioChannel can only play 8 bit mono samples
+	if (source->getBits() != 8 || source->isStereo()) return 0;
+
+	uint32 length = source->getLength();
+	if (length == 0) return 0;
+
+	std::vector<uint8> decomp(source->getDecompressorDataSize() + 1);
+
+	// Frames can be larger than the frame size the sample reports
+	uint32 framesize = source->getFrameSize();
+	if (framesize < 0x10000) framesize = 0x10000;
+	std::vector<uint8> frame(framesize);
+
+	uint8* pcm = new uint8[length];
+	uint32 pos = 0;
+
+	source->initDecompressor(&decomp[0]);
+	while (pos < length) {
+		uint32 count = source->decompressFrame(&decomp[0], &frame[0]);
+		if (count == 0) break;
+		if (count > length - pos) count = length - pos;
+		std::memcpy(pcm + pos, &frame[0], count);
+		pos += count;
+	}
+
+	if (pos == 0) {
+		delete [] pcm;
+		return 0;
+	}
+
+	size = pos;
+	return new RawAudioSample(pcm, pos, source->getRate(), false, false);
+}
+
+int SDLCALL AudioSampleCache::threadMain_Static(void* data)
+{
+	static_cast<AudioSampleCache*>(data)->threadMain();
+	return 0;
+}
+
+void AudioSampleCache::threadMain()
+{
+	SDL_mutexP(mutex);
+	while (!quit) {
+		if (queue.empty()) {
+			SDL_CondWait(jobcond, mutex);
+			continue;
+		}
+
+		Job job = queue.front();
+		queue.pop_front();
+		current = &job;
+		SDL_mutexV(mutex);
+
+		job.decoded = decode(job.source, job.size);
+
+		SDL_mutexP(mutex);
+		current = 0;
+		done.push_back(job);
+		SDL_CondBroadcast(idlecond);
+	}
+	SDL_mutexV(mutex);
+}
+
+void AudioSampleCache::ConCmd_stats(const Console::ArgvType &/*argv*/)
+{
+	AudioSampleCache* cache = AudioSampleCache::get_instance();
+	if (!cache) return;
+
+	pout << "AudioSampleCache: " << (cache->thread ? "enabled" : "disabled")
+		 << std::endl;
+	pout << "Samples    : " << cache->samples.size() << std::endl;
+	pout << "Memory     : " << cache->cursize / 1024 << "/"
+		 << cache->maxsize / 1024 << " KB" << std::endl;
+	pout << "Hits       : " << cache->hits << std::endl;
+	pout << "Misses     : " << cache->misses << std::endl;
+	pout << "Decoded    : " << cache->decoded << std::endl;
+	pout << "Evictions  : " << cache->evictions << std::endl;
+}
+
+}
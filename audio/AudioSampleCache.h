@@ -0,0 +1,132 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#ifndef AUDIOSAMPLECACHE_H_INCLUDED
+#define AUDIOSAMPLECACHE_H_INCLUDED
+
+#include <list>
+#include <map>
+#include <set>
+#include <SDL.h>
+#include <SDL_thread.h>
+
+class SoundFlex;
+
+namespace Pentagram {
+
+class AudioSample;
+
+//! A bounded LRU cache of fully decoded copies of compressed AudioSamples,
+//! so the AudioChannels can play sounds that are used often without
+//! decompressing them in the audio callback every time.
+//!
+//! Samples are keyed on the SoundFlex (or SpeechFlex) and the index in it.
+//! The first time a sample is asked for, it's decoded on a background
+//! thread and the compressed sample is played meanwhile.
+//!
+//! Only the main thread uses the cache; the decoder thread only sees
+//! its own queue.
+class AudioSampleCache
+{
+public:
+	//! \param maxsize maximum memory used by decoded samples, in bytes.
+	//!                0 disables the cache.
+	explicit AudioSampleCache(uint32 maxsize);
+	~AudioSampleCache();
+
+	static AudioSampleCache* get_instance() { return audiosamplecache; }
+
+	//! Get the decoded copy of a sample, or 0 if it isn't decoded yet.
+	//! In that case it's queued for decoding.
+	AudioSample* getSample(const SoundFlex* flex, uint32 index,
+						   AudioSample* source);
+
+	//! Remove a sample. Called before the source sample is deleted.
+	void forget(const SoundFlex* flex, uint32 index);
+
+	//! Remove all samples of a SoundFlex
+	void forget(const SoundFlex* flex);
+
+	//! "AudioSampleCache::stats" console command
+	static void ConCmd_stats(const Console::ArgvType &argv);
+
+private:
+	struct Key
+	{
+		const SoundFlex* flex;
+		uint32 index;
+
+		bool matches(const SoundFlex* f, uint32 i) const {
+			return flex == f && (i == 0xFFFFFFFF || index == i);
+		}
+		bool operator<(const Key& o) const {
+			if (flex != o.flex) return flex < o.flex;
+			return index < o.index;
+		}
+	};
+
+	struct Job
+	{
+		Key key;
+		AudioSample* source;
+		AudioSample* decoded;	//!< 0 if it couldn't be decoded
+		uint32 size;
+	};
+
+	struct Entry
+	{
+		AudioSample* sample;
+		uint32 size;
+		std::list<Key>::iterator lru;
+	};
+
+	//! Decode a whole sample into a new RawAudioSample
+	static AudioSample* decode(const AudioSample* source, uint32& size);
+
+	static int SDLCALL threadMain_Static(void* data);
+	void threadMain();
+
+	//! Move the samples the decoder is done with into the cache
+	void collect();
+	void evict();
+	void remove(std::map<Key, Entry>::iterator it);
+	void forgetMatching(const SoundFlex* flex, uint32 index);
+
+	std::list<Key> lru;				//!< most recently used first
+	std::map<Key, Entry> samples;
+	std::set<Key> requested;		//!< queued or being decoded
+
+	uint32 maxsize;
+	uint32 cursize;
+	uint32 hits, misses, decoded, evictions;
+
+	// Shared with the decoder thread, guarded by mutex
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* jobcond;			//!< signalled when a job is queued
+	SDL_cond* idlecond;			//!< signalled when a job is done
+	std::list<Job> queue;
+	std::list<Job> done;
+	Job* current;				//!< the job being decoded, or 0
+	bool quit;
+
+	static AudioSampleCache* audiosamplecache;
+};
+
+}
+
+#endif //AUDIOSAMPLECACHE_H_INCLUDED
@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#include "pent_include.h"
+#include "MixerKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MIXER_NEON
+#include <arm_neon.h>
+#endif
+
+// The volume is applied in single precision floating point, which is exact
+// as long as sample*volume fits in 24 bits. Truncating the result then
+// gives the same rounding as the integer division the scalar code does.
+
+namespace Pentagram {
+namespace MixerKernels {
+
+const char* getName()
+{
+#if defined(MIXER_SSE2)
+	return "SSE2";
+#elif defined(MIXER_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+void widen(sint32 *mix, const sint16 *src, uint32 count)
+{
+	uint32 i = 0;
+
+#if defined(MIXER_SSE2)
+	for (; i + 8 <= count; i += 8) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+		// Sign extend by putting the samples in the high halves
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mix+i), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mix+i+4), hi);
+	}
+#elif defined(MIXER_NEON)
+	for (; i + 8 <= count; i += 8) {
+		int16x8_t s = vld1q_s16(src+i);
+		vst1q_s32(mix+i, vmovl_s16(vget_low_s16(s)));
+		vst1q_s32(mix+i+4, vmovl_s16(vget_high_s16(s)));
+	}
+#endif
+
+	for (; i < count; ++i)
+		mix[i] = src[i];
+}
+
+void narrow(sint16 *dest, const sint32 *mix, uint32 count)
+{
+	uint32 i = 0;
+
+#if defined(MIXER_SSE2)
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix+i));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix+i+4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest+i),
+						 _mm_packs_epi32(lo, hi));
+	}
+#elif defined(MIXER_NEON)
+	for (; i + 8 <= count; i += 8) {
+		int16x4_t lo = vqmovn_s32(vld1q_s32(mix+i));
+		int16x4_t hi = vqmovn_s32(vld1q_s32(mix+i+4));
+		vst1q_s16(dest+i, vcombine_s16(lo, hi));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		sint32 s = mix[i];
+		if (s < -32768) s = -32768;
+		else if (s > 32767) s = 32767;
+		dest[i] = static_cast<sint16>(s);
+	}
+}
+
+void mixMono(sint32 *mix, const sint32 *src, uint32 count, int vol)
+{
+	uint32 i = 0;
+
+#if defined(MIXER_SSE2)
+	__m128 v = _mm_set1_ps(vol / 256.0f);
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+		__m128i r = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(s), v));
+		__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mix+i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mix+i),
+						 _mm_add_epi32(m, r));
+	}
+#elif defined(MIXER_NEON)
+	float v = vol / 256.0f;
+	for (; i + 4 <= count; i += 4) {
+		int32x4_t r = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src+i)), v));
+		vst1q_s32(mix+i, vaddq_s32(vld1q_s32(mix+i), r));
+	}
+#endif
+
+	for (; i < count; ++i)
+		mix[i] += (src[i]*vol)/256;
+}
+
+void mixMonoToStereo(sint32 *mix, const sint32 *src, uint32 count,
+					 int lvol, int rvol)
+{
+	uint32 i = 0;
+
+#if defined(MIXER_SSE2)
+	__m128 lv = _mm_set1_ps(lvol / 256.0f);
+	__m128 rv = _mm_set1_ps(rvol / 256.0f);
+	for (; i + 4 <= count; i += 4) {
+		__m128 s = _mm_cvtepi32_ps(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i)));
+		__m128i l = _mm_cvttps_epi32(_mm_mul_ps(s, lv));
+		__m128i r = _mm_cvttps_epi32(_mm_mul_ps(s, rv));
+
+		sint32 *m = mix + 2*i;
+		__m128i m0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m));
+		__m128i m1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m+4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(m),
+						 _mm_add_epi32(m0, _mm_unpacklo_epi32(l, r)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(m+4),
+						 _mm_add_epi32(m1, _mm_unpackhi_epi32(l, r)));
+	}
+#elif defined(MIXER_NEON)
+	float lv = lvol / 256.0f;
+	float rv = rvol / 256.0f;
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t s = vcvtq_f32_s32(vld1q_s32(src+i));
+		int32x4x2_t m = vld2q_s32(mix + 2*i);
+		m.val[0] = vaddq_s32(m.val[0], vcvtq_s32_f32(vmulq_n_f32(s, lv)));
+		m.val[1] = vaddq_s32(m.val[1], vcvtq_s32_f32(vmulq_n_f32(s, rv)));
+		vst2q_s32(mix + 2*i, m);
+	}
+#endif
+
+	for (; i < count; ++i) {
+		mix[2*i] += (src[i]*lvol)/256;
+		mix[2*i+1] += (src[i]*rvol)/256;
+	}
+}
+
+}
+}
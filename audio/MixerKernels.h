@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#ifndef MIXERKERNELS_H_INCLUDED
+#define MIXERKERNELS_H_INCLUDED
+
+// The inner loops of the AudioMixer. The AudioChannels mix into a buffer of
+// 32 bit samples without clamping, and the buffer is clamped to 16 bit once
+// at the end. Uses SSE2 or NEON where the compiler provides them.
+
+namespace Pentagram {
+namespace MixerKernels {
+
+//! Name of the instruction set the kernels were compiled for
+const char* getName();
+
+//! Copy 16 bit samples into the mix buffer
+void widen(sint32 *mix, const sint16 *src, uint32 count);
+
+//! Clamp the mix buffer to 16 bit samples
+void narrow(sint16 *dest, const sint32 *mix, uint32 count);
+
+//! mix[i] += src[i]*vol/256, rounded towards zero
+void mixMono(sint32 *mix, const sint32 *src, uint32 count, int vol);
+
+//! mix[2i] += src[i]*lvol/256 and mix[2i+1] += src[i]*rvol/256,
+//! rounded towards zero
+void mixMonoToStereo(sint32 *mix, const sint32 *src, uint32 count,
+					 int lvol, int rvol);
+
+}
+}
+
+#endif //MIXERKERNELS_H_INCLUDED
@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "SoundFlex.h"
 #include "SonarcAudioSample.h"
+#include "AudioSampleCache.h"
 #include "IDataSource.h"
 
 DEFINE_RUNTIME_CLASSTYPE_CODE(SoundFlex,Pentagram::Archive);
@@ -32,10 +33,31 @@ SoundFlex::SoundFlex(IDataSource* ds) : Archive(ds)
 
 SoundFlex::~SoundFlex()
 {
+	Pentagram::AudioSampleCache* samplecache =
+		Pentagram::AudioSampleCache::get_instance();
+	if (samplecache) samplecache->forget(this);
+
 	Archive::uncache();
 	delete [] samples;
 }
 
+Pentagram::AudioSample * SoundFlex::getSample(uint32 index)
+{
+	if (index >= count) return 0;
+	cache(index);
+	if (!samples[index]) return 0;
+
+	Pentagram::AudioSampleCache* samplecache =
+		Pentagram::AudioSampleCache::get_instance();
+	if (samplecache) {
+		Pentagram::AudioSample* decoded =
+			samplecache->getSample(this, index, samples[index]);
+		if (decoded) return decoded;
+	}
+
+	return samples[index];
+}
+
 void SoundFlex::cache(uint32 index)
 {
 	if (index >= count) return;
@@ -62,6 +84,10 @@ void SoundFlex::uncache(uint32 index)
 	if (index >= count) return;
 	if (!samples) return;
 
+	Pentagram::AudioSampleCache* samplecache =
+		Pentagram::AudioSampleCache::get_instance();
+	if (samplecache && samples[index]) samplecache->forget(this, index);
+
 	delete samples[index];
 	samples[index] = 0;
 }
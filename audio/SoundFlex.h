@@ -33,13 +33,9 @@ public:
 	SoundFlex (IDataSource* ds);
 	~SoundFlex();
 
-	//! Get an audiosample
-	Pentagram::AudioSample * getSample(uint32 index)
-	{
-		if (index >= count) return 0;
-		cache(index);
-		return samples[index];
-	}
+	//! Get an audiosample. If the AudioSampleCache has a decoded copy,
+	//! that is returned instead.
+	Pentagram::AudioSample * getSample(uint32 index);
 
 	virtual void cache(uint32 index);
 	virtual void uncache(uint32 index);
@@ -30,9 +30,11 @@
 #include "databuf.h"
 #else
 #include "IDataSource.h"
+#ifndef PENTAGRAM_IN_OPLVERIFY
 #include "GameData.h"
 #include "MusicFlex.h"
 #endif
+#endif
 
 #include <cmath>
 
@@ -206,7 +208,7 @@ const unsigned char FMOplMidiDriver::adlib_opadd[9] = {
 //
 // Constructor
 //
-FMOplMidiDriver::FMOplMidiDriver() : LowLevelMidiDriver()
+FMOplMidiDriver::FMOplMidiDriver() : LowLevelMidiDriver(), opl(0)
 {
 }
 
@@ -248,7 +250,8 @@ int FMOplMidiDriver::open()
 		chp[i][CHP_VEL] = 0;
 	}
 
-#ifndef PENTAGRAM_IN_EXULT
+	// tools/oplverify has no game data, and plays with the GM instruments
+#if !defined(PENTAGRAM_IN_EXULT) && !defined(PENTAGRAM_IN_OPLVERIFY)
 	IDataSource *timbres = GameData::get_instance()->getMusic()->getAdlibTimbres();
 	if (timbres) 
 	{
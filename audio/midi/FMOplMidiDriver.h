@@ -49,6 +49,8 @@ protected:
 	virtual bool		isFMSynth() { return true; }
 	virtual void		loadTimbreLibrary(IDataSource*, TimbreLibraryType type);
 
+	FMOpl_Pentagram::FM_OPL *opl;
+
 private:
 
 	static const unsigned char midi_fm_instruments_table[128][11];
@@ -96,7 +98,6 @@ private:
 	void			loadXMIDITimbres(IDataSource *ds);
 	void			loadU7VoiceTimbres(IDataSource *ds);
 
-	FMOpl_Pentagram::FM_OPL *opl;
 	midi_channel ch[16];
 };
 
@@ -26,6 +26,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ODataSource.h"
 #endif
 
+#include <map>
+
 #ifndef UNDER_CE
 using std::atof;
 using std::atoi;
@@ -223,12 +225,55 @@ uint32 XMidiEventList::convertListToMTrk (ODataSource *dest)
 void XMidiEventList::decerementCounter()
 {
 	if (--counter < 0) {
-		deleteEventList(events);
+		deleteEventList(events, compacted);
 		XMidiEvent::Free(this);
 	}
 }
 
-void XMidiEventList::deleteEventList (XMidiEvent *mlist)
+void XMidiEventList::compact()
+{
+	if (compacted || !events) return;
+
+	XMidiEvent *event;
+	XMidiEvent *next;
+	uint32 count = 0;
+
+	for (event = events; event; event = event->next)
+		count++;
+
+	// Where each of the branch index events ends up
+	std::map<XMidiEvent*, XMidiEvent*> moved;
+	for (event = branches; event; event = event->ex.branch_index.next_branch)
+		moved[event] = 0;
+
+	XMidiEvent *array = XMidiEvent::Calloc<XMidiEvent>(count);
+	uint32 i = 0;
+
+	for (event = events; event; event = next, i++)
+	{
+		next = event->next;
+
+		array[i] = *event;
+		array[i].next = next ? &array[i+1] : 0;
+
+		std::map<XMidiEvent*, XMidiEvent*>::iterator it = moved.find(event);
+		if (it != moved.end()) it->second = &array[i];
+
+		XMidiEvent::Free(event);
+	}
+
+	events = array;
+	if (branches) branches = moved[branches];
+	for (event = branches; event; event = event->ex.branch_index.next_branch)
+	{
+		next = event->ex.branch_index.next_branch;
+		if (next) event->ex.branch_index.next_branch = moved[next];
+	}
+
+	compacted = true;
+}
+
+void XMidiEventList::deleteEventList (XMidiEvent *mlist, bool compacted)
 {
 	XMidiEvent *event;
 	XMidiEvent *next;
@@ -241,6 +286,8 @@ void XMidiEventList::deleteEventList (XMidiEvent *mlist)
 		next = event->next;
 		// We only do this with sysex
 		if ((event->status>>4) == 0xF && event->ex.sysex_data.buffer) XMidiEvent::Free (event->ex.sysex_data.buffer);
-		XMidiEvent::Free (event);
+		if (!compacted) XMidiEvent::Free (event);
 	}
+
+	if (compacted) XMidiEvent::Free (mlist);
 }
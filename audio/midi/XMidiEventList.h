@@ -28,12 +28,13 @@ class ODataSource;
 class XMidiEventList 
 {
 	int				counter;
-	
+	bool			compacted;		//!< events is a single array
+
 	// Helper funcs for Write
 	int				putVLQ(ODataSource *dest, uint32 value);
 	uint32			convertListToMTrk (ODataSource *dest);
 
-	static void		deleteEventList (XMidiEvent *list);
+	static void		deleteEventList (XMidiEvent *list, bool compacted);
 
 public:
 	uint16			chan_mask;
@@ -51,6 +52,11 @@ public:
 	//! Decrement the counter and delete the event list, if possible
 	void			decerementCounter ();
 
+	//! Move the events into a single array, in the same order and still
+	//! linked with next, so playing the list reads memory in order.
+	//! Nothing may point at the events yet.
+	void			compact ();
+
 	//! Find the Sequence Branch Event for the index 
 	//! \param index The index to search for
 	//! \return The event found, or 0
@@ -527,10 +527,14 @@ XMidiFile::XMidiFile(IDataSource *source, int pconvert) : num_tracks(0),
 {
 	std::memset(bank127,0,sizeof(bank127));
 	
-	ExtractTracks (source);
+	if (!ExtractTracks (source)) return;
 
 	// SysEx data
 	if (pconvert >= XMIDIFILE_HINT_U7VOICE_MT_FILE) InsertDisplayEvents();
+
+	// The lists are only played from now on
+	for (int i=0; i < num_tracks; i++)
+		events[i]->compact();
 }
 
 XMidiFile::~XMidiFile()
@@ -1687,6 +1691,7 @@ int XMidiFile::ExtractTracks (IDataSource *source)
 			
 			//delete [] events;
 			XMidiEvent::Free (events);
+			events = NULL;
 			
 			return 0;		
 		}
@@ -1730,6 +1735,7 @@ int XMidiFile::ExtractTracks (IDataSource *source)
 			}
 			
 			XMidiEvent::Free (events);
+			events = NULL;
 			
 			return 0;
 				
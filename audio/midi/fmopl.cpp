@@ -297,41 +297,45 @@ inline void OPL_KEYOFF(OPL_SLOT *SLOT)
 	}
 }
 
+/* ---------- envelope generator phase change ---------- */
+inline void OPL_ENV_NEXT( OPL_SLOT *SLOT )
+{
+	switch( SLOT->evm ){
+	case ENV_MOD_AR: /* ATTACK -> DECAY1 */
+		/* next DR */
+		SLOT->evm = ENV_MOD_DR;
+		SLOT->evc = EG_DST;
+		SLOT->eve = SLOT->SL;
+		SLOT->evs = SLOT->evsd;
+		break;
+	case ENV_MOD_DR: /* DECAY -> SL or RR */
+		SLOT->evc = SLOT->SL;
+		SLOT->eve = EG_DED;
+		if(SLOT->eg_typ)
+		{
+			SLOT->evs = 0;
+		}
+		else
+		{
+			SLOT->evm = ENV_MOD_RR;
+			SLOT->evs = SLOT->evsr;
+		}
+		break;
+	case ENV_MOD_RR: /* RR -> OFF */
+		SLOT->evc = EG_OFF;
+		SLOT->eve = EG_OFF+1;
+		SLOT->evs = 0;
+		break;
+	}
+}
+
 /* ---------- calcrate Envelope Generator & Phase Generator ---------- */
 /* return : envelope output */
 inline uint32 OPL_CALC_SLOT( OPL_SLOT *SLOT )
 {
 	/* calcrate envelope generator */
 	if( (SLOT->evc+=SLOT->evs) >= SLOT->eve )
-	{
-		switch( SLOT->evm ){
-		case ENV_MOD_AR: /* ATTACK -> DECAY1 */
-			/* next DR */
-			SLOT->evm = ENV_MOD_DR;
-			SLOT->evc = EG_DST;
-			SLOT->eve = SLOT->SL;
-			SLOT->evs = SLOT->evsd;
-			break;
-		case ENV_MOD_DR: /* DECAY -> SL or RR */
-			SLOT->evc = SLOT->SL;
-			SLOT->eve = EG_DED;
-			if(SLOT->eg_typ)
-			{
-				SLOT->evs = 0;
-			}
-			else
-			{
-				SLOT->evm = ENV_MOD_RR;
-				SLOT->evs = SLOT->evsr;
-			}
-			break;
-		case ENV_MOD_RR: /* RR -> OFF */
-			SLOT->evc = EG_OFF;
-			SLOT->eve = EG_OFF+1;
-			SLOT->evs = 0;
-			break;
-		}
-	}
+		OPL_ENV_NEXT(SLOT);
 	/* calcrate envelope */
 	return SLOT->TLL+ENV_CURVE[SLOT->evc>>ENV_BITS]+(SLOT->ams ? ams : 0);
 }
@@ -557,6 +561,219 @@ inline void OPL_CALC_RH( OPL_CH *CH )
 		outd[0] += OP_OUT(SLOT7_2,env_hh,tone8)*2;
 }
 
+/* ---------- block renderer ---------- */
+/* The chip is rendered OPL_BLOCK samples at a time. The LFO is calculated
+   for the whole block first, channels that are silent for the block are
+   skipped, and the others are calculated over the whole block with their
+   state in locals. This gives exactly the same output as calculating one
+   sample at a time with OPL_CALC_CH. */
+#define OPL_BLOCK 64
+
+typedef struct opl_block {
+	int ams[OPL_BLOCK];			/* LFO amplitude modulation    */
+	int vib[OPL_BLOCK];			/* LFO vibrato                 */
+	int out[OPL_BLOCK];			/* channel output              */
+	int out2[OPL_BLOCK];		/* second channel output       */
+} OPL_BLOCKBUF;
+
+#define OP_OUT_BLOCK(wave,cnt,env,con)   wave[((cnt+con)/(0x1000000/SIN_ENT))&(SIN_ENT-1)][env]
+
+/* ---------- LFO for a block ---------- */
+inline void OPL_CALC_LFO_BLOCK( OPL_BLOCKBUF *B, int length, uint32 &amsCnt, uint32 &vibCnt )
+{
+	for( int i=0; i < length ; i++ )
+	{
+		B->ams[i] = ams_table[(amsCnt+=amsIncr)>>AMS_SHIFT];
+		B->vib[i] = vib_table[(vibCnt+=vibIncr)>>VIB_SHIFT];
+	}
+}
+
+/* ---------- is the slot silent until the next key on ---------- */
+inline bool OPL_SLOT_OFF( const OPL_SLOT *SLOT )
+{
+	return SLOT->evc == EG_OFF && SLOT->evs == 0 && SLOT->eve > EG_OFF;
+}
+
+/* ---------- state of one channel, in locals ---------- */
+typedef struct opl_ch_state {
+	OPL_CH *CH;
+	/* envelope generators */
+	int evc1, evs1, eve1, TLL1;
+	int evc2, evs2, eve2, TLL2;
+	bool ams1, ams2;
+	/* phase generators */
+	int **wave1, **wave2;
+	uint32 cnt1, cnt2;
+	uint32 incr1, incr2;
+	bool vib1, vib2;
+	/* connection */
+	int FB;
+	bool serial;
+	int op1_0, op1_1;
+} OPL_CH_STATE;
+
+inline void OPL_CH_LOAD( OPL_CH_STATE &S, OPL_CH *CH )
+{
+	OPL_SLOT *slot1 = &CH->SLOT[SLOT1];
+	OPL_SLOT *slot2 = &CH->SLOT[SLOT2];
+
+	S.CH = CH;
+	S.evc1 = slot1->evc; S.evs1 = slot1->evs; S.eve1 = slot1->eve; S.TLL1 = slot1->TLL;
+	S.evc2 = slot2->evc; S.evs2 = slot2->evs; S.eve2 = slot2->eve; S.TLL2 = slot2->TLL;
+	S.ams1 = slot1->ams != 0;
+	S.ams2 = slot2->ams != 0;
+	S.wave1 = slot1->wavetable;
+	S.wave2 = slot2->wavetable;
+	S.cnt1 = slot1->Cnt;
+	S.cnt2 = slot2->Cnt;
+	S.incr1 = slot1->Incr;
+	S.incr2 = slot2->Incr;
+	S.vib1 = slot1->vib != 0;
+	S.vib2 = slot2->vib != 0;
+	S.FB = CH->FB;
+	S.serial = CH->connect1 == &feedback2;
+	S.op1_0 = CH->op1_out[0];
+	S.op1_1 = CH->op1_out[1];
+}
+
+inline void OPL_CH_STORE( const OPL_CH_STATE &S )
+{
+	OPL_CH *CH = S.CH;
+	CH->SLOT[SLOT1].evc = S.evc1;
+	CH->SLOT[SLOT2].evc = S.evc2;
+	CH->SLOT[SLOT1].Cnt = S.cnt1;
+	CH->SLOT[SLOT2].Cnt = S.cnt2;
+	CH->op1_out[0] = S.op1_0;
+	CH->op1_out[1] = S.op1_1;
+}
+
+/* ---------- envelope phase change, on the state in locals ---------- */
+inline void OPL_ENV_NEXT_LOCAL( OPL_SLOT *SLOT, int &evc, int &evs, int &eve )
+{
+	SLOT->evc = evc;
+	OPL_ENV_NEXT(SLOT);
+	evc = SLOT->evc;
+	evs = SLOT->evs;
+	eve = SLOT->eve;
+}
+
+/* ---------- calcrate one sample of a channel, like OPL_CALC_CH ---------- */
+inline int OPL_CALC_CH_STATE( OPL_CH_STATE &S, int ams_out, int vib_out )
+{
+	int fb = 0;
+	int out = 0;
+	uint32 env_out;
+
+	/* SLOT 1 */
+	if( (S.evc1+=S.evs1) >= S.eve1 )
+		OPL_ENV_NEXT_LOCAL(&S.CH->SLOT[SLOT1], S.evc1, S.evs1, S.eve1);
+	env_out = S.TLL1+ENV_CURVE[S.evc1>>ENV_BITS]+(S.ams1 ? ams_out : 0);
+	if( env_out < EG_ENT-1 )
+	{
+		int op;
+		/* PG */
+		if(S.vib1) S.cnt1 += (S.incr1*vib_out/VIB_RATE);
+		else       S.cnt1 += S.incr1;
+		/* connectoion */
+		if(S.FB)
+		{
+			int feedback1 = (S.op1_0+S.op1_1)>>S.FB;
+			S.op1_1 = S.op1_0;
+			op = S.op1_0 = OP_OUT_BLOCK(S.wave1,S.cnt1,env_out,feedback1);
+		}
+		else
+		{
+			op = OP_OUT_BLOCK(S.wave1,S.cnt1,env_out,0);
+		}
+		if(S.serial) fb = op;
+		else         out = op;
+	}else
+	{
+		S.op1_1 = S.op1_0;
+		S.op1_0 = 0;
+	}
+	/* SLOT 2 */
+	if( (S.evc2+=S.evs2) >= S.eve2 )
+		OPL_ENV_NEXT_LOCAL(&S.CH->SLOT[SLOT2], S.evc2, S.evs2, S.eve2);
+	env_out = S.TLL2+ENV_CURVE[S.evc2>>ENV_BITS]+(S.ams2 ? ams_out : 0);
+	if( env_out < EG_ENT-1 )
+	{
+		/* PG */
+		if(S.vib2) S.cnt2 += (S.incr2*vib_out/VIB_RATE);
+		else       S.cnt2 += S.incr2;
+		/* connectoion */
+		out += OP_OUT_BLOCK(S.wave2,S.cnt2,env_out,fb);
+	}
+	return out;
+}
+
+/* ---------- calcrate two channels for a block ---------- */
+/* The channels are calculated side by side, as the operator feedback of
+   one channel alone is a long chain of dependent table lookups */
+inline void OPL_CALC_CH2_BLOCK( OPL_CH *CHa, OPL_CH *CHb, OPL_BLOCKBUF *B, int *outb, int length )
+{
+	OPL_CH_STATE Sa, Sb;
+	OPL_CH_LOAD(Sa, CHa);
+	OPL_CH_LOAD(Sb, CHb);
+	for( int i=0; i < length ; i++ )
+	{
+		B->out[i] = OPL_CALC_CH_STATE(Sa, B->ams[i], B->vib[i]);
+		outb[i] = OPL_CALC_CH_STATE(Sb, B->ams[i], B->vib[i]);
+	}
+	OPL_CH_STORE(Sa);
+	OPL_CH_STORE(Sb);
+}
+
+/* ---------- calcrate one channel for a block ---------- */
+inline void OPL_CALC_CH_BLOCK( OPL_CH *CH, OPL_BLOCKBUF *B, int length )
+{
+	OPL_CH_STATE S;
+	OPL_CH_LOAD(S, CH);
+	for( int i=0; i < length ; i++ )
+		B->out[i] = OPL_CALC_CH_STATE(S, B->ams[i], B->vib[i]);
+	OPL_CH_STORE(S);
+}
+
+/* ---------- silent channels ---------- */
+/* return : true if the channel is silent for the block. It's updated, as
+   the envelopes stay off and only the feedback is shifted out */
+inline bool OPL_CH_OFF_BLOCK( OPL_CH *CH, int length )
+{
+	if( !OPL_SLOT_OFF(&CH->SLOT[SLOT1]) || !OPL_SLOT_OFF(&CH->SLOT[SLOT2]) )
+		return false;
+
+	CH->op1_out[1] = (length > 1) ? 0 : CH->op1_out[0];
+	CH->op1_out[0] = 0;
+	return true;
+}
+
+/* ---------- calcrate rythm block for a block ---------- */
+/* The rythm slots share the noise and the phase of channel 7 and 8, so
+   they're still calculated one sample at a time */
+inline void OPL_CALC_RH_BLOCK( OPL_CH *CH, OPL_BLOCKBUF *B, int length )
+{
+	for( int i=0; i < length ; i++ )
+	{
+		ams = B->ams[i];
+		vib = B->vib[i];
+		outd[0] = 0;
+		OPL_CALC_RH(CH);
+		B->out[i] = outd[0];
+	}
+}
+
+inline void OPL_MIX_BLOCK( int *mix, const int *out, int length )
+{
+	for( int i=0; i < length ; i++ )
+		mix[i] += out[i];
+}
+
+inline void OPL_MIX_PAN_BLOCK( int *mix, const int *out, int length, int pan )
+{
+	for( int i=0; i < length ; i++ )
+		mix[i] += (out[i]>>6)*pan;
+}
+
 /* ----------- initialize time tabls ----------- */
 static void init_timetables( FM_OPL *OPL , int ARRATE , int DRRATE )
 {
@@ -949,17 +1166,9 @@ static void OPL_UnLockTable(void)
 /*		YM3812 local section                                                   */
 /*******************************************************************************/
 
-/* ---------- update one of chip ----------- */
-void YM3812UpdateOne_Mono(FM_OPL *OPL, sint16 *buffer, int length)
+/* ---------- set up the work table for a chip ----------- */
+static void OPL_SELECT_CHIP(FM_OPL *OPL)
 {
-    int i;
-	int data;
-	sint16 *buf = buffer;
-	uint32 amsCnt  = OPL->amsCnt;
-	uint32 vibCnt  = OPL->vibCnt;
-	uint8 rythm = OPL->rythm&0x20;
-	OPL_CH *CH,*R_CH;
-
 	if( (void *)OPL != cur_chip ){
 		cur_chip = (void *)OPL;
 		/* channel pointers */
@@ -976,6 +1185,154 @@ void YM3812UpdateOne_Mono(FM_OPL *OPL, sint16 *buffer, int length)
 		ams_table = OPL->ams_table;
 		vib_table = OPL->vib_table;
 	}
+}
+
+/* ---------- active channels for a block ---------- */
+/* return : number of channels that aren't silent */
+inline int OPL_ACTIVE_BLOCK( OPL_CH *R_CH, OPL_CH **active, int length )
+{
+	int nactive = 0;
+	for(OPL_CH *CH=S_CH ; CH < R_CH ; CH++)
+	{
+		if( !OPL_CH_OFF_BLOCK(CH, length) )
+			active[nactive++] = CH;
+	}
+	return nactive;
+}
+
+inline void OPL_MIX_STEREO_BLOCK( int *left, int *right, const int *out, int length, int pan )
+{
+	if (pan <= 64) OPL_MIX_BLOCK(left, out, length);
+	else OPL_MIX_PAN_BLOCK(left, out, length, 127-pan);
+	if (pan >= 64) OPL_MIX_BLOCK(right, out, length);
+	else OPL_MIX_PAN_BLOCK(right, out, length, pan);
+}
+
+/* ---------- update one of chip ----------- */
+void YM3812UpdateOne_Mono(FM_OPL *OPL, sint16 *buffer, int length)
+{
+	OPL_BLOCKBUF B;
+	int mix[OPL_BLOCK];
+	OPL_CH *active[9];
+	uint32 amsCnt  = OPL->amsCnt;
+	uint32 vibCnt  = OPL->vibCnt;
+	uint8 rythm = OPL->rythm&0x20;
+	OPL_CH *R_CH;
+	int i,c,nactive;
+
+	OPL_SELECT_CHIP(OPL);
+	R_CH = rythm ? &S_CH[6] : E_CH;
+	while( length > 0 )
+	{
+		int n = length < OPL_BLOCK ? length : OPL_BLOCK;
+
+		/* LFO */
+		OPL_CALC_LFO_BLOCK(&B, n, amsCnt, vibCnt);
+		for( i=0; i < n ; i++ )
+			mix[i] = 0;
+		/* FM part */
+		nactive = OPL_ACTIVE_BLOCK(R_CH, active, n);
+		for( c=0; c+1 < nactive ; c+=2 )
+		{
+			OPL_CALC_CH2_BLOCK(active[c], active[c+1], &B, B.out2, n);
+			OPL_MIX_BLOCK(mix, B.out, n);
+			OPL_MIX_BLOCK(mix, B.out2, n);
+		}
+		if( c < nactive )
+		{
+			OPL_CALC_CH_BLOCK(active[c], &B, n);
+			OPL_MIX_BLOCK(mix, B.out, n);
+		}
+		/* Rythn part */
+		if(rythm)
+		{
+			OPL_CALC_RH_BLOCK(S_CH, &B, n);
+			OPL_MIX_BLOCK(mix, B.out, n);
+		}
+		/* limit check and store to sound buffer */
+		for( i=0; i < n ; i++ )
+			buffer[i] = Limit( mix[i] , OPL_MAXOUT, OPL_MINOUT ) >> OPL_OUTSB;
+
+		buffer += n;
+		length -= n;
+	}
+
+	OPL->amsCnt = amsCnt;
+	OPL->vibCnt = vibCnt;
+}
+
+void YM3812UpdateOne_Stereo(FM_OPL *OPL, sint16 *buffer, int length)
+{
+	OPL_BLOCKBUF B;
+	int left[OPL_BLOCK];
+	int right[OPL_BLOCK];
+	OPL_CH *active[9];
+	uint32 amsCnt  = OPL->amsCnt;
+	uint32 vibCnt  = OPL->vibCnt;
+	uint8 rythm = OPL->rythm&0x20;
+	OPL_CH *R_CH;
+	int i,c,nactive;
+
+	OPL_SELECT_CHIP(OPL);
+	R_CH = rythm ? &S_CH[6] : E_CH;
+	while( length > 0 )
+	{
+		int n = length < OPL_BLOCK ? length : OPL_BLOCK;
+
+		/* LFO */
+		OPL_CALC_LFO_BLOCK(&B, n, amsCnt, vibCnt);
+		for( i=0; i < n ; i++ )
+			left[i] = right[i] = 0;
+		/* FM part */
+		nactive = OPL_ACTIVE_BLOCK(R_CH, active, n);
+		for( c=0; c+1 < nactive ; c+=2 )
+		{
+			OPL_CALC_CH2_BLOCK(active[c], active[c+1], &B, B.out2, n);
+			OPL_MIX_STEREO_BLOCK(left, right, B.out, n, active[c]->PAN);
+			OPL_MIX_STEREO_BLOCK(left, right, B.out2, n, active[c+1]->PAN);
+		}
+		if( c < nactive )
+		{
+			OPL_CALC_CH_BLOCK(active[c], &B, n);
+			OPL_MIX_STEREO_BLOCK(left, right, B.out, n, active[c]->PAN);
+		}
+		/* Rythn part */
+		if(rythm)
+		{
+			OPL_CALC_RH_BLOCK(S_CH, &B, n);
+			OPL_MIX_BLOCK(left, B.out, n);
+			OPL_MIX_BLOCK(right, B.out, n);
+		}
+		/* limit check and store to sound buffer */
+		for( i=0; i < n ; i++ )
+		{
+			buffer[i*2] = Limit( left[i] , OPL_MAXOUT, OPL_MINOUT ) >> OPL_OUTSB;
+			buffer[i*2+1] = Limit( right[i] , OPL_MAXOUT, OPL_MINOUT ) >> OPL_OUTSB;
+		}
+
+		buffer += n*2;
+		length -= n;
+	}
+
+	OPL->amsCnt = amsCnt;
+	OPL->vibCnt = vibCnt;
+}
+
+#ifdef PENTAGRAM_IN_OPLVERIFY
+/* ---------- update one of chip, one sample at a time ----------- */
+/* This is how the chip was rendered before the block renderer. It's only
+   built into tools/oplverify, which checks the block renderer against it */
+void YM3812UpdateOneRef_Mono(FM_OPL *OPL, sint16 *buffer, int length)
+{
+    int i;
+	int data;
+	sint16 *buf = buffer;
+	uint32 amsCnt  = OPL->amsCnt;
+	uint32 vibCnt  = OPL->vibCnt;
+	uint8 rythm = OPL->rythm&0x20;
+	OPL_CH *CH,*R_CH;
+
+	OPL_SELECT_CHIP(OPL);
 	R_CH = rythm ? &S_CH[6] : E_CH;
     for( i=0; i < length ; i++ )
 	{
@@ -1000,7 +1357,7 @@ void YM3812UpdateOne_Mono(FM_OPL *OPL, sint16 *buffer, int length)
 	OPL->vibCnt = vibCnt;
 }
 
-void YM3812UpdateOne_Stereo(FM_OPL *OPL, sint16 *buffer, int length)
+void YM3812UpdateOneRef_Stereo(FM_OPL *OPL, sint16 *buffer, int length)
 {
     int i;
 	int data;
@@ -1012,22 +1369,7 @@ void YM3812UpdateOne_Stereo(FM_OPL *OPL, sint16 *buffer, int length)
 	uint8 rythm = OPL->rythm&0x20;
 	OPL_CH *CH,*R_CH;
 
-	if( (void *)OPL != cur_chip ){
-		cur_chip = (void *)OPL;
-		/* channel pointers */
-		S_CH = OPL->P_CH;
-		E_CH = &S_CH[9];
-		/* rythm slot */
-		SLOT7_1 = &S_CH[7].SLOT[SLOT1];
-		SLOT7_2 = &S_CH[7].SLOT[SLOT2];
-		SLOT8_1 = &S_CH[8].SLOT[SLOT1];
-		SLOT8_2 = &S_CH[8].SLOT[SLOT2];
-		/* LFO state */
-		amsIncr = OPL->amsIncr;
-		vibIncr = OPL->vibIncr;
-		ams_table = OPL->ams_table;
-		vib_table = OPL->vib_table;
-	}
+	OPL_SELECT_CHIP(OPL);
 	R_CH = rythm ? &S_CH[6] : E_CH;
     for( i=0; i < length ; i++ )
 	{
@@ -1069,6 +1411,7 @@ void YM3812UpdateOne_Stereo(FM_OPL *OPL, sint16 *buffer, int length)
 	OPL->amsCnt = amsCnt;
 	OPL->vibCnt = vibCnt;
 }
+#endif
 
 /* ---------- reset a chip ---------- */
 void OPLResetChip(FM_OPL *OPL)
@@ -1142,6 +1485,7 @@ FM_OPL *OPLCreate(int type, int clock, int rate)
 /* ----------  Destroy one of vietual YM3812 ----------       */
 void OPLDestroy(FM_OPL *OPL)
 {
+	if( (void *)OPL == cur_chip ) cur_chip = NULL;
 	OPL_UnLockTable();
 	free(OPL);
 }
@@ -192,6 +192,12 @@ void OPLSetPan(FM_OPL *OPL,int c, int pan);
 void YM3812UpdateOne_Mono(FM_OPL *OPL, sint16 *buffer, int length);
 void YM3812UpdateOne_Stereo(FM_OPL *OPL, sint16 *buffer, int length);
 
+#ifdef PENTAGRAM_IN_OPLVERIFY
+/* The per sample renderer the block renderer above must match */
+void YM3812UpdateOneRef_Mono(FM_OPL *OPL, sint16 *buffer, int length);
+void YM3812UpdateOneRef_Stereo(FM_OPL *OPL, sint16 *buffer, int length);
+#endif
+
 };
 
 #endif //USE_FMOPL_MIDI
@@ -126,6 +126,14 @@ uint8* Archive::getRawObject(uint32 index, uint32* sizep)
 	return f->getObject(index, sizep);
 }
 
+const uint8* Archive::getRawObjectView(uint32 index, uint32* sizep)
+{
+	ArchiveFile* f = findArchiveFile(index);
+	if (!f) return 0;
+
+	return f->getObjectView(index, sizep);
+}
+
 uint32 Archive::getRawSize(uint32 index)
 {
 	ArchiveFile* f = findArchiveFile(index);
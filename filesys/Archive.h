@@ -84,6 +84,9 @@ protected:
 	uint32 count;
 
 	uint8* getRawObject(uint32 index, uint32* sizep=0);
+	//! Get a read-only view of an object, if the ArchiveFile holding it
+	//! can provide one. See ArchiveFile::getObjectView.
+	const uint8* getRawObjectView(uint32 index, uint32* sizep=0);
 	uint32 getRawSize(uint32 index);
 
 private:
@@ -60,6 +60,25 @@ public:
 	virtual uint8* getObject(const std::string& name, uint32* size=0)=0;
 
 
+	//! Get a read-only view of an object, without copying it.
+	//! Returns NULL if the object doesn't exist, or if the archive can't
+	//!  hand out views of it; use getObject then.
+	//! Don't delete the returned buffer. It stays valid as long as the
+	//!  ArchiveFile exists.
+	//! \param index index of object to fetch
+	//! \param size if non-NULL, size of object is stored in *size
+	virtual const uint8* getObjectView(uint32 index, uint32* size=0)
+		{ return 0; }
+
+	//! Get a read-only view of a named object, without copying it.
+	//! See getObjectView(uint32 index)
+	//! \param name name of object to fetch
+	//! \param size if non-NULL, size of object is stored in *size
+	virtual const uint8* getObjectView(const std::string& name,
+									   uint32* size=0)
+		{ return 0; }
+
+
 	//! Get size of object; returns zero if index is invalid.
 	//! See also exists(uint32 index)
 	//! \param index index of object to get size of
@@ -0,0 +1,291 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "filesys/AsyncSavegameWriter.h"
+#include "filesys/SavegameWriter.h"
+#include "filesys/ODataSource.h"
+#include "filesys/FileSystem.h"
+
+AsyncSavegameWriter* AsyncSavegameWriter::asyncsavegamewriter = 0;
+
+static double msSince(Uint64 start)
+{
+	return static_cast<double>(SDL_GetPerformanceCounter() - start) *
+		1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+AsyncSavegameWriter::AsyncSavegameWriter()
+	: building(0), filestart(0), thread(0), current(0), quit(false)
+{
+	assert(asyncsavegamewriter == 0);
+	asyncsavegamewriter = this;
+
+	mutex = SDL_CreateMutex();
+	jobcond = SDL_CreateCond();
+	idlecond = SDL_CreateCond();
+
+	thread = SDL_CreateThread(threadMain_Static, "AsyncSavegameWriter",
+							  static_cast<void*>(this));
+	if (!thread)
+		perr << "AsyncSavegameWriter: could not create thread: "
+			 << SDL_GetError() << std::endl;
+}
+
+AsyncSavegameWriter::~AsyncSavegameWriter()
+{
+	flush();
+
+	if (thread) {
+		SDL_mutexP(mutex);
+		quit = true;
+		SDL_CondSignal(jobcond);
+		SDL_mutexV(mutex);
+		SDL_WaitThread(thread, 0);
+	}
+
+	SDL_DestroyCond(idlecond);
+	SDL_DestroyCond(jobcond);
+	SDL_DestroyMutex(mutex);
+
+	asyncsavegamewriter = 0;
+}
+
+bool AsyncSavegameWriter::begin(const std::string& filename,
+								const std::string& desc, uint32 version)
+{
+	assert(!building);
+
+	// Don't write the same file twice at once
+	if (isWriting(filename))
+		flush();
+
+	std::string tmpname = filename + ".tmp";
+	ODataSource* ods = FileSystem::get_instance()->WriteFile(tmpname);
+	if (!ods) return false;
+
+	building = new Job;
+	building->filename = filename;
+	building->tmpname = tmpname;
+	building->desc = desc;
+	building->version = version;
+	building->ods = ods;
+	building->ok = false;
+
+	return true;
+}
+
+ODataSource* AsyncSavegameWriter::beginFile(const char* name)
+{
+	assert(building);
+
+	Section section;
+	section.name = name;
+	section.buf = new OAutoBufferDataSource(2048);
+	section.size = 0;
+	section.snapshotms = 0;
+	section.writems = 0;
+	building->sections.push_back(section);
+
+	filestart = SDL_GetPerformanceCounter();
+
+	return section.buf;
+}
+
+void AsyncSavegameWriter::endFile()
+{
+	assert(building && !building->sections.empty());
+
+	Section& section = building->sections.back();
+	section.snapshotms = msSince(filestart);
+	section.size = section.buf->getSize();
+}
+
+void AsyncSavegameWriter::commit()
+{
+	assert(building);
+	Job* job = building;
+	building = 0;
+
+	if (!thread) {
+		// no thread, so write it right away
+		write(job);
+		done.push_back(job);
+		poll();
+		return;
+	}
+
+	SDL_mutexP(mutex);
+	queue.push_back(job);
+	SDL_CondSignal(jobcond);
+	SDL_mutexV(mutex);
+}
+
+void AsyncSavegameWriter::poll()
+{
+	std::list<Job*> finished;
+
+	SDL_mutexP(mutex);
+	finished.splice(finished.begin(), done);
+	SDL_mutexV(mutex);
+
+	std::list<Job*>::iterator j;
+	for (j = finished.begin(); j != finished.end(); ++j) {
+		Job* job = *j;
+
+		if (job->ok) {
+			double snapshot = 0, written = 0;
+			uint32 size = 0;
+			for (unsigned int i = 0; i < job->sections.size(); ++i) {
+				snapshot += job->sections[i].snapshotms;
+				written += job->sections[i].writems;
+				size += job->sections[i].size;
+			}
+
+			pout << "Savegame written: " << job->filename << " ("
+				 << size / 1024 << " KB, serialised in " << snapshot
+				 << " ms, written in " << written << " ms)" << std::endl;
+		} else {
+			perr << "Error writing savegame " << job->filename << std::endl;
+		}
+
+		laststats = job->sections;
+		lastfile = job->filename;
+		delete job;
+	}
+}
+
+void AsyncSavegameWriter::flush()
+{
+	SDL_mutexP(mutex);
+	while (!queue.empty() || current)
+		SDL_CondWait(idlecond, mutex);
+	SDL_mutexV(mutex);
+
+	poll();
+}
+
+bool AsyncSavegameWriter::isWriting(const std::string& filename)
+{
+	bool writing = false;
+
+	SDL_mutexP(mutex);
+	if (current && current->filename == filename)
+		writing = true;
+	std::list<Job*>::iterator j;
+	for (j = queue.begin(); j != queue.end(); ++j) {
+		if ((*j)->filename == filename)
+			writing = true;
+	}
+	SDL_mutexV(mutex);
+
+	return writing;
+}
+
+void AsyncSavegameWriter::write(Job* job)
+{
+	SavegameWriter* sgw = new SavegameWriter(job->ods);
+	job->ods = 0;
+
+	bool ok = sgw->writeVersion(job->version);
+	sgw->writeDescription(job->desc);
+
+	for (unsigned int i = 0; i < job->sections.size(); ++i) {
+		Section& section = job->sections[i];
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		if (ok) ok = sgw->writeFile(section.name.c_str(), section.buf);
+
+		FORGET_OBJECT(section.buf);
+		section.writems = msSince(start);
+	}
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	if (ok) ok = sgw->finish();
+
+	// closes the file
+	delete sgw;
+
+	// only replace the old savegame with a complete one
+	if (ok)
+		ok = FileSystem::get_instance()->RenameFile(job->tmpname,
+													job->filename);
+
+	if (!job->sections.empty())
+		job->sections.back().writems += msSince(start);
+
+	job->ok = ok;
+}
+
+int SDLCALL AsyncSavegameWriter::threadMain_Static(void* data)
+{
+	static_cast<AsyncSavegameWriter*>(data)->threadMain();
+	return 0;
+}
+
+void AsyncSavegameWriter::threadMain()
+{
+	SDL_mutexP(mutex);
+	while (!quit) {
+		if (queue.empty()) {
+			SDL_CondWait(jobcond, mutex);
+			continue;
+		}
+
+		current = queue.front();
+		queue.pop_front();
+		SDL_mutexV(mutex);
+
+		write(current);
+
+		SDL_mutexP(mutex);
+		done.push_back(current);
+		current = 0;
+		SDL_CondBroadcast(idlecond);
+	}
+	SDL_mutexV(mutex);
+}
+
+void AsyncSavegameWriter::ConCmd_stats(const Console::ArgvType &/*argv*/)
+{
+	AsyncSavegameWriter* writer = AsyncSavegameWriter::get_instance();
+	if (!writer) return;
+
+	if (writer->laststats.empty()) {
+		pout << "No savegame written yet" << std::endl;
+		return;
+	}
+
+	pout << "Last savegame: " << writer->lastfile << std::endl;
+	pout << "File        Size (bytes)   Serialise (ms)   Write (ms)"
+		 << std::endl;
+
+	double snapshot = 0, written = 0;
+	uint32 size = 0;
+	for (unsigned int i = 0; i < writer->laststats.size(); ++i) {
+		const Section& section = writer->laststats[i];
+		con.Printf("%-11s %12u   %14.2f   %10.2f\n", section.name.c_str(),
+				   section.size, section.snapshotms, section.writems);
+		snapshot += section.snapshotms;
+		written += section.writems;
+		size += section.size;
+	}
+	con.Printf("%-11s %12u   %14.2f   %10.2f\n", "total",
+			   size, snapshot, written);
+}
@@ -0,0 +1,118 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef ASYNCSAVEGAMEWRITER_H
+#define ASYNCSAVEGAMEWRITER_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_thread.h>
+
+class ODataSource;
+class OAutoBufferDataSource;
+
+//! Writes savegames on a background thread.
+//!
+//! The main thread only serialises the game into memory buffers, one per
+//! file in the savegame. Compressing them and writing the zip file happens
+//! on the thread. The savegame is written to a temporary file, which
+//! replaces the real one once it's complete, so an interrupted save
+//! doesn't destroy the previous savegame.
+class AsyncSavegameWriter
+{
+public:
+	AsyncSavegameWriter();
+	~AsyncSavegameWriter();
+
+	static AsyncSavegameWriter* get_instance() { return asyncsavegamewriter; }
+
+	//! Start a new savegame
+	//! \return false if the savegame couldn't be created
+	bool begin(const std::string& filename, const std::string& desc,
+			   uint32 version);
+
+	//! Start a file in the savegame. Serialise it into the returned data
+	//! source, then call endFile().
+	ODataSource* beginFile(const char* name);
+	void endFile();
+
+	//! Queue the savegame to be written
+	void commit();
+
+	//! Report the savegames that have been written since the last call.
+	//! Called every frame.
+	void poll();
+
+	//! Wait until all queued savegames are written
+	void flush();
+
+	//! "AsyncSavegameWriter::stats" console command
+	static void ConCmd_stats(const Console::ArgvType &argv);
+
+private:
+	struct Section
+	{
+		std::string name;
+		OAutoBufferDataSource* buf;
+		uint32 size;
+		double snapshotms;		//!< time spent serialising
+		double writems;			//!< time spent compressing and writing
+	};
+
+	struct Job
+	{
+		std::string filename;
+		std::string tmpname;
+		std::string desc;
+		uint32 version;
+		ODataSource* ods;
+		std::vector<Section> sections;
+		bool ok;
+	};
+
+	static int SDLCALL threadMain_Static(void* data);
+	void threadMain();
+
+	//! Is a savegame queued or being written to filename?
+	bool isWriting(const std::string& filename);
+
+	//! Compress and write a savegame, and rename it into place
+	static void write(Job* job);
+
+	Job* building;				//!< the savegame being serialised, or 0
+	Uint64 filestart;
+
+	std::vector<Section> laststats;	//!< sections of the last written save
+	std::string lastfile;
+
+	// Shared with the writer thread, guarded by mutex
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* jobcond;			//!< signalled when a job is queued
+	SDL_cond* idlecond;			//!< signalled when a job is done
+	std::list<Job*> queue;
+	std::list<Job*> done;
+	Job* current;				//!< the savegame being written, or 0
+	bool quit;
+
+	static AsyncSavegameWriter* asyncsavegamewriter;
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "pent_include.h"
 
 #include "filesys/FileSystem.h"
+#include "filesys/MappedFileDataSource.h"
 
 #ifdef HAVE_SYS_STAT_H
 #include <sys/stat.h>
@@ -33,6 +34,7 @@
 #endif
 
 #include <string>
+#include <cstdio>
 using	std::string;
 
 #include "filesys/ListFiles.h"
@@ -114,6 +116,29 @@ IDataSource* FileSystem::ReadFile(const string &vfn, bool is_text)
 	return new IFileDataSource(f);
 }
 
+// Open a file as readable, memory mapped if possible (0 on failure)
+IDataSource* FileSystem::MapFile(const string &vfn)
+{
+	// Builtin data files are in memory already
+	bool builtin = (memoryfiles.find(vfn) != memoryfiles.end());
+
+	string name = vfn;
+	if ((allowdataoverride || !builtin) &&
+		IMappedFileDataSource::isSupported() && rewrite_virtual_path(name))
+	{
+		switch_slashes(name);
+
+		int uppercasecount = 0;
+		do {
+			IMappedFileDataSource* mapped = new IMappedFileDataSource(name);
+			if (mapped->isValid()) return mapped;
+			delete mapped;
+		} while (base_to_uppercase(name, ++uppercasecount));
+	}
+
+	return ReadFile(vfn);
+}
+
 // Open a streaming file as readable. Streamed (0 on failure)
 ODataSource* FileSystem::WriteFile(const string &vfn, bool is_text)
 {
@@ -126,6 +151,25 @@ ODataSource* FileSystem::WriteFile(const string &vfn, bool is_text)
 	return new OFileDataSource(f);
 }
 
+bool FileSystem::RenameFile(const string &oldvfn, const string &newvfn)
+{
+	string oldname = oldvfn;
+	string newname = newvfn;
+	if (!rewrite_virtual_path(oldname) || !rewrite_virtual_path(newname))
+		return false;
+
+	switch_slashes(oldname);
+	switch_slashes(newname);
+
+#if defined(WIN32)
+	// rename() doesn't replace existing files on Windows
+	return MoveFileExA(oldname.c_str(), newname.c_str(),
+					   MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(oldname.c_str(), newname.c_str()) == 0;
+#endif
+}
+
 /*
  *	Open a file for input,
  *	trying the original name (lower case), and the upper case version
@@ -51,12 +51,26 @@ class FileSystem
 	//! \return 0 on failure
 	IDataSource *ReadFile(const std::string &vfn, bool is_text=false);
 
+	//! Open a file as readable, memory mapped if possible.
+	//! The data source has its whole contents as a raw buffer, so
+	//! archives can hand out objects without copying them.
+	//! Falls back to ReadFile if the file can't be mapped.
+	//! \param vfn the (virtual) filename
+	//! \return 0 on failure
+	IDataSource *MapFile(const std::string &vfn);
+
 	//! Open a file as writable. Streamed.
 	//! \param vfn the (virtual) filename
 	//! \param is_text open in text mode?
 	//! \return 0 on failure
 	ODataSource *WriteFile(const std::string &vfn, bool is_text=false);
 
+	//! Rename a file, replacing the file newvfn if it exists
+	//! \param oldvfn the (virtual) filename of the file
+	//! \param newvfn the (virtual) filename to rename it to
+	//! \return true if successful
+	bool RenameFile(const std::string &oldvfn, const std::string &newvfn);
+
 	//! Mount a virtual path
 	//! \param vpath the name of the vpath (should start with '@')
 	//! \param realpath the name of the path to mount (note that this can
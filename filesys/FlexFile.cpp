@@ -90,6 +90,25 @@ uint8* FlexFile::getObject(uint32 index, uint32* sizep)
 	return object;
 }
 
+const uint8* FlexFile::getObjectView(uint32 index, uint32* sizep)
+{
+	if (index >= count) return 0;
+
+	// Only possible if the whole flex is in memory (or mapped)
+	const uint8* buf = ds->GetRawBuffer();
+	if (!buf) return 0;
+
+	uint32 size = getSize(index);
+	if (size == 0) return 0;
+
+	uint32 offset = getOffset(index);
+	if (offset > ds->getSize() || size > ds->getSize() - offset) return 0;
+
+	if (sizep) *sizep = size;
+
+	return buf + offset;
+}
+
 uint32 FlexFile::getSize(uint32 index)
 {
 	if (index >= count) return 0;
@@ -49,7 +49,16 @@ public:
 		else
 			return 0;
 	}
-	
+
+	virtual const uint8* getObjectView(uint32 index, uint32* size=0);
+	virtual const uint8* getObjectView(const std::string& name,
+									   uint32* size=0) {
+		uint32 index;
+		if (nameToIndex(name, index))
+			return getObjectView(index, size);
+		else
+			return 0;
+	}
 
 	virtual uint32 getSize(uint32 index);
 	virtual uint32 getSize(const std::string& name) {
@@ -114,6 +114,12 @@ class IDataSource
 			return 0; 
 		}
 
+		//! Get the whole data source as a buffer, if it is in memory.
+		//! The buffer stays valid as long as the IDataSource exists.
+		virtual const uint8 *GetRawBuffer() {
+			return 0;
+		}
+
 		/* SDL_RWops functions: */
 
 		static Sint64 rw_seek(SDL_RWops *context, Sint64 offset, int whence)
@@ -434,6 +440,9 @@ public:
 
 	virtual bool eof() { return (static_cast<uint32>(buf_ptr-buf))>=size; }
 
+	virtual const uint8 *GetRawBuffer() {
+		return buf;
+	}
 };
 
 
@@ -0,0 +1,131 @@
+/*
+ *	MappedFileDataSource.cpp - DataSource for a memory mapped file
+ *
+ *  Copyright (C) 2007 The Pentagram Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "pent_include.h"
+
+#include "filesys/MappedFileDataSource.h"
+
+#if defined(WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(HAVE_SYS_MMAN_H)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+IMappedFileDataSource::IMappedFileDataSource(const std::string& filename)
+	: IBufferDataSource(0, 0), mapping(0), mapsize(0)
+{
+#if defined(WIN32) && !defined(UNDER_CE)
+	filemapping = 0;
+	file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+					   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE) {
+		file = 0;
+		return;
+	}
+
+	DWORD high = 0;
+	DWORD low = GetFileSize(file, &high);
+	if (low == INVALID_FILE_SIZE || high != 0 || low == 0) {
+		unmap();
+		return;
+	}
+
+	filemapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+	if (!filemapping) {
+		unmap();
+		return;
+	}
+
+	mapping = MapViewOfFile(filemapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mapping) {
+		unmap();
+		return;
+	}
+	mapsize = low;
+
+#elif defined(HAVE_SYS_MMAN_H)
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 ||
+		st.st_size != static_cast<off_t>(static_cast<uint32>(st.st_size)))
+	{
+		close(fd);
+		return;
+	}
+
+	void* p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after closing the file
+	close(fd);
+	if (p == MAP_FAILED) return;
+
+	mapping = p;
+	mapsize = static_cast<uint32>(st.st_size);
+#endif
+
+	if (mapping)
+		IBufferDataSource::load(mapping, mapsize);
+}
+
+IMappedFileDataSource::~IMappedFileDataSource()
+{
+	unmap();
+}
+
+void IMappedFileDataSource::unmap()
+{
+	IBufferDataSource::load(0, 0);
+
+#if defined(WIN32) && !defined(UNDER_CE)
+	if (mapping) UnmapViewOfFile(mapping);
+	if (filemapping) CloseHandle(filemapping);
+	if (file) CloseHandle(file);
+	filemapping = 0;
+	file = 0;
+#elif defined(HAVE_SYS_MMAN_H)
+	if (mapping) munmap(mapping, mapsize);
+#endif
+
+	mapping = 0;
+	mapsize = 0;
+}
+
+void IMappedFileDataSource::load(const void* data, unsigned int len,
+								 bool is_text, bool delete_data)
+{
+	unmap();
+	IBufferDataSource::load(data, len, is_text, delete_data);
+}
+
+//static
+bool IMappedFileDataSource::isSupported()
+{
+#if (defined(WIN32) && !defined(UNDER_CE)) || defined(HAVE_SYS_MMAN_H)
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,58 @@
+/*
+ *	MappedFileDataSource.h - DataSource for a memory mapped file
+ *
+ *  Copyright (C) 2007 The Pentagram Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef MAPPEDFILEDATASOURCE_H
+#define MAPPEDFILEDATASOURCE_H
+
+#include "filesys/IDataSource.h"
+
+//! An IBufferDataSource over a read-only memory mapping of a file.
+//! The file isn't read until its pages are accessed, and the pages are
+//! shared with the OS file cache.
+class IMappedFileDataSource : public IBufferDataSource
+{
+public:
+	//! Map a file. Check isValid() afterwards.
+	//! \param filename the real (not virtual) name of the file
+	explicit IMappedFileDataSource(const std::string& filename);
+	virtual ~IMappedFileDataSource();
+
+	//! Was the file mapped?
+	bool isValid() const { return mapping != 0; }
+
+	//! Are memory mappings supported on this platform?
+	static bool isSupported();
+
+	virtual void load(const void* data, unsigned int len, bool is_text = false,
+					  bool delete_data = false);
+
+private:
+	void unmap();
+
+	void* mapping;
+	uint32 mapsize;
+
+#if defined(WIN32) && !defined(UNDER_CE)
+	void* file;
+	void* filemapping;
+#endif
+};
+
+#endif
@@ -41,6 +41,14 @@ public:
 	}
 	virtual uint8* getObject(const std::string& name, uint32* size=0)=0;
 
+	virtual const uint8* getObjectView(uint32 index, uint32* size=0) {
+		std::string name;
+		if (!indexToName(index, name)) return 0;
+		return getObjectView(name, size);
+	}
+	virtual const uint8* getObjectView(const std::string& name,
+									   uint32* size=0) { return 0; }
+
 	virtual uint32 getSize(uint32 index) {
 		std::string name;
 		if (!indexToName(index, name)) return 0;
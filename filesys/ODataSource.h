@@ -356,7 +356,7 @@ public:
 
 	virtual ~OAutoBufferDataSource()
 	{
-		delete [] buf_ptr;
+		delete [] buf;
 	}
 	
 	virtual void write1(uint32 val)
@@ -32,10 +32,21 @@ RawArchive::~RawArchive()
 void RawArchive::cache(uint32 index)
 {
 	if (index >= count) return;
-	if (objects.empty()) objects.resize(count);
+	if (objects.empty()) {
+		objects.resize(count);
+		views.resize(count);
+	}
 
 	if (objects[index]) return;
 
+	// No need to copy the object if the ArchiveFile has it in memory
+	const uint8* view = getRawObjectView(index);
+	if (view) {
+		objects[index] = view;
+		views[index] = true;
+		return;
+	}
+
 	objects[index] = getRawObject(index);
 }
 
@@ -45,8 +56,10 @@ void RawArchive::uncache(uint32 index)
 	if (objects.empty()) return;
 
 	if (objects[index]) {
-		delete[] objects[index];
+		if (!views[index])
+			delete[] const_cast<uint8*>(objects[index]);
 		objects[index] = 0;
+		views[index] = false;
 	}
 }
 
@@ -54,7 +54,9 @@ public:
 	virtual IDataSource* get_datasource(uint32 index);	
 
 protected:
-	std::vector<uint8*> objects;
+	std::vector<const uint8*> objects;
+	//! objects that are views into the ArchiveFile, and aren't ours to delete
+	std::vector<bool> views;
 };
 
 #endif
@@ -48,6 +48,40 @@ std::string Savegame::getDescription()
 	return zipfile->getComment();
 }
 
+uint32 Savegame::getSaveId()
+{
+	IDataSource* ids = getDataSource("SAVEID");
+	if (!ids || ids->getSize() != 4) {
+		delete ids;
+		return 0;
+	}
+
+	uint32 saveid = ids->read4();
+	delete ids;
+
+	return saveid;
+}
+
+bool Savegame::getBase(std::string& filename, uint32& saveid)
+{
+	IDataSource* ids = getDataSource("BASE");
+	if (!ids || ids->getSize() < 6) {
+		delete ids;
+		return false;
+	}
+
+	saveid = ids->read4();
+	uint16 len = ids->read2();
+	char* buf = new char[len+1];
+	ids->read(buf, len);
+	buf[len] = 0;
+	filename = buf;
+	delete[] buf;
+	delete ids;
+
+	return true;
+}
+
 IDataSource* Savegame::getDataSource(const std::string& name)
 {
 	uint32 size;
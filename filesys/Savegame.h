@@ -36,6 +36,14 @@ public:
 	//! get the savegame's description
 	std::string getDescription();
 
+	//! get the id that delta savegames use to refer to this savegame
+	//! \return the id, or 0 if this savegame can't be a base savegame
+	uint32 getSaveId();
+
+	//! get the base savegame a delta savegame refers to
+	//! \return false if this isn't a delta savegame
+	bool getBase(std::string& filename, uint32& saveid);
+
 	IDataSource* getDataSource(const std::string& name);
 protected:
 	ZipFile* zipfile;
@@ -73,7 +73,6 @@ bool SavegameWriter::writeFile(const char* name,
 							   const uint8* data, uint32 size)
 {
 	PentZip::zipFile zfile = static_cast<PentZip::zipFile>(zipfile);
-	perr << name << ": " << size << std::endl;
 
 	// Because zlib's deflate causes false positives in valgrind,
 	// check the data to be saved manually, so deflate can be
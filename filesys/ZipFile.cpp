@@ -180,6 +180,38 @@ uint8* ZipFile::getObject(const std::string& name, uint32* sizep)
 	return buf;
 }
 
+const uint8* ZipFile::getObjectView(const std::string& name, uint32* sizep)
+{
+	const uint8* buf = ds->GetRawBuffer();
+	if (!buf) return 0;
+
+	PentZip::unzFile unzfile = static_cast<PentZip::unzFile>(unzipfile);
+
+	if (PentZip::unzLocateFile(unzfile, name.c_str(), 1) != UNZ_OK) return 0;
+
+	PentZip::unz_file_info info;
+	if (PentZip::unzGetCurrentFileInfo(unzfile, &info, 0, 0, 0, 0, 0, 0)
+		!= UNZ_OK)
+		return 0;
+
+	// stored, unencrypted entries only
+	if (info.compression_method != 0 || (info.flag & 1) ||
+		info.compressed_size != info.uncompressed_size)
+		return 0;
+
+	if (PentZip::unzOpenCurrentFile2(unzfile, 0, 0, 1) != UNZ_OK)
+		return 0;
+	uLong offset = PentZip::unzGetCurrentFileZStreamPos(unzfile);
+	PentZip::unzCloseCurrentFile(unzfile);
+
+	uint32 size = info.uncompressed_size;
+	if (offset == 0 || offset > ds->getSize() || size > ds->getSize() - offset)
+		return 0;
+
+	if (sizep) *sizep = size;
+
+	return buf + offset;
+}
 
 
 // ------------
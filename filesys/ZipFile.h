@@ -38,6 +38,11 @@ public:
 
 	virtual uint8* getObject(const std::string& name, uint32* size=0);
 
+	//! Views are only available for stored (uncompressed) entries, and
+	//! only if the zip file is in memory.
+	virtual const uint8* getObjectView(const std::string& name,
+									   uint32* size=0);
+
 	virtual uint32 getSize(const std::string& name);
 
 	virtual uint32 getCount() { return count; }
@@ -761,6 +761,21 @@ extern int ZEXPORT unzGoToFirstFile (unzFile file)
     return err;
 }
 
+extern uLong ZEXPORT unzGetCurrentFileZStreamPos (unzFile file)
+{
+    unz_s* s;
+    file_in_zip_read_info_s* pfile_in_zip_read_info;
+
+    if (file==NULL)
+        return 0;
+    s=(unz_s*)file;
+    pfile_in_zip_read_info=s->pfile_in_zip_read;
+    if (pfile_in_zip_read_info==NULL)
+        return 0;
+    return pfile_in_zip_read_info->pos_in_zipfile +
+           pfile_in_zip_read_info->byte_before_the_zipfile;
+}
+
 /*
   Set the current file of the zipfile to the next file.
   return UNZ_OK if there is no problem
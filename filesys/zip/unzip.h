@@ -337,6 +337,10 @@ extern uLong ZEXPORT unzGetOffset (unzFile file);
 /* Set the current file offset */
 extern int ZEXPORT unzSetOffset (unzFile file, uLong pos);
 
+/* Get the offset of the data of the currently opened file in the zipfile,
+   or 0 if no file is opened (as in minizip 1.1) */
+extern uLong ZEXPORT unzGetCurrentFileZStreamPos (unzFile file);
+
 
 }
 
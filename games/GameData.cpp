@@ -228,7 +228,7 @@ void GameData::loadU8Data()
 {
 	FileSystem* filesystem = FileSystem::get_instance();
 
-	IDataSource *fd = filesystem->ReadFile("@game/static/fixed.dat");
+	IDataSource *fd = filesystem->MapFile("@game/static/fixed.dat");
 	if (!fd) {
 		perr << "Unable to load static/fixed.dat. Exiting" << std::endl;
 		std::exit(-1);
@@ -245,7 +245,7 @@ void GameData::loadU8Data()
 	filename += "usecode.flx";
 
 
-	IDataSource* uds = filesystem->ReadFile(filename);
+	IDataSource* uds = filesystem->MapFile(filename);
 	if (!uds) {
 		perr << "Unable to load " << filename << ". Exiting" << std::endl;
 		std::exit(-1);
@@ -254,8 +254,8 @@ void GameData::loadU8Data()
 
 	// Load main shapes
 	pout << "Load Shapes" << std::endl;
-	IDataSource *sf = filesystem->ReadFile("@game/static/u8shapes.flx");
-	if (!sf) sf = filesystem->ReadFile("@game/static/u8shapes.cmp");
+	IDataSource *sf = filesystem->MapFile("@game/static/u8shapes.flx");
+	if (!sf) sf = filesystem->MapFile("@game/static/u8shapes.cmp");
 
 	if (!sf) {
 		perr << "Unable to load static/u8shapes.flx or static/u8shapes.cmp. Exiting" << std::endl;
@@ -301,7 +301,7 @@ void GameData::loadU8Data()
 	delete overlayflex;
 
 	// Load globs
-	IDataSource *gds = filesystem->ReadFile("@game/static/glob.flx");
+	IDataSource *gds = filesystem->MapFile("@game/static/glob.flx");
 	if (!gds) {
 		perr << "Unable to load static/glob.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -324,7 +324,7 @@ void GameData::loadU8Data()
 	delete globflex;
 
 	// Load fonts
-	IDataSource *fds = filesystem->ReadFile("@game/static/u8fonts.flx");
+	IDataSource *fds = filesystem->MapFile("@game/static/u8fonts.flx");
 	if (!fds) {
 		perr << "Unable to load static/u8fonts.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -343,7 +343,7 @@ void GameData::loadU8Data()
 	mouse->setPalette(PaletteManager::get_instance()->getPalette(PaletteManager::Pal_Game));
 	delete msds;
 
-	IDataSource *gumpds = filesystem->ReadFile("@game/static/u8gumps.flx");
+	IDataSource *gumpds = filesystem->MapFile("@game/static/u8gumps.flx");
 	if (!gumpds) {
 		perr << "Unable to load static/u8gumps.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -498,7 +498,7 @@ void GameData::loadRemorseData()
 {
 	FileSystem* filesystem = FileSystem::get_instance();
 
-	IDataSource *fd = filesystem->ReadFile("@game/static/fixed.dat");
+	IDataSource *fd = filesystem->MapFile("@game/static/fixed.dat");
 	if (!fd) {
 		perr << "Unable to load static/fixed.dat. Exiting" << std::endl;
 		std::exit(-1);
@@ -515,7 +515,7 @@ void GameData::loadRemorseData()
 	filename += "usecode.flx";
 
 
-	IDataSource* uds = filesystem->ReadFile(filename);
+	IDataSource* uds = filesystem->MapFile(filename);
 	if (!uds) {
 		perr << "Unable to load " << filename << ". Exiting" << std::endl;
 		std::exit(-1);
@@ -524,7 +524,7 @@ void GameData::loadRemorseData()
 
 	// Load main shapes
 	pout << "Load Shapes" << std::endl;
-	IDataSource *sf = filesystem->ReadFile("@game/static/shapes.flx");
+	IDataSource *sf = filesystem->MapFile("@game/static/shapes.flx");
 
 	if (!sf) {
 		perr << "Unable to load static/shapes.flx. Exiting" << std::endl;
@@ -573,7 +573,7 @@ void GameData::loadRemorseData()
 	delete overlayflex;
 
 	// Load globs
-	IDataSource *gds = filesystem->ReadFile("@game/static/glob.flx");
+	IDataSource *gds = filesystem->MapFile("@game/static/glob.flx");
 	if (!gds) {
 		perr << "Unable to load static/glob.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -596,7 +596,7 @@ void GameData::loadRemorseData()
 	delete globflex;
 
 	// Load fonts
-	IDataSource *fds = filesystem->ReadFile("@game/static/fonts.flx");
+	IDataSource *fds = filesystem->MapFile("@game/static/fonts.flx");
 	if (!fds) {
 		perr << "Unable to load static/fonts.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -615,7 +615,7 @@ void GameData::loadRemorseData()
 	mouse->setPalette(PaletteManager::get_instance()->getPalette(PaletteManager::Pal_Game));
 	delete msds;
 
-	IDataSource *gumpds = filesystem->ReadFile("@game/static/gumps.flx");
+	IDataSource *gumpds = filesystem->MapFile("@game/static/gumps.flx");
 	if (!gumpds) {
 		perr << "Unable to load static/gumps.flx. Exiting" << std::endl;
 		std::exit(-1);
@@ -233,6 +233,27 @@ BaseSoftRenderSurface::BaseSoftRenderSurface(int w, int h) :
 }
 
 
+//
+// BaseSoftRenderSurface::BaseSoftRenderSurface(const BaseSoftRenderSurface *parent)
+//
+// Desc: Constructor for a BaseSoftRenderSurface painting to the buffer of
+//       another, locked, surface
+//
+BaseSoftRenderSurface::BaseSoftRenderSurface(const BaseSoftRenderSurface *parent) :
+	pixels(parent->pixels), pixels00(parent->pixels00),
+	zbuffer(parent->zbuffer), zbuffer00(parent->zbuffer00),
+	bytes_per_pixel(parent->bytes_per_pixel),
+	bits_per_pixel(parent->bits_per_pixel), format_type(parent->format_type),
+	ox(parent->ox), oy(parent->oy),
+	width(parent->width), height(parent->height),
+	pitch(parent->pitch), zpitch(parent->zpitch),
+	flipped(parent->flipped), clip_window(parent->clip_window),
+	lock_count(1), sdl_surf(0), sdl_win(0), rtt_tex(0)
+{
+	// The parent owns and locks the buffer
+}
+
+
 //
 // BaseSoftRenderSurface::~BaseSoftRenderSurface()
 //
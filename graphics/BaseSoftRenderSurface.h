@@ -75,6 +75,9 @@ protected:
 	// Create Generic
 	BaseSoftRenderSurface(int w, int h, int bpp, int rsft, int gsft, int bsft, int asft);
 	BaseSoftRenderSurface(int w, int h, uint8 *buf);
+
+	// Create sharing the buffer of another surface
+	explicit BaseSoftRenderSurface(const BaseSoftRenderSurface *parent);
 	virtual ECode GenericLock()  { return P_NO_ERROR; }
 	virtual ECode GenericUnlock()  { return P_NO_ERROR; }
 
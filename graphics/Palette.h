@@ -82,6 +82,10 @@ struct Palette
 
 	// The current palette transform
 	PalTransforms transform;
+
+	// Changes every time the native palettes are recreated, so cached
+	// native colours can be checked. Set by the PaletteManager
+	uint32 generation;
 };
 
 }
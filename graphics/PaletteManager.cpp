@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Texture.h"
 
 PaletteManager* PaletteManager::palettemanager = 0;
+uint32 PaletteManager::generation = 0;
 
 PaletteManager::PaletteManager(RenderSurface *rs)
 	: rendersurface(rs)
@@ -51,11 +52,19 @@ void PaletteManager::reset()
 	palettes.clear();
 }
 
+void PaletteManager::createNativePalette(Pentagram::Palette* pal)
+{
+	rendersurface->CreateNativePalette(pal);
+
+	// Let the ShapeCache know the colours changed
+	pal->generation = ++generation;
+}
+
 void PaletteManager::updatedFont(PalIndex index)
 {
 	Pentagram::Palette* pal = getPalette(index);
 	if (pal)
-		rendersurface->CreateNativePalette(pal); // convert to native format
+		createNativePalette(pal); // convert to native format
 }
 
 // Reset all the transforms back to default
@@ -72,7 +81,7 @@ void PaletteManager::resetTransforms()
 		if (!pal) continue;
 		pal->transform = Pentagram::Transform_None;
 		for (int j = 0; j < 12; j++) pal->matrix[j] = matrix[j];
-		rendersurface->CreateNativePalette(pal); // convert to native format
+		createNativePalette(pal); // convert to native format
 	}
 }
 
@@ -84,7 +93,7 @@ void PaletteManager::RenderSurfaceChanged(RenderSurface* rs)
 	// Create native palettes for all currently loaded palettes
 	for (unsigned int i = 0; i < palettes.size(); ++i)
 		if (palettes[i])
-			rendersurface->CreateNativePalette(palettes[i]); 
+			createNativePalette(palettes[i]); 
 }
 
 void PaletteManager::load(PalIndex index, IDataSource& ds,IDataSource &xformds)
@@ -97,7 +106,7 @@ void PaletteManager::load(PalIndex index, IDataSource& ds,IDataSource &xformds)
 
 	Pentagram::Palette* pal = new Pentagram::Palette;
 	pal->load(ds,xformds);
-	rendersurface->CreateNativePalette(pal); // convert to native format
+	createNativePalette(pal); // convert to native format
 
 	palettes[index] = pal;
 }
@@ -112,7 +121,7 @@ void PaletteManager::load(PalIndex index, IDataSource& ds)
 
 	Pentagram::Palette* pal = new Pentagram::Palette;
 	pal->load(ds);
-	rendersurface->CreateNativePalette(pal); // convert to native format
+	createNativePalette(pal); // convert to native format
 
 	palettes[index] = pal;
 }
@@ -126,7 +135,7 @@ void PaletteManager::duplicate(PalIndex src, PalIndex dest)
 	if (srcpal)
 		*newpal = *srcpal;
 
-	rendersurface->CreateNativePalette(newpal); // convert to native format
+	createNativePalette(newpal); // convert to native format
 	if (palettes.size() <= static_cast<unsigned int>(dest))
 		palettes.resize(dest+1);
 	palettes[dest] = newpal;
@@ -147,7 +156,7 @@ void PaletteManager::transformPalette(PalIndex index, sint16 matrix[12])
 	if (!pal) return;
 
 	for (int i = 0; i < 12; i++) pal->matrix[i] = matrix[i];
-	rendersurface->CreateNativePalette(pal); // convert to native format
+	createNativePalette(pal); // convert to native format
 }
 
 void PaletteManager::untransformPalette(PalIndex index)
@@ -72,9 +72,15 @@ public:
 	void resetTransforms();
 
 private:
+	//! Convert a palette to the native format of the RenderSurface
+	void createNativePalette(Pentagram::Palette* pal);
+
 	std::vector<Pentagram::Palette*> palettes;
 	RenderSurface *rendersurface;
 
+	//! Last Palette::generation handed out
+	static uint32 generation;
+
 	static PaletteManager* palettemanager;
 };
 
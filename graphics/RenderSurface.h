@@ -101,6 +101,13 @@ public:
 	// \note It should only be used with Painting and Blitting methods.
 	virtual Texture *GetSurfaceAsTexture() = 0;
 
+	//! Create a surface that paints to the same buffer as this one, with its
+	//! own clipping rectangle. Used to paint parts of a surface in parallel.
+	// \note Only valid while this surface is being painted.
+	// \note The new surface starts out locked; don't call BeginPainting().
+	// \return the new surface, or 0 if not supported
+	virtual RenderSurface *CreateSharedSurface() = 0;
+
 	//
 	// Surface Properties
 	//
@@ -29,12 +29,14 @@ namespace Pentagram {
 class Scaler
 {
 	friend class hqScaler;
+	friend class ::ScalerManager;
 
-protected:
+public:
 	// Basic scaler function template
 	typedef bool (*ScalerFunc) ( Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint32 sh, 
 					uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src);
 
+protected:
 	//
 	// Basic scaler functions (filled in by the scalers constructor)
 	//
@@ -46,7 +48,23 @@ protected:
 	ScalerFunc	Scale32_A888;
 	ScalerFunc	Scale32_888A;
 
-	Scaler() { ScalerManager::get_instance()->AddScaler(this); }
+	//
+	// The same scalers without the ScalerKernels, pixel by pixel, for
+	// ScalerManager::verify to check against (0 if there are none)
+	//
+	ScalerFunc	Ref16Nat;
+	ScalerFunc	Ref16Sta;
+
+	ScalerFunc	Ref32Nat;
+	ScalerFunc	Ref32Sta;
+	ScalerFunc	Ref32_A888;
+	ScalerFunc	Ref32_888A;
+
+	Scaler() : Ref16Nat(0), Ref16Sta(0), Ref32Nat(0), Ref32Sta(0),
+		Ref32_A888(0), Ref32_888A(0)
+	{
+		ScalerManager::get_instance()->AddScaler(this);
+	}
 public:
 	//
 	// Scaler Capabilites
@@ -67,7 +85,17 @@ public:
 	inline bool Scale(	Texture *texture, sint32 sx, sint32 sy, sint32 sw, sint32 sh, 
 						uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src) const
 	{
-		// Check to see if we are doing valid integer scalings
+		if (!CanScale(sw, sh, dw, dh)) return false;
+
+		ScalerFunc func = GetScalerFunc(texture);
+		if (!func) return false;
+
+		return func(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
+	}
+
+	// Check to see if we are doing valid integer scalings
+	inline bool CanScale(sint32 sw, sint32 sh, sint32 dw, sint32 dh) const
+	{
 		if (!ScaleArbitrary())
 		{
 			uint32 scale_bits = ScaleBits();
@@ -84,6 +112,12 @@ public:
 			if (!(scale_bits & (1<<y_factor))) return false;
 		}
 
+		return true;
+	}
+
+	// Get the scaler function for a texture and the RenderSurface format
+	inline ScalerFunc GetScalerFunc(const Texture *texture) const
+	{
 		if (RenderSurface::format.s_bytes_per_pixel == 4) 
 		{
 			if (texture->format == TEX_FMT_NATIVE || (texture->format == TEX_FMT_STANDARD && 
@@ -91,42 +125,26 @@ public:
 				RenderSurface::format.g_mask == TEX32_G_MASK && RenderSurface::format.b_mask == TEX32_B_MASK))
 			{
 				if (RenderSurface::format.a_mask == 0xFF000000)
-				{
-					if (!Scale32_A888) return 0;
-					return Scale32_A888(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
-				}
+					return Scale32_A888;
 				else if (RenderSurface::format.a_mask == 0x000000FF)
-				{
-					if (!Scale32_888A) return 0;
-					return Scale32_888A(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
-				}
+					return Scale32_888A;
 				else 
-				{
-					if (!Scale32Nat) return 0;
-					return Scale32Nat(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
-				}
+					return Scale32Nat;
 			}
 			else if (texture->format == TEX_FMT_STANDARD)
 			{
-				if (!Scale32Sta) return 0;
-				return Scale32Sta(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
+				return Scale32Sta;
 			}
 		}
 		if (RenderSurface::format.s_bytes_per_pixel == 2) 
 		{
 			if (texture->format == TEX_FMT_NATIVE)
-			{
-				if (!Scale16Nat) return 0;
-				return Scale16Nat(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
-			}
+				return Scale16Nat;
 			else if (texture->format == TEX_FMT_STANDARD)
-			{
-				if (!Scale16Sta) return 0;
-				return Scale16Sta(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
-			}
+				return Scale16Sta;
 		}
 
-		return false;
+		return 0;
 	}
 
 	virtual ~Scaler() { }
@@ -20,14 +20,97 @@
 #include "ScalerManager.h"
 #include "Scaler.h"
 #include "scalers/PointScaler.h"
+#include "scalers/ScalerKernels.h"
+#include "WorkerPool.h"
+
+#include <SDL.h>
 
 ScalerManager *ScalerManager::scaler_man = 0;
 
+// Bands are a multiple of this many source rows, so the scalers that work
+// on several rows at a time (like the bilinear 2x one) split them up the
+// same way as when scaling the whole texture
+static const sint32 BAND_ALIGN = 4;
+
+// Don't bother splitting bands smaller than this
+static const sint32 BAND_MIN_ROWS = 16;
+
+namespace {
+
+class ScaleBandJob : public WorkerPool::Job
+{
+public:
+	ScaleBandJob(Pentagram::Scaler::ScalerFunc func_, Texture *texture_,
+				 sint32 sx_, sint32 sy_, sint32 sw_, sint32 sh_,
+				 uint8* pixel_, sint32 dw_, sint32 dh_, sint32 pitch_)
+		: func(func_), texture(texture_), sx(sx_), sy(sy_), sw(sw_), sh(sh_),
+		  pixel(pixel_), dw(dw_), dh(dh_), pitch(pitch_), ok(false) { }
+
+	virtual void run() {
+		ok = func(texture, sx, sy, sw, sh, pixel, dw, dh, pitch, false);
+	}
+
+	Pentagram::Scaler::ScalerFunc func;
+	Texture *texture;
+	sint32 sx, sy, sw, sh;
+	uint8* pixel;
+	sint32 dw, dh, pitch;
+	bool ok;
+};
+
+}
+
+//
+// Scale a section of a texture with a scaler function, on all threads of
+// the pool
+//
+static bool ScaleBands(WorkerPool *pool, const Pentagram::Scaler *scaler,
+					   Pentagram::Scaler::ScalerFunc func, Texture *texture, sint32 sx, sint32 sy, sint32 sw, sint32 sh,
+					   uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src)
+{
+	sint32 threads = pool ? pool->getThreadCount() : 1;
+
+	// The bands need whole destination rows for each source row, and the
+	// arbitrary scalers step through the source in fixed point so their
+	// rows don't line up. The scalers read the rows around a band from the
+	// texture, unless the source is clamped, which would clamp the edges of
+	// every band.
+	if (threads < 2 || scaler->ScaleArbitrary() || clamp_src ||
+		(dh % sh) != 0 || sh < 2*BAND_MIN_ROWS)
+		return func(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clamp_src);
+
+	sint32 factor = dh / sh;
+	sint32 rows = (sh + threads - 1) / threads;
+	rows = (rows + BAND_ALIGN - 1) / BAND_ALIGN * BAND_ALIGN;
+	if (rows < BAND_MIN_ROWS) rows = BAND_MIN_ROWS;
+
+	std::vector<ScaleBandJob> bands;
+	bands.reserve((sh + rows - 1) / rows);
+	for (sint32 y = 0; y < sh; y += rows) {
+		sint32 h = (sh - y < rows) ? sh - y : rows;
+		bands.push_back(ScaleBandJob(func, texture, sx, sy + y, sw, h,
+									 pixel + y*factor*pitch, dw, h*factor,
+									 pitch));
+	}
+
+	std::vector<WorkerPool::Job*> jobs(bands.size());
+	for (unsigned int i = 0; i < bands.size(); ++i)
+		jobs[i] = &bands[i];
+	pool->runJobs(jobs);
+
+	for (unsigned int i = 0; i < bands.size(); ++i)
+		if (!bands[i].ok) return false;
+
+	return true;
+}
+
 //
 // Constructor
 //
-ScalerManager::ScalerManager()
+ScalerManager::ScalerManager() : pool(0)
 {
+	Pentagram::ScalerKernels::setLevel(
+		Pentagram::ScalerKernels::getBestLevel());
 }
 
 //
@@ -35,6 +118,7 @@ ScalerManager::ScalerManager()
 //
 ScalerManager::~ScalerManager()
 {
+	delete pool;
 }
 
 //
@@ -126,3 +210,249 @@ const Pentagram::Scaler *ScalerManager::GetPointScaler()
 }
 
 
+
+//
+// Set the number of threads used to scale
+//
+void ScalerManager::SetThreadCount(unsigned int count)
+{
+	delete pool;
+	pool = 0;
+
+	if (count != 1)
+		pool = new WorkerPool(count, "Scaler");
+
+	// Couldn't create any threads
+	if (pool && pool->getThreadCount() < 2) {
+		delete pool;
+		pool = 0;
+	}
+}
+
+//
+// Scale a section of a texture, in parallel
+//
+bool ScalerManager::Scale(const Pentagram::Scaler *scaler, Texture *texture,
+						  sint32 sx, sint32 sy, sint32 sw, sint32 sh,
+						  uint8* pixel, sint32 dw, sint32 dh, sint32 pitch,
+						  bool clamp_src)
+{
+	if (!scaler->CanScale(sw, sh, dw, dh)) return false;
+
+	Pentagram::Scaler::ScalerFunc func = scaler->GetScalerFunc(texture);
+	if (!func) return false;
+
+	return ScaleBands(pool, scaler, func, texture, sx, sy, sw, sh,
+					  pixel, dw, dh, pitch, clamp_src);
+}
+
+//
+// A frame at the game resolution for the console commands. The top half
+// has edges and gradients for the scalers to find, the bottom half flat
+// areas with some noise in them. The 16 bit scalers just read it as 16 bit
+// pixels.
+//
+static void MakeTestFrame(std::vector<uint32> &source, Texture &texture,
+						  sint32 sw, sint32 sh)
+{
+	source.resize(sw*sh);
+	uint32 seed = 12345;
+
+	for (sint32 y = 0; y < sh; ++y) {
+		for (sint32 x = 0; x < sw; ++x) {
+			uint32 r, g, b;
+			if (y < sh/2) {
+				r = ((x/8 + y/8) & 1) ? 0xE0 : 0x20;
+				g = (x * 255) / sw;
+				b = ((x - y*2) & 0x3F) < 0x18 ? 0xC0 : (y * 255) / sh;
+			} else {
+				seed = seed * 1103515245 + 12345;
+				r = (x < sw/3) ? 0x40 : 0xA0;
+				g = (x/40 + y/40) & 1 ? 0x80 : 0x30;
+				b = 0x60;
+				if (((seed >> 16) & 0x3F) == 0) r ^= (seed >> 8) & 0xFF;
+			}
+			source[y*sw+x] = TEX32_PACK_RGBA(r, g, b, 0xFF);
+		}
+	}
+
+	texture.buffer = &source[0];
+	texture.width = sw;
+	texture.height = sh;
+	texture.CalcLOG2s();
+}
+
+static const char * const depthnames[] = {
+	"16 Nat", "16 Sta", "32 Nat", "32 Sta", "32 A888", "32 888A"
+};
+
+//
+// Time all the scalers, at all the bit depths they support
+//
+void ScalerManager::ConCmd_benchmark(const Console::ArgvType &argv)
+{
+	if (argv.size() > 2) {
+		pout << "usage: ScalerManager::benchmark [frames]" << std::endl;
+		return;
+	}
+
+	int frames = 20;
+	if (argv.size() > 1) frames = static_cast<int>(strtol(argv[1].c_str(), 0, 0));
+	if (frames < 1) frames = 1;
+
+	ScalerManager *scaleman = get_instance();
+
+	const sint32 sw = 320, sh = 200;
+	std::vector<uint32> source;
+	Texture texture;
+	MakeTestFrame(source, texture, sw, sh);
+
+	std::vector<uint8> dest;
+	int threads = scaleman->pool ? scaleman->pool->getThreadCount() : 1;
+	con.Printf("ScalerManager: scaling %dx%d, %d frames, %d threads, "
+			   "%s kernels\n", sw, sh, frames, threads,
+			   Pentagram::ScalerKernels::getName(
+				   Pentagram::ScalerKernels::getLevel()));
+
+	for (unsigned int s = 0; s < scaleman->scalers.size(); ++s) {
+		const Pentagram::Scaler *scaler = scaleman->scalers[s];
+
+		Pentagram::Scaler::ScalerFunc funcs[6] = {
+			scaler->Scale16Nat, scaler->Scale16Sta,
+			scaler->Scale32Nat, scaler->Scale32Sta,
+			scaler->Scale32_A888, scaler->Scale32_888A
+		};
+		uint32 bytes[6] = { 2, 2, 4, 4, 4, 4 };
+
+		for (int factor = 2; factor <= 4; ++factor) {
+			sint32 dw = sw*factor, dh = sh*factor;
+			if (!scaler->CanScale(sw, sh, dw, dh)) continue;
+
+			for (int d = 0; d < 6; ++d) {
+				if (!funcs[d]) continue;
+
+				texture.format = (d == 1 || d == 3) ? TEX_FMT_STANDARD
+													: TEX_FMT_NATIVE;
+				sint32 pitch = dw * bytes[d];
+				dest.resize(pitch * dh);
+
+				bool ok = true;
+				Uint64 start = SDL_GetPerformanceCounter();
+				for (int f = 0; f < frames && ok; ++f)
+					ok = funcs[d](&texture, 0, 0, sw, sh, &dest[0],
+								  dw, dh, pitch, false);
+				Uint64 single = SDL_GetPerformanceCounter() - start;
+
+				start = SDL_GetPerformanceCounter();
+				for (int f = 0; f < frames && ok; ++f)
+					ok = ScaleBands(scaleman->pool, scaler, funcs[d], &texture,
+									0, 0, sw, sh, &dest[0], dw, dh, pitch,
+									false);
+				Uint64 banded = SDL_GetPerformanceCounter() - start;
+
+				if (!ok) {
+					con.Printf("%-8s %dx %-7s: failed\n",
+							   scaler->ScalerName(), factor, depthnames[d]);
+					continue;
+				}
+
+				double freq = static_cast<double>(SDL_GetPerformanceFrequency());
+				double ms1 = single * 1000.0 / freq / frames;
+				double msN = banded * 1000.0 / freq / frames;
+				con.Printf("%-8s %dx %-7s: %7.2f ms, %7.2f ms threaded "
+						   "(%.1fx)\n", scaler->ScalerName(), factor,
+						   depthnames[d], ms1, msN, msN > 0 ? ms1 / msN : 0.0);
+			}
+		}
+	}
+
+	// Not ours
+	texture.buffer = 0;
+}
+
+//
+// Check that the scalers give the same results at every kernel level as
+// their per-pixel reference versions, for all the bit depths
+//
+void ScalerManager::ConCmd_verify(const Console::ArgvType &/*argv*/)
+{
+	using namespace Pentagram::ScalerKernels;
+
+	ScalerManager *scaleman = get_instance();
+
+	const sint32 sw = 320, sh = 200;
+	std::vector<uint32> source;
+	Texture texture;
+	MakeTestFrame(source, texture, sw, sh);
+
+	// The whole frame, and a rectangle inside it whose width isn't a
+	// multiple of any vector size
+	static const sint32 rects[2][4] = {
+		{ 0, 0, sw, sh }, { 3, 5, sw-16, sh-9 }
+	};
+
+	Level best = getBestLevel();
+	Level current = getLevel();
+	std::vector<uint8> expected, dest;
+	int tests = 0, failures = 0;
+
+	for (unsigned int s = 0; s < scaleman->scalers.size(); ++s) {
+		const Pentagram::Scaler *scaler = scaleman->scalers[s];
+
+		Pentagram::Scaler::ScalerFunc funcs[6] = {
+			scaler->Scale16Nat, scaler->Scale16Sta,
+			scaler->Scale32Nat, scaler->Scale32Sta,
+			scaler->Scale32_A888, scaler->Scale32_888A
+		};
+		Pentagram::Scaler::ScalerFunc refs[6] = {
+			scaler->Ref16Nat, scaler->Ref16Sta,
+			scaler->Ref32Nat, scaler->Ref32Sta,
+			scaler->Ref32_A888, scaler->Ref32_888A
+		};
+		uint32 bytes[6] = { 2, 2, 4, 4, 4, 4 };
+
+		for (int factor = 2; factor <= 4; ++factor) {
+			for (int r = 0; r < 2; ++r) {
+				sint32 rx = rects[r][0], ry = rects[r][1];
+				sint32 rw = rects[r][2], rh = rects[r][3];
+				sint32 dw = rw*factor, dh = rh*factor;
+				if (!scaler->CanScale(rw, rh, dw, dh)) continue;
+
+				for (int d = 0; d < 6; ++d) {
+					if (!funcs[d] || !refs[d]) continue;
+
+					texture.format = (d == 1 || d == 3) ? TEX_FMT_STANDARD
+														: TEX_FMT_NATIVE;
+					sint32 pitch = dw * bytes[d];
+
+					expected.assign(pitch * dh, 0);
+					refs[d](&texture, rx, ry, rw, rh, &expected[0],
+							dw, dh, pitch, false);
+
+					for (int l = LEVEL_SCALAR; l <= best; ++l) {
+						setLevel(static_cast<Level>(l));
+						dest.assign(pitch * dh, 0);
+						funcs[d](&texture, rx, ry, rw, rh, &dest[0],
+								 dw, dh, pitch, false);
+
+						tests++;
+						if (dest != expected) {
+							failures++;
+							con.Printf("%-8s %dx %-7s %dx%d: %s differs\n",
+									   scaler->ScalerName(), factor,
+									   depthnames[d], rw, rh,
+									   getName(static_cast<Level>(l)));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	setLevel(current);
+	texture.buffer = 0;
+
+	con.Printf("ScalerManager: %d tests against the reference scalers, "
+			   "up to the %s kernels, %d failed\n",
+			   tests, getName(best), failures);
+}
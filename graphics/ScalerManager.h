@@ -26,12 +26,18 @@ namespace Pentagram {
 	class	Scaler;
 };
 
+struct Texture;
+class WorkerPool;
+
 //
 // This entire class is just static
 //
 class ScalerManager {
 	std::vector<const Pentagram::Scaler*>		scalers;
 
+	//! Threads used by Scale, or 0 to scale on the calling thread only
+	WorkerPool *pool;
+
 	static ScalerManager *scaler_man;
 
 	// Constructor
@@ -68,6 +74,22 @@ public:
 
 	//! Get the Point Sampling Scaler
 	const Pentagram::Scaler	*GetPointScaler();
+
+	//! Set the number of threads Scale uses, including the calling thread.
+	//! 0 means one thread per CPU.
+	void SetThreadCount(unsigned int count);
+
+	//! Scale a section of a texture like Pentagram::Scaler::Scale, split
+	//! into bands of rows that are scaled in parallel
+	bool Scale(const Pentagram::Scaler *scaler, Texture *texture,
+			   sint32 sx, sint32 sy, sint32 sw, sint32 sh,
+			   uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src);
+
+	//! "ScalerManager::benchmark" console command
+	static void ConCmd_benchmark(const Console::ArgvType &argv);
+
+	//! "ScalerManager::verify" console command
+	static void ConCmd_verify(const Console::ArgvType &argv);
 };
 
 
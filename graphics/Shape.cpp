@@ -24,6 +24,7 @@
 #include "u8/ConvertShapeU8.h"
 #include "crusader/ConvertShapeCrusader.h"
 #include "IDataSource.h"
+#include "ShapeCache.h"
 
 DEFINE_RUNTIME_CLASSTYPE_CODE_BASE_CLASS(Shape);
 
@@ -36,6 +37,7 @@ Shape::Shape(const uint8* data, uint32 size, const ConvertShapeFormat *format,
 
 	this->data = data;
 	this->size = size;
+	this->owns_data = true;
 	this->palette = 0;
 
 	if (!format) format = DetectShapeFormat(data,size);
@@ -65,6 +67,7 @@ Shape::Shape(IDataSource *src, const ConvertShapeFormat *format)
 	uint8 *d = new uint8[this->size];
 	this->data = d;
 	src->read(d, this->size);
+	this->owns_data = true;
 	this->palette = 0;
 
 	if (!format) format = DetectShapeFormat(data,size);
@@ -87,10 +90,15 @@ Shape::Shape(IDataSource *src, const ConvertShapeFormat *format)
 
 Shape::~Shape()
 {
+	ShapeCache* shapecache = ShapeCache::get_instance();
+	if (shapecache)
+		shapecache->shapeDeleted(this);
+
 	for (unsigned int i = 0; i < frames.size(); ++i)
 		delete frames[i];
 
-	delete[] const_cast<uint8*>(data);
+	if (owns_data)
+		delete[] const_cast<uint8*>(data);
 }
 
 void Shape::getShapeId(uint16 & id, uint32 & shape)
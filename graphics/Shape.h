@@ -37,6 +37,10 @@ public:
 	Shape(IDataSource *src, const ConvertShapeFormat *format);
 	virtual ~Shape();
 	void setPalette(const Pentagram::Palette* pal) { palette = pal; }
+
+	//! Don't delete the data on destruction. Used for shapes that are
+	//! views into the data of an archive.
+	void setDataOwned(bool owned) { owns_data = owned; }
 	const Pentagram::Palette* getPalette() const { return palette; }
 
 	uint32 frameCount() const { return static_cast<uint32>(frames.size()); }
@@ -77,6 +81,7 @@ protected:
 
 	const uint8* data;
 	uint32 size;
+	bool owns_data;
 	const uint16 flexId;
 	const uint32 shapenum;
 };
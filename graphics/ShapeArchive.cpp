@@ -46,7 +46,10 @@ void ShapeArchive::cache(uint32 shapenum)
 	if (shapes[shapenum]) return;
 
 	uint32 shpsize;
-	uint8 *data = getRawObject(shapenum, &shpsize);
+	// Use the archive's data directly if it's in memory
+	const uint8 *data = getRawObjectView(shapenum, &shpsize);
+	bool view = (data != 0);
+	if (!view) data = getRawObject(shapenum, &shpsize);
 
 	if (!data || shpsize == 0) return;
 
@@ -58,12 +61,13 @@ void ShapeArchive::cache(uint32 shapenum)
 	
 	if (!format)
 	{
-		delete [] data;
+		if (!view) delete [] const_cast<uint8*>(data);
 		perr << "Error: Unable to detect shape format for flex." << std::endl;
 		return;
 	}
 
 	Shape* shape = new Shape(data, shpsize, format, id, shapenum);
+	if (view) shape->setDataOwned(false);
 	if (palette) shape->setPalette(palette);
 
 	shapes[shapenum] = shape;
@@ -0,0 +1,264 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "ShapeCache.h"
+#include "Shape.h"
+#include "ShapeFrame.h"
+#include "Palette.h"
+
+ShapeCache* ShapeCache::shapecache = 0;
+
+CachedShapeFrame::CachedShapeFrame(Shape* s, uint32 framenum_,
+								   bool untformed_pal_,
+								   const ShapeFrame* frame)
+	: shape(s), framenum(framenum_), untformed_pal(untformed_pal_),
+	  width(frame->width), height(frame->height),
+	  xoff(frame->xoff), yoff(frame->yoff),
+	  palette(0), palette_generation(0)
+{
+	// Decode the RLE data the same way SoftRenderSurface.inl does
+	for (sint32 i = 0; i < height; i++)
+	{
+		const uint8* linedata = frame->rle_data + frame->line_offsets[i];
+		sint32 xpos = 0;
+
+		do
+		{
+			xpos += *linedata++;
+
+			if (xpos == width) break;
+
+			sint32 dlen = *linedata++;
+			int type = 0;
+			if (frame->compressed) {
+				type = dlen & 1;
+				dlen >>= 1;
+			}
+
+			if (dlen > 0) {
+				CachedShapeSpan span;
+				span.line = i;
+				span.x = xpos;
+				span.length = dlen;
+				span.offset = indices.size();
+				spans.push_back(span);
+
+				if (!type) {
+					indices.insert(indices.end(), linedata, linedata + dlen);
+					linedata += dlen;
+				} else {
+					indices.insert(indices.end(), dlen, *linedata);
+				}
+			}
+			if (type) linedata++;
+
+			xpos += dlen;
+
+		} while (xpos < width);
+	}
+}
+
+void CachedShapeFrame::setPalette(const Pentagram::Palette* pal)
+{
+	const uint32* pal_native = untformed_pal ?
+		pal->native_untransformed : pal->native;
+	const uint32* pal_xform = untformed_pal ?
+		pal->xform_untransformed : pal->xform;
+
+	unsigned int count = indices.size();
+	native.resize(count);
+	xform.resize(count);
+
+	bool translucent = false;
+	for (unsigned int i = 0; i < count; ++i) {
+		native[i] = pal_native[indices[i]];
+		xform[i] = pal_xform[indices[i]];
+		if (xform[i]) translucent = true;
+	}
+
+	// Most frames have no translucent pixels at all
+	if (!translucent) {
+		std::vector<uint32> empty;
+		xform.swap(empty);
+	}
+
+	palette = pal;
+	palette_generation = pal->generation;
+}
+
+uint32 CachedShapeFrame::getSize() const
+{
+	return sizeof(CachedShapeFrame) +
+		spans.capacity() * sizeof(CachedShapeSpan) +
+		indices.capacity() * sizeof(uint8) +
+		native.capacity() * sizeof(uint32) +
+		xform.capacity() * sizeof(uint32);
+}
+
+
+ShapeCache::ShapeCache(uint32 maxsize_)
+	: maxsize(maxsize_), cursize(0), enabled(true), frozen(false),
+	  hits(0), misses(0), recolours(0), evictions(0)
+{
+	con.Print(MM_INFO, "Creating ShapeCache...\n");
+
+	assert(shapecache == 0);
+	shapecache = this;
+}
+
+ShapeCache::~ShapeCache()
+{
+	con.Print(MM_INFO, "Destroying ShapeCache...\n");
+
+	clear();
+	shapecache = 0;
+}
+
+const CachedShapeFrame* ShapeCache::getFrame(Shape* s, uint32 framenum,
+											 bool untformed_pal)
+{
+	if (!enabled) return 0;
+
+	const Pentagram::Palette* pal = s->getPalette();
+	if (!pal || framenum >= s->frameCount()) return 0;
+
+	Key key;
+	key.shape = s;
+	key.framenum = framenum;
+	key.untformed_pal = untformed_pal;
+
+	CachedShapeFrame* cframe;
+
+	std::map<Key, FrameList::iterator>::iterator iter = frames.find(key);
+
+	if (frozen) {
+		if (iter == frames.end()) return 0;
+		cframe = *(iter->second);
+		if (cframe->palette != pal || cframe->palette_generation != pal->generation)
+			return 0;
+		return cframe;
+	}
+
+	if (iter != frames.end()) {
+		hits++;
+		cframe = *(iter->second);
+		// move to the front of the LRU list
+		lru.splice(lru.begin(), lru, iter->second);
+	} else {
+		misses++;
+		cframe = new CachedShapeFrame(s, framenum, untformed_pal,
+									  s->getFrame(framenum));
+		lru.push_front(cframe);
+		frames[key] = lru.begin();
+	}
+
+	if (cframe->palette != pal || cframe->palette_generation != pal->generation)
+	{
+		if (cframe->palette) recolours++;
+		cursize -= cframe->getSize();
+		cframe->setPalette(pal);
+		cursize += cframe->getSize();
+		evict();
+	}
+
+	return cframe;
+}
+
+void ShapeCache::evict()
+{
+	// Never evict the most recently used frame
+	while (cursize > maxsize && lru.size() > 1) {
+		CachedShapeFrame* cframe = lru.back();
+
+		Key key;
+		key.shape = cframe->shape;
+		key.framenum = cframe->framenum;
+		key.untformed_pal = cframe->untformed_pal;
+		frames.erase(key);
+
+		cursize -= cframe->getSize();
+		lru.pop_back();
+		delete cframe;
+		evictions++;
+	}
+}
+
+void ShapeCache::shapeDeleted(Shape* s)
+{
+	Key key;
+	key.shape = s;
+	key.framenum = 0;
+	key.untformed_pal = false;
+
+	std::map<Key, FrameList::iterator>::iterator iter = frames.lower_bound(key);
+	while (iter != frames.end() && iter->first.shape == s) {
+		CachedShapeFrame* cframe = *(iter->second);
+		cursize -= cframe->getSize();
+		lru.erase(iter->second);
+		delete cframe;
+		frames.erase(iter++);
+	}
+}
+
+void ShapeCache::clear()
+{
+	FrameList::iterator iter;
+	for (iter = lru.begin(); iter != lru.end(); ++iter)
+		delete *iter;
+	lru.clear();
+	frames.clear();
+	cursize = 0;
+}
+
+void ShapeCache::setEnabled(bool e)
+{
+	enabled = e;
+	if (!enabled)
+		clear();
+}
+
+void ShapeCache::ConCmd_toggle(const Console::ArgvType &/*argv*/)
+{
+	ShapeCache* cache = ShapeCache::get_instance();
+	if (!cache) return;
+
+	cache->setEnabled(!cache->isEnabled());
+
+	if (cache->isEnabled())
+		pout << "Painting shapes from the ShapeCache" << std::endl;
+	else
+		pout << "Painting shapes from RLE data" << std::endl;
+}
+
+void ShapeCache::ConCmd_stats(const Console::ArgvType &/*argv*/)
+{
+	ShapeCache* cache = ShapeCache::get_instance();
+	if (!cache) return;
+
+	pout << "ShapeCache: " << (cache->enabled ? "enabled" : "disabled")
+		 << std::endl;
+	pout << "Frames     : " << cache->lru.size() << std::endl;
+	pout << "Memory     : " << cache->cursize / 1024 << "/"
+		 << cache->maxsize / 1024 << " KB" << std::endl;
+	pout << "Hits       : " << cache->hits << std::endl;
+	pout << "Misses     : " << cache->misses << std::endl;
+	pout << "Recolours  : " << cache->recolours << std::endl;
+	pout << "Evictions  : " << cache->evictions << std::endl;
+}
@@ -0,0 +1,144 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SHAPECACHE_H
+#define SHAPECACHE_H
+
+#include <vector>
+#include <list>
+#include <map>
+
+class Shape;
+class ShapeFrame;
+namespace Pentagram { struct Palette; }
+
+//! A run of opaque pixels on a single line of a CachedShapeFrame
+struct CachedShapeSpan
+{
+	sint32 line;		//!< line in the frame
+	sint32 x;			//!< x of the first pixel in the frame
+	sint32 length;
+	uint32 offset;		//!< offset of the first pixel in the pixel arrays
+};
+
+//! A ShapeFrame with the RLE data expanded into spans of pixels,
+//! and the pixels converted to native colours of the palette of the shape
+struct CachedShapeFrame
+{
+	CachedShapeFrame(Shape* s, uint32 framenum, bool untformed_pal,
+					 const ShapeFrame* frame);
+
+	//! Convert the pixels to the colours of the given palette
+	void setPalette(const Pentagram::Palette* pal);
+
+	//! Approximate memory used by the frame
+	uint32 getSize() const;
+
+	Shape* shape;
+	uint32 framenum;
+	bool untformed_pal;
+
+	sint32 width, height;
+	sint32 xoff, yoff;
+
+	std::vector<CachedShapeSpan> spans;	//!< ordered by line
+	std::vector<uint8> indices;			//!< palette index of each pixel
+	std::vector<uint32> native;			//!< native colour of each pixel
+	//! premodulated xform colour of each pixel, or 0 if the pixel isn't
+	//! translucent. Empty if the frame has no translucent pixels.
+	std::vector<uint32> xform;
+
+	const Pentagram::Palette* palette;	//!< palette the colours are for
+	uint32 palette_generation;
+};
+
+//! A bounded LRU cache of CachedShapeFrames, used by the SoftRenderSurface
+//! so painting doesn't have to decode the RLE data and look up the palette
+//! for every pixel, every time.
+//!
+//! Frames are keyed on the Shape, the frame number and whether the
+//! untransformed palette is used. The colours are converted again whenever
+//! the PaletteManager changes the palette of the shape.
+class ShapeCache
+{
+public:
+	//! \param maxsize maximum memory used by cached frames, in bytes
+	explicit ShapeCache(uint32 maxsize);
+	~ShapeCache();
+
+	static ShapeCache* get_instance() { return shapecache; }
+
+	//! Get a frame of a shape, decoding it if it isn't cached yet.
+	//! Returns 0 if the frame doesn't exist, the shape has no palette, or
+	//! the cache is disabled.
+	//! The frame is only valid until the next call to getFrame.
+	const CachedShapeFrame* getFrame(Shape* s, uint32 framenum,
+									 bool untformed_pal);
+
+	//! Remove all frames of a shape. Called when the Shape is destroyed.
+	void shapeDeleted(Shape* s);
+
+	//! Remove all frames
+	void clear();
+
+	bool isEnabled() const { return enabled; }
+	void setEnabled(bool e);
+
+	//! While frozen, getFrame only returns frames that are already cached
+	//! with the current palette, and never changes the cache, so it can be
+	//! used from several threads at once. Returned frames stay valid until
+	//! the cache is unfrozen.
+	void setFrozen(bool f) { frozen = f; }
+
+	//! "ShapeCache::toggle" console command
+	static void ConCmd_toggle(const Console::ArgvType &argv);
+	//! "ShapeCache::stats" console command
+	static void ConCmd_stats(const Console::ArgvType &argv);
+
+private:
+	struct Key
+	{
+		Shape* shape;
+		uint32 framenum;
+		bool untformed_pal;
+
+		bool operator<(const Key& o) const {
+			if (shape != o.shape) return shape < o.shape;
+			if (framenum != o.framenum) return framenum < o.framenum;
+			return untformed_pal < o.untformed_pal;
+		}
+	};
+
+	typedef std::list<CachedShapeFrame*> FrameList;
+
+	void evict();
+
+	FrameList lru;	//!< most recently used first
+	std::map<Key, FrameList::iterator> frames;
+
+	uint32 maxsize;
+	uint32 cursize;
+	bool enabled;
+	bool frozen;
+
+	uint32 hits, misses, recolours, evictions;
+
+	static ShapeCache* shapecache;
+};
+
+#endif
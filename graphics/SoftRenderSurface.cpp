@@ -26,12 +26,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Shape.h"
 #include "ShapeFrame.h"
 #include "Palette.h"
+#include "ShapeCache.h"
 #include "FixedWidthFont.h"
 #include "memset_n.h"
 
 #include "XFormBlend.h"
 #include "scalers/PointScaler.h"
 #include "scalers/BilinearScaler.h"
+#include "ScalerManager.h"
 
 ///////////////////////
 //                   //
@@ -84,6 +86,29 @@ template<class uintX> SoftRenderSurface<uintX>::SoftRenderSurface(int w, int h)
 }
 
 
+//
+// SoftRenderSurface::SoftRenderSurface(const SoftRenderSurface<uintX> *parent)
+//
+// Desc: Create a surface painting to the buffer of another surface
+//
+template<class uintX> SoftRenderSurface<uintX>::SoftRenderSurface(const SoftRenderSurface<uintX> *parent)
+	: BaseSoftRenderSurface(parent)
+{
+}
+
+
+//
+// RenderSurface *SoftRenderSurface::CreateSharedSurface()
+//
+// Desc: Create a surface sharing our buffer, for painting in parallel
+//
+template<class uintX> RenderSurface *SoftRenderSurface<uintX>::CreateSharedSurface()
+{
+	if (!lock_count) return 0;
+	return new SoftRenderSurface<uintX>(this);
+}
+
+
 //
 // SoftRenderSurface::Fill8(uint8 index, sint32 sx, sint32 sy, sint32 w, sint32 h)
 //
@@ -819,7 +844,8 @@ template<class uintX> bool SoftRenderSurface<uintX>::ScalerBlit(Texture *texture
 
 	uint8 *pixel = pixels + dy * pitch + dx * sizeof(uintX);
 
-	return scaler->Scale(texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clampedges);
+	// Split into bands that are scaled in parallel
+	return ScalerManager::get_instance()->Scale(scaler,texture,sx,sy,sw,sh,pixel,dw,dh,pitch,clampedges);
 }
 
 //
@@ -894,6 +920,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PrintTextFixed(FixedWidthFo
 //
 template<class uintX> void SoftRenderSurface<uintX>::Paint(Shape*s, uint32 framenum, sint32 x, sint32 y, bool untformed_pal)
 {
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 }
 
@@ -906,6 +933,7 @@ template<class uintX> void SoftRenderSurface<uintX>::Paint(Shape*s, uint32 frame
 template<class uintX> void SoftRenderSurface<uintX>::PaintNoClip(Shape*s, uint32 framenum, sint32 x, sint32 y, bool untformed_pal)
 {
 #define NO_CLIPPING
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 #undef NO_CLIPPING
 }
@@ -919,6 +947,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintNoClip(Shape*s, uint32
 template<class uintX> void SoftRenderSurface<uintX>::PaintTranslucent(Shape* s, uint32 framenum, sint32 x, sint32 y, bool untformed_pal)
 {
 #define XFORM_SHAPES
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 #undef XFORM_SHAPES
 }
@@ -935,6 +964,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintMirrored(Shape* s, uin
 #define XFORM_SHAPES
 #define XFORM_CONDITIONAL trans
 
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 
 #undef FLIP_SHAPES
@@ -957,6 +987,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintInvisible(Shape* s, ui
 #define XFORM_CONDITIONAL trans
 #define BLEND_SHAPES(src,dst) BlendInvisible(src,dst)
 
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 
 #undef FLIP_SHAPES
@@ -986,6 +1017,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintHighlight(Shape* s, ui
 	uint32 cg = TEX32_G(col32);
 	uint32 cb = TEX32_B(col32);
 
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 
 #undef FLIP_SHAPES
@@ -1014,6 +1046,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintHighlightInvis(Shape*
 	uint32 cg = TEX32_G(col32);
 	uint32 cb = TEX32_B(col32);
 
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 
 #undef FLIP_SHAPES
@@ -1043,6 +1076,7 @@ template<class uintX> void SoftRenderSurface<uintX>::PaintMasked(Shape* s, uint3
 	uint32 cg = TEX32_G(col32);
 	uint32 cb = TEX32_B(col32);
 
+	#include "SoftRenderSurfaceCached.inl"
 	#include "SoftRenderSurface.inl"
 
 #undef FLIP_SHAPES
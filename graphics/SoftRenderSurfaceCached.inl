@@ -0,0 +1,167 @@
+/*
+Copyright (C) 2007 The Pentagram Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+//
+// Render Surface Cached Shape Display include file
+//
+// Paints a frame from the ShapeCache, and returns. If the frame isn't
+// available from the cache, nothing happens, and the function continues
+// with SoftRenderSurface.inl.
+//
+// Takes the same macros as SoftRenderSurface.inl, and must give exactly
+// the same results.
+//
+// Since spans are clipped as a whole, there are no per pixel clipping
+// checks.
+//
+
+//
+// Flipping
+//
+#ifdef FLIP_SHAPES
+#ifdef FLIP_CONDITIONAL
+#define CACHED_FLIPPED (FLIP_CONDITIONAL)
+#else
+#define CACHED_FLIPPED (true)
+#endif
+#else
+#define CACHED_FLIPPED (false)
+#endif
+
+//
+// XForm
+//
+#ifdef XFORM_SHAPES
+#ifdef XFORM_CONDITIONAL
+#define CACHED_XFORM (XFORM_CONDITIONAL)
+#else
+#define CACHED_XFORM (true)
+#endif
+#else
+#define CACHED_XFORM (false)
+#endif
+
+//
+// Invisibility
+//
+#ifdef BLEND_SHAPES
+#ifdef BLEND_CONDITIONAL
+#define CACHED_BLEND(src) static_cast<uintX>((BLEND_CONDITIONAL)?BLEND_SHAPES(src,*pixptr):src)
+#else
+#define CACHED_BLEND(src) static_cast<uintX>(BLEND_SHAPES(src,*pixptr))
+#endif
+#else
+#define CACHED_BLEND(src) static_cast<uintX>(src)
+#endif
+
+//
+// Destination Alpha Masking
+//
+#ifdef DESTALPHA_MASK
+#define CACHED_NOT_DESTINATION_MASKED	(*pixptr & RenderSurface::format.a_mask)
+#else
+#define CACHED_NOT_DESTINATION_MASKED	(1)
+#endif
+
+{
+	ShapeCache* shapecache = ShapeCache::get_instance();
+	const CachedShapeFrame* cframe = 0;
+	if (shapecache)
+		cframe = shapecache->getFrame(s, framenum, untformed_pal);
+
+	if (cframe)
+	{
+		const bool flipped = CACHED_FLIPPED;
+		const bool use_xform = CACHED_XFORM && !cframe->xform.empty();
+		const sintptr dir = flipped ? -1 : 1;
+
+#ifdef NO_CLIPPING
+		uint8* base = static_cast<uint8*>(pixels);
+		sint32 ox = x;
+		sint32 oy = y;
+#else
+		const sint32 cw = clip_window.w;
+		const sint32 ch = clip_window.h;
+		uint8* base = static_cast<uint8*>(pixels) + static_cast<sintptr>(clip_window.x)*sizeof(uintX) + static_cast<sintptr>(clip_window.y)*pitch;
+		sint32 ox = x - clip_window.x;
+		sint32 oy = y - clip_window.y;
+#endif
+		ox = flipped ? ox + cframe->xoff : ox - cframe->xoff;
+		oy -= cframe->yoff;
+
+		const unsigned int count = cframe->spans.size();
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const CachedShapeSpan& span = cframe->spans[i];
+
+			sint32 line = oy + span.line;
+#ifndef NO_CLIPPING
+			if (line < 0 || line >= ch) continue;
+#endif
+
+			// Screen x of the first pixel, and the visible pixels [k0,k1)
+			sint32 sx = flipped ? ox - span.x : ox + span.x;
+			sint32 k0 = 0;
+			sint32 k1 = span.length;
+#ifndef NO_CLIPPING
+			if (!flipped) {
+				if (sx < 0) k0 = -sx;
+				if (sx + k1 > cw) k1 = cw - sx;
+			} else {
+				if (sx >= cw) k0 = sx - cw + 1;
+				if (sx - k1 + 1 < 0) k1 = sx + 1;
+			}
+			if (k0 >= k1) continue;
+#endif
+
+			uintX* pixptr = reinterpret_cast<uintX*>(base + pitch*static_cast<sintptr>(line)) + sx + dir*k0;
+			uintX* endrun = pixptr + dir*(k1-k0);
+			const uint32* src = &cframe->native[span.offset + k0];
+
+			if (use_xform)
+			{
+				const uint32* xsrc = &cframe->xform[span.offset + k0];
+				for (; pixptr != endrun; pixptr += dir, ++src, ++xsrc)
+				{
+					if (CACHED_NOT_DESTINATION_MASKED)
+					{
+						if (*xsrc)
+							*pixptr = CACHED_BLEND(BlendPreModulated(*xsrc,*pixptr));
+						else
+							*pixptr = CACHED_BLEND(*src);
+					}
+				}
+			}
+			else
+			{
+				for (; pixptr != endrun; pixptr += dir, ++src)
+				{
+					if (CACHED_NOT_DESTINATION_MASKED)
+						*pixptr = CACHED_BLEND(*src);
+				}
+			}
+		}
+
+		return;
+	}
+}
+
+#undef CACHED_NOT_DESTINATION_MASKED
+#undef CACHED_BLEND
+#undef CACHED_XFORM
+#undef CACHED_FLIPPED
@@ -19,12 +19,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "pent_include.h"
 
 #include "Font.h"
+#include "RenderedTextCache.h"
 
 namespace Pentagram {
 
 DEFINE_RUNTIME_CLASSTYPE_CODE_BASE_CLASS(Font)
 
-Font::Font() : highRes(false)
+// Number of texts each font keeps rendered
+static const unsigned int TEXTCACHE_SIZE = 32;
+
+Font::Font() : highRes(false), textcache(0)
 {
 
 }
@@ -32,6 +36,39 @@ Font::Font() : highRes(false)
 
 Font::~Font()
 {
+	delete textcache;
+}
+
+
+RenderedText* Font::renderText(const std::string& text,
+							   unsigned int& remaining,
+							   int width, int height, TextAlign align,
+							   bool u8specials,
+							   std::string::size_type cursor)
+{
+	if (!textcache)
+		textcache = new RenderedTextCache(TEXTCACHE_SIZE);
+
+	RenderedTextCache::Key key;
+	key.text = text;
+	key.width = width;
+	key.height = height;
+	key.align = align;
+	key.u8specials = u8specials;
+	key.cursor = cursor;
+
+	RenderedText* rendered = textcache->get(key, remaining);
+	if (rendered) return rendered;
+
+	rendered = renderTextUncached(text, remaining, width, height, align,
+								  u8specials, cursor);
+	return textcache->add(key, rendered, remaining);
+}
+
+
+void Font::clearTextCache()
+{
+	if (textcache) textcache->clear();
 }
 
 
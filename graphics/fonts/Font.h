@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "encoding.h"
 
 class RenderedText;
+class RenderedTextCache;
 
 struct PositionedText {
 	std::string text;
@@ -64,7 +65,7 @@ public:
 	virtual void getStringSize(const std::string& text,
 							   int& width, int& height)=0;
 
-	//! render a string
+	//! render a string. Text that was rendered recently comes from a cache.
 	//! \param text The text
 	//! \param remaining Returns index of the first character not printed
 	//! \param width The width of the target rectangle, or 0 for unlimited
@@ -72,13 +73,17 @@ public:
 	//! \param align Alignment of the text (left, right, center)
 	//! \param u8specials If true, interpret the special characters U8 uses
 	//! \return the rendered text in a RenderedText object
-	virtual RenderedText* renderText(const std::string& text,
-									 unsigned int& remaining,
-									 int width=0, int height=0,
-									 TextAlign align=TEXT_LEFT,
-									 bool u8specials=false,
-									 std::string::size_type cursor
-											=std::string::npos)=0;
+	RenderedText* renderText(const std::string& text,
+							 unsigned int& remaining,
+							 int width=0, int height=0,
+							 TextAlign align=TEXT_LEFT,
+							 bool u8specials=false,
+							 std::string::size_type cursor
+									=std::string::npos);
+
+	//! forget the cached text, when the font changes in a way that changes
+	//! how text is rendered
+	void clearTextCache();
 
 	//! get the dimensions of a rendered string
 	//! \param text The text
@@ -100,7 +105,17 @@ public:
 
 protected:
 	bool highRes;
-	
+
+	//! render a string, without the cache (see renderText)
+	virtual RenderedText* renderTextUncached(const std::string& text,
+											 unsigned int& remaining,
+											 int width, int height,
+											 TextAlign align,
+											 bool u8specials,
+											 std::string::size_type cursor)=0;
+
+private:
+	RenderedTextCache* textcache;
 
 protected:
 
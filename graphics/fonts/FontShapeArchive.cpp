@@ -38,7 +38,10 @@ void FontShapeArchive::cache(uint32 shapenum)
 	if (shapes[shapenum]) return;
 
 	uint32 shpsize;
-	uint8 *data = getRawObject(shapenum, &shpsize);
+	// Use the archive's data directly if it's in memory
+	const uint8 *data = getRawObjectView(shapenum, &shpsize);
+	bool view = (data != 0);
+	if (!view) data = getRawObject(shapenum, &shpsize);
 
 	if (!data || shpsize == 0) return;
 
@@ -47,12 +50,13 @@ void FontShapeArchive::cache(uint32 shapenum)
 	
 	if (!format)
 	{
-		delete [] data;
+		if (!view) delete [] const_cast<uint8*>(data);
 		perr << "Error: Unable to detect shape format for flex." << std::endl;
 		return;
 	}
 
 	Shape* shape = new ShapeFont(data, shpsize, format, id, shapenum);
+	if (view) shape->setDataOwned(false);
 	if (palette) shape->setPalette(palette);
 
 	shapes[shapenum] = shape;
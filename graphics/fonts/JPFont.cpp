@@ -93,11 +93,11 @@ void JPFont::getTextSize(const std::string& text,
 								  resultwidth, resultheight);		
 }
 
-RenderedText* JPFont::renderText(const std::string& text,
-								 unsigned int& remaining,
-								 int width, int height, TextAlign align,
-								 bool u8specials,
-								 std::string::size_type cursor)
+RenderedText* JPFont::renderTextUncached(const std::string& text,
+										 unsigned int& remaining,
+										 int width, int height, TextAlign align,
+										 bool u8specials,
+										 std::string::size_type cursor)
 {
 	int resultwidth, resultheight;
 	std::list<PositionedText> lines;
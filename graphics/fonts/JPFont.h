@@ -43,16 +43,14 @@ public:
 							 int width=0, int height=0,
 							 TextAlign align=TEXT_LEFT, bool u8specials=false);
 
-	virtual RenderedText* renderText(const std::string& text,
-									 unsigned int& remaining,
-									 int width=0, int height=0,
-									 TextAlign align=TEXT_LEFT,
-									 bool u8specials=false,
-									 std::string::size_type cursor
-											=std::string::npos);
-
 	ENABLE_RUNTIME_CLASSTYPE();
 protected:
+	virtual RenderedText* renderTextUncached(const std::string& text,
+											 unsigned int& remaining,
+											 int width, int height,
+											 TextAlign align,
+											 bool u8specials,
+											 std::string::size_type cursor);
 
 	unsigned int fontnum;
 	ShapeFont* shapefont;
@@ -0,0 +1,147 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+#include "RenderedTextCache.h"
+#include "RenderedText.h"
+
+uint32 RenderedTextCache::hits = 0;
+uint32 RenderedTextCache::misses = 0;
+uint32 RenderedTextCache::evictions = 0;
+
+//! The copy of a cached RenderedText that renderText returns
+class CachedRenderedText : public RenderedText
+{
+public:
+	explicit CachedRenderedText(RenderedTextCache::Shared* shared_)
+		: shared(shared_)
+	{
+		shared->refcount++;
+		shared->rendered->getSize(width, height);
+		vlead = shared->rendered->getVlead();
+	}
+
+	virtual ~CachedRenderedText() { shared->release(); }
+
+	virtual void draw(RenderSurface* surface, int x, int y,
+					  bool destmasked = false) {
+		shared->rendered->draw(surface, x, y, destmasked);
+	}
+
+	virtual void drawBlended(RenderSurface* surface, int x, int y, uint32 col,
+							 bool destmasked = false) {
+		shared->rendered->drawBlended(surface, x, y, col, destmasked);
+	}
+
+	ENABLE_RUNTIME_CLASSTYPE();
+
+protected:
+	RenderedTextCache::Shared* shared;
+};
+
+DEFINE_RUNTIME_CLASSTYPE_CODE(CachedRenderedText,RenderedText);
+
+
+bool RenderedTextCache::Key::operator<(const Key& o) const
+{
+	if (width != o.width) return width < o.width;
+	if (height != o.height) return height < o.height;
+	if (align != o.align) return align < o.align;
+	if (u8specials != o.u8specials) return u8specials < o.u8specials;
+	if (cursor != o.cursor) return cursor < o.cursor;
+	return text < o.text;
+}
+
+void RenderedTextCache::Shared::release()
+{
+	if (--refcount == 0) {
+		delete rendered;
+		delete this;
+	}
+}
+
+
+RenderedTextCache::RenderedTextCache(unsigned int maxentries_)
+	: maxentries(maxentries_)
+{
+}
+
+RenderedTextCache::~RenderedTextCache()
+{
+	clear();
+}
+
+RenderedText* RenderedTextCache::get(const Key& key, unsigned int& remaining)
+{
+	std::map<Key, Entry>::iterator it = entries.find(key);
+	if (it == entries.end()) {
+		misses++;
+		return 0;
+	}
+
+	hits++;
+	lru.splice(lru.begin(), lru, it->second.lru);
+	remaining = it->second.shared->remaining;
+	return new CachedRenderedText(it->second.shared);
+}
+
+RenderedText* RenderedTextCache::add(const Key& key, RenderedText* rendered,
+									 unsigned int remaining)
+{
+	std::map<Key, Entry>::iterator it = entries.find(key);
+	if (it != entries.end())
+		remove(it);
+
+	while (!entries.empty() && entries.size() >= maxentries) {
+		remove(entries.find(lru.back()));
+		evictions++;
+	}
+
+	Shared* shared = new Shared;
+	shared->rendered = rendered;
+	shared->remaining = remaining;
+	shared->refcount = 1;
+
+	Entry entry;
+	entry.shared = shared;
+	entry.lru = lru.insert(lru.begin(), key);
+	entries[key] = entry;
+
+	return new CachedRenderedText(shared);
+}
+
+void RenderedTextCache::clear()
+{
+	while (!entries.empty())
+		remove(entries.begin());
+}
+
+void RenderedTextCache::remove(std::map<Key, Entry>::iterator it)
+{
+	lru.erase(it->second.lru);
+	it->second.shared->release();
+	entries.erase(it);
+}
+
+void RenderedTextCache::ConCmd_stats(const Console::ArgvType &/*argv*/)
+{
+	pout << "RenderedTextCache (all fonts)" << std::endl;
+	pout << "Hits       : " << hits << std::endl;
+	pout << "Misses     : " << misses << std::endl;
+	pout << "Evictions  : " << evictions << std::endl;
+}
@@ -0,0 +1,94 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef RENDEREDTEXTCACHE_H
+#define RENDEREDTEXTCACHE_H
+
+#include <list>
+#include <map>
+#include "Font.h"
+
+class RenderedText;
+
+//! An LRU cache of the text a Font rendered recently, so text that is drawn
+//! over and over (buttons, barks, labels) is only laid out and rasterised
+//! once.
+//!
+//! Font::renderText hands out a new RenderedText every time, which the
+//! caller deletes. For cached text these are small copies that share the
+//! real RenderedText, which lives until it's evicted and the last copy
+//! is deleted.
+class RenderedTextCache
+{
+public:
+	struct Key
+	{
+		std::string text;
+		int width, height;
+		Pentagram::Font::TextAlign align;
+		bool u8specials;
+		std::string::size_type cursor;
+
+		bool operator<(const Key& o) const;
+	};
+
+	explicit RenderedTextCache(unsigned int maxentries);
+	~RenderedTextCache();
+
+	//! Get a copy of cached text, or 0 if it isn't cached
+	RenderedText* get(const Key& key, unsigned int& remaining);
+
+	//! Add newly rendered text, and return a copy of it for the caller.
+	//! The cache takes ownership of rendered.
+	RenderedText* add(const Key& key, RenderedText* rendered,
+					  unsigned int remaining);
+
+	//! Forget all text
+	void clear();
+
+	//! "RenderedTextCache::stats" console command
+	static void ConCmd_stats(const Console::ArgvType &argv);
+
+	//! A RenderedText shared by the cache and its copies
+	struct Shared
+	{
+		RenderedText* rendered;
+		unsigned int remaining;
+		int refcount;
+
+		void release();
+	};
+
+private:
+	struct Entry
+	{
+		Shared* shared;
+		std::list<Key>::iterator lru;
+	};
+
+	void remove(std::map<Key, Entry>::iterator it);
+
+	std::list<Key> lru;				//!< most recently used first
+	std::map<Key, Entry> entries;
+	unsigned int maxentries;
+
+	// Totals over all fonts
+	static uint32 hits, misses, evictions;
+};
+
+#endif
@@ -95,11 +95,11 @@ void ShapeFont::getStringSize(const std::string& text, int& width, int& height)
 	}
 }
 
-RenderedText* ShapeFont::renderText(const std::string& text,
-									unsigned int& remaining,
-									int width, int height, TextAlign align,
-									bool u8specials,
-									std::string::size_type cursor)
+RenderedText* ShapeFont::renderTextUncached(const std::string& text,
+											unsigned int& remaining,
+											int width, int height, TextAlign align,
+											bool u8specials,
+											std::string::size_type cursor)
 {
 	int resultwidth, resultheight;
 	std::list<PositionedText> lines;
@@ -42,21 +42,21 @@ public:
 	int getVlead() const { return vlead; }
 	int getHlead() const { return hlead; }
 
-	void setVLead(int vl) { vlead = vl; }
-	void setHLead(int hl) { hlead = hl; }
+	void setVLead(int vl) { vlead = vl; clearTextCache(); }
+	void setHLead(int hl) { hlead = hl; clearTextCache(); }
 
 	virtual void getStringSize(const std::string& text,
 							   int& width, int& height);
 
-	virtual RenderedText* renderText(const std::string& text,
-									 unsigned int& remaining,
-									 int width=0, int height=0,
-									 TextAlign align=TEXT_LEFT,
-									 bool u8specials=false,
-									 std::string::size_type cursor
-											=std::string::npos);
-
 	ENABLE_RUNTIME_CLASSTYPE();
+
+protected:
+	virtual RenderedText* renderTextUncached(const std::string& text,
+											 unsigned int& remaining,
+											 int width, int height,
+											 TextAlign align,
+											 bool u8specials,
+											 std::string::size_type cursor);
 };
 
 #endif
@@ -38,11 +38,28 @@ DEFINE_RUNTIME_CLASSTYPE_CODE(TTFont,Pentagram::Font);
 // various unicode characters which look like small black circles
 static const Uint16 bullets[] = { 0x2022, 0x30FB, 0x25CF, 0 };
 
+// Width of the glyph atlas
+static const int ATLAS_WIDTH = 256;
+
+// SDL_ttf kerns the lines it renders. Kerning can be looked up by
+// character from 2.0.14, by glyph index from 2.0.10, and not at all before.
+#define TTF_VERSION_NUM SDL_VERSIONNUM(SDL_TTF_MAJOR_VERSION, \
+									   SDL_TTF_MINOR_VERSION, \
+									   SDL_TTF_PATCHLEVEL)
+#if TTF_VERSION_NUM >= SDL_VERSIONNUM(2,0,14)
+#define TTF_KERNING_GLYPHS
+#elif TTF_VERSION_NUM >= SDL_VERSIONNUM(2,0,10)
+#define TTF_KERNING_INDICES
+#endif
+
 
 TTFont::TTFont(TTF_Font* font, uint32 rgb_, int bordersize_,
 			   bool antiAliased_, bool SJIS_)
-	: ttf_font(font), antiAliased(antiAliased_), SJIS(SJIS_)
+	: ttf_font(font), antiAliased(antiAliased_), SJIS(SJIS_),
+	  atlas_x(0), atlas_y(0), atlas_rowh(0)
 {
+	memset(palette, 0, sizeof(palette));
+
 //	rgb = PACK_RGB8( (rgb_>>16)&0xFF , (rgb_>>8)&0xFF , rgb_&0xFF );
 	// This should be performed by PACK_RGB8, but it is not initialized at this point.
 	rgb = (rgb_>>16)&0xFF | ((rgb_>>8)&0xFF)<<8 | (rgb_&0xFF)<<16;
@@ -131,6 +148,151 @@ void TTFont::getStringSize(const std::string& text, int& width, int& height)
 	height += 2*bordersize;
 }
 
+const TTFont::Glyph& TTFont::getGlyph(uint16 ch)
+{
+	std::map<uint16, Glyph>::iterator it = glyphs.find(ch);
+	if (it != glyphs.end()) return it->second;
+
+	Glyph glyph;
+	glyph.x = glyph.y = glyph.w = glyph.h = 0;
+	glyph.left = glyph.top = 0;
+	glyph.minx = glyph.advance = 0;
+
+	int maxx, miny, maxy;
+	TTF_GlyphMetrics(ttf_font, ch, &glyph.minx, &maxx, &miny, &maxy,
+					 &glyph.advance);
+
+	// Render the glyph as a line of one character. TTF_RenderGlyph_*
+	// changed to that in SDL_ttf 2.0.18, but before it returned just the
+	// glyph's bitmap. A line's surface starts at the top of the line (the
+	// font's ascent above the baseline), and at the glyph's left edge if
+	// that is left of the pen, in every version.
+	uint16 str[2] = { ch, 0 };
+	SDL_Surface* glyphsurf;
+	if (!antiAliased)
+	{
+		SDL_Color white = { 0xFF , 0xFF , 0xFF, 0 };
+		glyphsurf = TTF_RenderUNICODE_Solid(ttf_font, str, white);
+	}
+	else
+	{
+		SDL_Color colour = { TEX32_R(rgb) , TEX32_G(rgb), TEX32_B(rgb), 0 };
+		SDL_Color black = { 0x00 , 0x00 , 0x00, 0 };
+		glyphsurf = TTF_RenderUNICODE_Shaded(ttf_font, str, colour, black);
+	}
+
+	if (glyphsurf) {
+		SDL_LockSurface(glyphsurf);
+		const uint8* pixels = static_cast<const uint8*>(glyphsurf->pixels);
+		int pitch = glyphsurf->pitch;
+
+		// Only keep the pixels the glyph covers
+		int x0 = glyphsurf->w, y0 = glyphsurf->h, x1 = 0, y1 = 0;
+		for (int y = 0; y < glyphsurf->h; y++) {
+			for (int x = 0; x < glyphsurf->w; x++) {
+				if (!pixels[y*pitch + x]) continue;
+				if (x < x0) x0 = x;
+				if (x >= x1) x1 = x+1;
+				if (y < y0) y0 = y;
+				if (y >= y1) y1 = y+1;
+			}
+		}
+
+		if (x0 < x1 && x1 - x0 <= ATLAS_WIDTH) {
+			glyph.w = x1 - x0;
+			glyph.h = y1 - y0;
+			glyph.left = x0 + (glyph.minx < 0 ? glyph.minx : 0);
+			glyph.top = y0;
+
+			// Start a new row of the atlas if it doesn't fit
+			if (atlas_x + glyph.w > ATLAS_WIDTH) {
+				atlas_x = 0;
+				atlas_y += atlas_rowh;
+				atlas_rowh = 0;
+			}
+
+			glyph.x = atlas_x;
+			glyph.y = atlas_y;
+
+			if (atlas_y + glyph.h > static_cast<int>(atlas.size() / ATLAS_WIDTH))
+				atlas.resize((atlas_y + glyph.h) * ATLAS_WIDTH);
+
+			for (int y = 0; y < glyph.h; y++) {
+				memcpy(&atlas[(glyph.y+y)*ATLAS_WIDTH + glyph.x],
+					   pixels + (y0+y)*pitch + x0, glyph.w);
+			}
+
+			atlas_x += glyph.w;
+			if (glyph.h > atlas_rowh) atlas_rowh = glyph.h;
+		}
+
+		// The shaded glyphs all have the same palette
+		if (antiAliased && glyphsurf->format->palette) {
+			SDL_Palette *pal = glyphsurf->format->palette;
+			for (int i = 0; i < pal->ncolors && i < 256; i++)
+				palette[i] = pal->colors[i];
+		}
+
+		SDL_UnlockSurface(glyphsurf);
+		SDL_FreeSurface(glyphsurf);
+	}
+
+	return glyphs[ch] = glyph;
+}
+
+int TTFont::getKerning(uint16 prev, uint16 ch)
+{
+#if defined(TTF_KERNING_GLYPHS)
+	if (TTF_GetFontKerning(ttf_font))
+		return TTF_GetFontKerningSizeGlyphs(ttf_font, prev, ch);
+#elif defined(TTF_KERNING_INDICES)
+	if (TTF_GetFontKerning(ttf_font))
+		return TTF_GetFontKerningSize(ttf_font,
+									  TTF_GlyphIsProvided(ttf_font, prev),
+									  TTF_GlyphIsProvided(ttf_font, ch));
+#endif
+	return 0;
+}
+
+void TTFont::renderLine(const uint16* unicodetext, uint8* pixels,
+						int width, int height)
+{
+	const uint16* ch;
+	uint16 prev;
+
+	// SDL_ttf moves the line right if a glyph sticks out left of it
+	int xstart = 0, pen = 0;
+	for (ch = unicodetext, prev = 0; *ch; prev = *ch, ++ch) {
+		const Glyph& glyph = getGlyph(*ch);
+		if (prev) pen += getKerning(prev, *ch);
+		if (pen + glyph.minx < -xstart) xstart = -(pen + glyph.minx);
+		pen += glyph.advance;
+	}
+
+	pen = xstart;
+	for (ch = unicodetext, prev = 0; *ch; prev = *ch, ++ch) {
+		const Glyph& glyph = getGlyph(*ch);
+		if (prev) pen += getKerning(prev, *ch);
+
+		int dx = pen + glyph.left;
+		int dy = glyph.top;
+
+		for (int y = 0; y < glyph.h; y++) {
+			if (dy + y < 0 || dy + y >= height) continue;
+			const uint8* src = &atlas[(glyph.y+y)*ATLAS_WIDTH + glyph.x];
+			uint8* dest = pixels + (dy+y)*width;
+
+			// Overlapping glyphs keep the highest coverage
+			for (int x = 0; x < glyph.w; x++) {
+				if (dx + x < 0 || dx + x >= width) continue;
+				if (src[x] > dest[dx+x]) dest[dx+x] = src[x];
+			}
+		}
+
+		pen += glyph.advance;
+	}
+}
+
 void TTFont::getTextSize(const std::string& text,
 						 int& resultwidth, int& resultheight,
 						 unsigned int& remaining,
@@ -149,11 +311,11 @@ void TTFont::getTextSize(const std::string& text,
 }
 
 
-RenderedText* TTFont::renderText(const std::string& text,
-								 unsigned int& remaining,
-								 int width, int height,
-								 TextAlign align, bool u8specials,
-								 std::string::size_type cursor)
+RenderedText* TTFont::renderTextUncached(const std::string& text,
+										 unsigned int& remaining,
+										 int width, int height,
+										 TextAlign align, bool u8specials,
+										 std::string::size_type cursor)
 {
 	int resultwidth, resultheight;
 	std::list<PositionedText> lines;
@@ -189,37 +351,27 @@ RenderedText* TTFont::renderText(const std::string& text,
 		else
 			unicodetext = toUnicode<SJISTraits>(iter->text, bullet);
 
-		// let SDL_ttf render the text
-		SDL_Surface* textsurf;
+		// draw the line from the glyph atlas, into a buffer like the
+		// surface SDL_ttf would render it to
+		int linew = 0, lineh = 0;
+		TTF_SizeUNICODE(ttf_font, unicodetext, &linew, &lineh);
+		std::vector<uint8> line(linew*lineh);
 
-		if (!antiAliased)
-		{
-			SDL_Color white = { 0xFF , 0xFF , 0xFF, 0 };
-			textsurf = TTF_RenderUNICODE_Solid(ttf_font, unicodetext, white);
-		}
-		else 
-		{
-			SDL_Color colour = { TEX32_R(rgb) , TEX32_G(rgb), TEX32_B(rgb), 0 };
-			SDL_Color black = { 0x00 , 0x00 , 0x00, 0 };
-			textsurf = TTF_RenderUNICODE_Shaded(ttf_font, unicodetext, colour, black);
-		}
-
-		if (textsurf) { 
-			SDL_LockSurface(textsurf);
+		if (!line.empty()) {
+			renderLine(unicodetext, &line[0], linew, lineh);
 
 #if 0
 			pout << iter->dims.w << "," << iter->dims.h << " vs. "
-				 << textsurf->w << "," << textsurf->h << ": " << iter->text
+				 << linew << "," << lineh << ": " << iter->text
 				 << std::endl;
 #endif
-			SDL_Palette *pal = textsurf->format->palette;
 
-			// render the text surface into our texture buffer
-			for (int y = 0; y < textsurf->h; y++) {
-				uint8* surfrow = static_cast<uint8*>(textsurf->pixels) + y * textsurf->pitch;
+			// render the line into our texture buffer
+			for (int y = 0; y < lineh; y++) {
+				uint8* surfrow = &line[y * linew];
 				// CHECKME: bordersize!
 				uint32* bufrow = buf + (iter->dims.y+y+bordersize)*resultwidth;
-				for (int x = 0; x < textsurf->w; x++) {
+				for (int x = 0; x < linew; x++) {
 
 					if (!antiAliased && surfrow[x] == 1) {
 
@@ -259,7 +411,7 @@ RenderedText* TTFont::renderText(const std::string& text,
 						uint32 idx = surfrow[x];
 
 						if (idx == 0) continue;
-						SDL_Color pe = pal->colors[idx];
+						SDL_Color pe = palette[idx];
 
 						if (bordersize <= 0) {
 							bufrow[iter->dims.x+x+bordersize] = TEX32_PACK_RGBA(pe.r, pe.g, pe.b, idx);
@@ -300,9 +452,6 @@ RenderedText* TTFont::renderText(const std::string& text,
 					}
 				}
 			}
-
-			SDL_UnlockSurface(textsurf);
-			SDL_FreeSurface(textsurf);
 		}
 
 		if (iter->cursor != std::string::npos) {
@@ -21,6 +21,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Font.h"
 
+#include <map>
+#include <vector>
+#include <SDL.h>
+
 // This is TTF_Font struct from SDL_ttf
 typedef struct _TTF_Font TTF_Font;
 
@@ -46,16 +50,15 @@ public:
 							 int width=0, int height=0,
 							 TextAlign align=TEXT_LEFT, bool u8specials=false);
 
-	virtual RenderedText* renderText(const std::string& text,
-									 unsigned int& remaining,
-									 int width=0, int height=0,
-									 TextAlign align=TEXT_LEFT,
-									 bool u8specials=false,
-									 std::string::size_type cursor
-											=std::string::npos);
-
 	ENABLE_RUNTIME_CLASSTYPE();
 protected:
+	virtual RenderedText* renderTextUncached(const std::string& text,
+											 unsigned int& remaining,
+											 int width, int height,
+											 TextAlign align,
+											 bool u8specials,
+											 std::string::size_type cursor);
+
 	TTF_Font* ttf_font;
 	uint32 rgb;
 	int bordersize;
@@ -63,6 +66,35 @@ protected:
 	bool SJIS;
 
 	uint16 bullet;
+
+	//! A glyph in the atlas
+	struct Glyph
+	{
+		int x, y, w, h;			//!< where it is in the atlas
+		int left, top;			//!< offset from the pen and the top of the line
+		int minx, advance;
+	};
+
+	//! Glyphs rasterised so far, as 8 bit SDL_ttf pixels: 1 for solid
+	//! pixels, or the coverage (the index in palette) when antialiased.
+	//! The atlas is ATLAS_WIDTH wide and grows downwards; glyphs are
+	//! packed in rows, cropped to the pixels they cover.
+	std::map<uint16, Glyph> glyphs;
+	std::vector<uint8> atlas;
+	int atlas_x, atlas_y, atlas_rowh;
+	SDL_Color palette[256];
+
+	//! Get a glyph, rasterising it if it isn't in the atlas yet
+	const Glyph& getGlyph(uint16 ch);
+
+	//! Kerning between two characters, as SDL_ttf applies it to lines
+	int getKerning(uint16 prev, uint16 ch);
+
+	//! Draw a line of text from the atlas, like SDL_ttf would
+	//! \param pixels 8 bit buffer of width*height pixels, as sized by
+	//!               TTF_SizeUNICODE
+	void renderLine(const uint16* unicodetext, uint8* pixels,
+					int width, int height);
 };
 
 
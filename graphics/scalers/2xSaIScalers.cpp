@@ -20,7 +20,9 @@
 #include "2xSaIScalers.h"
 #include "Manips.h"
 #include "Texture.h"
+#include "ScalerKernels.h"
 #include <cmath>
+#include <algorithm>
 
 namespace Pentagram {
 
@@ -104,9 +106,23 @@ static inline int GetResult2(uintS A, uintS B, uintS C, uintS D)
 	return r;
 }
 
+//! Number of columns, up to max, that are colour in all four rows.
+//! A pixel whose window is all one colour scales to a block of that colour,
+//! so the pixels after it can copy its block while this holds.
+static inline int FlatRun(uintS colour, const uintS *row0, const uintS *row1,
+						  const uintS *row2, const uintS *row3, int max)
+{
+	int n = ScalerKernels::countEqual(row0, colour, max);
+	n = ScalerKernels::countEqual(row1, colour, n);
+	n = ScalerKernels::countEqual(row2, colour, n);
+	n = ScalerKernels::countEqual(row3, colour, n);
+	return n;
+}
+
 //
 // 2xSaI Scaler
 //
+template<bool reference>
 static void Scale_2xSaI
 (
 	uintS *source,			// ->source pixels.
@@ -330,6 +346,31 @@ static void Scale_2xSaI
 			*(dP+dline_pixels) = product1;
 			*(dP+dline_pixels+1) = product2;
 
+			// Copy the block along a flat area. The windows of the pixels
+			// after this one start at column x, so this window has to be
+			// flat and the columns from x+3 on are checked. (The reference
+			// version scales every pixel, to check this against.)
+			if (!reference && x < xbeforelast-1 && x < srcw-1 &&
+				colorI == colorA && colorE == colorA && colorF == colorA && colorJ == colorA &&
+				colorG == colorA && colorB == colorA && colorK == colorA &&
+				colorH == colorA && colorC == colorA && colorD == colorA && colorL == colorA &&
+				colorM == colorA && colorN == colorA && colorO == colorA && colorP == colorA)
+			{
+				int n = FlatRun(colorA, bP - prev1_yoff + 3, bP + 3,
+								bP + next1_yoff + 3, bP + next2_yoff + 3,
+								std::min(srcw, xbeforelast) - 1 - x);
+				for (int k = 1; k <= n; k++)
+				{
+					*(dP+2*k) = orig;
+					*(dP+2*k+1) = product;
+					*(dP+dline_pixels+2*k) = product1;
+					*(dP+dline_pixels+2*k+1) = product2;
+				}
+				bP += n;
+				dP += 2*n;
+				x += n;
+			}
+
 			bP += 1;
 			dP += 2;
 			prev1_xoff = 1;
@@ -344,6 +385,7 @@ static void Scale_2xSaI
 //
 // Super2xSaI Scaler
 //
+template<bool reference>
 static void Scale_Super2xSaI
 (
 	uintS *source,			// ->source pixels.
@@ -541,6 +583,28 @@ static void Scale_Super2xSaI
 			*(dP+dline_pixels) = product2a;
 			*(dP+dline_pixels+1) = product2b;
 
+			// Copy the block along a flat area, as in Scale_2xSaI
+			if (!reference && x < xbeforelast2-1 && x < srcw-1 &&
+				colorB0 == color5 && colorB1 == color5 && colorB2 == color5 && colorB3 == color5 &&
+				color4 == color5 && color6 == color5 && colorS2 == color5 &&
+				color1 == color5 && color2 == color5 && color3 == color5 && colorS1 == color5 &&
+				colorA0 == color5 && colorA1 == color5 && colorA2 == color5 && colorA3 == color5)
+			{
+				int n = FlatRun(color5, bP - prevl1 + 3, bP + 3,
+								bP + nextl1 + 3, bP + nextl1 + nextl2 + 3,
+								std::min(srcw, xbeforelast2) - 1 - x);
+				for (int k = 1; k <= n; k++)
+				{
+					*(dP+2*k) = product1a;
+					*(dP+2*k+1) = product1b;
+					*(dP+dline_pixels+2*k) = product2a;
+					*(dP+dline_pixels+2*k+1) = product2b;
+				}
+				bP += n;
+				dP += 2*n;
+				x += n;
+			}
+
 			bP += 1;
 			dP += 2;
 
@@ -553,6 +617,7 @@ static void Scale_Super2xSaI
 //
 // SuperEagle Scaler
 //
+template<bool reference>
 static void Scale_SuperEagle
 (
 	uintS *source,			// ->source pixels.
@@ -772,6 +837,28 @@ static void Scale_SuperEagle
 			*(dP+dline_pixels) = product2a;
 			*(dP+dline_pixels+1) = product2b;
 
+			// Copy the block along a flat area, as in Scale_2xSaI
+			if (!reference && x < xbeforelast2-1 && x < srcw-1 &&
+				colorB0 == color5 && colorB1 == color5 && colorB2 == color5 && colorB3 == color5 &&
+				color4 == color5 && color6 == color5 && colorS2 == color5 &&
+				color1 == color5 && color2 == color5 && color3 == color5 && colorS1 == color5 &&
+				colorA0 == color5 && colorA1 == color5 && colorA2 == color5 && colorA3 == color5)
+			{
+				int n = FlatRun(color5, bP - prevl1 + 3, bP + 3,
+								bP + nextl1 + 3, bP + nextl1 + nextl2 + 3,
+								std::min(srcw, xbeforelast2) - 1 - x);
+				for (int k = 1; k <= n; k++)
+				{
+					*(dP+2*k) = product1a;
+					*(dP+2*k+1) = product1b;
+					*(dP+dline_pixels+2*k) = product2a;
+					*(dP+dline_pixels+2*k+1) = product2b;
+				}
+				bP += n;
+				dP += 2*n;
+				x += n;
+			}
+
 			bP += 1;
 			dP += 2;
 
@@ -782,6 +869,7 @@ static void Scale_SuperEagle
 	
 }
 
+template<bool reference>
 static bool Scale2xSaI(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint32 sh, 
 					uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src)
 {
@@ -789,19 +877,20 @@ static bool Scale2xSaI(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint32 sh,
 
 	if (clamp_src)
 	{
-		Scale_2xSaI(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
+		Scale_2xSaI<reference>(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
 					0, 0, sw, sh, tex->width, sh,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
 	else
 	{
-		Scale_2xSaI(reinterpret_cast<uintS*>(tex->buffer),
+		Scale_2xSaI<reference>(reinterpret_cast<uintS*>(tex->buffer),
 					sx, sy, sw, sh, tex->width, tex->height,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
 	return true;
 }
 
+template<bool reference>
 static bool ScaleSuper2xSaI(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint32 sh, 
 					uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src)
 {
@@ -809,19 +898,20 @@ static bool ScaleSuper2xSaI(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint3
 
 	if (clamp_src)
 	{
-		Scale_Super2xSaI(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
+		Scale_Super2xSaI<reference>(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
 					0, 0, sw, sh, tex->width, sh,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
 	else
 	{
-		Scale_Super2xSaI(reinterpret_cast<uintS*>(tex->buffer),
+		Scale_Super2xSaI<reference>(reinterpret_cast<uintS*>(tex->buffer),
 					sx, sy, sw, sh, tex->width, tex->height,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
 	return true;
 }
 
+template<bool reference>
 static bool ScaleSuperEagle(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint32 sh, 
 					uint8* pixel, sint32 dw, sint32 dh, sint32 pitch, bool clamp_src)
 {
@@ -829,13 +919,13 @@ static bool ScaleSuperEagle(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint3
 
 	if (clamp_src)
 	{
-		Scale_SuperEagle(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
+		Scale_SuperEagle<reference>(reinterpret_cast<uintS*>(tex->buffer) + sx + sy*tex->width,
 					0, 0, sw, sh, tex->width, sh,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
 	else
 	{
-		Scale_SuperEagle(reinterpret_cast<uintS*>(tex->buffer),
+		Scale_SuperEagle<reference>(reinterpret_cast<uintS*>(tex->buffer),
 					sx, sy, sw, sh, tex->width, tex->height,
 					reinterpret_cast<uintX*>(pixel), pitch/sizeof(uintX));
 	}
@@ -849,13 +939,21 @@ static bool ScaleSuperEagle(Texture *tex, sint32 sx, sint32 sy, sint32 sw, sint3
 //
 _2xSaIScaler::_2xSaIScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::Scale2xSaI;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::Scale2xSaI;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::Scale2xSaI<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::Scale2xSaI<false>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::Scale2xSaI;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::Scale2xSaI;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::Scale2xSaI;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::Scale2xSaI;
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::Scale2xSaI<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::Scale2xSaI<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::Scale2xSaI<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::Scale2xSaI<false>;
+
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::Scale2xSaI<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::Scale2xSaI<true>;
+
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::Scale2xSaI<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::Scale2xSaI<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::Scale2xSaI<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::Scale2xSaI<true>;
 }
 
 const uint32 _2xSaIScaler::ScaleBits() const { return 1<<2; }
@@ -872,13 +970,21 @@ const _2xSaIScaler _2xSaI_scaler;
 //
 Super2xSaIScaler::Super2xSaIScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuper2xSaI;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuper2xSaI;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuper2xSaI<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuper2xSaI<false>;
+
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuper2xSaI<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuper2xSaI<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuper2xSaI<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuper2xSaI<false>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuper2xSaI;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuper2xSaI;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuper2xSaI;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuper2xSaI;
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuper2xSaI<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuper2xSaI<true>;
+
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuper2xSaI<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuper2xSaI<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuper2xSaI<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuper2xSaI<true>;
 }
 
 const uint32 Super2xSaIScaler::ScaleBits() const { return 1<<2; }
@@ -895,13 +1001,21 @@ const Super2xSaIScaler Super2xSaI_scaler;
 //
 SuperEagleScaler::SuperEagleScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuperEagle;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuperEagle;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuperEagle<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuperEagle<false>;
+
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuperEagle<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuperEagle<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuperEagle<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuperEagle<false>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuperEagle;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuperEagle;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuperEagle;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuperEagle;
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16, uint16>::ScaleSuperEagle<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16, uint32>::ScaleSuperEagle<true>;
+
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32, uint32>::ScaleSuperEagle<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32, uint32>::ScaleSuperEagle<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888, uint32>::ScaleSuperEagle<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A, uint32>::ScaleSuperEagle<true>;
 }
 
 const uint32 SuperEagleScaler::ScaleBits() const { return 1<<2; }
@@ -922,14 +1036,21 @@ const SuperEagleScaler SuperEagle_scaler;
 
 GC_2xSaIScaler::GC_2xSaIScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::Scale2xSaI;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::Scale2xSaI;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::Scale2xSaI<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::Scale2xSaI<false>;
+
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::Scale2xSaI<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::Scale2xSaI<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::Scale2xSaI<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::Scale2xSaI<false>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::Scale2xSaI;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::Scale2xSaI;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::Scale2xSaI;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::Scale2xSaI;
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::Scale2xSaI<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::Scale2xSaI<true>;
 
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::Scale2xSaI<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::Scale2xSaI<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::Scale2xSaI<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::Scale2xSaI<true>;
 }
 
 const uint32 GC_2xSaIScaler::ScaleBits() const { return 1<<2; }
@@ -948,14 +1069,21 @@ const GC_2xSaIScaler GC_2xSaI_scaler;
 
 GC_Super2xSaIScaler::GC_Super2xSaIScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuper2xSaI;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuper2xSaI;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuper2xSaI<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuper2xSaI<false>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuper2xSaI;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuper2xSaI;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuper2xSaI;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuper2xSaI;
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuper2xSaI<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuper2xSaI<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuper2xSaI<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuper2xSaI<false>;
 
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuper2xSaI<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuper2xSaI<true>;
+
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuper2xSaI<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuper2xSaI<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuper2xSaI<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuper2xSaI<true>;
 }
 
 const uint32 GC_Super2xSaIScaler::ScaleBits() const { return 1<<2; }
@@ -973,13 +1101,21 @@ const GC_Super2xSaIScaler GC_Super2xSaI_scaler;
 //
 GC_SuperEagleScaler::GC_SuperEagleScaler() : Scaler()
 {
-	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuperEagle;
-	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuperEagle;
+	Scale16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuperEagle<false>;
+	Scale16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuperEagle<false>;
+
+	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuperEagle<false>;
+	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuperEagle<false>;
+	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuperEagle<false>;
+	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuperEagle<false>;
+
+	Ref16Nat = _2xSaIScalerInternal<uint16, Manip_Nat2Nat_16_GC, uint16>::ScaleSuperEagle<true>;
+	Ref16Sta = _2xSaIScalerInternal<uint16, Manip_Sta2Nat_16_GC, uint32>::ScaleSuperEagle<true>;
 
-	Scale32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuperEagle;
-	Scale32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuperEagle;
-	Scale32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuperEagle;
-	Scale32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuperEagle;
+	Ref32Nat = _2xSaIScalerInternal<uint32, Manip_Nat2Nat_32_GC, uint32>::ScaleSuperEagle<true>;
+	Ref32Sta = _2xSaIScalerInternal<uint32, Manip_Sta2Nat_32_GC, uint32>::ScaleSuperEagle<true>;
+	Ref32_A888 = _2xSaIScalerInternal<uint32, Manip_32_A888_GC, uint32>::ScaleSuperEagle<true>;
+	Ref32_888A = _2xSaIScalerInternal<uint32, Manip_32_888A_GC, uint32>::ScaleSuperEagle<true>;
 }
 
 const uint32 GC_SuperEagleScaler::ScaleBits() const { return 1<<2; }
@@ -0,0 +1,331 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#include "pent_include.h"
+#include "ScalerKernels.h"
+
+#include <SDL.h>
+
+// The SIMD versions are compiled for their instruction set whatever the
+// compiler flags are, and only used when the CPU has it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCALER_SSE2
+#define SCALER_AVX2
+#define SCALER_TARGET(x) __attribute__((target(x)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_X64) || defined(_M_IX86))
+#define SCALER_SSE2
+#define SCALER_AVX2
+#define SCALER_TARGET(x)
+#include <immintrin.h>
+#endif
+
+#if defined(SCALER_AVX2) && !SDL_VERSION_ATLEAST(2,0,4)
+// No SDL_HasAVX2
+#undef SCALER_AVX2
+#endif
+
+namespace Pentagram {
+namespace ScalerKernels {
+
+// The hq YUV values have a component in each byte: 0x00YYUUVV. Two values
+// are different if a component differs by more than this.
+static const uint32 YUV_THRESHOLD = 0x00300706;
+
+//
+// Scalar
+//
+
+static inline bool YUVDiff(uint32 yuv1, uint32 yuv2)
+{
+	for (int shift = 0; shift < 24; shift += 8) {
+		int c1 = (yuv1 >> shift) & 0xFF;
+		int c2 = (yuv2 >> shift) & 0xFF;
+		int d = (c1 > c2) ? c1 - c2 : c2 - c1;
+		if (d > static_cast<int>((YUV_THRESHOLD >> shift) & 0xFF))
+			return true;
+	}
+	return false;
+}
+
+static void hqPatterns_Scalar(uint8 *patterns, const uint32 *prev,
+							  const uint32 *cur, const uint32 *next, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		uint32 yuv = cur[i];
+		int pattern = 0;
+		if (YUVDiff(yuv, prev[i-1])) pattern |= 0x01;
+		if (YUVDiff(yuv, prev[i]))   pattern |= 0x02;
+		if (YUVDiff(yuv, prev[i+1])) pattern |= 0x04;
+		if (YUVDiff(yuv, cur[i-1]))  pattern |= 0x08;
+		if (YUVDiff(yuv, cur[i+1]))  pattern |= 0x10;
+		if (YUVDiff(yuv, next[i-1])) pattern |= 0x20;
+		if (YUVDiff(yuv, next[i]))   pattern |= 0x40;
+		if (YUVDiff(yuv, next[i+1])) pattern |= 0x80;
+		patterns[i] = static_cast<uint8>(pattern);
+	}
+}
+
+template<class uintX>
+static int countEqual_Scalar(const uintX *src, uintX value, int max)
+{
+	int n = 0;
+	while (n < max && src[n] == value) ++n;
+	return n;
+}
+
+static inline int trailingOnes(uint32 mask)
+{
+	int n = 0;
+	while (mask & 1) {
+		++n;
+		mask >>= 1;
+	}
+	return n;
+}
+
+//
+// SSE2
+//
+
+#ifdef SCALER_SSE2
+
+SCALER_TARGET("sse2")
+static inline __m128i hqDiff_SSE2(__m128i yuv, const uint32 *other,
+								  __m128i threshold, int bit)
+{
+	__m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other));
+	__m128i d = _mm_or_si128(_mm_subs_epu8(yuv, o), _mm_subs_epu8(o, yuv));
+	__m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(d, threshold),
+								   _mm_setzero_si128());
+	return _mm_andnot_si128(same, _mm_set1_epi32(bit));
+}
+
+SCALER_TARGET("sse2")
+static void hqPatterns_SSE2(uint8 *patterns, const uint32 *prev,
+							const uint32 *cur, const uint32 *next, int count)
+{
+	const __m128i threshold = _mm_set1_epi32(YUV_THRESHOLD);
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i yuv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur+i));
+		__m128i p = hqDiff_SSE2(yuv, prev+i-1, threshold, 0x01);
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, prev+i,   threshold, 0x02));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, prev+i+1, threshold, 0x04));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, cur+i-1,  threshold, 0x08));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, cur+i+1,  threshold, 0x10));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, next+i-1, threshold, 0x20));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, next+i,   threshold, 0x40));
+		p = _mm_or_si128(p, hqDiff_SSE2(yuv, next+i+1, threshold, 0x80));
+
+		p = _mm_packs_epi32(p, p);
+		p = _mm_packus_epi16(p, p);
+		sint32 bytes = _mm_cvtsi128_si32(p);
+		std::memcpy(patterns+i, &bytes, 4);
+	}
+
+	hqPatterns_Scalar(patterns+i, prev+i, cur+i, next+i, count-i);
+}
+
+SCALER_TARGET("sse2")
+static int countEqual16_SSE2(const uint16 *src, uint16 value, int max)
+{
+	const __m128i v = _mm_set1_epi16(static_cast<short>(value));
+	int n = 0;
+
+	for (; n + 8 <= max; n += 8) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+n));
+		uint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi16(s, v));
+		if (mask != 0xFFFF)
+			return n + trailingOnes(mask)/2;
+	}
+
+	return n + countEqual_Scalar(src+n, value, max-n);
+}
+
+SCALER_TARGET("sse2")
+static int countEqual32_SSE2(const uint32 *src, uint32 value, int max)
+{
+	const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+	int n = 0;
+
+	for (; n + 4 <= max; n += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+n));
+		uint32 mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(s, v)));
+		if (mask != 0xF)
+			return n + trailingOnes(mask);
+	}
+
+	return n + countEqual_Scalar(src+n, value, max-n);
+}
+
+#endif
+
+//
+// AVX2
+//
+
+#ifdef SCALER_AVX2
+
+SCALER_TARGET("avx2")
+static inline __m256i hqDiff_AVX2(__m256i yuv, const uint32 *other,
+								  __m256i threshold, int bit)
+{
+	__m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other));
+	__m256i d = _mm256_or_si256(_mm256_subs_epu8(yuv, o),
+								_mm256_subs_epu8(o, yuv));
+	__m256i same = _mm256_cmpeq_epi32(_mm256_subs_epu8(d, threshold),
+									  _mm256_setzero_si256());
+	return _mm256_andnot_si256(same, _mm256_set1_epi32(bit));
+}
+
+SCALER_TARGET("avx2")
+static void hqPatterns_AVX2(uint8 *patterns, const uint32 *prev,
+							const uint32 *cur, const uint32 *next, int count)
+{
+	const __m256i threshold = _mm256_set1_epi32(YUV_THRESHOLD);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m256i yuv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur+i));
+		__m256i p = hqDiff_AVX2(yuv, prev+i-1, threshold, 0x01);
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, prev+i,   threshold, 0x02));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, prev+i+1, threshold, 0x04));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, cur+i-1,  threshold, 0x08));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, cur+i+1,  threshold, 0x10));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, next+i-1, threshold, 0x20));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, next+i,   threshold, 0x40));
+		p = _mm256_or_si256(p, hqDiff_AVX2(yuv, next+i+1, threshold, 0x80));
+
+		// The packs work on each 128 bit half, so the first 4 patterns end
+		// up in the low half and the other 4 in the high half
+		p = _mm256_packs_epi32(p, p);
+		p = _mm256_packus_epi16(p, p);
+		sint32 lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(p));
+		sint32 hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(p, 1));
+		std::memcpy(patterns+i, &lo, 4);
+		std::memcpy(patterns+i+4, &hi, 4);
+	}
+
+	hqPatterns_Scalar(patterns+i, prev+i, cur+i, next+i, count-i);
+}
+
+SCALER_TARGET("avx2")
+static int countEqual16_AVX2(const uint16 *src, uint16 value, int max)
+{
+	const __m256i v = _mm256_set1_epi16(static_cast<short>(value));
+	int n = 0;
+
+	for (; n + 16 <= max; n += 16) {
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+n));
+		uint32 mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(s, v));
+		if (mask != 0xFFFFFFFF)
+			return n + trailingOnes(mask)/2;
+	}
+
+	return n + countEqual_Scalar(src+n, value, max-n);
+}
+
+SCALER_TARGET("avx2")
+static int countEqual32_AVX2(const uint32 *src, uint32 value, int max)
+{
+	const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+	int n = 0;
+
+	for (; n + 8 <= max; n += 8) {
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+n));
+		uint32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, v)));
+		if (mask != 0xFF)
+			return n + trailingOnes(mask);
+	}
+
+	return n + countEqual_Scalar(src+n, value, max-n);
+}
+
+#endif
+
+//
+// Selection
+//
+
+static Level level = LEVEL_SCALAR;
+
+void (*hqPatterns)(uint8 *patterns, const uint32 *prev, const uint32 *cur,
+				   const uint32 *next, int count) = hqPatterns_Scalar;
+int (*countEqual16)(const uint16 *src, uint16 value, int max) =
+	countEqual_Scalar<uint16>;
+int (*countEqual32)(const uint32 *src, uint32 value, int max) =
+	countEqual_Scalar<uint32>;
+
+Level getBestLevel()
+{
+#ifdef SCALER_AVX2
+	if (SDL_HasAVX2()) return LEVEL_AVX2;
+#endif
+#ifdef SCALER_SSE2
+	if (SDL_HasSSE2()) return LEVEL_SSE2;
+#endif
+	return LEVEL_SCALAR;
+}
+
+void setLevel(Level newlevel)
+{
+	Level best = getBestLevel();
+	if (newlevel > best) newlevel = best;
+
+	level = newlevel;
+	hqPatterns = hqPatterns_Scalar;
+	countEqual16 = countEqual_Scalar<uint16>;
+	countEqual32 = countEqual_Scalar<uint32>;
+
+	switch (level) {
+#ifdef SCALER_AVX2
+	case LEVEL_AVX2:
+		hqPatterns = hqPatterns_AVX2;
+		countEqual16 = countEqual16_AVX2;
+		countEqual32 = countEqual32_AVX2;
+		break;
+#endif
+#ifdef SCALER_SSE2
+	case LEVEL_SSE2:
+		hqPatterns = hqPatterns_SSE2;
+		countEqual16 = countEqual16_SSE2;
+		countEqual32 = countEqual32_SSE2;
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+Level getLevel()
+{
+	return level;
+}
+
+const char* getName(Level l)
+{
+	switch (l) {
+	case LEVEL_SSE2: return "SSE2";
+	case LEVEL_AVX2: return "AVX2";
+	default: return "scalar";
+	}
+}
+
+}
+}
@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#ifndef SCALERKERNELS_H_INCLUDED
+#define SCALERKERNELS_H_INCLUDED
+
+// The inner loops of the hq and 2xSaI scalers that work on several pixels
+// at a time. There are scalar, SSE2 and AVX2 versions, and the best one the
+// CPU supports is picked at startup. They all give the same results.
+
+namespace Pentagram {
+namespace ScalerKernels {
+
+enum Level {
+	LEVEL_SCALAR = 0,
+	LEVEL_SSE2 = 1,
+	LEVEL_AVX2 = 2,
+	LEVEL_COUNT
+};
+
+//! Best level the CPU supports, of the ones compiled in
+Level getBestLevel();
+
+//! Use the kernels of a level. Levels the CPU doesn't support are ignored.
+//! Don't call while scaling.
+void setLevel(Level level);
+
+//! Level in use
+Level getLevel();
+
+//! Name of a level
+const char* getName(Level level);
+
+//! Calculate the hq pattern of count pixels: the bits are set for the
+//! neighbours whose YUV value is too different from the pixel's.
+//! prev, cur and next are the YUV values of the rows above, at and below
+//! the pixels, and have to be valid from [-1] to [count].
+extern void (*hqPatterns)(uint8 *patterns, const uint32 *prev,
+						  const uint32 *cur, const uint32 *next, int count);
+
+//! Number of pixels from src[0] on that are value, up to max
+extern int (*countEqual16)(const uint16 *src, uint16 value, int max);
+extern int (*countEqual32)(const uint32 *src, uint32 value, int max);
+
+inline int countEqual(const uint16 *src, uint16 value, int max) {
+	return countEqual16(src, value, max);
+}
+inline int countEqual(const uint32 *src, uint32 value, int max) {
+	return countEqual32(src, value, max);
+}
+
+}
+}
+
+#endif //SCALERKERNELS_H_INCLUDED
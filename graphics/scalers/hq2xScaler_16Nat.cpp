@@ -23,7 +23,7 @@
 #include "hq2xScaler.inc"
 
 namespace Pentagram {
-	template Scaler::ScalerFunc hq2xScaler::GetScaler<uint16, Manip_Nat2Nat_16, uint16>();
+	template Scaler::ScalerFunc hq2xScaler::GetScaler<uint16, Manip_Nat2Nat_16, uint16>(bool);
 }
 
 #endif
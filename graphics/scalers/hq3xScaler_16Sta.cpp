@@ -24,7 +24,7 @@
 #include "hq3xScaler.inc"
 
 namespace Pentagram {
-	template Scaler::ScalerFunc hq3xScaler::GetScaler<uint16, Manip_Sta2Nat_16, uint32>();
+	template Scaler::ScalerFunc hq3xScaler::GetScaler<uint16, Manip_Sta2Nat_16, uint32>(bool);
 }
 
 #endif
@@ -36,6 +36,14 @@ hq4xScaler::hq4xScaler() : Scaler()
 	Scale32Sta = GetScaler<uint32, Manip_Sta2Nat_32, uint32>();
 	Scale32_A888 = GetScaler<uint32, Manip_32_A888, uint32>();
 	Scale32_888A = GetScaler<uint32, Manip_32_888A, uint32>();
+
+	Ref16Nat = GetScaler<uint16, Manip_Nat2Nat_16, uint16>(true);
+	Ref16Sta = GetScaler<uint16, Manip_Sta2Nat_16, uint32>(true);
+
+	Ref32Nat = GetScaler<uint32, Manip_Nat2Nat_32, uint32>(true);
+	Ref32Sta = GetScaler<uint32, Manip_Sta2Nat_32, uint32>(true);
+	Ref32_A888 = GetScaler<uint32, Manip_32_A888, uint32>(true);
+	Ref32_888A = GetScaler<uint32, Manip_32_888A, uint32>(true);
 }
 
 const uint32 hq4xScaler::ScaleBits() const { return 1<<4; }
@@ -37,7 +37,7 @@ public:
 	virtual const char *	ScalerDesc() const;			//< Desciption of the Scaler
 	virtual const char *	ScalerCopyright() const;	//< Scaler Copyright info
 private:
-	template<class uintX, class Manip, class uintS> ScalerFunc GetScaler();
+	template<class uintX, class Manip, class uintS> ScalerFunc GetScaler(bool reference=false);
 };
 
 extern const hq4xScaler hq4x_scaler;
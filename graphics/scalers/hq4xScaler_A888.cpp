@@ -24,7 +24,7 @@
 #include "hq4xScaler.inc"
 
 namespace Pentagram {
-	template Scaler::ScalerFunc hq4xScaler::GetScaler<uint32, Manip_32_A888, uint32>();
+	template Scaler::ScalerFunc hq4xScaler::GetScaler<uint32, Manip_32_A888, uint32>(bool);
 }
 
 #endif
@@ -52,6 +52,8 @@
 #include "Texture.h"
 #include "FileSystem.h"
 #include "PNGWriter.h"
+#include "SettingManager.h"
+#include "Profiler.h"
 
 
 DEFINE_RUNTIME_CLASSTYPE_CODE(GameMapGump,Gump);
@@ -74,6 +76,14 @@ GameMapGump::GameMapGump(int X, int Y, int Width, int Height) :
 
 	pout << "Create display_list ItemSorter object" << std::endl;
 	display_list = new ItemSorter();
+
+	// Number of threads to paint with. 0 means one per CPU
+	int paintthreads = 1;
+	SettingManager* settingman = SettingManager::get_instance();
+	settingman->setDefault("paintthreads", paintthreads);
+	settingman->get("paintthreads", paintthreads);
+	if (paintthreads < 0) paintthreads = 1;
+	display_list->setPaintThreads(paintthreads);
 }
 
 GameMapGump::~GameMapGump()
@@ -137,62 +147,68 @@ void GameMapGump::PaintThis(RenderSurface *surf, sint32 lerp_factor, bool scaled
 
 	bool paintEditorItems = GUIApp::get_instance()->isPaintEditorItems();
 
-	// Get all the required items
-	for (int cy = 0; cy < MAP_NUM_CHUNKS; cy++)
 	{
-		for (int cx = 0; cx < MAP_NUM_CHUNKS; cx++)
-		{
-			// Not fast, ignore
-			if (!map->isChunkFast(cx,cy)) continue;
-
-			const std::list<Item*>* items = map->getItemList(cx,cy);
+		Profiler::Scope sortscope(Profiler::SORT);
 
-			if (!items) continue;
-
-			std::list<Item*>::const_iterator it = items->begin();
-			std::list<Item*>::const_iterator end = items->end();
-			for (; it != end; ++it)
+		// Get all the required items
+		for (int cy = 0; cy < MAP_NUM_CHUNKS; cy++)
+		{
+			for (int cx = 0; cx < MAP_NUM_CHUNKS; cx++)
 			{
-				Item *item = *it;
-				if (!item) continue;
-
-				item->setupLerp(gametick);
-				item->doLerp(lerp_factor);
-
-				if (item->getZ() >= zlimit && !item->getShapeInfo()->is_draw())
-					continue;
-				if (!paintEditorItems && item->getShapeInfo()->is_editor())
-					continue;
-				if (item->getFlags() & Item::FLG_INVISIBLE) {
-					// special case: invisible avatar _is_ drawn
-					// HACK: unless EXT_TRANSPARENT is also set.
-					// (Used for hiding the avatar when drawing a full area map)
-
-					if (item->getObjId() == 1) {
-						if (item->getExtFlags() & Item::EXT_TRANSPARENT)
-							continue;
-
-						sint32 x, y, z;
-						item->getLerped(x, y, z);
-						display_list->AddItem(x,y,z,item->getShape(),item->getFrame(), item->getFlags() & ~Item::FLG_INVISIBLE, item->getExtFlags() | Item::EXT_TRANSPARENT, 1);
+				// Not fast, ignore
+				if (!map->isChunkFast(cx,cy)) continue;
+
+				const std::vector<Item*>* items = map->getItemList(cx,cy);
+
+				if (!items) continue;
+
+				std::vector<Item*>::const_iterator it = items->begin();
+				std::vector<Item*>::const_iterator end = items->end();
+				for (; it != end; ++it)
+				{
+					Item *item = *it;
+					if (!item) continue;
+
+					item->setupLerp(gametick);
+					item->doLerp(lerp_factor);
+
+					if (item->getZ() >= zlimit && !item->getShapeInfo()->is_draw())
+						continue;
+					if (!paintEditorItems && item->getShapeInfo()->is_editor())
+						continue;
+					if (item->getFlags() & Item::FLG_INVISIBLE) {
+						// special case: invisible avatar _is_ drawn
+						// HACK: unless EXT_TRANSPARENT is also set.
+						// (Used for hiding the avatar when drawing a full area map)
+
+						if (item->getObjId() == 1) {
+							if (item->getExtFlags() & Item::EXT_TRANSPARENT)
+								continue;
+
+							sint32 x, y, z;
+							item->getLerped(x, y, z);
+							display_list->AddItem(x,y,z,item->getShape(),item->getFrame(), item->getFlags() & ~Item::FLG_INVISIBLE, item->getExtFlags() | Item::EXT_TRANSPARENT, 1);
+						}
+
+						continue;
 					}
-
-					continue;
+					display_list->AddItem(item);
 				}
-				display_list->AddItem(item);
 			}
 		}
-	}
 
-	// Dragging:
+		// Dragging:
 
-	if (display_dragging) {
-		display_list->AddItem(dragging_pos[0],dragging_pos[1],dragging_pos[2],
-							  dragging_shape, dragging_frame,
-							  dragging_flags, Item::EXT_TRANSPARENT);
-	}
+		if (display_dragging) {
+			display_list->AddItem(dragging_pos[0],dragging_pos[1],dragging_pos[2],
+								  dragging_shape, dragging_frame,
+								  dragging_flags, Item::EXT_TRANSPARENT);
+		}
 
+		display_list->SortDisplayList();
+	}
 
+	Profiler::Scope paintscope(Profiler::PAINT);
 	display_list->PaintDisplayList(highlightItems);
 }
 
@@ -631,7 +647,7 @@ void GameMapGump::ConCmd_dumpMap(const Console::ArgvType &)
 	{
 		for (sint32 x = 0; x < 64; x++)
 		{
-			const std::list<Item *> *list =
+			const std::vector<Item *> *list =
 				World::get_instance()->getCurrentMap()->getItemList(x,y);
 
 			// Should iterate the items!
@@ -768,6 +784,26 @@ void GameMapGump::ConCmd_decrementSortOrder(const Console::ArgvType &argv)
 	}
 }
 
+void GameMapGump::ConCmd_setPaintThreads(const Console::ArgvType &argv)
+{
+	GameMapGump* gameMapGump = GUIApp::get_instance()->getGameMapGump();
+	if (!gameMapGump) return;
+
+	ItemSorter* display_list = gameMapGump->getDisplayList();
+
+	if (argv.size() == 2) {
+		int count = strtol(argv[1].c_str(), 0, 0);
+		if (count < 0) count = 1;
+		display_list->setPaintThreads(count);
+	} else if (argv.size() != 1) {
+		pout << "usage: GameMapGump::setPaintThreads [count]" << std::endl;
+		return;
+	}
+
+	pout << "Painting with " << display_list->getPaintThreads()
+		 << " thread(s)" << std::endl;
+}
+
 void GameMapGump::RenderSurfaceChanged()
 {
 	dims.x += dims.w/2;
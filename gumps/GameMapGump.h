@@ -68,6 +68,8 @@ public:
 
 	void IncSortOrder(int count);
 
+	ItemSorter*			getDisplayList() { return display_list; }
+
 	bool loadData(IDataSource* ids, uint32 version);
 
 	static void			SetHighlightItems(bool highlight) { highlightItems = highlight; }
@@ -78,6 +80,7 @@ public:
 
 	static void ConCmd_incrementSortOrder(const Console::ArgvType &argv);
 	static void ConCmd_decrementSortOrder(const Console::ArgvType &argv);
+	static void ConCmd_setPaintThreads(const Console::ArgvType &argv);
 
 	virtual void		RenderSurfaceChanged();
 
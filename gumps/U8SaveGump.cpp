@@ -29,6 +29,7 @@
 #include "ShapeFrame.h"
 #include "FileSystem.h"
 #include "Savegame.h"
+#include "AsyncSavegameWriter.h"
 #include "PagedGump.h"
 #include "getObject.h"
 #include "MainActor.h"
@@ -314,6 +315,10 @@ void U8SaveGump::loadDescriptions()
 {
 	descriptions.resize(6);
 
+	// Show the savegames that are still being written as well
+	AsyncSavegameWriter* writer = AsyncSavegameWriter::get_instance();
+	if (writer) writer->flush();
+
 	for (int i = 0; i < 6; ++i) {
 		int index = 6*page + i + 1;
 
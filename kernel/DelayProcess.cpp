@@ -18,6 +18,7 @@
 
 #include "pent_include.h"
 #include "DelayProcess.h"
+#include "Kernel.h"
 
 #include "IDataSource.h"
 #include "ODataSource.h"
@@ -27,7 +28,7 @@ DEFINE_RUNTIME_CLASSTYPE_CODE(DelayProcess,Process);
 
 
 DelayProcess::DelayProcess(int count_)
-	: Process(), count(count_)
+	: Process(), count(count_), asleep(false), sleepframe(0)
 {
 
 }
@@ -39,14 +40,41 @@ DelayProcess::~DelayProcess()
 
 void DelayProcess::run()
 {
-	if (--count == 0)
+	Kernel* kernel = Kernel::get_instance();
+
+	// Catch up on the frames we slept through
+	if (asleep) {
+		count -= kernel->getFrameNum() - sleepframe - 1;
+		if (count < 1) count = 1;
+		asleep = false;
+	}
+
+	if (--count == 0) {
 		terminate();
+		return;
+	}
+
+	// Nothing happens until the count runs out, so let the Kernel skip us
+	// until then. Processes running while paused count differently.
+	if (count > 0 && !(flags & PROC_RUNPAUSED)) {
+		asleep = true;
+		sleepframe = kernel->getFrameNum();
+		kernel->sleepProcess(this, count);
+	}
+}
+
+int DelayProcess::getFramesLeft() const
+{
+	if (!asleep) return count;
+
+	return count - static_cast<int>(Kernel::get_instance()->getFrameNum()
+									- sleepframe);
 }
 
 void DelayProcess::dumpInfo()
 {
 	Process::dumpInfo();
-	pout << "Frames left: " << count << std::endl;
+	pout << "Frames left: " << getFramesLeft() << std::endl;
 }
 
 
@@ -62,5 +90,5 @@ bool DelayProcess::loadData(IDataSource* ids, uint32 version)
 void DelayProcess::saveData(ODataSource* ods)
 {
 	Process::saveData(ods);
-	ods->write4(static_cast<uint32>(count));
+	ods->write4(static_cast<uint32>(getFramesLeft()));
 }
@@ -40,7 +40,13 @@ public:
 protected:
 	virtual void saveData(ODataSource* ods);
 
+	//! the number of frames left, counting the ones slept through
+	int getFramesLeft() const;
+
 	int count;
+
+	bool asleep;
+	uint32 sleepframe;
 };
 
 #endif
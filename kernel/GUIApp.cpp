@@ -30,7 +30,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ObjectManager.h"
 #include "GameInfo.h"
 #include "FontManager.h"
+#include "RenderedTextCache.h"
 #include "MemoryManager.h"
+#include "Profiler.h"
+#include "PathfinderQueue.h"
 
 #include "HIDManager.h"
 #include "Joystick.h"
@@ -39,6 +42,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Texture.h"
 #include "FixedWidthFont.h"
 #include "PaletteManager.h"
+#include "ShapeCache.h"
 #include "Palette.h"
 #include "GameData.h"
 #include "World.h"
@@ -46,7 +50,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Game.h"
 #include "getObject.h"
 
-#include "SavegameWriter.h"
+#include "AsyncSavegameWriter.h"
 #include "Savegame.h"
 #include <ctime>
 
@@ -54,8 +58,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "DesktopGump.h"
 #include "ConsoleGump.h"
 #include "GameMapGump.h"
+#include "ItemSorter.h"
 #include "InverterGump.h"
 #include "ScalerGump.h"
+#include "ScalerManager.h"
 #include "FastAreaVisGump.h"
 #include "MiniMapGump.h"
 #include "QuitGump.h"
@@ -77,6 +83,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "remorseintrinsics.h"
 #include "Egg.h"
 #include "CurrentMap.h"
+#include "CompiledLoopScript.h"
 #include "InverterProcess.h"
 #include "HealProcess.h"
 #include "SchedulerProcess.h"
@@ -108,6 +115,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ShapeViewerGump.h"
 
 #include "AudioMixer.h"
+#include "AudioSampleCache.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -137,9 +145,10 @@ using std::string;
 DEFINE_RUNTIME_CLASSTYPE_CODE(GUIApp,CoreApp);
 
 GUIApp::GUIApp(int argc, const char* const* argv)
-	: CoreApp(argc, argv), save_count(0), game(0), kernel(0), objectmanager(0),
-	  hidmanager(0), ucmachine(0), screen(0), fullscreen(false), palettemanager(0), 
-	  gamedata(0), world(0), desktopGump(0), consoleGump(0), gameMapGump(0),
+	: CoreApp(argc, argv), save_count(0), basesaveid(0), game(0), kernel(0),
+	  pathfinderqueue(0), savegamewriter(0), objectmanager(0), hidmanager(0), ucmachine(0), screen(0), fullscreen(false), palettemanager(0), 
+	  shapecache(0), gamedata(0), world(0), desktopGump(0), consoleGump(0),
+	  gameMapGump(0),
 	  avatarMoverProcess(0), runSDLInit(false),
 	  frameSkip(false), frameLimit(true), interpolate(true),
 	  animationRate(100), avatarInStasis(false), paintEditorItems(false),
@@ -148,7 +157,9 @@ GUIApp::GUIApp(int argc, const char* const* argv)
 	  mouseOverGump(0), dragging(DRAG_NOT), dragging_offsetX(0),
 	  dragging_offsetY(0), inversion(0), timeOffset(0),
 	  has_cheated(false), cheats_enabled(false),
-	  drawRenderStats(false), ttfoverrides(false), audiomixer(0), textModeActive(false)
+	  drawRenderStats(false), ttfoverrides(false),
+	  oBenchmarkTicks(0), oBenchmarkPaint(false), oBenchmarkSeed(1),
+	  audiomixer(0), audiosamplecache(0), textModeActive(false)
 {
 	application = this;
 
@@ -243,10 +254,24 @@ GUIApp::GUIApp(int argc, const char* const* argv)
 						  GameMapGump::ConCmd_incrementSortOrder);
 	con.AddConsoleCommand("GameMapGump::decrementSortOrder",
 						  GameMapGump::ConCmd_decrementSortOrder);
+	con.AddConsoleCommand("GameMapGump::setPaintThreads",
+						  GameMapGump::ConCmd_setPaintThreads);
+	con.AddConsoleCommand("CurrentMap::toggleCollisionIndex",
+						  CurrentMap::ConCmd_toggleCollisionIndex);
+	con.AddConsoleCommand("CompiledLoopScript::stats",
+						  CompiledLoopScript::ConCmd_stats);
+	con.AddConsoleCommand("ShapeCache::toggle", ShapeCache::ConCmd_toggle);
+	con.AddConsoleCommand("ShapeCache::stats", ShapeCache::ConCmd_stats);
 
 	con.AddConsoleCommand("AudioProcess::listSFX", AudioProcess::ConCmd_listSFX);
 	con.AddConsoleCommand("AudioProcess::playSFX", AudioProcess::ConCmd_playSFX);
 	con.AddConsoleCommand("AudioProcess::stopSFX", AudioProcess::ConCmd_stopSFX);
+	con.AddConsoleCommand("AudioMixer::benchmark", Pentagram::AudioMixer::ConCmd_benchmark);
+	con.AddConsoleCommand("AudioSampleCache::stats", Pentagram::AudioSampleCache::ConCmd_stats);
+	con.AddConsoleCommand("AsyncSavegameWriter::stats", AsyncSavegameWriter::ConCmd_stats);
+	con.AddConsoleCommand("RenderedTextCache::stats", RenderedTextCache::ConCmd_stats);
+	con.AddConsoleCommand("ScalerManager::benchmark", ScalerManager::ConCmd_benchmark);
+	con.AddConsoleCommand("ScalerManager::verify", ScalerManager::ConCmd_verify);
 
 	// Game related console commands are now added in startupGame
 }
@@ -308,39 +333,63 @@ GUIApp::~GUIApp()
 	con.RemoveConsoleCommand(GameMapGump::ConCmd_dumpMap);
 	con.RemoveConsoleCommand(GameMapGump::ConCmd_incrementSortOrder);
 	con.RemoveConsoleCommand(GameMapGump::ConCmd_decrementSortOrder);
+	con.RemoveConsoleCommand(GameMapGump::ConCmd_setPaintThreads);
+	con.RemoveConsoleCommand(CurrentMap::ConCmd_toggleCollisionIndex);
+	con.RemoveConsoleCommand(CompiledLoopScript::ConCmd_stats);
+	con.RemoveConsoleCommand(ShapeCache::ConCmd_toggle);
+	con.RemoveConsoleCommand(ShapeCache::ConCmd_stats);
 
 	con.RemoveConsoleCommand(AudioProcess::ConCmd_listSFX);
 	con.RemoveConsoleCommand(AudioProcess::ConCmd_stopSFX);
 	con.RemoveConsoleCommand(AudioProcess::ConCmd_playSFX);
+	con.RemoveConsoleCommand(Pentagram::AudioMixer::ConCmd_benchmark);
+	con.RemoveConsoleCommand(Pentagram::AudioSampleCache::ConCmd_stats);
+	con.RemoveConsoleCommand(AsyncSavegameWriter::ConCmd_stats);
+	con.RemoveConsoleCommand(RenderedTextCache::ConCmd_stats);
+	con.RemoveConsoleCommand(ScalerManager::ConCmd_benchmark);
+	con.RemoveConsoleCommand(ScalerManager::ConCmd_verify);
 
 	// Game related console commands are now removed in shutdownGame
 
+	FORGET_OBJECT(savegamewriter);
+	FORGET_OBJECT(pathfinderqueue);
 	FORGET_OBJECT(kernel);
 	FORGET_OBJECT(defMouse);
 	FORGET_OBJECT(objectmanager);
 	FORGET_OBJECT(hidmanager);
 	FORGET_OBJECT(audiomixer);
+	FORGET_OBJECT(audiosamplecache);
 	FORGET_OBJECT(ucmachine);
 	FORGET_OBJECT(palettemanager);
+	FORGET_OBJECT(shapecache);
 	FORGET_OBJECT(gamedata);
 	FORGET_OBJECT(world);
 	FORGET_OBJECT(ucmachine);
 	FORGET_OBJECT(fontmanager);
 	FORGET_OBJECT(screen);
+
+	// Stop the scaler threads
+	ScalerManager::get_instance()->SetThreadCount(1);
 }
 
 // Init sdl
 void GUIApp::SDLInit()
 {
 	con.Print(MM_INFO, "Initialising SDL...\n");
+
+	// The benchmark doesn't need a window or sound, but still wants a
+	// screen surface to paint to.
+	if (oBenchmarkTicks) {
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	}
+
 	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
 	atexit(SDL_Quit);
 }
 
 void GUIApp::startup()
 {
-	SDLInit();
-
 	// Set the console to auto paint, till we have finished initing
 	con.SetAutoPaint(conAutoPaint);
 
@@ -349,6 +398,9 @@ void GUIApp::startup()
 	// parent's startup first
 	CoreApp::startup();
 
+	// after the arguments have been parsed
+	SDLInit();
+
 	bool dataoverride;
 	if (!settingman->get("dataoverride", dataoverride,
 						 SettingManager::DOM_GLOBAL))
@@ -427,6 +479,23 @@ void GUIApp::startup()
 	kernel->addProcessLoader("AmbushProcess",
 							 ProcessLoader<AmbushProcess>::load);
 
+	// Number of threads searching for PathfinderProcesses (0 = none)
+	int pathfindthreads;
+	settingman->setDefault("pathfindthreads", 1);
+	settingman->get("pathfindthreads", pathfindthreads);
+	if (pathfindthreads < 0) pathfindthreads = 0;
+	pathfinderqueue = new PathfinderQueue(pathfindthreads);
+
+	savegamewriter = new AsyncSavegameWriter();
+
+	// Number of threads scaling the screen, including the main thread
+	// (0 = one per CPU)
+	int scalerthreads = 0;
+	settingman->setDefault("scalerthreads", scalerthreads);
+	settingman->get("scalerthreads", scalerthreads);
+	if (scalerthreads < 0) scalerthreads = 1;
+	ScalerManager::get_instance()->SetThreadCount(scalerthreads);
+
 	objectmanager = new ObjectManager();
 
 	GraphicSysInit();
@@ -439,6 +508,14 @@ void GUIApp::startup()
 	// Audio Mixer
 	audiomixer = new Pentagram::AudioMixer(22050,true,8);
 
+	// size of the AudioSampleCache in KB
+	int audiocachesize = 4096;
+	settingman->setDefault("audiocachesize", audiocachesize);
+	settingman->get("audiocachesize", audiocachesize);
+	if (audiocachesize < 0) audiocachesize = 0;
+	audiosamplecache = new Pentagram::AudioSampleCache(
+		static_cast<uint32>(audiocachesize) * 1024);
+
 	pout << "-- Pentagram Initialized -- " << std::endl << std::endl;
 
 	// We Attempt to startup game
@@ -470,8 +547,11 @@ void GUIApp::startupGame()
 
 	// Generic Commands
 	con.AddConsoleCommand("GUIApp::saveGame", ConCmd_saveGame);
+	con.AddConsoleCommand("GUIApp::saveDelta", ConCmd_saveDelta);
 	con.AddConsoleCommand("GUIApp::loadGame", ConCmd_loadGame);
 	con.AddConsoleCommand("GUIApp::newGame", ConCmd_newGame);
+	con.AddConsoleCommand("Pathfinder::toggleWalkGrid",
+						  Pathfinder::ConCmd_toggleWalkGrid);
 #ifdef DEBUG
 	con.AddConsoleCommand("Pathfinder::visualDebug",
 						  Pathfinder::ConCmd_visualDebug);
@@ -625,6 +705,8 @@ void GUIApp::shutdownGame(bool reloading)
 		audiomixer->reset();
 	}
 
+	pathfinderqueue->discard();
+	savegamewriter->flush();
 	FORGET_OBJECT(world);
 	objectmanager->reset();
 	FORGET_OBJECT(ucmachine);
@@ -648,8 +730,10 @@ void GUIApp::shutdownGame(bool reloading)
 
 	// Generic Game 
 	con.RemoveConsoleCommand(GUIApp::ConCmd_saveGame);
+	con.RemoveConsoleCommand(GUIApp::ConCmd_saveDelta);
 	con.RemoveConsoleCommand(GUIApp::ConCmd_loadGame);
 	con.RemoveConsoleCommand(GUIApp::ConCmd_newGame);
+	con.RemoveConsoleCommand(Pathfinder::ConCmd_toggleWalkGrid);
 #ifdef DEBUG
 	con.RemoveConsoleCommand(Pathfinder::ConCmd_visualDebug);
 #endif
@@ -747,11 +831,29 @@ void GUIApp::DeclareArgs()
 	// parent's arguments first
 	CoreApp::DeclareArgs();
 
-	// anything else?
+	parameters.declare("--benchmark",		&oBenchmarkTicks,	0);
+	parameters.declare("--benchmark-save",	&oBenchmarkSave,	"");
+	parameters.declare("--benchmark-paint",	&oBenchmarkPaint,	true);
+	parameters.declare("--seed",			&oBenchmarkSeed,	1);
+}
+
+void GUIApp::helpMe()
+{
+	CoreApp::helpMe();
+
+	con.Print("\t--benchmark {ticks}\t- run the game headless for a number of\n\t\t\t  ticks, print timings and quit\n");
+	con.Print("\t--benchmark-save {file} - start the benchmark from a savegame\n");
+	con.Print("\t--benchmark-paint\t- also paint every tick of the benchmark\n");
+	con.Print("\t--seed {n}\t- random seed for the benchmark\n");
 }
 
 void GUIApp::run()
 {
+	if (oBenchmarkTicks) {
+		runBenchmark();
+		return;
+	}
+
 	isRunning = true;
 
 	sint32 next_ticks = SDL_GetTicks()*3;	// Next time is right now!
@@ -760,6 +862,12 @@ void GUIApp::run()
 	while (isRunning) {
 		inBetweenFrame = true;	// Will get set false if it's not an inBetweenFrame
 
+		// Searches started during the last paint are done before the
+		// world can change again
+		pathfinderqueue->finish();
+
+		savegamewriter->poll();
+
 		if (!frameLimit) {			
 			kernel->runProcesses();
 			desktopGump->run();
@@ -806,6 +914,9 @@ void GUIApp::run()
 		}
 		handleDelayedEvents();
 
+		// Search for paths while painting
+		pathfinderqueue->start();
+
 		// Paint Screen
 		paint();
 
@@ -842,6 +953,71 @@ void GUIApp::run()
 	}
 }
 
+void GUIApp::runBenchmark()
+{
+	isRunning = true;
+
+	if (!oBenchmarkSave.empty() && !loadGame(oBenchmarkSave)) {
+		perr << "Benchmark: can't load " << oBenchmarkSave << std::endl;
+		isRunning = false;
+		return;
+	}
+
+	// Every tick is a whole frame, and nothing depends on the user
+	std::srand(oBenchmarkSeed);
+	inBetweenFrame = false;
+	lerpFactor = 256;
+
+	Profiler::reset();
+	Profiler::setEnabled(true);
+
+	Uint64 freq = SDL_GetPerformanceFrequency();
+	Uint64 kerneltime = 0, painttime = 0, maxtick = 0;
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	SDL_Event event;
+	for (uint32 tick = 0; tick < oBenchmarkTicks && isRunning; ++tick) {
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		pathfinderqueue->finish();
+		kernel->runProcesses();
+		desktopGump->run();
+		Uint64 t1 = SDL_GetPerformanceCounter();
+		kerneltime += t1 - t0;
+		if (t1 - t0 > maxtick) maxtick = t1 - t0;
+
+		pathfinderqueue->start();
+		if (oBenchmarkPaint) {
+			paint();
+			painttime += SDL_GetPerformanceCounter() - t1;
+		}
+
+		// Keep SDL happy, but don't act on anything
+		while (SDL_PollEvent(&event)) { }
+	}
+
+	Uint64 total = SDL_GetPerformanceCounter() - start;
+	Profiler::setEnabled(false);
+
+	// One "BENCHMARK <name> <value>" line per result, for scripts to parse
+	double us = 1000000.0 / static_cast<double>(freq);
+	con.Printf("BENCHMARK ticks %u\n", oBenchmarkTicks);
+	con.Printf("BENCHMARK seed %u\n", oBenchmarkSeed);
+	con.Printf("BENCHMARK total_us %.0f\n", total * us);
+	con.Printf("BENCHMARK kernel_us %.0f\n", kerneltime * us);
+	con.Printf("BENCHMARK kernel_max_tick_us %.0f\n", maxtick * us);
+	if (oBenchmarkPaint)
+		con.Printf("BENCHMARK frame_us %.0f\n", painttime * us);
+	for (int i = 0; i < Profiler::SECTION_COUNT; ++i) {
+		Profiler::Section s = static_cast<Profiler::Section>(i);
+		con.Printf("BENCHMARK %s_us %.0f\n", Profiler::getSectionName(s),
+				   Profiler::getTime(s));
+		con.Printf("BENCHMARK %s_count %u\n", Profiler::getSectionName(s),
+				   Profiler::getCount(s));
+	}
+
+	isRunning = false;
+}
+
 
 // conAutoPaint hackery
 void GUIApp::conAutoPaint(void)
@@ -1087,6 +1263,15 @@ void GUIApp::paint()
 		snprintf(buf, 255, "t %02d:%02d gh %i ", I_getTimeInMinutes(0,0), I_getTimeInSeconds(0,0)%60, I_getTimeInGameHours(0,0));
 		screen->PrintTextFixed(confont, buf, dims.w-char_w*strlen(buf), v_offset);
 		v_offset += confont->height;
+
+		if (gameMapGump) {
+			const ItemSorter::RenderStats &rs =
+				gameMapGump->getDisplayList()->getRenderStats();
+			snprintf(buf, 255, "Sort %u items %u overlap %u cmp %u reused ",
+					 rs.items, rs.overlap_tests, rs.comparisons, rs.reused);
+			screen->PrintTextFixed(confont, buf, dims.w-char_w*strlen(buf), v_offset);
+			v_offset += confont->height;
+		}
 	}
 
 	// End painting
@@ -1417,6 +1602,13 @@ void GUIApp::GraphicSysInit()
 	fontmanager = new FontManager(ttf_antialiasing);
 	palettemanager = new PaletteManager(new_screen);
 
+	// size of the ShapeCache in KB
+	int shapecachesize = 8192;
+	settingman->setDefault("shapecachesize", shapecachesize);
+	settingman->get("shapecachesize", shapecachesize);
+	if (shapecachesize < 0) shapecachesize = 0;
+	shapecache = new ShapeCache(static_cast<uint32>(shapecachesize) * 1024);
+
 	// TODO: assign names to these fontnumbers somehow
 	fontmanager->loadTTFont(0, "Vera.ttf", 18, 0xFFFFFF, 0);
 	fontmanager->loadTTFont(1, "VeraBd.ttf", 12, 0xFFFFFF, 0);
@@ -1979,7 +2171,7 @@ void GUIApp::writeSaveInfo(ODataSource* ods)
 }
 
 bool GUIApp::saveGame(std::string filename, std::string desc,
-					  bool ignore_modals)
+					  bool ignore_modals, bool delta)
 {
 	// Don't allow saving with Modals open
 	if (!ignore_modals && desktopGump->FindGump<ModalGump>()) {
@@ -1997,72 +2189,90 @@ bool GUIApp::saveGame(std::string filename, std::string desc,
 
 	pout << "Saving..." << std::endl;
 
+	// Processes waiting for a path have nothing to save yet
+	pathfinderqueue->finish();
+
+	// A delta savegame can't replace the savegame it refers to
+	if (delta && (basesave.empty() || basesave == filename)) {
+		pout << "No base savegame to refer to; saving in full." << std::endl;
+		delta = false;
+	}
+
 	pout << "Savegame file: " << filename << std::endl;
 	pout << "Description: " << desc << std::endl;
+	if (delta)
+		pout << "Base savegame: " << basesave << std::endl;
 
 	// Hack - don't save mouse over status for gumps
 	Gump * gump = getGump(mouseOverGump);
 	if (gump) gump->OnMouseLeft();
 
-	ODataSource* ods = filesystem->WriteFile(filename);
-	if (!ods) return false;
+	if (!savegamewriter->begin(filename, desc, Pentagram::savegame_version))
+		return false;
 
 	save_count++;
 
-	SavegameWriter* sgw = new SavegameWriter(ods);
-	sgw->writeVersion(Pentagram::savegame_version);
-	sgw->writeDescription(desc);
+	uint32 saveid = 0;
+	ODataSource* ods;
 
-	// We'll make it 2KB initially
-	OAutoBufferDataSource buf(2048);
+	if (delta) {
+		ods = savegamewriter->beginFile("BASE");
+		ods->write4(basesaveid);
+		ods->write2(static_cast<uint16>(basesave.size()));
+		ods->write(basesave.c_str(), static_cast<uint32>(basesave.size()));
+		savegamewriter->endFile();
+	} else {
+		// Only has to tell savegames written to the same file apart
+		saveid = (static_cast<uint32>(std::time(0)) << 8) ^ SDL_GetTicks();
+		if (saveid == 0) saveid = 1;
 
-	gameinfo->save(&buf);
-	sgw->writeFile("GAME", &buf);
-	buf.clear();
+		ods = savegamewriter->beginFile("SAVEID");
+		ods->write4(saveid);
+		savegamewriter->endFile();
+	}
 
-	writeSaveInfo(&buf);
-	sgw->writeFile("INFO", &buf);
-	buf.clear();
+	// Only serialise the game here; it's compressed and written
+	// to disk on a separate thread
+	gameinfo->save(savegamewriter->beginFile("GAME"));
+	savegamewriter->endFile();
 
-	kernel->save(&buf);
-	sgw->writeFile("KERNEL", &buf);
-	buf.clear();
+	writeSaveInfo(savegamewriter->beginFile("INFO"));
+	savegamewriter->endFile();
 
-	objectmanager->save(&buf);
-	sgw->writeFile("OBJECTS", &buf);
-	buf.clear();
+	kernel->save(savegamewriter->beginFile("KERNEL"));
+	savegamewriter->endFile();
 
-	world->save(&buf);
-	sgw->writeFile("WORLD", &buf);
-	buf.clear();
+	objectmanager->save(savegamewriter->beginFile("OBJECTS"), delta);
+	savegamewriter->endFile();
 
-	world->saveMaps(&buf);
-	sgw->writeFile("MAPS", &buf);
-	buf.clear();
+	world->save(savegamewriter->beginFile("WORLD"));
+	savegamewriter->endFile();
 
-	world->getCurrentMap()->save(&buf);
-	sgw->writeFile("CURRENTMAP", &buf);
-	buf.clear();
+	world->saveMaps(savegamewriter->beginFile("MAPS"), delta);
+	savegamewriter->endFile();
 
-	ucmachine->saveStrings(&buf);
-	sgw->writeFile("UCSTRINGS", &buf);
-	buf.clear();
+	world->getCurrentMap()->save(savegamewriter->beginFile("CURRENTMAP"));
+	savegamewriter->endFile();
 
-	ucmachine->saveGlobals(&buf);
-	sgw->writeFile("UCGLOBALS", &buf);
-	buf.clear();
+	ucmachine->saveStrings(savegamewriter->beginFile("UCSTRINGS"));
+	savegamewriter->endFile();
 
-	ucmachine->saveLists(&buf);
-	sgw->writeFile("UCLISTS", &buf);
-	buf.clear();
+	ucmachine->saveGlobals(savegamewriter->beginFile("UCGLOBALS"));
+	savegamewriter->endFile();
 
-	save(&buf);
-	sgw->writeFile("APP", &buf);
-	buf.clear();
+	ucmachine->saveLists(savegamewriter->beginFile("UCLISTS"));
+	savegamewriter->endFile();
 
-	sgw->finish();
+	save(savegamewriter->beginFile("APP"));
+	savegamewriter->endFile();
 
-	delete sgw;
+	savegamewriter->commit();
+
+	// Later delta savegames refer to this one
+	if (!delta) {
+		basesave = filename;
+		basesaveid = saveid;
+	}
 
 	// Restore mouse over
 	if (gump) gump->OnMouseOver();
@@ -2082,6 +2292,7 @@ void GUIApp::resetEngine()
 	if (audiomixer) audiomixer->reset();
 
 	// now, reset everything (order matters)
+	pathfinderqueue->discard();
 	world->reset();
 	ucmachine->reset();
 	// ObjectManager, Kernel have to be last, because they kill
@@ -2112,6 +2323,10 @@ void GUIApp::resetEngine()
 	save_count = 0;
 	has_cheated = false;
 
+	// there's nothing left for a delta savegame to refer to
+	basesave.clear();
+	basesaveid = 0;
+
 	con.Print(MM_INFO, "-- Engine Reset --\n");
 }
 
@@ -2203,6 +2418,9 @@ bool GUIApp::loadGame(std::string filename)
 {
 	con.Print(MM_INFO, "Loading...\n");
 
+	// The savegame may still be being written
+	savegamewriter->flush();
+
 	IDataSource* ids = filesystem->ReadFile(filename);
 	if (!ids) {
 		Error("Can't load file", "Error Loading savegame " + filename);
@@ -2262,6 +2480,27 @@ bool GUIApp::loadGame(std::string filename)
 #endif
 	}
 
+	// A delta savegame needs the savegame it refers to
+	std::string basename;
+	uint32 baseid = 0, baseversion = 0;
+	Savegame* basesg = 0;
+	if (sg->getBase(basename, baseid)) {
+		IDataSource* baseds = filesystem->ReadFile(basename);
+		if (baseds) {
+			basesg = new Savegame(baseds);
+			baseversion = basesg->getVersion();
+		}
+
+		if (!basesg || basesg->getSaveId() != baseid || baseversion == 0) {
+			Error("Base savegame " + basename + " is missing or has been "
+				  "overwritten", "Error Loading savegame " + filename);
+			delete basesg;
+			delete sg;
+			settingman->set("lastSave", "");
+			return false;
+		}
+	}
+
 	resetEngine();
 
 	setupCoreGumps();
@@ -2325,30 +2564,46 @@ bool GUIApp::loadGame(std::string filename)
 	if (!ok) message += "CURRENTMAP: failed\n";
 	delete ds;
 
+	IDataSource* baseds = basesg ? basesg->getDataSource("OBJECTS") : 0;
 	ds = sg->getDataSource("OBJECTS");
-	ok = objectmanager->load(ds, version);
+	ok = objectmanager->load(ds, version, baseds, baseversion);
 	totalok &= ok;
 	perr << "OBJECTS: " << (ok ? "ok" : "failed") << std::endl;
 	if (!ok) message += "OBJECTS: failed\n";
 	delete ds;
+	delete baseds;
 
+	baseds = basesg ? basesg->getDataSource("MAPS") : 0;
 	ds = sg->getDataSource("MAPS");
-	ok = world->loadMaps(ds, version);
+	ok = world->loadMaps(ds, version, baseds, baseversion);
 	totalok &= ok;
 	perr << "MAPS: " << (ok ? "ok" : "failed") << std::endl;
 	if (!ok) message += "MAPS: failed\n";
 	delete ds;
+	delete baseds;
 
 	if (!totalok) {
 		Error(message, "Error Loading savegame " + filename, true);
+		delete basesg;
 		delete sg;
 		return false;
 	}
 
+	// Later delta savegames refer to the same savegame as this one did,
+	// or to this one if it's a full savegame
+	if (basesg) {
+		basesave = basename;
+		basesaveid = baseid;
+	} else {
+		basesaveid = sg->getSaveId();
+		if (basesaveid) basesave = filename;
+	}
+
 	pout << "Done" << std::endl;
 
 	settingman->set("lastSave", filename);
 
+	delete basesg;
 	delete sg;
 	return true;
 }
@@ -2487,6 +2742,19 @@ void GUIApp::ConCmd_saveGame(const Console::ArgvType &argv)
 	GUIApp::get_instance()->saveGame(filename, argv[1]);
 }
 
+void GUIApp::ConCmd_saveDelta(const Console::ArgvType &argv)
+{
+	if (argv.size()==1)
+	{
+		pout << "Usage: GUIApp::saveDelta <filename>" << std::endl;
+		return;
+	}
+
+	std::string filename = "@save/";
+	filename += argv[1].c_str();
+	GUIApp::get_instance()->saveGame(filename, argv[1], false, true);
+}
+
 void GUIApp::ConCmd_loadGame(const Console::ArgvType &argv)
 {
 	if (argv.size()==1)
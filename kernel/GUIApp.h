@@ -41,20 +41,24 @@ class ScalerGump;
 class InverterGump;
 class RenderSurface;
 class PaletteManager;
+class ShapeCache;
 class GameData;
 class World;
 class ObjectManager;
 class FontManager;
 class HIDManager;
 class AvatarMoverProcess;
+class PathfinderQueue;
+class AsyncSavegameWriter;
 class IDataSource;
 class ODataSource;
 struct Texture;
 
 namespace Pentagram {
 	class AudioMixer;
+	class AudioSampleCache;
 
-	const unsigned int savegame_version = 5;
+	const unsigned int savegame_version = 6;
 };
 
 // Hack alert
@@ -130,9 +134,11 @@ public:
 
 	//! save a game
 	//! \param filename the file to save to
+	//! \param delta only save what changed since the last full savegame,
+	//!              which has to stay around to load this one
 	//! \return true if succesful
 	bool saveGame(std::string filename, std::string desc,
-				  bool ignore_modals=false);
+				  bool ignore_modals=false, bool delta=false);
 
 	//! load a game
 	//! \param filename the savegame to load
@@ -194,10 +200,15 @@ public:
 
 protected:
 	virtual void DeclareArgs();
+	virtual void helpMe();
 
 private:
 	uint32 save_count;
 
+	//! the savegame delta savegames refer to, and its id
+	std::string basesave;
+	uint32 basesaveid;
+
 	//! write savegame info (time, ..., game-specifics)
 	void writeSaveInfo(ODataSource* ods);
 
@@ -226,12 +237,15 @@ private:
 	std::string error_title;
 
 	Kernel* kernel;
+	PathfinderQueue* pathfinderqueue;
+	AsyncSavegameWriter* savegamewriter;
 	ObjectManager* objectmanager;
 	HIDManager* hidmanager;
 	UCMachine* ucmachine;
 	RenderSurface *screen;
 	bool fullscreen;
 	PaletteManager *palettemanager;
+	ShapeCache *shapecache;
 	GameData *gamedata;
 	World *world;
 	FontManager* fontmanager;
@@ -343,6 +357,7 @@ private:
 
 	// Load and save games from arbitrary filenames from the console
 	static void			ConCmd_saveGame(const Console::ArgvType &argv);			//!< "GUIApp::saveGame <filename>" console command
+	static void			ConCmd_saveDelta(const Console::ArgvType &argv);		//!< "GUIApp::saveDelta <filename>" console command
 	static void			ConCmd_loadGame(const Console::ArgvType &argv);			//!< "GUIApp::loadGame <filename>" console command
 	static void			ConCmd_newGame(const Console::ArgvType &argv);			//!< "GUIApp::newGame" console command
 
@@ -372,8 +387,18 @@ private:
 
 	bool				ttfoverrides;
 
+	// Headless benchmark, from the command line
+	uint32				oBenchmarkTicks;	//!< ticks to run (0 = no benchmark)
+	std::string			oBenchmarkSave;		//!< savegame to start from
+	bool				oBenchmarkPaint;	//!< paint every tick too
+	uint32				oBenchmarkSeed;		//!< seed for the random number generator
+
+	//! Run oBenchmarkTicks ticks as fast as possible and print timings
+	void				runBenchmark();
+
 	// Audio Mixer
 	Pentagram::AudioMixer *audiomixer;
+	Pentagram::AudioSampleCache *audiosamplecache;
 };
 
 #endif
@@ -37,8 +37,15 @@ Kernel::Kernel() : loading(false)
 
 	assert(kernel == 0);
 	kernel = this;
-	pIDs = new idMan(1,32766,128);
+	pIDs = new idMan(1,MAX_PID,128);
 	current_process = processes.end();
+
+	ProcessSlot emptyslot;
+	emptyslot.proc = 0;
+	emptyslot.pos = processes.end();
+	emptyslot.order = 0;
+	emptyslot.wakeframe = 0;
+	slots.resize(MAX_PID+1, emptyslot);
 	framenum = 0;
 	paused = 0;
 	runningprocess = 0;
@@ -60,11 +67,16 @@ void Kernel::reset()
 	con.Print(MM_INFO, "Resetting Kernel...\n");
 
 	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it) {
+		slots[(*it)->pid].proc = 0;
 		delete (*it);
 	}
 	processes.clear();
 	current_process = processes.begin();
 
+	objprocs.clear();
+	for (unsigned int i = 0; i < TIMERWHEEL_SIZE; ++i)
+		timerwheel[i].clear();
+
 	pIDs->clearAll();
 
 	paused = 0;
@@ -123,7 +135,7 @@ ProcId Kernel::addProcessExec(Process* proc)
 		 << ", pid = " << proc->pid << std::endl;
 #endif
 
-	processes.push_back(proc);
+	linkProcess(processes.end(), proc);
 	proc->flags |= Process::PROC_ACTIVE;
 
 	Process* oldrunning = runningprocess; runningprocess = proc;
@@ -142,27 +154,169 @@ void Kernel::removeProcess(Process* proc)
 	//! over the list. (Hence the special 'erase' in runProcs below, which
 	//! is very std::list-specific, incidentally)
 
-	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it) {
-		if (*it == proc) {
-			proc->flags &= ~Process::PROC_ACTIVE;
-			
-			perr << "[Kernel] Removing process " << proc << std::endl;
+	if (proc->pid > MAX_PID || slots[proc->pid].proc != proc) return;
 
-			processes.erase(it);
+	proc->flags &= ~Process::PROC_ACTIVE;
 
-			// Clear pid
-			pIDs->clearID(proc->pid);
+	perr << "[Kernel] Removing process " << proc << std::endl;
+
+	unlinkProcess(slots[proc->pid].pos);
+
+	// Clear pid
+	pIDs->clearID(proc->pid);
+}
+
+void Kernel::linkProcess(ProcessIterator pos, Process* proc)
+{
+	ProcessIterator it = processes.insert(pos, proc);
+
+	if (proc->pid > MAX_PID || slots[proc->pid].proc) {
+		perr << "[Kernel] Process " << proc->pid << " linked twice"
+			 << std::endl;
+		return;
+	}
+
+	ProcessSlot& slot = slots[proc->pid];
+	slot.proc = proc;
+	slot.pos = it;
+	setProcessOrder(it);
+
+	indexProcess(proc);
+}
+
+ProcessIterator Kernel::unlinkProcess(ProcessIterator it)
+{
+	Process* proc = *it;
+
+	if (proc->pid <= MAX_PID && slots[proc->pid].proc == proc) {
+		unindexProcess(proc);
+		slots[proc->pid].proc = 0;
+	}
+
+	return processes.erase(it);
+}
 
+void Kernel::setProcessOrder(ProcessIterator it)
+{
+	// The order keys only have to increase along the list, so most
+	// insertions can take a key between those of their neighbours.
+	// When there is no room left, renumber the whole list.
+	ProcessIterator next = it;
+	++next;
+
+	uint32 lo = 0;
+	if (it != processes.begin()) {
+		ProcessIterator prev = it;
+		--prev;
+		lo = slots[(*prev)->pid].order;
+	}
+
+	uint32 order;
+	if (next == processes.end()) {
+		if (lo > 0xFFFFFFFF - ORDER_STEP) {
+			renumberProcesses();
 			return;
 		}
+		order = lo + ORDER_STEP;
+	} else {
+		uint32 hi = slots[(*next)->pid].order;
+		if (hi - lo < 2) {
+			renumberProcesses();
+			return;
+		}
+		order = lo + (hi - lo) / 2;
+	}
+
+	slots[(*it)->pid].order = order;
+}
+
+void Kernel::renumberProcesses()
+{
+	uint32 order = 0;
+	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it)
+	{
+		order += ORDER_STEP;
+		if ((*it)->pid <= MAX_PID)
+			slots[(*it)->pid].order = order;
+	}
+}
+
+void Kernel::indexProcess(Process* proc)
+{
+	if (proc->item_num == 0) return;
+	objprocs[proc->item_num].push_back(proc->pid);
+}
+
+void Kernel::unindexProcess(Process* proc)
+{
+	if (proc->item_num == 0) return;
+
+	std::map<ObjId, std::vector<ProcId> >::iterator iter;
+	iter = objprocs.find(proc->item_num);
+	if (iter == objprocs.end()) return;
+
+	std::vector<ProcId>& procs = iter->second;
+	for (unsigned int i = 0; i < procs.size(); ++i) {
+		if (procs[i] == proc->pid) {
+			procs.erase(procs.begin() + i);
+			break;
+		}
+	}
+	if (procs.empty())
+		objprocs.erase(iter);
+}
+
+void Kernel::setProcessItemNum(Process* proc, ObjId objid)
+{
+	bool linked = proc->pid <= MAX_PID && slots[proc->pid].proc == proc;
+
+	if (linked) unindexProcess(proc);
+	proc->item_num = objid;
+	if (linked) indexProcess(proc);
+}
+
+void Kernel::sleepProcess(Process* proc, uint32 frames)
+{
+	if (frames == 0) return;
+	if (proc->pid > MAX_PID || slots[proc->pid].proc != proc) return;
+
+	slots[proc->pid].wakeframe = framenum + frames;
+	timerwheel[(framenum + frames) % TIMERWHEEL_SIZE].push_back(proc->pid);
+	proc->flags |= Process::PROC_SLEEPING;
+}
+
+void Kernel::wakeSleepingProcesses()
+{
+	std::vector<ProcId>& sleeping = timerwheel[framenum % TIMERWHEEL_SIZE];
+
+	unsigned int i = 0;
+	while (i < sleeping.size()) {
+		ProcessSlot& slot = slots[sleeping[i]];
+
+		// Entries for processes that are gone or already awake are dropped,
+		// entries for later turns of the wheel are kept
+		if (slot.proc && (slot.proc->flags & Process::PROC_SLEEPING) &&
+			static_cast<sint32>(slot.wakeframe - framenum) > 0)
+		{
+			++i;
+			continue;
+		}
+
+		if (slot.proc)
+			slot.proc->flags &= ~Process::PROC_SLEEPING;
+
+		sleeping[i] = sleeping.back();
+		sleeping.pop_back();
 	}
 }
 
 
 void Kernel::runProcesses()
 {
-	if (!paused)
+	if (!paused) {
 		framenum++;
+		wakeSleepingProcesses();
+	}
 
 	if (processes.size() == 0) {
 		return;
@@ -181,7 +335,7 @@ void Kernel::runProcesses()
 		{
 			p->terminate();
 		}
-		if (!(p->is_terminated() || p->is_suspended()) &&
+		if (!(p->is_terminated() || p->is_suspended() || p->is_sleeping()) &&
 			(!paused || (p->flags & Process::PROC_RUNPAUSED)))
 		{
 			runningprocess = p;
@@ -194,7 +348,7 @@ void Kernel::runProcesses()
 		}
 		if (!paused && (p->flags & Process::PROC_TERMINATED)) {
 			// process is killed, so remove it from the list
-			current_process = processes.erase(current_process);
+			current_process = unlinkProcess(current_process);
 				
 			// Clear pid
 			pIDs->clearID(p->pid);
@@ -213,42 +367,47 @@ void Kernel::setNextProcess(Process* proc)
 {
 	if (current_process != processes.end() && *current_process == proc) return;
 
-	if (proc->flags & Process::PROC_ACTIVE) {
-		for (ProcessIterator it = processes.begin();
-			 it != processes.end(); ++it) {
-			if (*it == proc) {
-				processes.erase(it);
-				break;
-			}
-		}
-	} else {
-		proc->flags |= Process::PROC_ACTIVE;
+	ProcessIterator t = processes.begin();
+	if (current_process != processes.end()) {
+		t = current_process;
+		++t;
 	}
 
-	if (current_process == processes.end()) {
-		processes.push_front(proc);
-	} else {
-		ProcessIterator t = current_process;
-		++t;
+	bool linked = proc->pid <= MAX_PID && slots[proc->pid].proc == proc;
 
-		processes.insert(t, proc);
+	if ((proc->flags & Process::PROC_ACTIVE) && linked) {
+		// move it, keeping its slot and index entries
+		ProcessSlot& slot = slots[proc->pid];
+		if (slot.pos != t) {
+			processes.splice(t, processes, slot.pos);
+			setProcessOrder(slot.pos);
+		}
+	} else {
+		proc->flags |= Process::PROC_ACTIVE;
+		linkProcess(t, proc);
 	}
 }
 
 Process* Kernel::getProcess(ProcId pid)
 {
-	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it) {
-		Process* p = *it;
-		if (p->pid == pid)
-			return p;
-	}
-	return 0;
+	if (pid > MAX_PID) return 0;
+	return slots[pid].proc;
 }
 
 void Kernel::kernelStats()
 {
+	unsigned int suspended = 0, sleeping = 0;
+	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it) {
+		if ((*it)->is_suspended()) suspended++;
+		if ((*it)->is_sleeping()) sleeping++;
+	}
+
 	pout << "Kernel memory stats:" << std::endl;
 	pout << "Processes  : " << processes.size() << "/32765" << std::endl;
+	pout << "Suspended  : " << suspended << ", sleeping: " << sleeping
+		 << std::endl;
+	pout << "Objects    : " << objprocs.size() << " with processes"
+		 << std::endl;
 }
 
 void Kernel::processTypes()
@@ -339,6 +498,25 @@ uint32 Kernel::getNumProcesses(ObjId objid, uint16 processtype)
 {
 	uint32 count = 0;
 
+	if (objid != 0) {
+		std::map<ObjId, std::vector<ProcId> >::iterator iter;
+		iter = objprocs.find(objid);
+		if (iter == objprocs.end()) return 0;
+
+		const std::vector<ProcId>& procs = iter->second;
+		for (unsigned int i = 0; i < procs.size(); ++i) {
+			Process* p = slots[procs[i]].proc;
+
+			// Don't count us, we are not really here
+			if (p->is_terminated()) continue;
+
+			if (processtype == 6 || processtype == p->type)
+				count++;
+		}
+
+		return count;
+	}
+
 	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it)
 	{
 		Process* p = *it;
@@ -356,6 +534,33 @@ uint32 Kernel::getNumProcesses(ObjId objid, uint16 processtype)
 
 Process* Kernel::findProcess(ObjId objid, uint16 processtype)
 {
+	if (objid != 0) {
+		std::map<ObjId, std::vector<ProcId> >::iterator iter;
+		iter = objprocs.find(objid);
+		if (iter == objprocs.end()) return 0;
+
+		// return the first one in the process list
+		Process* found = 0;
+		uint32 foundorder = 0;
+		const std::vector<ProcId>& procs = iter->second;
+		for (unsigned int i = 0; i < procs.size(); ++i) {
+			const ProcessSlot& slot = slots[procs[i]];
+			Process* p = slot.proc;
+
+			// Don't count us, we are not really here
+			if (p->is_terminated()) continue;
+
+			if ((processtype == 6 || processtype == p->type) &&
+				(!found || slot.order < foundorder))
+			{
+				found = p;
+				foundorder = slot.order;
+			}
+		}
+
+		return found;
+	}
+
 	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it)
 	{
 		Process* p = *it;
@@ -376,6 +581,11 @@ Process* Kernel::findProcess(ObjId objid, uint16 processtype)
 
 void Kernel::killProcesses(ObjId objid, uint16 processtype, bool fail)
 {
+	if (objid != 0) {
+		killObjectProcesses(objid, processtype, false, fail);
+		return;
+	}
+
 	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it)
 	{
 		Process* p = *it;
@@ -395,6 +605,11 @@ void Kernel::killProcesses(ObjId objid, uint16 processtype, bool fail)
 
 void Kernel::killProcessesNotOfType(ObjId objid, uint16 processtype, bool fail)
 {
+	if (objid != 0) {
+		killObjectProcesses(objid, processtype, true, fail);
+		return;
+	}
+
 	for (ProcessIterator it = processes.begin(); it != processes.end(); ++it)
 	{
 		Process* p = *it;
@@ -412,6 +627,58 @@ void Kernel::killProcessesNotOfType(ObjId objid, uint16 processtype, bool fail)
 	}
 }
 
+void Kernel::killObjectProcesses(ObjId objid, uint16 processtype,
+								 bool nottype, bool fail)
+{
+	// Killing a process can wake up, move or create other processes.
+	// To end up with the same result as walking the process list, look up
+	// the next process after the last one killed again each time.
+	bool first = true;
+	uint32 lastorder = 0;
+
+	for (;;) {
+		std::map<ObjId, std::vector<ProcId> >::iterator iter;
+		iter = objprocs.find(objid);
+		if (iter == objprocs.end()) return;
+
+		Process* next = 0;
+		uint32 nextorder = 0;
+		const std::vector<ProcId>& procs = iter->second;
+		for (unsigned int i = 0; i < procs.size(); ++i) {
+			const ProcessSlot& slot = slots[procs[i]];
+			Process* p = slot.proc;
+
+			if (!first && slot.order <= lastorder) continue;
+
+			bool typematch = (nottype ? (p->type != processtype)
+							  : (processtype == 6 || processtype == p->type));
+
+			if (typematch &&
+				!(p->flags & Process::PROC_TERMINATED) &&
+				!(p->flags & Process::PROC_TERM_DEFERRED) &&
+				(!next || slot.order < nextorder))
+			{
+				next = p;
+				nextorder = slot.order;
+			}
+		}
+
+		if (!next) return;
+
+		if (fail)
+			next->fail();
+		else
+			next->terminate();
+
+		// the list may have been renumbered
+		first = false;
+		if (slots[next->pid].proc == next)
+			lastorder = slots[next->pid].order;
+		else
+			lastorder = nextorder;
+	}
+}
+
 void Kernel::save(ODataSource* ods)
 {
 	ods->write4(framenum);
@@ -434,7 +701,12 @@ bool Kernel::load(IDataSource* ids, uint32 version)
 	for (unsigned int i = 0; i < pcount; ++i) {
 		Process* p = loadProcess(ids, version);
 		if (!p) return false;
-		processes.push_back(p);
+
+		// the timer wheel isn't saved, so let sleeping processes run;
+		// they will go back to sleep
+		p->flags &= ~Process::PROC_SLEEPING;
+
+		linkProcess(processes.end(), p);
 	}
 
 	return true;
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include <list>
 #include <map>
+#include <vector>
 
 #include "intrinsics.h"
 
@@ -56,6 +57,13 @@ public:
 	void setNextProcess(Process *proc);
 	Process* getRunningProcess() const { return runningprocess; }
 
+	//! Don't run an active process until the given number of frames
+	//! have passed. It keeps its place in the process list.
+	void sleepProcess(Process *proc, uint32 frames);
+
+	//! change the item a process is assigned to
+	void setProcessItemNum(Process *proc, ObjId objid);
+
 	// objid = 0 means any object, type = 6 means any type
 	uint32 getNumProcesses(ObjId objid, uint16 processtype);
 
@@ -113,11 +121,54 @@ public:
 private:
 	Process* loadProcess(IDataSource* ids, uint32 version);
 
+	//! insert a process into the process list before pos
+	void linkProcess(std::list<Process*>::iterator pos, Process* proc);
+
+	//! remove a process from the process list
+	//! \return the iterator following the removed process
+	std::list<Process*>::iterator unlinkProcess(
+		std::list<Process*>::iterator it);
+
+	//! give a process an order key between those of its neighbours
+	void setProcessOrder(std::list<Process*>::iterator it);
+	void renumberProcesses();
+
+	void indexProcess(Process* proc);
+	void unindexProcess(Process* proc);
+
+	//! kill the processes of an object in process list order
+	void killObjectProcesses(ObjId objid, uint16 processtype, bool nottype,
+							 bool fail);
+
+	//! clear PROC_SLEEPING on the processes that wake up this frame
+	void wakeSleepingProcesses();
+
 	std::list<Process*> processes;
 	idMan	*pIDs;
 
 	std::list<Process*>::iterator current_process;
 
+	enum {
+		MAX_PID = 32766,
+		ORDER_STEP = 1 << 16,
+		TIMERWHEEL_SIZE = 256
+	};
+
+	//! Bookkeeping for a process in the process list, indexed by pid
+	struct ProcessSlot {
+		Process* proc;
+		std::list<Process*>::iterator pos;
+		uint32 order;		//!< increases along the process list
+		uint32 wakeframe;	//!< frame a sleeping process wakes up
+	};
+	std::vector<ProcessSlot> slots;
+
+	//! processes assigned to each object (except objid 0)
+	std::map<ObjId, std::vector<ProcId> > objprocs;
+
+	//! sleeping processes, by wakeframe % TIMERWHEEL_SIZE
+	std::vector<ProcId> timerwheel[TIMERWHEEL_SIZE];
+
 	std::map<std::string, ProcessLoadFunc> processloaders;
 
 	bool loading;
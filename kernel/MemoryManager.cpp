@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "MemoryManager.h"
 
-#include "SegmentedAllocator.h"
+#include "SlabAllocator.h"
 
 MemoryManager* MemoryManager::memorymanager = 0;
 
@@ -29,11 +29,7 @@ MemoryManager::MemoryManager()
 	assert(memorymanager == 0);
 	memorymanager = this;
 
-	//!!! CONSTANT !!!!
-	allocatorCount = 2;
-	// Tune these with averages from MemoryManager::MemInfo when needed
-	allocators[0] = new SegmentedAllocator(192, 8500);
-	allocators[1] = new SegmentedAllocator(4224, 25);
+	allocator = new SlabAllocator();
 
 	Pentagram::setAllocationFunctions(MemoryManager::allocate,
 									  MemoryManager::deallocate);
@@ -44,77 +40,44 @@ MemoryManager::~MemoryManager()
 	memorymanager = 0;
 
 	Pentagram::setAllocationFunctions(malloc, free);
-	delete allocators[0];
-	delete allocators[1];
+	delete allocator;
 }
 
 void * MemoryManager::_allocate(size_t size)
 {
-	int i;
-	// get the memory from the first allocator that can hold "size"
-	for (i = 0; i < allocatorCount; ++i)
-	{
-		if (allocators[i]->getCapacity() >= size)
-		{
-			return allocators[i]->allocate(size);
-		}
-	}
-
-	// else
-	void * ptr = malloc(size);
-#ifdef DEBUG
-	con.Printf("MemoryManager::allocate - Allocated %d bytes to 0x%X\n", size, ptr);
-#endif
-
-	return ptr;
+	return allocator->allocate(size);
 }
 
 void MemoryManager::_deallocate(void * ptr)
 {
-	Pool * p;
-	int i;
-	for (i = 0; i < allocatorCount; ++i)
-	{
-		p = allocators[i]->findPool(ptr);
-		if (p)
-		{
-			p->deallocate(ptr);
-			return;
-		}
-	}
-
-#ifdef DEBUG
-	con.Printf("MemoryManager::deallocate - deallocating memory at 0x%X\n", ptr);
-#endif
-	// Pray!
-	free(ptr);
+	allocator->deallocate(ptr);
 }
 
 void MemoryManager::freeResources()
 {
-	int i;
-	for (i = 0; i < allocatorCount; ++i)
-	{
-		allocators[i]->freeResources();
-	}
+	allocator->freeResources();
 }
 
 void MemoryManager::ConCmd_MemInfo(const Console::ArgvType &argv)
 {
 	MemoryManager * mm = MemoryManager::get_instance();
-	int i, count;
 
 	if (!mm)
 		return;
 
-	count = mm->getAllocatorCount();
+	pout << "Size classes:" << std::endl;
+	mm->getAllocator()->printInfo();
+	pout << "==============" << std::endl;
 
-	pout << "Allocators: " << count << std::endl;
-	for (i = 0; i < count; ++i)
+	pout << "Classes:" << std::endl;
+	Pentagram::AllocationStats * stats;
+	for (stats = Pentagram::AllocationStats::first; stats; stats = stats->next)
 	{
-		pout << " Allocator " << i << ": " << std::endl;
-		mm->getAllocator(i)->printInfo();
-		pout << "==============" << std::endl;
+		con.Printf(" %-12s %6d objects (%6d KB), high-water %6d objects (%6d KB)\n",
+				   stats->name, stats->count,
+				   static_cast<int>(stats->bytes / 1024),
+				   stats->highwater,
+				   static_cast<int>(stats->bytes_highwater / 1024));
 	}
 }
 
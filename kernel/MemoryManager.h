@@ -19,7 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef MEMORYMANAGER_H
 #define MEMORYMANAGER_H
 
-class Allocator;
+class SlabAllocator;
 
 class MemoryManager
 {
@@ -29,19 +29,16 @@ public:
 
 	static MemoryManager* get_instance() { return memorymanager; }
 
-	//! Allocates memory with the default allocator or malloc
+	//! Allocates memory with the slab allocator
 	static void * allocate(size_t size)
 		{ return memorymanager ? memorymanager->_allocate(size) : 0; }
 
-	//! Checks all known Allocators to free memory
+	//! Frees memory from allocate
 	static void deallocate(void * ptr)
 		{ memorymanager->_deallocate(ptr); }
 
-	Allocator * getAllocator(uint16 index)
-		{ return index < allocatorCount ? allocators[index] : 0; }
-
-	uint16 getAllocatorCount()
-		{ return allocatorCount; }
+	SlabAllocator * getAllocator()
+		{ return allocator; }
 
 	void freeResources();
 
@@ -52,8 +49,7 @@ public:
 	static void ConCmd_test(const Console::ArgvType &argv);
 
 private:
-	Allocator* allocators[10];
-	uint16 allocatorCount;
+	SlabAllocator* allocator;
 
 	void * _allocate(size_t size);
 	void _deallocate(void * ptr);
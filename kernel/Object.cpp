@@ -42,8 +42,10 @@ Object::~Object()
 
 ObjId Object::assignObjId()
 {
-	if (objid == 0xFFFF)
+	if (objid == 0xFFFF) {
 		objid = ObjectManager::get_instance()->assignObjId(this);
+		dirty = true;
+	}
 	return objid;
 }
 
@@ -52,8 +54,10 @@ void Object::clearObjId()
 	// On clearObjId we kill all processes that belonged to us
 	Kernel::get_instance()->killProcesses(objid, 6, true);
 
-	if (objid != 0xFFFF)
+	if (objid != 0xFFFF) {
 		ObjectManager::get_instance()->clearObjId(objid);
+		dirty = true;
+	}
 	objid = 0xFFFF;
 }
 
@@ -26,7 +26,7 @@ class IDataSource;
 class Object
 {
 public:
-	Object() : objid(0xFFFF) {}
+	Object() : objid(0xFFFF), dirty(true) {}
 	virtual ~Object();
 
 	// p_dynamic_cast stuff
@@ -48,6 +48,20 @@ public:
 	//! dump some info about this object to pout
 	virtual void dumpInfo();
 
+	//! Has the saved state of this object changed since the base savegame?
+	//! Only meaningful if tracksDirty() is true.
+	bool isDirty() const { return dirty; }
+
+	//! Mark the saved state of this object as changed
+	virtual void setDirty() { dirty = true; }
+
+	//! Mark this object as unchanged since the base savegame
+	void clearDirty() { dirty = false; }
+
+	//! Does this object call setDirty() whenever its saved state changes?
+	//! Objects that don't are always saved in full.
+	virtual bool tracksDirty() const { return false; }
+
 	//! save this object
 	void save(ODataSource* ods);
 
@@ -71,6 +85,8 @@ protected:
 	virtual void saveData(ODataSource* ods);
 
 	ObjId objid;
+
+	bool dirty;
 };
 
 #endif
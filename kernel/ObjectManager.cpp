@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ObjectManager.h"
 
 #include <map>
+#include <list>
 #include "idMan.h"
 #include "Object.h"
 #include "Item.h"
@@ -122,6 +123,8 @@ void ObjectManager::reset()
 	objIDs->clearAll(32766);
 	objIDs->reserveID(666);		// 666 is reserved for the Guardian Bark hack
 	actorIDs->clearAll();
+
+	baseoffsets.clear();
 }
 
 void ObjectManager::objectStats()
@@ -253,11 +256,13 @@ void ObjectManager::allow64kObjects()
 }
 
 
-void ObjectManager::save(ODataSource* ods)
+void ObjectManager::save(ODataSource* ods, bool delta)
 {
 	objIDs->save(ods);
 	actorIDs->save(ods);
 
+	if (!delta) baseoffsets.clear();
+
 	for (unsigned int i = 0; i < objects.size(); ++i) {
 		Object* object = objects[i];
 		if (!object) continue;
@@ -272,31 +277,91 @@ void ObjectManager::save(ODataSource* ods)
 		// FIXME: This leaks objIDs. See comment in ObjectManager::load().
 		if (gump && !gump->mustSave(true)) continue;
 
+		if (!delta) {
+			if (object->tracksDirty())
+				baseoffsets[object->getObjId()] = ods->getPos();
+		} else if (object->tracksDirty() && !object->isDirty()) {
+			std::map<ObjId, uint32>::iterator it;
+			it = baseoffsets.find(object->getObjId());
+			if (it != baseoffsets.end()) {
+				// unchanged, so refer to the base savegame instead
+				ods->write2(0xFFFF);
+				ods->write2(object->getObjId());
+				ods->write4(it->second);
+				continue;
+			}
+		}
+
 		object->save(ods);
 	}
 
 	ods->write2(0);
+
+	// This is the new base savegame
+	if (!delta) {
+		for (unsigned int i = 0; i < objects.size(); ++i) {
+			if (objects[i]) objects[i]->clearDirty();
+		}
+	}
 }
 
 
-bool ObjectManager::load(IDataSource* ids, uint32 version)
+bool ObjectManager::load(IDataSource* ids, uint32 version,
+						 IDataSource* baseids, uint32 baseversion)
 {
 	if (!objIDs->load(ids, version)) return false;
 	if (!actorIDs->load(ids, version)) return false;
 
+	baseoffsets.clear();
+
+	// objects saved in full in a delta savegame
+	std::list<Object*> changed;
+
 	do {
+		uint32 pos = ids->getPos();
+
 		// peek ahead for terminator
 		uint16 classlen = ids->read2();
 		if (classlen == 0) break;
-		char* buf = new char[classlen+1];
-		ids->read(buf, classlen);
-		buf[classlen] = 0;
 
-		std::string classname = buf;
-		delete[] buf;
-
-		Object* obj = loadObject(ids, classname, version);
-		if (!obj) return false;
+		Object* obj;
+
+		if (classlen == 0xFFFF) {
+			// unchanged object, stored in the base savegame
+			ObjId objid = ids->read2();
+			uint32 offset = ids->read4();
+			if (!baseids) {
+				perr << "Object " << objid << " refers to a missing base "
+					 << "savegame." << std::endl;
+				return false;
+			}
+
+			baseids->seek(offset);
+			obj = loadObject(baseids, baseversion);
+			if (!obj) return false;
+			if (obj->getObjId() != objid) {
+				perr << "Object " << objid << " not found in base savegame."
+					 << std::endl;
+				return false;
+			}
+
+			baseoffsets[objid] = offset;
+		} else {
+			char* buf = new char[classlen+1];
+			ids->read(buf, classlen);
+			buf[classlen] = 0;
+
+			std::string classname = buf;
+			delete[] buf;
+
+			obj = loadObject(ids, classname, version);
+			if (!obj) return false;
+
+			if (baseids)
+				changed.push_back(obj);
+			else if (obj->tracksDirty())
+				baseoffsets[obj->getObjId()] = pos;
+		}
 
 		// top level gumps have to be added to the correct core gump
 		Gump* gump = p_dynamic_cast<Gump*>(obj);
@@ -306,6 +371,14 @@ bool ObjectManager::load(IDataSource* ids, uint32 version)
 
 	} while(true);
 
+	// Everything is as in the base savegame, except what a delta changed
+	for (unsigned int i = 0; i < objects.size(); ++i) {
+		if (objects[i]) objects[i]->clearDirty();
+	}
+	std::list<Object*>::iterator iter;
+	for (iter = changed.begin(); iter != changed.end(); ++iter)
+		(*iter)->setDirty();
+
 	// ObjectManager::save() doesn't save Gumps with the DONT_SAVE flag, but
 	// their IDs are still marked in use in objIDs.
 	// As a workaround, we clear all IDs still in use without actual objects.
@@ -58,8 +58,16 @@ public:
 	void objectStats();
 	void objectTypes();
 
-	void save(ODataSource* ods);
-	bool load(IDataSource* ids, uint32 version);
+	//! Save all top-level objects.
+	//! A full save becomes the base savegame, and all objects are marked
+	//! unchanged. A delta save only refers to the unchanged objects in the
+	//! base savegame, instead of saving them again.
+	void save(ODataSource* ods, bool delta=false);
+
+	//! Load the objects.
+	//! \param baseids the OBJECTS of the base savegame, if this is a delta
+	bool load(IDataSource* ids, uint32 version,
+			  IDataSource* baseids=0, uint32 baseversion=0);
 
 	Object* loadObject(IDataSource* ids, uint32 version);
 	Object* loadObject(IDataSource* ids, std::string classname,uint32 version);
@@ -80,6 +88,9 @@ private:
 		{ objectloaders[classname] = func; }
 	std::map<std::string, ObjectLoadFunc> objectloaders;
 
+	//! where each top-level object is in the OBJECTS of the base savegame
+	std::map<ObjId, uint32> baseoffsets;
+
 	static ObjectManager* objectmanager;
 };
 
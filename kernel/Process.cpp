@@ -97,6 +97,11 @@ void Process::suspend()
 	flags |= PROC_SUSPENDED;
 }
 
+void Process::setItemNum(ObjId it)
+{
+	Kernel::get_instance()->setProcessItemNum(this, it);
+}
+
 void Process::dumpInfo()
 {
 	pout << "Process " << getPid() << " class "
@@ -108,6 +113,7 @@ void Process::dumpInfo()
 	if (flags & PROC_TERM_DEFERRED) pout << "t";
 	if (flags & PROC_FAILED) pout << "F";
 	if (flags & PROC_RUNPAUSED) pout << "R";
+	if (flags & PROC_SLEEPING) pout << "Z";
 	if (!waiting.empty()) {
 		pout << ", notify: ";
 		for (std::vector<ProcId>::iterator i = waiting.begin();
@@ -44,6 +44,7 @@ public:
 	bool is_terminated() const { return (flags & (PROC_TERMINATED |
 												  PROC_TERM_DEFERRED))!=0; }
 	bool is_suspended() const { return (flags & PROC_SUSPENDED)!=0; }
+	bool is_sleeping() const { return (flags & PROC_SLEEPING)!=0; }
 
 	//! terminate the process and recursively fail all processes waiting for it
 	void fail();
@@ -65,7 +66,7 @@ public:
 
 	void wakeUp(uint32 result);
 
-	void setItemNum(ObjId it) { item_num = it; }
+	void setItemNum(ObjId it);
 	void setType(uint16 ty) { type = ty; }
 
 	ProcId getPid() const { return pid; }
@@ -112,6 +113,7 @@ public:
 		PROC_TERM_DEFERRED=0x0008, //!< automatically call terminate next frame
 		PROC_FAILED      = 0x0010,
 		PROC_RUNPAUSED   = 0x0020, //!< run even if game is paused
+		PROC_SLEEPING    = 0x0040  //!< not run until the Kernel wakes it
 	};
 
 };
@@ -0,0 +1,49 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "Profiler.h"
+
+bool Profiler::enabled = false;
+SDL_threadID Profiler::mainthread = 0;
+Uint64 Profiler::times[Profiler::SECTION_COUNT];
+uint32 Profiler::counts[Profiler::SECTION_COUNT];
+uint32 Profiler::depth[Profiler::SECTION_COUNT];
+
+void Profiler::reset()
+{
+	for (int i = 0; i < SECTION_COUNT; ++i) {
+		times[i] = 0;
+		counts[i] = 0;
+	}
+}
+
+const char* Profiler::getSectionName(Section s)
+{
+	static const char* names[SECTION_COUNT] = {
+		"usecode", "pathfinding", "collision", "sort", "paint"
+	};
+	return names[s];
+}
+
+double Profiler::getTime(Section s)
+{
+	return static_cast<double>(times[s]) * 1000000.0 /
+		static_cast<double>(SDL_GetPerformanceFrequency());
+}
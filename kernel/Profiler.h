@@ -0,0 +1,92 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL.h>
+
+//! Time spent in the main subsystems of the engine, for benchmarking.
+//! Only the thread that enabled the Profiler is timed, and only while the
+//! Profiler is enabled.
+//! Sections can be nested in each other (pathfinding does collision
+//! detection, for instance), and the time of a section includes the time
+//! of the sections inside it.
+class Profiler
+{
+public:
+	enum Section {
+		USECODE = 0,
+		PATHFINDING,
+		COLLISION,
+		SORT,
+		PAINT,
+		SECTION_COUNT
+	};
+
+	//! Enable or disable the Profiler. Only the calling thread is timed.
+	static void setEnabled(bool e) { enabled = e; mainthread = SDL_ThreadID(); }
+	static bool isEnabled() { return enabled; }
+
+	//! Clear all times and counts
+	static void reset();
+
+	static const char* getSectionName(Section s);
+
+	//! Time spent in a section, in microseconds
+	static double getTime(Section s);
+
+	//! Number of times a section was entered
+	static uint32 getCount(Section s) { return counts[s]; }
+
+	//! Time a section for the lifetime of the Scope
+	class Scope
+	{
+	public:
+		explicit Scope(Section s)
+			: section(s), start(0),
+			  active(enabled && SDL_ThreadID() == mainthread) {
+			// Only the outermost scope of a section is timed
+			if (active && depth[section]++ == 0)
+				start = SDL_GetPerformanceCounter();
+		}
+		~Scope() {
+			if (!active) return;
+			if (--depth[section] == 0)
+				add(section, SDL_GetPerformanceCounter() - start);
+		}
+	private:
+		Section section;
+		Uint64 start;
+		bool active;
+	};
+
+private:
+	static void add(Section s, Uint64 time) {
+		times[s] += time;
+		counts[s]++;
+	}
+
+	static bool enabled;
+	static SDL_threadID mainthread;
+	static Uint64 times[SECTION_COUNT];
+	static uint32 counts[SECTION_COUNT];
+	static uint32 depth[SECTION_COUNT];
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+#include "pent_include.h"
+
+#include "SlabAllocator.h"
+
+// Blocks are aligned to two pointers, which is enough for anything we
+// allocate, including doubles on 32 bit systems.
+#define BLOCK_ALIGN(X) ( (X + 2*sizeof(uintptr) - 1) & ~(2*sizeof(uintptr) - 1) )
+
+// Slabs are at least this big, and hold at least MIN_SLAB_BLOCKS blocks
+static const size_t SLAB_SIZE = 64*1024;
+static const uint32 MIN_SLAB_BLOCKS = 8;
+
+struct SlabBlockHeader
+{
+	SlabPage * slab;		// 0 for malloc'ed blocks
+	size_t size;			// requested size
+};
+
+struct SlabPage
+{
+	SlabAllocator::SizeClass * sc;
+	SlabPage * prev;
+	SlabPage * next;
+
+	SlabBlockHeader * firstFree;	// freed blocks, linked through the slab field
+	uint32 used;
+	uint32 fresh;					// blocks never handed out, at the end
+	uint8 * blocks;
+};
+
+static const size_t headerSize = BLOCK_ALIGN(sizeof(SlabBlockHeader));
+static const size_t pageSize = BLOCK_ALIGN(sizeof(SlabPage));
+
+
+SlabAllocator::SlabAllocator()
+	: largeUsed(0), largeHighwater(0), largeBytes(0), largeBytesHighwater(0)
+{
+	size_t capacity = 16;
+	for (int i = 0; i < CLASS_COUNT; ++i)
+	{
+		SizeClass& sc = classes[i];
+		sc.capacity = capacity;
+		sc.blockSize = headerSize + BLOCK_ALIGN(capacity);
+		sc.blocksPerSlab = (SLAB_SIZE - pageSize) / sc.blockSize;
+		if (sc.blocksPerSlab < MIN_SLAB_BLOCKS)
+			sc.blocksPerSlab = MIN_SLAB_BLOCKS;
+
+		sc.partial = 0;
+		sc.full = 0;
+		sc.slabs = 0;
+		sc.used = 0;
+		sc.highwater = 0;
+		sc.requested = 0;
+		sc.allocations = 0;
+
+		// 16, 24, 32, 48, 64, 96, ...
+		if (i & 1)
+			capacity = capacity / 3 * 4;
+		else
+			capacity = capacity / 2 * 3;
+	}
+
+	assert(classes[CLASS_COUNT-1].capacity == MAX_CAPACITY);
+
+	int c = 0;
+	for (unsigned int i = 0; i <= MAX_CAPACITY / LOOKUP_STEP; ++i)
+	{
+		while (classes[c].capacity < i * LOOKUP_STEP) ++c;
+		classLookup[i] = static_cast<uint8>(c);
+	}
+}
+
+SlabAllocator::~SlabAllocator()
+{
+	// Anything still in use is leaked on purpose, since it is
+	// going to be freed with free() once we're gone.
+	freeResources();
+}
+
+SlabPage* SlabAllocator::newSlab(SizeClass& sc)
+{
+	uint8 * mem = static_cast<uint8 *>(
+		malloc(pageSize + sc.blockSize * sc.blocksPerSlab));
+	if (!mem) return 0;
+
+	SlabPage * slab = reinterpret_cast<SlabPage *>(mem);
+	slab->sc = &sc;
+	slab->prev = 0;
+	slab->next = 0;
+	slab->firstFree = 0;
+	slab->used = 0;
+	slab->fresh = sc.blocksPerSlab;
+	slab->blocks = mem + pageSize;
+
+	VALGRIND_CREATE_MEMPOOL(slab->blocks, 0, 0);
+
+	sc.slabs++;
+	return slab;
+}
+
+void SlabAllocator::deleteSlab(SlabPage* slab)
+{
+	assert(slab->used == 0);
+
+	VALGRIND_DESTROY_MEMPOOL(slab->blocks);
+
+	slab->sc->slabs--;
+	free(slab);
+}
+
+void SlabAllocator::unlinkSlab(SlabPage*& list, SlabPage* slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		list = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+
+	slab->prev = 0;
+	slab->next = 0;
+}
+
+void SlabAllocator::linkSlab(SlabPage*& list, SlabPage* slab)
+{
+	slab->prev = 0;
+	slab->next = list;
+	if (list)
+		list->prev = slab;
+	list = slab;
+}
+
+void * SlabAllocator::allocate(size_t size)
+{
+	SlabBlockHeader * header;
+
+	if (size > MAX_CAPACITY)
+	{
+		header = static_cast<SlabBlockHeader *>(malloc(headerSize + size));
+		if (!header) return 0;
+
+		header->slab = 0;
+		header->size = size;
+
+		largeUsed++;
+		largeBytes += size;
+		if (largeUsed > largeHighwater) largeHighwater = largeUsed;
+		if (largeBytes > largeBytesHighwater) largeBytesHighwater = largeBytes;
+
+		return reinterpret_cast<uint8 *>(header) + headerSize;
+	}
+
+	SizeClass& sc = classes[classLookup[(size + LOOKUP_STEP - 1) / LOOKUP_STEP]];
+
+	SlabPage * slab = sc.partial;
+	if (!slab)
+	{
+		slab = newSlab(sc);
+		if (!slab) return 0;
+		linkSlab(sc.partial, slab);
+	}
+
+	if (slab->firstFree)
+	{
+		header = slab->firstFree;
+		slab->firstFree = reinterpret_cast<SlabBlockHeader *>(header->slab);
+	}
+	else
+	{
+		assert(slab->fresh > 0);
+		uint32 index = sc.blocksPerSlab - slab->fresh;
+		header = reinterpret_cast<SlabBlockHeader *>(
+			slab->blocks + index * sc.blockSize);
+		slab->fresh--;
+	}
+
+	header->slab = slab;
+	header->size = size;
+	slab->used++;
+
+	if (slab->used == sc.blocksPerSlab)
+	{
+		unlinkSlab(sc.partial, slab);
+		linkSlab(sc.full, slab);
+	}
+
+	sc.used++;
+	sc.requested += size;
+	sc.allocations++;
+	if (sc.used > sc.highwater) sc.highwater = sc.used;
+
+	uint8 * p = reinterpret_cast<uint8 *>(header) + headerSize;
+	VALGRIND_MEMPOOL_ALLOC(slab->blocks, p, size);
+
+	return p;
+}
+
+void SlabAllocator::deallocate(void * ptr)
+{
+	if (!ptr) return;
+
+	SlabBlockHeader * header = reinterpret_cast<SlabBlockHeader *>(
+		static_cast<uint8 *>(ptr) - headerSize);
+	SlabPage * slab = header->slab;
+
+	if (!slab)
+	{
+		largeUsed--;
+		largeBytes -= header->size;
+		free(header);
+		return;
+	}
+
+	SizeClass& sc = *slab->sc;
+	assert(slab->used > 0);
+
+	VALGRIND_MEMPOOL_FREE(slab->blocks, ptr);
+
+	sc.used--;
+	sc.requested -= header->size;
+
+	if (slab->used == sc.blocksPerSlab)
+	{
+		unlinkSlab(sc.full, slab);
+		linkSlab(sc.partial, slab);
+	}
+	slab->used--;
+
+	header->slab = reinterpret_cast<SlabPage *>(slab->firstFree);
+	header->size = 0;
+	slab->firstFree = header;
+}
+
+void SlabAllocator::freeResources()
+{
+	for (int i = 0; i < CLASS_COUNT; ++i)
+	{
+		SlabPage * slab = classes[i].partial;
+		while (slab)
+		{
+			SlabPage * next = slab->next;
+			if (slab->used == 0)
+			{
+				unlinkSlab(classes[i].partial, slab);
+				deleteSlab(slab);
+			}
+			slab = next;
+		}
+	}
+}
+
+void SlabAllocator::printInfo()
+{
+	size_t totalSlabBytes = 0;
+	size_t totalUsedBytes = 0;
+	size_t totalRequested = 0;
+
+	con.Printf(" class   slabs    used  hiwater   alloced   in-use KB   slack%%   free%%\n");
+	for (int i = 0; i < CLASS_COUNT; ++i)
+	{
+		SizeClass& sc = classes[i];
+		if (sc.slabs == 0 && sc.allocations == 0)
+			continue;
+
+		size_t slabBytes = sc.slabs * sc.blocksPerSlab * sc.capacity;
+		size_t usedBytes = sc.used * sc.capacity;
+
+		// slack: unused bytes at the end of used blocks
+		// free: unused blocks in the slabs
+		int slack = usedBytes ? 100 - static_cast<int>(sc.requested * 100 / usedBytes) : 0;
+		int freepct = slabBytes ? static_cast<int>((slabBytes - usedBytes) * 100 / slabBytes) : 0;
+
+		con.Printf(" %5d  %6d  %6d   %6d  %8d  %10d   %5d%%  %5d%%\n",
+				   static_cast<int>(sc.capacity), sc.slabs, sc.used,
+				   sc.highwater, sc.allocations,
+				   static_cast<int>(usedBytes / 1024), slack, freepct);
+
+		totalSlabBytes += sc.slabs * (pageSize + sc.blocksPerSlab * sc.blockSize);
+		totalUsedBytes += usedBytes;
+		totalRequested += sc.requested;
+	}
+
+	con.Printf(" large: %d blocks (%d KB), high-water %d blocks (%d KB)\n",
+			   largeUsed, static_cast<int>(largeBytes / 1024),
+			   largeHighwater, static_cast<int>(largeBytesHighwater / 1024));
+	con.Printf(" slab memory: %d KB, in use %d KB, requested %d KB\n",
+			   static_cast<int>(totalSlabBytes / 1024),
+			   static_cast<int>(totalUsedBytes / 1024),
+			   static_cast<int>(totalRequested / 1024));
+}
@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+struct SlabPage;
+struct SlabBlockHeader;
+
+/**
+ * An allocator with a fixed set of size classes (powers of two, and one
+ * and a half times powers of two).
+ *
+ * Each size class gets its memory from slabs holding blocks of the size
+ * of the class, and keeps a list of the slabs with free blocks. Every block
+ * starts with a small header pointing to its slab, so freeing a block never
+ * has to search for its owner.
+ *
+ * Requests larger than the largest class go to malloc, with the same header.
+ */
+class SlabAllocator
+{
+public:
+	SlabAllocator();
+	~SlabAllocator();
+
+	void * allocate(size_t size);
+	void deallocate(void * ptr);
+
+	//! Frees slabs without any used blocks
+	void freeResources();
+
+	void printInfo();
+
+	struct SizeClass
+	{
+		size_t capacity;		//!< largest request the class handles
+		size_t blockSize;		//!< capacity plus header, aligned
+		uint32 blocksPerSlab;
+
+		SlabPage* partial;		//!< slabs with free blocks
+		SlabPage* full;			//!< slabs without free blocks
+
+		uint32 slabs;
+		uint32 used;			//!< blocks in use
+		uint32 highwater;		//!< most blocks ever in use at once
+		size_t requested;		//!< bytes requested for the blocks in use
+		uint32 allocations;		//!< total number of allocations
+	};
+
+private:
+	SlabPage* newSlab(SizeClass& sc);
+	void deleteSlab(SlabPage* slab);
+
+	//! Unlink a slab from a list
+	void unlinkSlab(SlabPage*& list, SlabPage* slab);
+	//! Link a slab to the front of a list
+	void linkSlab(SlabPage*& list, SlabPage* slab);
+
+	enum {
+		CLASS_COUNT = 19,
+		MAX_CAPACITY = 8192,
+		LOOKUP_STEP = 8
+	};
+
+	SizeClass classes[CLASS_COUNT];
+
+	//! Size class of each request size, in steps of LOOKUP_STEP bytes
+	uint8 classLookup[MAX_CAPACITY / LOOKUP_STEP + 1];
+
+	// malloc'ed blocks larger than MAX_CAPACITY
+	uint32 largeUsed;
+	uint32 largeHighwater;
+	size_t largeBytes;
+	size_t largeBytesHighwater;
+};
+
+#endif
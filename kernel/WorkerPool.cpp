@@ -0,0 +1,143 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int threadcount, const char* name)
+	: batch(0), next(0), pending(0), quit(false)
+{
+	if (threadcount == 0) {
+		int cpus = SDL_GetCPUCount();
+		threadcount = (cpus > 0) ? cpus : 1;
+	}
+
+	mutex = SDL_CreateMutex();
+	startcond = SDL_CreateCond();
+	donecond = SDL_CreateCond();
+
+	// The thread calling runJobs does its share too
+	for (unsigned int i = 1; i < threadcount; ++i) {
+		SDL_Thread* thread = SDL_CreateThread(threadMain_Static, name,
+											  static_cast<void*>(this));
+		if (!thread) {
+			perr << "WorkerPool: could not create thread: " << SDL_GetError()
+				 << std::endl;
+			break;
+		}
+		threads.push_back(thread);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	SDL_mutexP(mutex);
+	quit = true;
+	SDL_CondBroadcast(startcond);
+	SDL_mutexV(mutex);
+
+	for (unsigned int i = 0; i < threads.size(); ++i)
+		SDL_WaitThread(threads[i], 0);
+	threads.clear();
+
+	SDL_DestroyCond(donecond);
+	SDL_DestroyCond(startcond);
+	SDL_DestroyMutex(mutex);
+}
+
+WorkerPool::Job* WorkerPool::nextJob()
+{
+	if (!batch || next >= batch->size()) return 0;
+	return (*batch)[next++];
+}
+
+void WorkerPool::jobDone()
+{
+	if (--pending == 0)
+		SDL_CondSignal(donecond);
+}
+
+void WorkerPool::runJobs(const std::vector<Job*>& jobs)
+{
+	if (jobs.empty()) return;
+
+	// Nothing to hand out
+	if (threads.empty() || jobs.size() == 1) {
+		for (unsigned int i = 0; i < jobs.size(); ++i)
+			jobs[i]->run();
+		return;
+	}
+
+	startJobs(jobs);
+	finishJobs();
+}
+
+void WorkerPool::startJobs(const std::vector<Job*>& jobs)
+{
+	SDL_mutexP(mutex);
+	assert(!batch);
+	batch = &jobs;
+	next = 0;
+	pending = jobs.size();
+	if (pending > 0)
+		SDL_CondBroadcast(startcond);
+	SDL_mutexV(mutex);
+}
+
+void WorkerPool::finishJobs()
+{
+	SDL_mutexP(mutex);
+
+	Job* job;
+	while ((job = nextJob()) != 0) {
+		SDL_mutexV(mutex);
+		job->run();
+		SDL_mutexP(mutex);
+		jobDone();
+	}
+
+	while (pending > 0)
+		SDL_CondWait(donecond, mutex);
+	batch = 0;
+	SDL_mutexV(mutex);
+}
+
+int SDLCALL WorkerPool::threadMain_Static(void* data)
+{
+	static_cast<WorkerPool*>(data)->threadMain();
+	return 0;
+}
+
+void WorkerPool::threadMain()
+{
+	SDL_mutexP(mutex);
+	while (!quit) {
+		Job* job = nextJob();
+		if (!job) {
+			SDL_CondWait(startcond, mutex);
+			continue;
+		}
+
+		SDL_mutexV(mutex);
+		job->run();
+		SDL_mutexP(mutex);
+		jobDone();
+	}
+	SDL_mutexV(mutex);
+}
@@ -0,0 +1,82 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <vector>
+#include <SDL.h>
+#include <SDL_thread.h>
+
+//! A set of worker threads that run a batch of jobs in parallel.
+//! runJobs() hands out the jobs to the workers and the calling thread,
+//! and returns when all of them are done.
+//! startJobs() and finishJobs() do the same in two steps, so the calling
+//! thread can do something else while the workers are busy.
+class WorkerPool
+{
+public:
+	class Job
+	{
+	public:
+		virtual ~Job() { }
+		virtual void run() = 0;
+	};
+
+	//! Create a pool that runs jobs on the given number of threads, including
+	//! the thread calling runJobs. 0 means one thread per CPU.
+	WorkerPool(unsigned int threadcount, const char* name);
+	~WorkerPool();
+
+	//! Number of threads used by runJobs, including the calling thread
+	unsigned int getThreadCount() const { return threads.size() + 1; }
+
+	//! Run all jobs, and wait for them to finish
+	void runJobs(const std::vector<Job*>& jobs);
+
+	//! Hand out jobs to the worker threads only, and return immediately.
+	//! jobs has to stay valid until finishJobs() returns.
+	void startJobs(const std::vector<Job*>& jobs);
+
+	//! Help with the jobs passed to startJobs() until all are done.
+	//! Does nothing if there are no jobs.
+	void finishJobs();
+
+private:
+	static int SDLCALL threadMain_Static(void* data);
+	void threadMain();
+
+	//! Take the next job of the batch, or 0 if none are left.
+	//! mutex must be locked.
+	Job* nextJob();
+
+	//! Mark a job as done. mutex must be locked.
+	void jobDone();
+
+	std::vector<SDL_Thread*> threads;
+	SDL_mutex* mutex;
+	SDL_cond* startcond;	//!< signalled when a batch is started
+	SDL_cond* donecond;		//!< signalled when the last job of a batch is done
+
+	const std::vector<Job*>* batch;
+	unsigned int next;		//!< next job in the batch to hand out
+	unsigned int pending;	//!< jobs in the batch not done yet
+	bool quit;
+};
+
+#endif
@@ -36,4 +36,13 @@ void setAllocationFunctions(allocFunc a, deallocFunc d)
 	pfree = d;
 }
 
+AllocationStats* AllocationStats::first = 0;
+
+AllocationStats::AllocationStats(const char* name_)
+	: name(name_), count(0), highwater(0), bytes(0), bytes_highwater(0)
+{
+	next = first;
+	first = this;
+}
+
 }
@@ -139,18 +139,45 @@ namespace Pentagram
 extern allocFunc palloc;
 extern deallocFunc pfree;
 void setAllocationFunctions(allocFunc a, deallocFunc d);
+
+//! Instance counts of a class using custom memory allocation,
+//! for MemoryManager::MemInfo
+struct AllocationStats
+{
+	explicit AllocationStats(const char* name_);
+
+	void allocated(size_t size) {
+		if (++count > highwater) highwater = count;
+		bytes += size;
+		if (bytes > bytes_highwater) bytes_highwater = bytes;
+	}
+	void freed(size_t size) { --count; bytes -= size; }
+
+	const char* name;
+	uint32 count, highwater;
+	size_t bytes, bytes_highwater;
+
+	AllocationStats* next;
+	static AllocationStats* first;
+};
 }
 
 #define ENABLE_CUSTOM_MEMORY_ALLOCATION()							\
 	static void * operator new(size_t size);						\
-	static void operator delete(void * ptr);
+	static void operator delete(void * ptr, size_t size);			\
+	static Pentagram::AllocationStats allocationStats;
 
 #define DEFINE_CUSTOM_MEMORY_ALLOCATION(Classname)					\
+Pentagram::AllocationStats Classname::allocationStats(#Classname);	\
+																	\
 void * Classname::operator new(size_t size) {						\
+	allocationStats.allocated(size);								\
 	return Pentagram::palloc(size);									\
 }																	\
 																	\
-void Classname::operator delete(void * ptr) {						\
+void Classname::operator delete(void * ptr, size_t size) {			\
+	if (!ptr) return;												\
+	allocationStats.freed(size);									\
 	Pentagram::pfree(ptr);											\
 }
 
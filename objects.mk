@@ -12,12 +12,16 @@ KERNEL = \
 	kernel/ObjectManager.o \
 	kernel/Process.o \
 	kernel/Pool.o \
+	kernel/Profiler.o \
 	kernel/SegmentedAllocator.o \
-	kernel/SegmentedPool.o
+	kernel/SegmentedPool.o \
+	kernel/SlabAllocator.o \
+	kernel/WorkerPool.o
 
 USECODE = \
 	usecode/BitSet.o \
 	usecode/UCMachine.o \
+	usecode/UCDecodedClass.o \
 	usecode/UCProcess.o \
 	usecode/Usecode.o \
 	usecode/UsecodeFlex.o \
@@ -38,6 +42,7 @@ FILESYS = \
 	filesys/DirFile.o \
 	filesys/FileSystem.o \
 	filesys/FlexFile.o \
+	filesys/MappedFileDataSource.o \
 	filesys/RawArchive.o \
 	filesys/U8SaveFile.o \
 	filesys/Savegame.o \
@@ -83,6 +88,7 @@ GRAPHICS = \
 	graphics/TextureBitmap.o \
 	graphics/TexturePNG.o \
 	graphics/Shape.o \
+	graphics/ShapeCache.o \
 	graphics/ShapeFrame.o \
 	graphics/SKFPlayer.o \
 	graphics/Palette.o \
@@ -127,7 +133,8 @@ SCALERS = \
 	graphics/scalers/hq4xScaler_888A.o \
 	graphics/scalers/hq4xScaler_A888.o \
 	graphics/scalers/hqScaler.o \
-	graphics/scalers/2xSaIScalers.o
+	graphics/scalers/2xSaIScalers.o \
+	graphics/scalers/ScalerKernels.o
 
 FONTS = \
 	graphics/fonts/Font.o \
@@ -136,6 +143,7 @@ FONTS = \
 	graphics/fonts/JPFont.o \
 	graphics/fonts/JPRenderedText.o \
 	graphics/fonts/RenderedText.o \
+	graphics/fonts/RenderedTextCache.o \
 	graphics/fonts/ShapeFont.o \
 	graphics/fonts/ShapeRenderedText.o \
 	graphics/fonts/TTFont.o \
@@ -200,13 +208,16 @@ WIDGETS = \
 
 WORLD = \
 	world/CameraProcess.o \
+	world/CompiledLoopScript.o \
 	world/Container.o \
 	world/CreateItemProcess.o \
 	world/CurrentMap.o \
+	world/CurrentMapChunk.o \
 	world/DestroyItemProcess.o \
 	world/Egg.o \
 	world/EggHatcherProcess.o \
 	world/FireballProcess.o \
+	world/FixedItemCache.o \
 	world/MapGlob.o \
 	world/GlobEgg.o \
 	world/GravityProcess.o \
@@ -220,6 +231,7 @@ WORLD = \
 	world/SplitItemProcess.o \
 	world/SpriteProcess.o \
 	world/TeleportEgg.o \
+	world/WalkGrid.o \
 	world/World.o \
 	world/getObject.o
 
@@ -242,6 +254,7 @@ ACTORS = \
 	world/actors/MainActor.o \
 	world/actors/Pathfinder.o \
 	world/actors/PathfinderProcess.o \
+	world/actors/PathfinderQueue.o \
 	world/actors/QuickAvatarMoverProcess.o \
 	world/actors/ResurrectionProcess.o \
 	world/actors/SchedulerProcess.o \
@@ -253,8 +266,10 @@ AUDIO = \
 	audio/MusicProcess.o \
 	audio/AudioChannel.o \
 	audio/AudioMixer.o \
+	audio/MixerKernels.o \
 	audio/AudioProcess.o \
 	audio/AudioSample.o \
+	audio/AudioSampleCache.o \
 	audio/RawAudioSample.o \
 	audio/SonarcAudioSample.o \
 	audio/SoundFlex.o \
@@ -0,0 +1,252 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+// Checks that the FMOpl block renderer (YM3812UpdateOne_Mono/Stereo) makes
+// exactly the same samples as the per sample renderer it replaced, by
+// playing the same fixed XMIDI sequence through both.
+//
+// Returns 0 if all the samples match, 1 if they don't.
+
+#include "pent_include.h"
+
+#include "OplVerifyDriver.h"
+#include "XMidiFile.h"
+#include "XMidiEventList.h"
+#include "IDataSource.h"
+#include "ODataSource.h"
+
+#include <vector>
+
+#ifdef USE_FMOPL_MIDI
+
+// Times in the sequence are in 120ths of a second
+static const int NUM_CHANNELS = 7;
+static const int NUM_STEPS = 48;
+static const int STEP_TIME = 15;
+
+// Long enough for the last notes to be released
+static const uint32 RENDER_SECONDS = 8;
+
+// Samples per channel asked for at a time, like an audio callback would
+static const uint32 CHUNK_SAMPLES = 1024;
+
+static const uint8 programs[NUM_CHANNELS] = { 0, 19, 33, 48, 73, 80, 105 };
+static const uint8 pans[NUM_CHANNELS] = { 0, 32, 64, 96, 127, 48, 80 };
+
+static void writeDelay(ODataSource *ods, uint32 delay)
+{
+	// An XMIDI delay is a run of (at most 4) bytes below 0x80, added up
+	assert(delay <= 127*4);
+	while (delay > 127) {
+		ods->write1(127);
+		delay -= 127;
+	}
+	if (delay) ods->write1(delay);
+}
+
+static void writeVLQ(ODataSource *ods, uint32 value)
+{
+	uint8 buf[4];
+	int n = 0;
+
+	buf[n++] = value & 0x7F;
+	while ((value >>= 7) != 0 && n < 4)
+		buf[n++] = (value & 0x7F) | 0x80;
+
+	while (n--) ods->write1(buf[n]);
+}
+
+//! Write the EVNT chunk of the test sequence
+static void writeEvents(ODataSource *ods)
+{
+	int c;
+
+	for (c = 0; c < NUM_CHANNELS; c++) {
+		ods->write1(0xC0 | c);
+		ods->write1(programs[c]);
+		ods->write1(0xB0 | c);
+		ods->write1(7);				// volume
+		ods->write1(100 + c*4);
+		ods->write1(0xB0 | c);
+		ods->write1(10);			// pan
+		ods->write1(pans[c]);
+	}
+
+	for (int step = 0; step < NUM_STEPS; step++) {
+		if (step) writeDelay(ods, STEP_TIME);
+
+		// Channel c plays on every (c+1)th step, so the number of notes
+		// playing at once keeps changing, and is sometimes more than the
+		// chip's 9 voices
+		for (c = 0; c < NUM_CHANNELS; c++) {
+			if (step % (c+1)) continue;
+
+			ods->write1(0x90 | c);
+			ods->write1(36 + c*6 + (step*5)%24);		// note
+			ods->write1(40 + (step*13 + c*17)%88);		// velocity
+			writeVLQ(ods, STEP_TIME * (1 + (step+c)%4));	// duration
+		}
+
+		// Bend channel 1 up and down
+		int bend = 0x2000 + ((step%8) - 4) * 0x400;
+		ods->write1(0xE1);
+		ods->write1(bend & 0x7F);
+		ods->write1((bend >> 7) & 0x7F);
+
+		// and keep fading channel 4 out
+		ods->write1(0xB4);
+		ods->write1(7);
+		ods->write1(127 - (step*8)%128);
+	}
+
+	writeDelay(ods, STEP_TIME*4);
+	ods->write1(0xFF);				// end of track
+	ods->write1(0x2F);
+	ods->write1(0x00);
+}
+
+//! Make the test sequence, as a one track XMIDI file
+static XMidiFile *makeSequence()
+{
+	OAutoBufferDataSource evnt(1024);
+	writeEvents(&evnt);
+	uint32 evntlen = evnt.getSize();
+	uint32 formlen = 4 + 8 + ((evntlen+1)&~1);
+
+	OAutoBufferDataSource xmi(evntlen + 64);
+	xmi.write("FORM", 4);
+	xmi.write4high(4 + 8 + 2);
+	xmi.write("XDIR", 4);
+	xmi.write("INFO", 4);
+	xmi.write4high(2);
+	xmi.write2(1);					// number of tracks
+	xmi.write("CAT ", 4);
+	xmi.write4high(4 + 8 + formlen);
+	xmi.write("XMID", 4);
+	xmi.write("FORM", 4);
+	xmi.write4high(formlen);
+	xmi.write("XMID", 4);
+	xmi.write("EVNT", 4);
+	xmi.write4high(evntlen);
+	xmi.write(evnt.getBuf(), evntlen);
+	if (evntlen & 1) xmi.write1(0);
+
+	IBufferDataSource ids(xmi.getBuf(), xmi.getSize());
+	return new XMidiFile(&ids, XMIDIFILE_CONVERT_NOCONVERSION);
+}
+
+//! Play the sequence through an OplVerifyDriver
+//! \return false if the driver couldn't be initialised
+static bool render(XMidiEventList *list, bool reference, uint32 rate,
+				   bool stereo, std::vector<sint16> &samples, Uint64 &rendertime)
+{
+	OplVerifyDriver driver(reference);
+	if (driver.initMidiDriver(rate, stereo)) return false;
+
+	driver.startSequence(0, list, false, 255);
+
+	uint32 channels = stereo ? 2 : 1;
+	samples.resize(rate * RENDER_SECONDS * channels);
+	for (uint32 pos = 0; pos < samples.size(); pos += CHUNK_SAMPLES*channels)
+	{
+		uint32 count = samples.size() - pos;
+		if (count > CHUNK_SAMPLES*channels) count = CHUNK_SAMPLES*channels;
+		driver.produceSamples(&samples[pos], count * sizeof(sint16));
+	}
+
+	rendertime = driver.getRenderTime();
+	driver.destroyMidiDriver();
+	return true;
+}
+
+//! Render the sequence with both renderers, and compare the samples
+//! \return true if they are the same
+static bool verify(XMidiEventList *list, uint32 rate, bool stereo)
+{
+	std::vector<sint16> block, reference;
+	Uint64 blocktime, reftime;
+
+	pout << rate << "Hz " << (stereo ? "stereo" : "mono") << ": ";
+
+	if (!render(list, false, rate, stereo, block, blocktime) ||
+		!render(list, true, rate, stereo, reference, reftime))
+	{
+		pout << "unable to initialise the driver" << std::endl;
+		return false;
+	}
+
+	uint32 mismatches = 0, first = 0;
+	bool silent = true;
+	for (uint32 i = 0; i < block.size(); ++i) {
+		if (block[i] != reference[i] && !mismatches++) first = i;
+		if (reference[i]) silent = false;
+	}
+
+	double freq = static_cast<double>(SDL_GetPerformanceFrequency());
+	con.Printf("%u samples, %u differ, block renderer %.2f ms, per sample "
+			   "renderer %.2f ms\n", static_cast<uint32>(block.size()),
+			   mismatches, blocktime * 1000.0 / freq, reftime * 1000.0 / freq);
+
+	if (mismatches) {
+		con.Printf("    first difference at sample %u: %d, should be %d\n",
+				   first, block[first], reference[first]);
+	}
+
+	// Nothing played, so nothing was tested
+	if (silent) {
+		pout << "    the sequence didn't make any sound" << std::endl;
+		return false;
+	}
+
+	return mismatches == 0;
+}
+
+int main()
+{
+	con.DisableWordWrap();
+
+	XMidiFile *xmidi = makeSequence();
+	XMidiEventList *list = xmidi->GetEventList(0);
+	if (!list) {
+		perr << "Error: unable to read the test sequence" << std::endl;
+		delete xmidi;
+		return 1;
+	}
+
+	bool ok = true;
+	ok &= verify(list, 22050, false);
+	ok &= verify(list, 22050, true);
+	ok &= verify(list, 44100, false);
+	ok &= verify(list, 44100, true);
+
+	delete xmidi;
+
+	pout << (ok ? "OK" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+	perr << "oplverify needs Pentagram to be built with the FMOpl midi driver"
+		 << std::endl;
+	return 1;
+}
+
+#endif //USE_FMOPL_MIDI
@@ -0,0 +1,53 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+// oplverify's own copy of the driver, which doesn't load the timbres from
+// the game data
+#define PENTAGRAM_IN_OPLVERIFY
+#include "FMOplMidiDriver.cpp"
+
+#include "OplVerifyDriver.h"
+
+#ifdef USE_FMOPL_MIDI
+
+OplVerifyDriver::OplVerifyDriver(bool reference_)
+	: FMOplMidiDriver(), reference(reference_), rendertime(0)
+{
+}
+
+void OplVerifyDriver::lowLevelProduceSamples(sint16 *samples, uint32 num_samples)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	if (!reference || !opl)
+		FMOplMidiDriver::lowLevelProduceSamples(samples, num_samples);
+	else if (stereo)
+		FMOpl_Pentagram::YM3812UpdateOneRef_Stereo(opl, samples, num_samples);
+	else
+		FMOpl_Pentagram::YM3812UpdateOneRef_Mono(opl, samples, num_samples);
+
+	rendertime += SDL_GetPerformanceCounter() - start;
+}
+
+void OplVerifyDriver::yield()
+{
+	sint16 samples[256];
+	produceSamples(samples, sizeof(samples));
+}
+
+#endif //USE_FMOPL_MIDI
@@ -0,0 +1,51 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef OPLVERIFYDRIVER_H
+#define OPLVERIFYDRIVER_H
+
+#include "FMOplMidiDriver.h"
+
+#ifdef USE_FMOPL_MIDI
+
+//! An FMOplMidiDriver that renders the chip with either the block renderer
+//! or the per sample reference renderer, and is driven without an audio
+//! thread.
+class OplVerifyDriver : public FMOplMidiDriver
+{
+public:
+	OplVerifyDriver(bool reference_);
+
+	//! Time spent in the renderer, in performance counter ticks
+	Uint64 getRenderTime() const { return rendertime; }
+
+protected:
+	virtual void		lowLevelProduceSamples(sint16 *samples, uint32 num_samples);
+
+	//! There's no audio callback to take the messages destroyMidiDriver()
+	//! waits on, so produce (and throw away) some samples here instead
+	virtual void		yield();
+
+private:
+	bool reference;
+	Uint64 rendertime;
+};
+
+#endif //USE_FMOPL_MIDI
+
+#endif //OPLVERIFYDRIVER_H
@@ -0,0 +1,28 @@
+# TODO - it would be nice if LPATH could be set by the Makefile that
+# includes us, since that has to know our path anyway.
+LPATH := tools/oplverify
+
+LSRC := $(wildcard $(srcdir)/$(LPATH)/*.cpp)
+
+include $(srcdir)/objects.mk
+
+# OplVerifyFMOpl and OplVerifyDriver are this tool's own builds of
+# audio/midi/fmopl.o and audio/midi/FMOplMidiDriver.o
+oplverify_OBJ = \
+	$(MISC) \
+	audio/midi/XMidiEventList.o \
+	audio/midi/XMidiFile.o \
+	audio/midi/XMidiSequence.o \
+	audio/midi/LowLevelMidiDriver.o \
+	tools/oplverify/OplVerifyFMOpl.o \
+	tools/oplverify/OplVerifyDriver.o \
+	tools/oplverify/OplVerify.o
+
+# A console tool, but the midi driver needs SDL's threading functions
+$(LPATH)/oplverify$(EXEEXT): $(oplverify_OBJ)
+	$(CXX) -g -o $@ $+ $(LDFLAGS) $(SYS_LIBS) $(CON_LIBS) $(SDL_LIBS)
+
+# Common rules
+include $(srcdir)/common.mk
+
+all-$(LPATH): $(LPATH)/oplverify$(EXEEXT) $(LOBJ)
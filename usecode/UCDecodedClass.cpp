@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "UCDecodedClass.h"
+#include "Usecode.h"
+
+UCInstruction UCDecodedClass::interpret = {
+	UCInstruction::UC_INTERPRET, 0, 0, 0
+};
+
+// Operand formats of the opcodes UCMachine::execDecodedProcess handles
+// itself. Everything else is left to the reference interpreter.
+enum UCOperandFormat {
+	OPF_INTERPRET = 0,
+	OPF_NONE,
+	OPF_SINT8,
+	OPF_UINT8,
+	OPF_UINT16,
+	OPF_UINT32,
+	OPF_JUMP
+};
+
+static UCOperandFormat getOperandFormat(uint8 opcode)
+{
+	switch (opcode) {
+	case 0x00: case 0x01: case 0x02: case 0x0A:
+	case 0x3E: case 0x3F: case 0x40:
+	case 0x62: case 0x63: case 0x64: case 0x65: case 0x66: case 0x67:
+	case 0x69:
+		return OPF_SINT8;
+
+	case 0x5A:
+		return OPF_UINT8;
+
+	case 0x0B:
+		return OPF_UINT16;
+
+	case 0x0C:
+		return OPF_UINT32;
+
+	case 0x51: case 0x52:
+		return OPF_JUMP;
+
+	case 0x08: case 0x12: case 0x13: case 0x14: case 0x15:
+	case 0x1C: case 0x1D: case 0x1E: case 0x1F:
+	case 0x20: case 0x21: case 0x22: case 0x23: case 0x24: case 0x25:
+	case 0x28: case 0x29: case 0x2A: case 0x2B:
+	case 0x2C: case 0x2D: case 0x2E: case 0x2F:
+	case 0x30: case 0x31: case 0x32: case 0x33:
+	case 0x34: case 0x35: case 0x36: case 0x37:
+	case 0x39: case 0x3A: case 0x3B: case 0x3C: case 0x3D:
+	case 0x53: case 0x59:
+	case 0x5D: case 0x5E: case 0x5F: case 0x60: case 0x61:
+		return OPF_NONE;
+
+	default:
+		return OPF_INTERPRET;
+	}
+}
+
+UCDecodedClass::UCDecodedClass(Usecode* usecode, uint32 classid_)
+	: classid(classid_), data(0), size(0)
+{
+	uint32 base = usecode->get_class_base_offset(classid);
+	uint32 classsize = usecode->get_class_size(classid);
+
+	if (classsize > base) {
+		data = usecode->get_class(classid) + base;
+		size = classsize - base;
+	}
+
+	// ips are 16 bit
+	if (size > 0x10000) size = 0x10000;
+
+	index.resize(size, 0);
+}
+
+bool UCDecodedClass::isValid(Usecode* usecode) const
+{
+	uint32 base = usecode->get_class_base_offset(classid);
+	uint32 classsize = usecode->get_class_size(classid);
+
+	if (classsize <= base) return data == 0;
+	return data == usecode->get_class(classid) + base;
+}
+
+const UCInstruction* UCDecodedClass::decode(uint16 ip)
+{
+	if (ip >= size || code.size() >= 0xFFFF) return &interpret;
+
+	UCInstruction ins;
+	ins.opcode = data[ip];
+	ins.target = 0;
+	ins.operand = 0;
+
+	unsigned int length;
+	switch (getOperandFormat(ins.opcode)) {
+	case OPF_NONE: length = 1; break;
+	case OPF_SINT8: case OPF_UINT8: length = 2; break;
+	case OPF_UINT16: case OPF_JUMP: length = 3; break;
+	case OPF_UINT32: length = 5; break;
+	default: length = 0; break;
+	}
+
+	// Leave anything odd to the interpreter
+	if (length == 0 || ip + length > size) {
+		ins.opcode = UCInstruction::UC_INTERPRET;
+		length = 0;
+	}
+
+	const uint8* operand = data + ip + 1;
+	switch (getOperandFormat(ins.opcode)) {
+	case OPF_SINT8:
+		ins.operand = static_cast<sint8>(operand[0]);
+		break;
+	case OPF_UINT8:
+		ins.operand = operand[0];
+		break;
+	case OPF_UINT16:
+		ins.operand = operand[0] | (operand[1] << 8);
+		break;
+	case OPF_UINT32:
+		ins.operand = static_cast<sint32>(operand[0] | (operand[1] << 8) |
+										  (operand[2] << 16) |
+										  (static_cast<uint32>(operand[3]) << 24));
+		break;
+	case OPF_JUMP:
+		ins.operand = static_cast<sint16>(operand[0] | (operand[1] << 8));
+		ins.target = static_cast<uint16>(ip + length + ins.operand);
+		break;
+	default:
+		break;
+	}
+
+	ins.next = static_cast<uint16>(ip + length);
+
+	code.push_back(ins);
+	index[ip] = static_cast<uint16>(code.size());
+
+	return &code.back();
+}
@@ -0,0 +1,80 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef UCDECODEDCLASS_H
+#define UCDECODEDCLASS_H
+
+#include <vector>
+
+class Usecode;
+
+//! A single pre-decoded usecode instruction
+struct UCInstruction
+{
+	//! The opcode, or UC_INTERPRET if the instruction has to be run by the
+	//! reference interpreter in UCMachine
+	uint8 opcode;
+	uint16 next;		//!< ip of the following instruction
+	uint16 target;		//!< ip of the jump target (jumps only)
+	sint32 operand;		//!< the (sign-extended) operand, if any
+
+	enum {
+		UC_INTERPRET = 0xFF
+	};
+};
+
+//! The instructions of a usecode class, decoded into UCInstructions.
+//! Instructions are decoded the first time they are executed, and kept
+//! for as long as the UCDecodedClass lives.
+class UCDecodedClass
+{
+public:
+	UCDecodedClass(Usecode* usecode, uint32 classid);
+	~UCDecodedClass() { }
+
+	uint32 getClassId() const { return classid; }
+
+	//! Check if this is still the decoded form of the given class data
+	bool isValid(Usecode* usecode) const;
+
+	//! Get the instruction at ip.
+	//! The pointer is only valid until the next call to fetch.
+	const UCInstruction* fetch(uint16 ip)
+	{
+		if (ip < index.size() && index[ip])
+			return &code[index[ip] - 1];
+		return decode(ip);
+	}
+
+	//! Number of instructions decoded so far
+	unsigned int getInstructionCount() const { return code.size(); }
+
+private:
+	const UCInstruction* decode(uint16 ip);
+
+	uint32 classid;
+	const uint8* data;	//!< class code, starting at the base offset
+	uint32 size;
+
+	std::vector<UCInstruction> code;
+	std::vector<uint16> index;	//!< ip -> code index + 1, or 0
+
+	static UCInstruction interpret;
+};
+
+#endif
@@ -31,9 +31,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "World.h"
 #include "BitSet.h"
 #include "UCList.h"
+#include "UCDecodedClass.h"
 #include "idMan.h"
 #include "ConsoleGump.h"
 #include "getObject.h"
+#include "Profiler.h"
 
 #define INCLUDE_CONVERTUSECODEU8_WITHOUT_BRINGING_IN_FOLD
 #include "u8/ConvertUsecodeU8.h"
@@ -95,8 +97,13 @@ UCMachine::UCMachine(Intrinsic *iset, unsigned int icount)
 	listIDs = new idMan(1, 65534, 128);
 	stringIDs = new idMan(1, 65534, 256);
 
+	useDecoded = false;
+	decodedUsecode = 0;
+
 	con.AddConsoleCommand("UCMachine::getGlobal", ConCmd_getGlobal);
 	con.AddConsoleCommand("UCMachine::setGlobal", ConCmd_setGlobal);
+	con.AddConsoleCommand("UCMachine::toggleDecodedUsecode",
+						  ConCmd_toggleDecodedUsecode);
 #ifdef DEBUG
 	con.AddConsoleCommand("UCMachine::traceObjID", ConCmd_traceObjID);
 	con.AddConsoleCommand("UCMachine::tracePID", ConCmd_tracePID);
@@ -117,6 +124,7 @@ UCMachine::~UCMachine()
 
 	con.RemoveConsoleCommand(UCMachine::ConCmd_getGlobal);
 	con.RemoveConsoleCommand(UCMachine::ConCmd_setGlobal);
+	con.RemoveConsoleCommand(UCMachine::ConCmd_toggleDecodedUsecode);
 #ifdef DEBUG
 	con.RemoveConsoleCommand(UCMachine::ConCmd_traceObjID);
 	con.RemoveConsoleCommand(UCMachine::ConCmd_tracePID);
@@ -127,6 +135,8 @@ UCMachine::~UCMachine()
 
 	ucmachine = 0;
 
+	clearDecodedClasses();
+
 	delete globals; globals = 0;
 	delete convuse; convuse = 0;
 	delete listIDs; listIDs = 0;
@@ -146,6 +156,8 @@ void UCMachine::reset()
 		delete (iter->second);
 	listHeap.clear();
 	stringHeap.clear();
+
+	clearDecodedClasses();
 }
 
 void UCMachine::loadIntrinsics(Intrinsic *i, unsigned int icount)
@@ -158,6 +170,24 @@ void UCMachine::execProcess(UCProcess* p)
 {
 	assert(p);
 
+	Profiler::Scope profile(Profiler::USECODE);
+
+#ifdef DEBUG
+	// Only the interpreter can trace
+	if (trace_show(p->pid, p->item_num, p->classid)) {
+		interpretProcess(p, 0);
+		return;
+	}
+#endif
+
+	if (useDecoded)
+		execDecodedProcess(p);
+	else
+		interpretProcess(p, 0);
+}
+
+bool UCMachine::interpretProcess(UCProcess* p, unsigned int maxsteps)
+{
 	uint32 base = p->usecode->get_class_base_offset(p->classid);
 	IBufferDataSource cs(p->usecode->get_class(p->classid) + base,
 						 p->usecode->get_class_size(p->classid) - base);
@@ -174,8 +204,10 @@ void UCMachine::execProcess(UCProcess* p)
 
 	bool cede = false;
 	bool error = false;
+	unsigned int steps = 0;
 
-	while(!cede && !error && !p->is_terminated())
+	while(!cede && !error && !p->is_terminated() &&
+		  (maxsteps == 0 || steps++ < maxsteps))
 	{
 		//! guard against reading past end of class
 		//! guard against other error conditions
@@ -1974,6 +2006,616 @@ void UCMachine::execProcess(UCProcess* p)
 		            p->pid, p->classid, p->ip);
 		p->terminateDeferred();
 	}
+
+	return !cede && !error && !p->is_terminated();
+}
+
+// The pre-decoded engine.
+// Only instructions that can't call out, spawn, suspend or terminate are
+// handled here; anything else is single-stepped by interpretProcess. Each
+// handler has to behave exactly like its counterpart in interpretProcess.
+// With GCC every handler jumps directly to the next one (direct threading),
+// otherwise a plain switch is used.
+
+#if defined(__GNUC__)
+#define UC_COMPUTED_GOTO
+#endif
+
+#ifdef UC_COMPUTED_GOTO
+#define UC_CASE(x) op_##x
+#define UC_DEFAULT op_interpret
+#define UC_NEXT() do { ins = dc->fetch(p->ip); goto *labels[ins->opcode]; } while(0)
+#else
+#define UC_CASE(x) case 0x##x
+#define UC_DEFAULT default
+#define UC_NEXT() goto dispatch
+#endif
+
+void UCMachine::execDecodedProcess(UCProcess* p)
+{
+	if (p->is_terminated()) return;
+
+	UCDecodedClass* dc = getDecodedClass(p);
+	if (!dc) {
+		interpretProcess(p, 0);
+		return;
+	}
+
+	UCStack& stack = p->stack;
+	const UCInstruction* ins;
+
+	uint16 ui16a, ui16b;
+	uint32 ui32a, ui32b;
+	sint16 si16a, si16b;
+	sint32 si32a, si32b;
+
+#ifdef UC_COMPUTED_GOTO
+	static void* labels[256];
+	static bool labels_initialized = false;
+
+	if (!labels_initialized) {
+		for (unsigned int i = 0; i < 256; ++i)
+			labels[i] = &&op_interpret;
+
+#define UC_LABEL(x) labels[0x##x] = &&op_##x
+		UC_LABEL(00); UC_LABEL(01); UC_LABEL(02); UC_LABEL(08);
+		UC_LABEL(0A); UC_LABEL(0B); UC_LABEL(0C);
+		UC_LABEL(12); UC_LABEL(13); UC_LABEL(14); UC_LABEL(15);
+		UC_LABEL(1C); UC_LABEL(1D); UC_LABEL(1E); UC_LABEL(1F);
+		UC_LABEL(20); UC_LABEL(21); UC_LABEL(22); UC_LABEL(23);
+		UC_LABEL(24); UC_LABEL(25);
+		UC_LABEL(28); UC_LABEL(29); UC_LABEL(2A); UC_LABEL(2B);
+		UC_LABEL(2C); UC_LABEL(2D); UC_LABEL(2E); UC_LABEL(2F);
+		UC_LABEL(30); UC_LABEL(31); UC_LABEL(32); UC_LABEL(33);
+		UC_LABEL(34); UC_LABEL(35); UC_LABEL(36); UC_LABEL(37);
+		UC_LABEL(39); UC_LABEL(3A); UC_LABEL(3B); UC_LABEL(3C);
+		UC_LABEL(3D); UC_LABEL(3E); UC_LABEL(3F); UC_LABEL(40);
+		UC_LABEL(51); UC_LABEL(52); UC_LABEL(53); UC_LABEL(59);
+		UC_LABEL(5A); UC_LABEL(5D); UC_LABEL(5E); UC_LABEL(5F);
+		UC_LABEL(60); UC_LABEL(61);
+		UC_LABEL(62); UC_LABEL(63); UC_LABEL(64);
+		UC_LABEL(65); UC_LABEL(66); UC_LABEL(67); UC_LABEL(69);
+#undef UC_LABEL
+
+		labels_initialized = true;
+	}
+
+	UC_NEXT();
+#else
+dispatch:
+	ins = dc->fetch(p->ip);
+	switch (ins->opcode) {
+#endif
+
+	UC_CASE(00):
+		// pop 16 bit int, and assign LS 8 bit int into bp+xx
+		ui16a = stack.pop2();
+		stack.assign1(p->bp+ins->operand, static_cast<uint8>(ui16a));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(01):
+		// pop 16 bit int into bp+xx
+		ui16a = stack.pop2();
+		stack.assign2(p->bp+ins->operand, ui16a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(02):
+		// pop 32 bit int into bp+xx
+		ui32a = stack.pop4();
+		stack.assign4(p->bp+ins->operand, ui32a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(08):
+		// pop 32bits into result register
+		p->result = stack.pop4();
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(0A):
+		// push sign-extended 8 bit xx onto the stack as 16 bit
+		stack.push2(static_cast<uint16>(ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(0B):
+		// push 16 bit xxxx onto the stack
+		stack.push2(static_cast<uint16>(ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(0C):
+		// push 32 bit xxxxxxxx onto the stack
+		stack.push4(static_cast<uint32>(ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(12):
+		// pop 16bits into temp register
+		p->temp32 = stack.pop2();
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(13):
+		// pop 32bits into temp register
+		p->temp32 = stack.pop4();
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(14):
+		// 16 bit add
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(static_cast<uint16>(si16a + si16b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(15):
+		// 32 bit add
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push4(static_cast<uint32>(si32a + si32b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(1C):
+		// 16 bit subtract
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(static_cast<uint16>(si16b - si16a));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(1D):
+		// 32 bit subtract
+		si32a = static_cast<sint16>(stack.pop4());
+		si32b = static_cast<sint16>(stack.pop4());
+		stack.push4(static_cast<uint32>(si32b - si32a));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(1E):
+		// 16 bit multiply
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(static_cast<uint16>(si16a * si16b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(1F):
+		// 32 bit multiply
+		si32a = static_cast<sint16>(stack.pop4());
+		si32b = static_cast<sint16>(stack.pop4());
+		stack.push4(static_cast<uint32>(si32a * si32b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(20):
+		// 16 bit divide
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		if (si16a != 0) {
+			stack.push2(static_cast<uint16>(si16b / si16a));
+		} else {
+			perr.printf("division by zero.\n");
+			stack.push2(0);
+		}
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(21):
+		// 32 bit divide
+		si32a = static_cast<sint16>(stack.pop4());
+		si32b = static_cast<sint16>(stack.pop4());
+		if (si32a != 0) {
+			stack.push4(static_cast<uint32>(si32b / si32a));
+		} else {
+			perr.printf("division by zero.\n");
+			stack.push4(0);
+		}
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(22):
+		// 16 bit mod
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		if (si16a != 0) {
+			stack.push2(static_cast<uint16>(si16b % si16a));
+		} else {
+			perr.printf("division by zero.\n");
+			stack.push2(0);
+		}
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(23):
+		// 32 bit mod
+		si32a = static_cast<sint16>(stack.pop4());
+		si32b = static_cast<sint16>(stack.pop4());
+		if (si32a != 0) {
+			stack.push4(static_cast<uint32>(si32b % si32a));
+		} else {
+			perr.printf("division by zero.\n");
+			stack.push4(0);
+		}
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(24):
+		// 16 bit cmp
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16a == si16b ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(25):
+		// 32 bit cmp
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push2(si32a == si32b ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(28):
+		// 16 bit less-than
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16b < si16a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(29):
+		// 32 bit less-than
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push2(si32b < si32a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2A):
+		// 16 bit less-or-equal
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16b <= si16a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2B):
+		// 32 bit less-or-equal
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push2(si32b <= si32a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2C):
+		// 16 bit greater-than
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16b > si16a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2D):
+		// 32 bit greater-than
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push2(si32b > si32a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2E):
+		// 16 bit greater-or-equal
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16b >= si16a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(2F):
+		// 32 bit greater-or-equal
+		si32a = static_cast<sint32>(stack.pop4());
+		si32b = static_cast<sint32>(stack.pop4());
+		stack.push2(si32b >= si32a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(30):
+		// 16 bit boolean not
+		ui16a = stack.pop2();
+		stack.push2(!ui16a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(31):
+		// 32 bit boolean not
+		ui32a = stack.pop4();
+		stack.push4(!ui32a ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(32):
+		// 16 bit boolean and
+		ui16a = stack.pop2();
+		ui16b = stack.pop2();
+		stack.push2((ui16a && ui16b) ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(33):
+		// 32 bit boolean and
+		ui32a = stack.pop4();
+		ui32b = stack.pop4();
+		stack.push4((ui32a && ui32b) ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(34):
+		// 16 bit boolean or
+		ui16a = stack.pop2();
+		ui16b = stack.pop2();
+		stack.push2((ui16a || ui16b) ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(35):
+		// 32 bit boolean or
+		ui32a = stack.pop4();
+		ui32b = stack.pop4();
+		stack.push4((ui32a || ui32b) ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(36):
+		// 16 bit not-equal
+		si16a = static_cast<sint16>(stack.pop2());
+		si16b = static_cast<sint16>(stack.pop2());
+		stack.push2(si16a != si16b ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(37):
+		// 32 bit not-equal
+		si32a = static_cast<sint16>(stack.pop4());
+		si32b = static_cast<sint16>(stack.pop4());
+		stack.push2(si32a != si32b ? 1 : 0);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(39):
+		// 16 bit bitwise and
+		ui16a = stack.pop2();
+		ui16b = stack.pop2();
+		stack.push2(ui16a & ui16b);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3A):
+		// 16 bit bitwise or
+		ui16a = stack.pop2();
+		ui16b = stack.pop2();
+		stack.push2(ui16a | ui16b);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3B):
+		// 16 bit bitwise not
+		ui16a = stack.pop2();
+		stack.push2(~ui16a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3C):
+		// 16 bit left shift
+		si16a = static_cast<sint16>(stack.pop2());
+		ui16b = static_cast<sint16>(stack.pop2());
+		stack.push2(static_cast<uint16>(si16a << ui16b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3D):
+		// 16 bit right shift
+		si16a = static_cast<sint16>(stack.pop2());
+		ui16b = static_cast<sint16>(stack.pop2());
+		stack.push2(static_cast<uint16>(si16a >> ui16b));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3E):
+		// push the unsigned 8 bit local var xx as 16 bit int
+		stack.push2(stack.access1(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(3F):
+		// push the 16 bit local var xx
+		stack.push2(stack.access2(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(40):
+		// push the 32 bit local var xx
+		stack.push4(stack.access4(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(51):
+		// relative jump to xxxx if false
+		if (!stack.pop2())
+			p->ip = ins->target;
+		else
+			p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(52):
+		// relative jump to xxxx
+		p->ip = ins->target;
+		UC_NEXT();
+
+	UC_CASE(53):
+		// suspend
+		p->ip = ins->next;
+		return;
+
+	UC_CASE(59):
+		// push process id
+		stack.push2(p->pid);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(5A):
+		// init function: clear xx bytes of local vars
+		ui16a = static_cast<uint16>(ins->operand);
+		if (ui16a & 1) ui16a++; // 16-bit align
+		if (ui16a > 0)
+			stack.push0(ui16a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(5D):
+		// push temp8 as 16 bit value
+		stack.push2(static_cast<uint8>(p->temp32 & 0xFF));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(5E):
+		// push temp16
+		stack.push2(static_cast<uint16>(p->temp32 & 0xFFFF));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(5F):
+		// push temp32
+		stack.push4(p->temp32);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(60):
+		// convert 16-bit to 32-bit int (sign extend)
+		si32a = static_cast<sint16>(stack.pop2());
+		stack.push4(si32a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(61):
+		// convert 32-bit to 16-bit int
+		si16a = static_cast<sint16>(stack.pop4());
+		stack.push2(si16a);
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(62):
+		// free the string in var BP+xx
+		freeString(stack.access2(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(63):
+		// free the stringlist in var BP+xx
+		freeStringList(stack.access2(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(64):
+		// free the list in var BP+xx
+		freeList(stack.access2(p->bp+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(65):
+		// free the string at SP+xx
+		freeString(stack.access2(stack.getSP()+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(66):
+		// free the list at SP+xx
+		freeList(stack.access2(stack.getSP()+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(67):
+		// free the string list at SP+xx
+		freeStringList(stack.access2(stack.getSP()+ins->operand));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_CASE(69):
+		// push the string in var BP+xx as 32 bit pointer
+		stack.push4(stringToPtr(stack.access2(p->bp+ins->operand)));
+		p->ip = ins->next;
+		UC_NEXT();
+
+	UC_DEFAULT:
+		// Anything else (calls, intrinsics, list and string handling,
+		// returns, ...) is run by the interpreter, one instruction at a time
+		if (!interpretProcess(p, 1))
+			return;
+
+		// calls and returns can switch classes
+		if (p->classid != dc->getClassId()) {
+			dc = getDecodedClass(p);
+			if (!dc) {
+				interpretProcess(p, 0);
+				return;
+			}
+		}
+		UC_NEXT();
+
+#ifndef UC_COMPUTED_GOTO
+	}
+#endif
+}
+
+#undef UC_CASE
+#undef UC_DEFAULT
+#undef UC_NEXT
+
+UCDecodedClass* UCMachine::getDecodedClass(UCProcess* p)
+{
+#ifdef DEBUG
+	// Only the interpreter can trace
+	if (trace_show(p->pid, p->item_num, p->classid))
+		return 0;
+#endif
+
+	if (p->usecode != decodedUsecode) {
+		clearDecodedClasses();
+		decodedUsecode = p->usecode;
+	}
+
+	std::map<uint32, UCDecodedClass*>::iterator iter;
+	iter = decodedClasses.find(p->classid);
+	if (iter != decodedClasses.end()) {
+		if (iter->second->isValid(p->usecode))
+			return iter->second;
+		delete iter->second;
+		decodedClasses.erase(iter);
+	}
+
+	UCDecodedClass* dc = new UCDecodedClass(p->usecode, p->classid);
+	decodedClasses[p->classid] = dc;
+	return dc;
+}
+
+void UCMachine::clearDecodedClasses()
+{
+	std::map<uint32, UCDecodedClass*>::iterator iter;
+	for (iter = decodedClasses.begin(); iter != decodedClasses.end(); ++iter)
+		delete iter->second;
+	decodedClasses.clear();
+	decodedUsecode = 0;
+}
+
+void UCMachine::setUseDecodedUsecode(bool use)
+{
+	useDecoded = use;
+	if (!useDecoded)
+		clearDecodedClasses();
 }
 
 
@@ -2273,6 +2915,13 @@ void UCMachine::usecodeStats()
 		}
 	}
 #endif
+
+	unsigned int instructions = 0;
+	std::map<uint32, UCDecodedClass*>::iterator iterd;
+	for (iterd = decodedClasses.begin(); iterd != decodedClasses.end(); ++iterd)
+		instructions += iterd->second->getInstructionCount();
+	pout << "Decoded    : " << decodedClasses.size() << " classes, "
+		 << instructions << " instructions" << std::endl;
 }
 
 void UCMachine::saveGlobals(ODataSource* ods)
@@ -2437,6 +3086,17 @@ void UCMachine::ConCmd_setGlobal(const Console::ArgvType &argv)
 				uc->globals->getBits(offset, size));
 }
 
+void UCMachine::ConCmd_toggleDecodedUsecode(const Console::ArgvType &/*argv*/)
+{
+	UCMachine *uc = UCMachine::get_instance();
+	uc->setUseDecodedUsecode(!uc->isUsingDecodedUsecode());
+
+	if (uc->isUsingDecodedUsecode())
+		pout << "Running usecode from decoded instructions" << std::endl;
+	else
+		pout << "Running usecode with the interpreter" << std::endl;
+}
+
 #ifdef DEBUG
 
 void UCMachine::ConCmd_tracePID(const Console::ArgvType &argv)
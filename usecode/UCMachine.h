@@ -32,6 +32,8 @@ class ODataSource;
 class BitSet;
 class UCList;
 class idMan;
+class Usecode;
+class UCDecodedClass;
 
 class UCMachine
 {
@@ -45,6 +47,11 @@ public:
 
 	void execProcess(UCProcess* proc);
 
+	//! Run usecode from pre-decoded instructions instead of interpreting
+	//! the bytecode directly. Both give identical results.
+	void setUseDecodedUsecode(bool use);
+	bool isUsingDecodedUsecode() const { return useDecoded; }
+
 	std::string& getString(uint16 str);
 	UCList* getList(uint16 l);
 
@@ -87,6 +94,21 @@ protected:
 	void loadIntrinsics(Intrinsic *i, unsigned int icount);
 
 private:
+	//! The reference interpreter.
+	//! \param maxsteps stop after this many instructions (0 for no limit)
+	//! \return true if the process stopped only because of maxsteps
+	bool interpretProcess(UCProcess* p, unsigned int maxsteps);
+
+	//! The pre-decoded engine. Falls back to interpretProcess for
+	//! instructions it doesn't handle itself.
+	void execDecodedProcess(UCProcess* p);
+
+	UCDecodedClass* getDecodedClass(UCProcess* p);
+	void clearDecodedClasses();
+
+	bool useDecoded;
+	Usecode* decodedUsecode;
+	std::map<uint32, UCDecodedClass*> decodedClasses;
 
 	ConvertUsecode*	convuse;
 	Intrinsic* intrinsics;
@@ -107,6 +129,7 @@ private:
 
 	static void		ConCmd_getGlobal(const Console::ArgvType &argv);
 	static void		ConCmd_setGlobal(const Console::ArgvType &argv);
+	static void		ConCmd_toggleDecodedUsecode(const Console::ArgvType &argv);
 
 
 #ifdef DEBUG
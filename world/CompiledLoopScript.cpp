@@ -0,0 +1,501 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+#include "CompiledLoopScript.h"
+#include "LoopScript.h"
+#include "Item.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+
+struct CompiledLoopScript::Cache
+{
+	Cache();
+	~Cache();
+
+	//! compiled scripts by hash, chained by CompiledLoopScript::next
+	std::map<uint32, CompiledLoopScript*> scripts;
+	uint32 compiled, interpreted;
+
+	uint32 searches[NUM_SEARCH_TYPES];
+	uint32 tested[NUM_SEARCH_TYPES];
+	uint32 matched[NUM_SEARCH_TYPES];
+};
+
+CompiledLoopScript::Cache CompiledLoopScript::cache;
+
+CompiledLoopScript::Cache::Cache()
+	: compiled(0), interpreted(0)
+{
+	for (int i = 0; i < NUM_SEARCH_TYPES; ++i) {
+		searches[i] = tested[i] = matched[i] = 0;
+	}
+}
+
+CompiledLoopScript::Cache::~Cache()
+{
+	std::map<uint32, CompiledLoopScript*>::iterator it;
+	for (it = scripts.begin(); it != scripts.end(); ++it) {
+		CompiledLoopScript* ls = it->second;
+		while (ls) {
+			CompiledLoopScript* next = ls->next;
+			delete ls;
+			ls = next;
+		}
+	}
+}
+
+// FNV-1a
+static uint32 hashScript(const uint8* script, uint32 scriptsize)
+{
+	uint32 hash = 2166136261U;
+	for (uint32 i = 0; i < scriptsize; ++i) {
+		hash ^= script[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+CompiledLoopScript* CompiledLoopScript::get(const uint8* script,
+											uint32 scriptsize)
+{
+	uint32 hash = hashScript(script, scriptsize);
+
+	CompiledLoopScript* first = 0;
+	std::map<uint32, CompiledLoopScript*>::iterator it;
+	it = cache.scripts.find(hash);
+	if (it != cache.scripts.end())
+		first = it->second;
+
+	for (CompiledLoopScript* ls = first; ls; ls = ls->next) {
+		if (ls->script.size() == scriptsize && (scriptsize == 0 ||
+			std::memcmp(&ls->script[0], script, scriptsize) == 0))
+			return ls;
+	}
+
+	CompiledLoopScript* ls = new CompiledLoopScript(script, scriptsize, hash);
+	ls->next = first;
+	cache.scripts[hash] = ls;
+
+	if (ls->compiled)
+		cache.compiled++;
+	else
+		cache.interpreted++;
+
+	return ls;
+}
+
+CompiledLoopScript::CompiledLoopScript(const uint8* script_,
+									   uint32 scriptsize, uint32 hash_)
+	: script(script_, script_ + scriptsize), hash(hash_), next(0),
+	  compiled(false), root(0), shapefilter(false), framefilter(false),
+	  tested(0), filtered(0), matched(0)
+{
+	compiled = compile();
+
+	if (compiled) {
+		findFilters();
+	} else {
+		nodes.clear();
+		constants.clear();
+	}
+}
+
+uint16 CompiledLoopScript::addNode(uint8 op, uint16 value,
+								   uint16 left, uint16 right)
+{
+	Node node;
+	node.op = op;
+	node.value = value;
+	node.left = left;
+	node.right = right;
+
+	switch (op) {
+	case OP_FAMILY:
+		node.slow = true;
+		break;
+	case OP_NOT:
+		node.slow = nodes[left].slow;
+		break;
+	case OP_AND: case OP_OR:
+		// test the cheap side first
+		if (nodes[left].slow && !nodes[right].slow) {
+			node.left = right;
+			node.right = left;
+		}
+		// fall through
+	case OP_EQUAL: case OP_GREATER: case OP_LESS:
+	case OP_GEQUAL: case OP_LEQUAL:
+		node.slow = nodes[left].slow || nodes[right].slow;
+		break;
+	default:
+		node.slow = false;
+		break;
+	}
+
+	nodes.push_back(node);
+	return static_cast<uint16>(nodes.size() - 1);
+}
+
+// This follows Item::checkLoopScript. Anything it would complain about
+// (or read out of bounds for) isn't compiled, so it still does.
+bool CompiledLoopScript::compile()
+{
+	uint32 size = static_cast<uint32>(script.size());
+	if (size > 0x4000) return false;
+
+	std::vector<uint16> stack;
+
+	// default to true if script is empty
+	stack.push_back(addNode(OP_CONST, 1, 0, 0));
+
+	uint32 i = 0;
+	while (i < size) {
+		uint8 token = script[i];
+		uint8 op = OP_CONST;
+
+		switch (token) {
+		case LS_TOKEN_FALSE:
+			stack.push_back(addNode(OP_CONST, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_TRUE:
+			stack.push_back(addNode(OP_CONST, 1, 0, 0));
+			break;
+
+		case LS_TOKEN_END:
+			root = stack.back();
+			return true;
+
+		case LS_TOKEN_INT:
+			if (i + 2 >= size) return false;
+			stack.push_back(addNode(OP_CONST, static_cast<uint16>(
+										script[i+1] + (script[i+2]<<8)),
+									0, 0));
+			i += 2;
+			break;
+
+		case LS_TOKEN_NOT:
+		{
+			if (stack.empty()) return false;
+			uint16 a = stack.back();
+			stack.pop_back();
+			stack.push_back(addNode(OP_NOT, 0, a, 0));
+		}
+		break;
+
+		case LS_TOKEN_AND: if (op == OP_CONST) op = OP_AND;
+		case LS_TOKEN_OR: if (op == OP_CONST) op = OP_OR;
+		case LS_TOKEN_EQUAL: if (op == OP_CONST) op = OP_EQUAL;
+		case LS_TOKEN_GREATER: if (op == OP_CONST) op = OP_GREATER;
+		case LS_TOKEN_LESS: if (op == OP_CONST) op = OP_LESS;
+		case LS_TOKEN_GEQUAL: if (op == OP_CONST) op = OP_GEQUAL;
+		case LS_TOKEN_LEQUAL: if (op == OP_CONST) op = OP_LEQUAL;
+		{
+			if (stack.size() < 2) return false;
+			uint16 right = stack.back();
+			stack.pop_back();
+			uint16 left = stack.back();
+			stack.pop_back();
+			stack.push_back(addNode(op, 0, left, right));
+		}
+		break;
+
+		case LS_TOKEN_STATUS:
+			stack.push_back(addNode(OP_STATUS, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_Q:
+			stack.push_back(addNode(OP_Q, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_NPCNUM:
+			stack.push_back(addNode(OP_NPCNUM, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_FAMILY:
+			stack.push_back(addNode(OP_FAMILY, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_SHAPE:
+			stack.push_back(addNode(OP_SHAPE, 0, 0, 0));
+			break;
+
+		case LS_TOKEN_FRAME:
+			stack.push_back(addNode(OP_FRAME, 0, 0, 0));
+			break;
+
+		case 'A': case 'B': case 'C': case 'D': case 'E':
+		case 'F': case 'G': case 'H': case 'I': case 'J':
+		case 'K': case 'L': case 'M': case 'N': case 'O':
+		case 'P': case 'Q': case 'R': case 'S': case 'T':
+		case 'U': case 'V': case 'W': case 'X': case 'Y': case 'Z':
+			op = OP_SHAPE_IN;
+			// fall through
+		case 'a': case 'b': case 'c': case 'd': case 'e':
+		case 'f': case 'g': case 'h': case 'i': case 'j':
+		case 'k': case 'l': case 'm': case 'n': case 'o':
+		case 'p': case 'q': case 'r': case 's': case 't':
+		case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
+		{
+			if (op == OP_CONST) op = OP_FRAME_IN;
+			int count = token - (op == OP_SHAPE_IN ? '@' : '`');
+			if (i + 2*count >= size) return false;
+
+			uint16 first = static_cast<uint16>(constants.size());
+			for (int j = 0; j < count; j++) {
+				constants.push_back(static_cast<uint16>(
+										script[i+1] + (script[i+2]<<8)));
+				i += 2;
+			}
+			stack.push_back(addNode(op, 0, first,
+									static_cast<uint16>(count)));
+		}
+		break;
+
+		default:
+			return false;
+		}
+
+		i++;
+	}
+
+	// no end token
+	return false;
+}
+
+void CompiledLoopScript::getConjuncts(uint16 node,
+									  std::vector<uint16>& conjuncts) const
+{
+	if (nodes[node].op == OP_AND) {
+		getConjuncts(nodes[node].left, conjuncts);
+		getConjuncts(nodes[node].right, conjuncts);
+	} else {
+		conjuncts.push_back(node);
+	}
+}
+
+bool CompiledLoopScript::getAccepted(uint16 node, uint8 op, uint8 in_op,
+									 std::vector<uint16>& accepted) const
+{
+	const Node& n = nodes[node];
+
+	if (n.op == in_op) {
+		accepted.assign(constants.begin() + n.left,
+						constants.begin() + n.left + n.right);
+	} else if (n.op == OP_EQUAL && nodes[n.left].op == op &&
+			   nodes[n.right].op == OP_CONST) {
+		accepted.assign(1, nodes[n.right].value);
+	} else if (n.op == OP_EQUAL && nodes[n.right].op == op &&
+			   nodes[n.left].op == OP_CONST) {
+		accepted.assign(1, nodes[n.left].value);
+	} else {
+		return false;
+	}
+
+	std::sort(accepted.begin(), accepted.end());
+	accepted.erase(std::unique(accepted.begin(), accepted.end()),
+				   accepted.end());
+	return true;
+}
+
+static void intersect(std::vector<uint16>& values,
+					  const std::vector<uint16>& accepted)
+{
+	std::vector<uint16> both;
+	std::set_intersection(values.begin(), values.end(),
+						  accepted.begin(), accepted.end(),
+						  std::back_inserter(both));
+	values.swap(both);
+}
+
+void CompiledLoopScript::findFilters()
+{
+	// The script only matches if all of these match
+	std::vector<uint16> conjuncts;
+	getConjuncts(root, conjuncts);
+
+	for (unsigned int i = 0; i < conjuncts.size(); ++i) {
+		std::vector<uint16> accepted;
+
+		if (getAccepted(conjuncts[i], OP_SHAPE, OP_SHAPE_IN, accepted)) {
+			if (shapefilter)
+				intersect(shapes, accepted);
+			else
+				shapes.swap(accepted);
+			shapefilter = true;
+		} else if (getAccepted(conjuncts[i], OP_FRAME, OP_FRAME_IN,
+							   accepted)) {
+			if (framefilter)
+				intersect(frames, accepted);
+			else
+				frames.swap(accepted);
+			framefilter = true;
+		}
+	}
+}
+
+static inline bool isAccepted(const std::vector<uint16>& values, uint32 v)
+{
+	// (values are only 16 bit, so don't reject what the script would
+	//  compare truncated)
+	if (v > 0xFFFF) return true;
+	return std::binary_search(values.begin(), values.end(),
+							  static_cast<uint16>(v));
+}
+
+bool CompiledLoopScript::match(Item* item)
+{
+	tested++;
+
+	if (!compiled) {
+		bool result = item->checkLoopScript(
+			script.empty() ? 0 : &script[0],
+			static_cast<uint32>(script.size()));
+		if (result) matched++;
+		return result;
+	}
+
+	if ((shapefilter && !isAccepted(shapes, item->getShape())) ||
+		(framefilter && !isAccepted(frames, item->getFrame())))
+	{
+		filtered++;
+		return false;
+	}
+
+	if (eval(root, item) == 0)
+		return false;
+
+	matched++;
+	return true;
+}
+
+uint16 CompiledLoopScript::eval(uint16 node, Item* item) const
+{
+	const Node& n = nodes[node];
+
+	switch (n.op) {
+	case OP_CONST:
+		return n.value;
+	case OP_STATUS:
+		return item->getFlags();
+	case OP_Q:
+		return item->getQuality();
+	case OP_NPCNUM:
+		return item->getNpcNum();
+	case OP_FAMILY:
+		return item->getFamily();
+	case OP_SHAPE:
+		return static_cast<uint16>(item->getShape());
+	case OP_FRAME:
+		return static_cast<uint16>(item->getFrame());
+
+	case OP_SHAPE_IN:
+	case OP_FRAME_IN:
+	{
+		uint32 v = (n.op == OP_SHAPE_IN) ? item->getShape()
+										 : item->getFrame();
+		for (unsigned int i = n.left; i < n.left + n.right; ++i) {
+			if (v == constants[i]) return 1;
+		}
+		return 0;
+	}
+
+	case OP_AND:
+		return (eval(n.left, item) != 0 && eval(n.right, item) != 0) ? 1 : 0;
+	case OP_OR:
+		return (eval(n.left, item) != 0 || eval(n.right, item) != 0) ? 1 : 0;
+	case OP_NOT:
+		return (eval(n.left, item) != 0) ? 0 : 1;
+
+	case OP_EQUAL:
+		return (eval(n.left, item) == eval(n.right, item)) ? 1 : 0;
+	case OP_GREATER:
+		return (eval(n.left, item) > eval(n.right, item)) ? 1 : 0;
+	case OP_LESS:
+		return (eval(n.left, item) < eval(n.right, item)) ? 1 : 0;
+	case OP_GEQUAL:
+		return (eval(n.left, item) >= eval(n.right, item)) ? 1 : 0;
+	case OP_LEQUAL:
+		return (eval(n.left, item) <= eval(n.right, item)) ? 1 : 0;
+	}
+
+	CANT_HAPPEN();
+	return 0;
+}
+
+void CompiledLoopScript::countSearch(SearchType type, uint32 tested,
+									 uint32 matched)
+{
+	cache.searches[type]++;
+	cache.tested[type] += tested;
+	cache.matched[type] += matched;
+}
+
+void CompiledLoopScript::ConCmd_stats(const Console::ArgvType &/*argv*/)
+{
+	static const char* names[NUM_SEARCH_TYPES] = {
+		"area", "surface", "container"
+	};
+
+	pout << "Loopscripts: " << cache.compiled << " compiled, "
+		 << cache.interpreted << " interpreted" << std::endl;
+
+	pout << "Search      Searches     Tested    Matched" << std::endl;
+	for (int i = 0; i < NUM_SEARCH_TYPES; ++i) {
+		con.Printf("%-10s %9u %10u %10u\n", names[i], cache.searches[i],
+				   cache.tested[i], cache.matched[i]);
+	}
+
+	std::vector<CompiledLoopScript*> all;
+	std::map<uint32, CompiledLoopScript*>::iterator it;
+	for (it = cache.scripts.begin(); it != cache.scripts.end(); ++it) {
+		for (CompiledLoopScript* ls = it->second; ls; ls = ls->next)
+			all.push_back(ls);
+	}
+	std::sort(all.begin(), all.end(), testedMore);
+
+	pout << "Script                      Tested   Filtered    Matched"
+		 << std::endl;
+	for (unsigned int i = 0; i < all.size() && i < 10; ++i) {
+		const CompiledLoopScript* ls = all[i];
+
+		char hex[32];
+		unsigned int j;
+		for (j = 0; j < ls->script.size() && j < 11; ++j)
+			std::sprintf(hex + 2*j, "%02X", ls->script[j]);
+		hex[2*j] = 0;
+
+		con.Printf("%-22s%c%c %10u %10u %10u\n", hex,
+				   j < ls->script.size() ? '+' : ' ',
+				   ls->compiled ? ' ' : '*',
+				   ls->tested, ls->filtered, ls->matched);
+	}
+	if (cache.interpreted)
+		pout << "(* = interpreted)" << std::endl;
+}
+
+bool CompiledLoopScript::testedMore(const CompiledLoopScript* a,
+									const CompiledLoopScript* b)
+{
+	return a->tested > b->tested;
+}
@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef COMPILEDLOOPSCRIPT_H
+#define COMPILEDLOOPSCRIPT_H
+
+#include <vector>
+
+class Item;
+
+//! A loopscript (see LoopScript.h) compiled into an expression tree, so
+//! the item searches don't have to interpret it for every item they test.
+//!
+//! If the script has to match one of a set of shapes or frames, that's
+//! checked first, so most items are rejected before anything else (like
+//! their family, which needs their ShapeInfo) is looked at.
+//! Scripts that don't compile are left to Item::checkLoopScript.
+//!
+//! Compiled scripts are cached by their bytes. Only use this on the main
+//! thread.
+class CompiledLoopScript
+{
+public:
+	enum SearchType {
+		AREA_SEARCH = 0,
+		SURFACE_SEARCH,
+		CONTAINER_SEARCH,
+		NUM_SEARCH_TYPES
+	};
+
+	//! Get the compiled form of a loopscript, compiling it on first use
+	static CompiledLoopScript* get(const uint8* script, uint32 scriptsize);
+
+	//! Check an item against the loopscript
+	bool match(Item* item);
+
+	//! Record the number of items a search tested and matched
+	static void countSearch(SearchType type, uint32 tested, uint32 matched);
+
+	//! "CompiledLoopScript::stats" console command
+	static void ConCmd_stats(const Console::ArgvType &argv);
+
+private:
+	CompiledLoopScript(const uint8* script, uint32 scriptsize, uint32 hash);
+
+	enum Op {
+		OP_CONST, OP_STATUS, OP_Q, OP_NPCNUM, OP_FAMILY, OP_SHAPE, OP_FRAME,
+		OP_SHAPE_IN, OP_FRAME_IN,
+		OP_AND, OP_OR, OP_NOT,
+		OP_EQUAL, OP_GREATER, OP_LESS, OP_GEQUAL, OP_LEQUAL
+	};
+
+	struct Node
+	{
+		uint8 op;
+		bool slow;			//!< needs the item's ShapeInfo
+		uint16 value;		//!< OP_CONST
+		uint16 left;		//!< child, or first constant of OP_*_IN
+		uint16 right;		//!< child, or number of constants of OP_*_IN
+	};
+
+	//! Build the expression tree. False if the script can't be compiled.
+	bool compile();
+
+	uint16 addNode(uint8 op, uint16 value, uint16 left, uint16 right);
+
+	//! Hoist the shape and frame tests that the whole script depends on
+	void findFilters();
+	void getConjuncts(uint16 node, std::vector<uint16>& conjuncts) const;
+
+	//! Get the values a shape or frame test accepts
+	//! \return false if node isn't such a test
+	bool getAccepted(uint16 node, uint8 op, uint8 in_op,
+					 std::vector<uint16>& accepted) const;
+
+	uint16 eval(uint16 node, Item* item) const;
+
+	static bool testedMore(const CompiledLoopScript* a,
+						   const CompiledLoopScript* b);
+
+	std::vector<uint8> script;
+	uint32 hash;
+	CompiledLoopScript* next;	//!< next cached script with the same hash
+
+	bool compiled;
+	std::vector<Node> nodes;
+	std::vector<uint16> constants;
+	uint16 root;
+
+	bool shapefilter, framefilter;
+	std::vector<uint16> shapes;	//!< sorted
+	std::vector<uint16> frames;	//!< sorted
+
+	// statistics
+	uint32 tested, filtered, matched;
+
+	struct Cache;
+	friend struct Cache;
+	static Cache cache;
+};
+
+#endif
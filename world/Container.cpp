@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "MainActor.h"
 #include "getObject.h"
 #include "CoreApp.h"
+#include "CompiledLoopScript.h"
 
 #include "ShapeInfo.h"
 
@@ -152,6 +153,7 @@ bool Container::addItem(Item* item, bool checkwghtvol)
 	if (item->getParent() == objid) return true; // already in here
 
 	contents.push_back(item);
+	setDirty();
 	return true;
 }
 
@@ -163,6 +165,7 @@ bool Container::removeItem(Item* item)
 	for (iter = contents.begin(); iter != contents.end(); ++iter) {
 		if (*iter == item) {
 			contents.erase(iter);
+			setDirty();
 			return true;
 		}
 	}
@@ -178,6 +181,7 @@ bool Container::moveItemToEnd(Item* item)
 			// found; move to end
 			contents.erase(iter);
 			contents.push_back(item);
+			setDirty();
 			return true;
 		}
 	}
@@ -288,10 +292,16 @@ uint32 Container::getContentVolume()
 void Container::containerSearch(UCList* itemlist, const uint8* loopscript,
 								uint32 scriptsize, bool recurse)
 {
+	CompiledLoopScript* script = CompiledLoopScript::get(loopscript,
+														 scriptsize);
+	uint32 tested = 0, matched = 0;
+
 	std::list<Item*>::iterator iter;
 	for (iter = contents.begin(); iter != contents.end(); ++iter) {
 		// check item against loopscript
-		if ((*iter)->checkLoopScript(loopscript, scriptsize)) {
+		tested++;
+		if (script->match(*iter)) {
+			matched++;
 			uint16 objid = (*iter)->getObjId();
 			uint8 buf[2];
 			buf[0] = static_cast<uint8>(objid);
@@ -306,7 +316,10 @@ void Container::containerSearch(UCList* itemlist, const uint8* loopscript,
 				container->containerSearch(itemlist, loopscript,
 										   scriptsize, recurse);
 		}
-	}	
+	}
+
+	CompiledLoopScript::countSearch(CompiledLoopScript::CONTAINER_SEARCH,
+									tested, matched);
 }
 
 void Container::dumpInfo()
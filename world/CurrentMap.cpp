@@ -40,23 +40,37 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "GameMapGump.h"
 #include "Direction.h"
 #include "getObject.h"
+#include "Profiler.h"
+#include "WalkGrid.h"
+#include "CompiledLoopScript.h"
 
 #include "IDataSource.h"	
 #include "ODataSource.h"
 
 using std::list; // too messy otherwise
 using Pentagram::Rect;
-typedef list<Item*> item_list;
+typedef std::vector<Item*> item_list;
+
+bool CurrentMap::useCollisionIndex = true;
+
+// Collision queries also run on the pathfinding threads, so each thread
+// gets its own candidate list
+static SDL_TLSID candidatesTLS = 0;
+
+static void DeleteCandidateList(void* list)
+{
+	delete static_cast<std::vector<unsigned int>*>(list);
+}
 
 CurrentMap::CurrentMap()
 	: current_map(0), egghatcher(0),
 		fast_x_min(-1), fast_y_min(-1),
 		fast_x_max(-1), fast_y_max(-1)
 {
-	items = new list<Item*>*[MAP_NUM_CHUNKS];
+	items = new CurrentMapChunk*[MAP_NUM_CHUNKS];
 	fast = new uint32*[MAP_NUM_CHUNKS];
 	for (unsigned int i = 0; i < MAP_NUM_CHUNKS; i++) {
-		items[i] = new list<Item*>[MAP_NUM_CHUNKS];
+		items[i] = new CurrentMapChunk[MAP_NUM_CHUNKS];
 		fast[i] = new uint32[MAP_NUM_CHUNKS/32];
 		std::memset(fast[i],false,sizeof(uint32)*MAP_NUM_CHUNKS/32);
 	}
@@ -68,6 +82,11 @@ CurrentMap::CurrentMap()
 	} else {
 		CANT_HAPPEN_MSG("Unknown game type in CurrentMap constructor.");
 	}
+
+	walkgrid = new WalkGrid(this);
+
+	if (!candidatesTLS)
+		candidatesTLS = SDL_TLSCreate();
 }
 
 
@@ -81,14 +100,16 @@ CurrentMap::~CurrentMap()
 	}
 	delete[] items;
 	delete[] fast;
+	delete walkgrid;
 }
 
 void CurrentMap::clear()
 {
 	for (unsigned int i = 0; i < MAP_NUM_CHUNKS; i++) {
 		for (unsigned int j = 0; j < MAP_NUM_CHUNKS; j++) {
-			item_list::iterator iter;
-			for (iter = items[i][j].begin(); iter != items[i][j].end(); ++iter)
+			item_list::const_iterator iter;
+			const item_list& chunkitems = items[i][j].getItems();
+			for (iter = chunkitems.begin(); iter != chunkitems.end(); ++iter)
 				delete *iter;
 			items[i][j].clear();
 		}
@@ -98,6 +119,8 @@ void CurrentMap::clear()
 	fast_x_min =  fast_y_min = fast_x_max = fast_y_max = -1;
 	current_map = 0;
 
+	walkgrid->clear();
+
 	Process* ehp = Kernel::get_instance()->getProcess(egghatcher);
 	if (ehp)
 		ehp->terminate();
@@ -123,6 +146,12 @@ void CurrentMap::createEggHatcher()
 	egghatcher = Kernel::get_instance()->addProcess(ehp);
 }
 
+EggHatcherProcess* CurrentMap::getEggHatcher()
+{
+	Process* ehp = Kernel::get_instance()->getProcess(egghatcher);
+	return p_dynamic_cast<EggHatcherProcess*>(ehp);
+}
+
 void CurrentMap::writeback()
 {
 	if (!current_map)
@@ -130,8 +159,9 @@ void CurrentMap::writeback()
 
 	for (unsigned int i = 0; i < MAP_NUM_CHUNKS; i++) {
 		for (unsigned int j = 0; j < MAP_NUM_CHUNKS; j++) {
-			item_list::iterator iter;
-			for (iter = items[i][j].begin(); iter != items[i][j].end(); ++iter)
+			item_list::const_iterator iter;
+			const item_list& chunkitems = items[i][j].getItems();
+			for (iter = chunkitems.begin(); iter != chunkitems.end(); ++iter)
 			{
 				Item* item = *iter;
 
@@ -168,6 +198,11 @@ void CurrentMap::writeback()
 		}
 	}
 
+	// the map's items have (probably) changed while it was loaded
+	current_map->setDirty();
+
+	walkgrid->clear();
+
 	// delete egghatcher
 	Process* ehp = Kernel::get_instance()->getProcess(egghatcher);
 	if (ehp)
@@ -175,9 +210,9 @@ void CurrentMap::writeback()
 	egghatcher = 0;
 }
 
-void CurrentMap::loadItems(list<Item*> itemlist, bool callCacheIn)
+void CurrentMap::loadItems(const list<Item*>& itemlist, bool callCacheIn)
 {
-	item_list::iterator iter;
+	list<Item*>::const_iterator iter;
 	for (iter = itemlist.begin(); iter != itemlist.end(); ++iter)
 	{
 		Item* item = *iter;
@@ -219,6 +254,7 @@ void CurrentMap::loadMap(Map* map)
 	// we take control of the items in map, so clear the pointers
 	map->fixeditems.clear();
 	map->dynamicitems.clear();
+	map->setDirty();
 
 	// load relevant NPCs to the item lists
 	// !constant
@@ -264,7 +300,7 @@ void CurrentMap::addItem(Item* item)
 
 	Egg* egg = p_dynamic_cast<Egg*>(item);
 	if (egg) {
-		EggHatcherProcess* ehp = p_dynamic_cast<EggHatcherProcess*>(Kernel::get_instance()->getProcess(egghatcher));
+		EggHatcherProcess* ehp = getEggHatcher();
 		assert(ehp);
 		ehp->addEgg(egg);
 	}
@@ -291,7 +327,7 @@ void CurrentMap::addItemToEnd(Item* item)
 
 	Egg* egg = p_dynamic_cast<Egg*>(item);
 	if (egg) {
-		EggHatcherProcess* ehp = p_dynamic_cast<EggHatcherProcess*>(Kernel::get_instance()->getProcess(egghatcher));
+		EggHatcherProcess* ehp = getEggHatcher();
 		assert(ehp);
 		ehp->addEgg(egg);
 	}
@@ -325,6 +361,70 @@ void CurrentMap::removeItemFromList(Item* item, sint32 oldx, sint32 oldy)
 
 	items[cx][cy].remove(item);
 	item->clearExtFlag(Item::EXT_INCURMAP);
+
+	Egg* egg = p_dynamic_cast<Egg*>(item);
+	if (egg) {
+		EggHatcherProcess* ehp = getEggHatcher();
+		if (ehp) ehp->removeEgg(egg);
+	}
+}
+
+void CurrentMap::updateItem(Item* item)
+{
+	sint32 ix, iy, iz;
+
+	item->getLocation(ix, iy, iz);
+
+	if (ix < 0 || ix >= mapChunkSize*MAP_NUM_CHUNKS || 
+		iy < 0 || iy >= mapChunkSize*MAP_NUM_CHUNKS) {
+		perr << "Skipping item " << item->getObjId() << ": out of range (" 
+			 << ix << "," << iy << ")" << std::endl;
+		return;
+	}
+
+	sint32 cx = ix / mapChunkSize;
+	sint32 cy = iy / mapChunkSize;
+
+	items[cx][cy].update(item);
+
+	// the egg's hatch area may have moved
+	Egg* egg = p_dynamic_cast<Egg*>(item);
+	if (egg) {
+		EggHatcherProcess* ehp = getEggHatcher();
+		if (ehp) ehp->addEgg(egg);
+	}
+}
+
+void CurrentMap::getCandidates(const CurrentMapChunk& chunk,
+							   sint32 zmin, sint32 zmax,
+							   std::vector<unsigned int>& candidates)
+{
+	if (!useCollisionIndex) {
+		getAllCandidates(chunk, candidates);
+		return;
+	}
+
+	candidates.clear();
+	chunk.getCollisionCandidates(zmin, zmax, candidates);
+}
+
+void CurrentMap::getAllCandidates(const CurrentMapChunk& chunk,
+								  std::vector<unsigned int>& candidates)
+{
+	candidates.clear();
+	for (unsigned int idx = 0; idx < chunk.size(); ++idx)
+		candidates.push_back(idx);
+}
+
+std::vector<unsigned int>& CurrentMap::getCandidateList()
+{
+	std::vector<unsigned int>* list =
+		static_cast<std::vector<unsigned int>*>(SDL_TLSGet(candidatesTLS));
+	if (!list) {
+		list = new std::vector<unsigned int>;
+		SDL_TLSSet(candidatesTLS, list, DeleteCandidateList);
+	}
+	return *list;
 }
 
 // Check to see if the chunk is on the screen 
@@ -450,19 +550,21 @@ void CurrentMap::setChunkFast(sint32 cx, sint32 cy)
 {
 	fast[cy][cx/32] |= 1<<(cx&31);
 
+	// Work on a copy, since entering the fast area can change the chunk
+	item_list chunkitems = items[cx][cy].getItems();
 	item_list::iterator iter;
-	for (iter = items[cx][cy].begin();
-			iter != items[cx][cy].end(); ++iter) {
-				(*iter)->enterFastArea();
-			}
+	for (iter = chunkitems.begin(); iter != chunkitems.end(); ++iter)
+		(*iter)->enterFastArea();
 }
 
 void CurrentMap::unsetChunkFast(sint32 cx, sint32 cy)
 {
 	fast[cy][cx/32] &= ~(1<<(cx&31));
 
-	item_list::iterator iter = items[cx][cy].begin();
-	while (iter != items[cx][cy].end())
+	// Work on a copy, since leaving the fast area can change the chunk
+	item_list chunkitems = items[cx][cy].getItems();
+	item_list::iterator iter = chunkitems.begin();
+	while (iter != chunkitems.end())
 	{
 		Item* item = *iter;
 		++iter;
@@ -497,39 +599,33 @@ void CurrentMap::areaSearch(UCList* itemlist, const uint8* loopscript,
 	if (miny < 0) miny = 0;
 	if (maxy >= MAP_NUM_CHUNKS) maxy = MAP_NUM_CHUNKS-1;
 
+	CompiledLoopScript* script = CompiledLoopScript::get(loopscript,
+														 scriptsize);
+	uint32 tested = 0, matched = 0;
+
 	for (int cx = minx; cx <= maxx; cx++) {
 		for (int cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter) {
+			const CurrentMapChunk& chunk = items[cx][cy];
+			for (unsigned int idx = 0; idx < chunk.size(); ++idx) {
 
-				Item* item = *iter;
-
-				if (item->getExtFlags() & Item::EXT_SPRITE) continue;
+				if (chunk.isSprite(idx)) continue;
 
 				// check if item is in range?
-				sint32 ix, iy, iz;
-				item->getLocation(ix, iy, iz);
-
-				ShapeInfo* info = item->getShapeInfo();
-				sint32 ixd, iyd;
-
-				//!! constants
-				if (item->getFlags() & Item::FLG_FLIPPED) {
-					ixd = 32 * info->y;
-					iyd = 32 * info->x;
-				} else {
-					ixd = 32 * info->x;
-					iyd = 32 * info->y;
-				}
+				sint32 ix, iy, iz, ixd, iyd, izd;
+				chunk.getLocation(idx, ix, iy, iz);
+				chunk.getFootpadWorld(idx, ixd, iyd, izd);
 
 				Rect itemrect(ix - ixd, iy - iyd, ixd, iyd);
 
 				if (!itemrect.Overlaps(searchrange)) continue;
+
+				Item* item = chunk.getItem(idx);
 				
 				// check item against loopscript
-				if ((*iter)->checkLoopScript(loopscript, scriptsize)) {
-					uint16 objid = (*iter)->getObjId();
+				tested++;
+				if (script->match(item)) {
+					matched++;
+					uint16 objid = item->getObjId();
 					uint8 buf[2];
 					buf[0] = static_cast<uint8>(objid);
 					buf[1] = static_cast<uint8>(objid >> 8);
@@ -538,7 +634,7 @@ void CurrentMap::areaSearch(UCList* itemlist, const uint8* loopscript,
 
 				if (recurse) {
 					// recurse into child-containers
-					Container *container = p_dynamic_cast<Container*>(*iter);
+					Container *container = p_dynamic_cast<Container*>(item);
 					if (container)
 						container->containerSearch(itemlist, loopscript,
 												   scriptsize, recurse);
@@ -546,6 +642,9 @@ void CurrentMap::areaSearch(UCList* itemlist, const uint8* loopscript,
 			}
 		}
 	}
+
+	CompiledLoopScript::countSearch(CompiledLoopScript::AREA_SEARCH,
+									tested, matched);
 }
 
 void CurrentMap::surfaceSearch(UCList* itemlist, const uint8* loopscript,
@@ -579,22 +678,23 @@ void CurrentMap::surfaceSearch(UCList* itemlist, const uint8* loopscript,
 	if (miny < 0) miny = 0;
 	if (maxy >= MAP_NUM_CHUNKS) maxy = MAP_NUM_CHUNKS-1;
 
+	CompiledLoopScript* script = CompiledLoopScript::get(loopscript,
+														 scriptsize);
+	uint32 tested = 0, matched = 0;
+
 	for (sint32 cx = minx; cx <= maxx; cx++) {
 		for (sint32 cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter) {
+			const CurrentMapChunk& chunk = items[cx][cy];
+			for (unsigned int idx = 0; idx < chunk.size(); ++idx) {
 
-				Item* item = *iter;
-
-				if (item->getObjId() == check) continue;
-				if (item->getExtFlags() & Item::EXT_SPRITE) continue;
+				if (chunk.getObjId(idx) == check) continue;
+				if (chunk.isSprite(idx)) continue;
 
 				// check if item is in range?
 				sint32 ix, iy, iz;
-				item->getLocation(ix, iy, iz);
+				chunk.getLocation(idx, ix, iy, iz);
 				sint32 ixd, iyd, izd;
-				item->getFootpadWorld(ixd, iyd, izd);
+				chunk.getFootpadWorld(idx, ixd, iyd, izd);
 
 				Rect itemrect(ix - ixd, iy - iyd, ixd, iyd);
 
@@ -607,7 +707,7 @@ void CurrentMap::surfaceSearch(UCList* itemlist, const uint8* loopscript,
 					ok = true;
 					// Only recursive if tops aren't same (i.e. NOT flat)
 					if (recurse && (izd+iz != origin[2] + dims[2]) )
-						surfaceSearch(itemlist, loopscript, scriptsize, item, true, false, true);
+						surfaceSearch(itemlist, loopscript, scriptsize, chunk.getItem(idx), true, false, true);
 				}
 				
 				if (below && origin[2] == (iz + izd))
@@ -615,14 +715,17 @@ void CurrentMap::surfaceSearch(UCList* itemlist, const uint8* loopscript,
 					ok = true;
 					// Only recursive if bottoms aren't same (i.e. NOT flat)
 					if (recurse && (izd != dims[2]) )
-						surfaceSearch(itemlist, loopscript, scriptsize, item, false, true, true);
+						surfaceSearch(itemlist, loopscript, scriptsize, chunk.getItem(idx), false, true, true);
 				}
 
 				if (!ok) continue;
 
 				// check item against loopscript
-				if ((*iter)->checkLoopScript(loopscript, scriptsize)) {
-					uint16 objid = (*iter)->getObjId();
+				Item* item = chunk.getItem(idx);
+				tested++;
+				if (script->match(item)) {
+					matched++;
+					uint16 objid = item->getObjId();
 					uint8 buf[2];
 					buf[0] = static_cast<uint8>(objid);
 					buf[1] = static_cast<uint8>(objid >> 8);
@@ -631,15 +734,18 @@ void CurrentMap::surfaceSearch(UCList* itemlist, const uint8* loopscript,
 			}
 		}
 	}
+
+	CompiledLoopScript::countSearch(CompiledLoopScript::SURFACE_SEARCH,
+									tested, matched);
 }
 
 TeleportEgg* CurrentMap::findDestination(uint16 id)
 {
 	for (unsigned int i = 0; i < MAP_NUM_CHUNKS; i++) {
 		for (unsigned int j = 0; j < MAP_NUM_CHUNKS; j++) {
-			item_list::iterator iter;
-			for (iter = items[i][j].begin();
-				 iter != items[i][j].end(); ++iter)
+			item_list::const_iterator iter;
+			const item_list& chunkitems = items[i][j].getItems();
+			for (iter = chunkitems.begin(); iter != chunkitems.end(); ++iter)
 			{
 				TeleportEgg* egg = p_dynamic_cast<TeleportEgg*>(*iter);
 				if (egg) {
@@ -688,8 +794,11 @@ bool CurrentMap::isValidPosition(sint32 x, sint32 y, sint32 z,
 								 uint32 shapeflags,
 								 ObjId item_, Item** support_, uint16* roof_)
 {
+	Profiler::Scope profile(Profiler::COLLISION);
+
 	const uint32 flagmask = (ShapeInfo::SI_SOLID | ShapeInfo::SI_DAMAGING |
 							 ShapeInfo::SI_ROOF);
+	std::vector<unsigned int>& candidates = getCandidateList();
 	const uint32 blockflagmask = (ShapeInfo::SI_SOLID|ShapeInfo::SI_DAMAGING);
 
 	bool valid = true;
@@ -697,6 +806,9 @@ bool CurrentMap::isValidPosition(sint32 x, sint32 y, sint32 z,
 	ObjId roof = 0;
 	sint32 roofz = 1 << 24; //!! semi-constant
 
+	// Items below z can only support us, items above z+zd only be a roof
+	sint32 zmax = roof_ ? roofz : z + zd;
+
 	int minx, miny, maxx, maxy;
 
 	minx = ((x-xd)/mapChunkSize) - 1;
@@ -710,34 +822,34 @@ bool CurrentMap::isValidPosition(sint32 x, sint32 y, sint32 z,
 
 	for (int cx = minx; cx <= maxx; cx++) {
 		for (int cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter)
+			const CurrentMapChunk& chunk = items[cx][cy];
+			getCandidates(chunk, z, zmax, candidates);
+			for (unsigned int k = 0; k < candidates.size(); ++k)
 			{
-				Item* item = *iter;
-				if (item->getObjId() == item_) continue;
-				if (item->getExtFlags() & Item::EXT_SPRITE) continue;
+				unsigned int idx = candidates[k];
+				if (chunk.getObjId(idx) == item_) continue;
+				if (chunk.isSprite(idx)) continue;
 
-				ShapeInfo* si = item->getShapeInfo();
+				const uint32 siflags = chunk.getShapeFlags(idx);
 				//!! need to check is_sea() and is_land() maybe?
-				if (!(si->flags & flagmask))
+				if (!(siflags & flagmask))
 					continue; // not an interesting item
 
 				sint32 ix, iy, iz, ixd, iyd, izd;
-				si->getFootpadWorld(ixd, iyd, izd, item->getFlags() & Item::FLG_FLIPPED);
-				item->getLocation(ix, iy, iz);
+				chunk.getFootpadWorld(idx, ixd, iyd, izd);
+				chunk.getLocation(idx, ix, iy, iz);
 
 #if 0
-				if (item->getShape() == 145) {
+				if (chunk.getItem(idx)->getShape() == 145) {
 					perr << "Shape 145: (" << ix-ixd << "," << iy-iyd << ","
 						 << iz << ")-(" << ix << "," << iy << "," << iz+izd
 						 << ")" << std::endl;
-					if (!si->is_solid()) perr << "not solid" << std::endl;
+					if (!(siflags & ShapeInfo::SI_SOLID)) perr << "not solid" << std::endl;
 				}
 #endif
 
 				// check overlap
-				if ((si->flags & shapeflags & blockflagmask) &&
+				if ((siflags & shapeflags & blockflagmask) &&
 					/* not non-overlapping */
 					!(x <= ix - ixd || x - xd >= ix ||
 					  y <= iy - iyd || y - yd >= iy ||
@@ -749,7 +861,7 @@ bool CurrentMap::isValidPosition(sint32 x, sint32 y, sint32 z,
 				{
 					// overlapping an item. Invalid position
 #if 0
-					item->dumpInfo();
+					chunk.getItem(idx)->dumpInfo();
 #endif					
 					valid = false;
 				}
@@ -759,15 +871,17 @@ bool CurrentMap::isValidPosition(sint32 x, sint32 y, sint32 z,
 					  y <= iy - iyd || y - yd >= iy))
 				{
 					// check support
-					if (support == 0 && si->is_solid() &&
+					if (support == 0 && (siflags & ShapeInfo::SI_SOLID) &&
 						iz + izd == z)
 					{
-						support = item;
+						support = chunk.getItem(idx);
 					}
 
 					// check roof
-					if (si->is_roof() && iz < roofz && iz >= z + zd) {
-						roof = item->getObjId();
+					if ((siflags & ShapeInfo::SI_ROOF) && iz < roofz &&
+						iz >= z + zd)
+					{
+						roof = chunk.getObjId(idx);
 						roofz = iz;
 					}
 				}
@@ -787,12 +901,14 @@ bool CurrentMap::scanForValidPosition(sint32 x, sint32 y, sint32 z, Item* item,
 									  int movedir, bool wantsupport,
 									  sint32& tx, sint32& ty, sint32& tz)
 {
+	Profiler::Scope profile(Profiler::COLLISION);
+
 	// TODO: clean this up. Currently the mask arrays are filled with more
 	// data than is actually used.
 
 	uint32 blockflagmask = (ShapeInfo::SI_SOLID | ShapeInfo::SI_DAMAGING);
-	static uint32 validmask[17];
-	static uint32 supportmask[17];
+	uint32 validmask[17];
+	uint32 supportmask[17];
 
 	int searchdir = (movedir + 2) % 4;
 
@@ -833,22 +949,20 @@ bool CurrentMap::scanForValidPosition(sint32 x, sint32 y, sint32 z, Item* item,
 
 	for (int cx = minx; cx <= maxx; cx++) {
 		for (int cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter)
+			const CurrentMapChunk& chunk = items[cx][cy];
+			for (unsigned int idx = 0; idx < chunk.size(); ++idx)
 			{
-				Item* citem = *iter;
-				if (citem->getObjId() == item->getObjId()) continue;
-				if (citem->getExtFlags() & Item::EXT_SPRITE) continue;
+				if (chunk.getObjId(idx) == item->getObjId()) continue;
+				if (chunk.isSprite(idx)) continue;
 
-				ShapeInfo* si = citem->getShapeInfo();
+				const uint32 siflags = chunk.getShapeFlags(idx);
 				//!! need to check is_sea() and is_land() maybe?
-				if (!(si->flags & blockflagmask))
+				if (!(siflags & blockflagmask))
 					continue; // not an interesting item
 
 				sint32 ix, iy, iz, ixd, iyd, izd;
-				citem->getLocation(ix, iy, iz);
-				citem->getFootpadWorld(ixd, iyd, izd);
+				chunk.getLocation(idx, ix, iy, iz);
+				chunk.getFootpadWorld(idx, ixd, iyd, izd);
 
 				int minv = iz-z-zd+1;
 				int maxv = iz+izd-z-1;
@@ -886,7 +1000,7 @@ bool CurrentMap::scanForValidPosition(sint32 x, sint32 y, sint32 z, Item* item,
 					for (int i = minh; i <= maxh; ++i)
 						validmask[j+8] &= ~(1 << (i+8));
 
-				if (wantsupport && si->is_solid() &&
+				if (wantsupport && (siflags & ShapeInfo::SI_SOLID) &&
 					iz+izd >= z-8 && iz+izd <= z+8)
 				{
 					for (int i = minh; i <= maxh; ++i)
@@ -961,7 +1075,10 @@ bool CurrentMap::sweepTest(const sint32 start[3], const sint32 end[3],
 						   ObjId item, bool blocking_only,
 						   std::list<SweepItem> *hit)
 {
+	Profiler::Scope profile(Profiler::COLLISION);
+
 	const uint32 blockflagmask = (ShapeInfo::SI_SOLID|ShapeInfo::SI_DAMAGING);
+	std::vector<unsigned int>& candidates = getCandidateList();
 
 	int i;
 
@@ -1008,20 +1125,33 @@ bool CurrentMap::sweepTest(const sint32 start[3], const sint32 end[3],
 //	pout << "Sweeping to   (" << vel[0]-ext[0] << ", " << vel[1]-ext[1] << ", " << vel[2]-ext[2] << ")" << std::endl;
 //	pout << "              (" << vel[0]+ext[0] << ", " << vel[1]+ext[1] << ", " << vel[2]+ext[2] << ")" << std::endl;
 
+	// z range swept by the item, padded for the rounding of the extents
+	sint32 zmin = start[2] < end[2] ? start[2] : end[2];
+	sint32 zmax = start[2] > end[2] ? start[2] : end[2];
+	zmin -= 1;
+	zmax += dims[2] + 1;
+
 	std::list<SweepItem>::iterator sw_it;
 	if (hit) sw_it = hit->end();
 
 	for (int cx = minx; cx <= maxx; cx++) {
 		for (int cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter)
+			const CurrentMapChunk& chunk = items[cx][cy];
+
+			// Non-blocking items are only in the collision index if they
+			// happen to be roofs, so we need them all when those are wanted
+			if (blocking_only)
+				getCandidates(chunk, zmin, zmax, candidates);
+			else
+				getAllCandidates(chunk, candidates);
+
+			for (unsigned int k = 0; k < candidates.size(); ++k)
 			{
-				Item* other_item = *iter;
-				if (other_item->getObjId()==item) continue;
-				if (other_item->getExtFlags() & Item::EXT_SPRITE) continue;
+				unsigned int idx = candidates[k];
+				if (chunk.getObjId(idx)==item) continue;
+				if (chunk.isSprite(idx)) continue;
 
-				uint32 othershapeflags = other_item->getShapeInfo()->flags;
+				uint32 othershapeflags = chunk.getShapeFlags(idx);
 				bool blocking = (othershapeflags & shapeflags &
 								 blockflagmask) != 0;
 
@@ -1031,8 +1161,8 @@ bool CurrentMap::sweepTest(const sint32 start[3], const sint32 end[3],
 					continue;
 
 				sint32 other[3], oext[3];
-				other_item->getLocation(other[0], other[1], other[2]);
-				other_item->getFootpadWorld(oext[0], oext[1], oext[2]);
+				chunk.getLocation(idx, other[0], other[1], other[2]);
+				chunk.getFootpadWorld(idx, oext[0], oext[1], oext[2]);
 
 				// If the objects overlapped at the start, ignore collision.
 				// The -1 and +1 portions are to still consider collisions
@@ -1148,7 +1278,7 @@ bool CurrentMap::sweepTest(const sint32 start[3], const sint32 end[3],
 				//before the last time of overlap
 				if (first <= last)
 				{
-					//pout << "Hit item " << other_item->getObjId() << " at first: " << first << "  last: " << last << std::endl;
+					//pout << "Hit item " << chunk.getObjId(idx) << " at first: " << first << "  last: " << last << std::endl;
 
 					if (!hit) return true;
 
@@ -1172,8 +1302,8 @@ bool CurrentMap::sweepTest(const sint32 start[3], const sint32 end[3],
 						if ((*sw_it).hit_time > first) break;
 
 					// Now add it
-					sw_it = hit->insert(sw_it, SweepItem(other_item->getObjId(),first,last,touch,touch_floor,blocking,dirs));
-//					pout << "Hit item " << other_item->getObjId() << " at (" << first << "," << last << ")" << std::endl;
+					sw_it = hit->insert(sw_it, SweepItem(chunk.getObjId(idx),first,last,touch,touch_floor,blocking,dirs));
+//					pout << "Hit item " << chunk.getObjId(idx) << " at (" << first << "," << last << ")" << std::endl;
 //					pout << "hit item      (" << other[0] << ", " << other[1] << ", " << other[2] << ")" << std::endl;
 //					pout << "hit item time (" << u_0[0] << "-" << u_1[0] << ") (" << u_0[1] << "-" << u_1[1] << ") ("
 //						 << u_0[2] << "-" << u_1[2] << ")" << std::endl;
@@ -1209,20 +1339,20 @@ Item *CurrentMap::traceTopItem(sint32 x, sint32 y, sint32 ztop, sint32 zbot, Obj
 
 	for (int cx = minx; cx <= maxx; cx++) {
 		for (int cy = miny; cy <= maxy; cy++) {
-			item_list::iterator iter;
-			for (iter = items[cx][cy].begin();
-				 iter != items[cx][cy].end(); ++iter)
+			const CurrentMapChunk& chunk = items[cx][cy];
+			for (unsigned int idx = 0; idx < chunk.size(); ++idx)
 			{
-				Item* item = *iter;
-				if (item->getObjId() == ignore) continue;
-				if (item->getExtFlags() & Item::EXT_SPRITE) continue;
+				if (chunk.getObjId(idx) == ignore) continue;
+				if (chunk.isSprite(idx)) continue;
 
-				ShapeInfo* si = item->getShapeInfo();
-				if (!(si->flags & shflags) || si->is_editor() || si->is_translucent()) continue;
+				const uint32 siflags = chunk.getShapeFlags(idx);
+				if (!(siflags & shflags) ||
+					(siflags & (ShapeInfo::SI_EDITOR | ShapeInfo::SI_TRANSL)))
+					continue;
 
 				sint32 ix, iy, iz, ixd, iyd, izd;
-				item->getLocation(ix, iy, iz);
-				item->getFootpadWorld(ixd, iyd, izd);
+				chunk.getLocation(idx, ix, iy, iz);
+				chunk.getFootpadWorld(idx, ixd, iyd, izd);
 
 				if ((ix-ixd) >= x || ix <= x) continue;
 				if ((iy-iyd) >= y || iy <= y) continue;
@@ -1236,7 +1366,7 @@ Item *CurrentMap::traceTopItem(sint32 x, sint32 y, sint32 ztop, sint32 zbot, Obj
 					if ((tiz+tizd) < (iz+izd)) top = 0;
 				}
 
-				if (!top) top = item;
+				if (!top) top = chunk.getItem(idx);
 			}
 		}
 	}
@@ -1296,3 +1426,20 @@ uint32 CurrentMap::I_canExistAt(const uint8* args, unsigned int /*argsize*/)
 	else
 		return 0;
 }
+
+void CurrentMap::ConCmd_toggleCollisionIndex(const Console::ArgvType &argv)
+{
+	useCollisionIndex = !useCollisionIndex;
+
+	CurrentMap* cm = World::get_instance()->getCurrentMap();
+	unsigned int total = 0, indexed = 0;
+	for (unsigned int i = 0; i < MAP_NUM_CHUNKS; i++) {
+		for (unsigned int j = 0; j < MAP_NUM_CHUNKS; j++) {
+			total += cm->items[i][j].size();
+			indexed += cm->items[i][j].getCollisionCount();
+		}
+	}
+
+	pout << "CurrentMap::useCollisionIndex = " << useCollisionIndex
+		 << " (" << indexed << "/" << total << " items indexed)" << std::endl;
+}
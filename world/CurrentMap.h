@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include <list>
 #include "intrinsics.h"
+#include "CurrentMapChunk.h"
 
 class Map;
 class Item;
@@ -29,6 +30,7 @@ class TeleportEgg;
 class EggHatcherProcess;
 class IDataSource;
 class ODataSource;
+class WalkGrid;
 
 #define MAP_NUM_CHUNKS	64
 
@@ -61,6 +63,11 @@ public:
 	void removeItemFromList(Item* item, sint32 oldx, sint32 oldy);
 	void removeItem(Item* item);
 
+	//! Update the cached location, footpad and flags of an item in the
+	//! item lists. Has to be called when any of these change while the
+	//! item stays in the same chunk.
+	void updateItem(Item* item);
+
 	//! Update the fast area for the cameras position
 	void updateFastArea(sint32 from_x, sint32 from_y, sint32 from_z, sint32 to_x, sint32 to_y, sint32 to_z);
 
@@ -175,14 +182,24 @@ public:
 	TeleportEgg* findDestination(uint16 id);
 
 	// Not allowed to modify the list. Remember to use const_iterator
-	const std::list<Item*>* getItemList (sint32 gx, sint32 gy)
+	const std::vector<Item*>* getItemList (sint32 gx, sint32 gy)
 	{
 		// CONSTANTS!
 		if (gx < 0 || gy < 0 || gx >= MAP_NUM_CHUNKS || gy >= MAP_NUM_CHUNKS) 
 			return 0;
-		return &items[gx][gy];
+		return &items[gx][gy].getItems();
 	}
 
+	const CurrentMapChunk* getChunk(sint32 cx, sint32 cy) const
+	{
+		if (cx < 0 || cy < 0 || cx >= MAP_NUM_CHUNKS || cy >= MAP_NUM_CHUNKS) 
+			return 0;
+		return &items[cx][cy];
+	}
+
+	//! The coarse walkability grid, for planning long routes
+	WalkGrid* getWalkGrid() { return walkgrid; }
+
 	bool isChunkFast(sint32 cx, sint32 cy)
 	{
 		// CONSTANTS!
@@ -202,15 +219,34 @@ public:
 
 	INTRINSIC(I_canExistAt);
 
+	//! "CurrentMap::toggleCollisionIndex" console command
+	static void ConCmd_toggleCollisionIndex(const Console::ArgvType &argv);
+
 private:
-	void loadItems(std::list<Item*> itemlist, bool callCacheIn);
+	void loadItems(const std::list<Item*>& itemlist, bool callCacheIn);
 	void createEggHatcher();
+	EggHatcherProcess* getEggHatcher();
+
+	//! Fill candidates with the indices of the items in chunk that may
+	//! block, support or cover something in the z range [zmin, zmax]
+	void getCandidates(const CurrentMapChunk& chunk, sint32 zmin, sint32 zmax,
+					   std::vector<unsigned int>& candidates);
+
+	//! Fill candidates with the indices of all items in chunk
+	void getAllCandidates(const CurrentMapChunk& chunk,
+						  std::vector<unsigned int>& candidates);
+
+	//! Scratch list for getCandidates, one per thread
+	static std::vector<unsigned int>& getCandidateList();
+
+	//! Use the per-chunk collision index in collision queries
+	static bool useCollisionIndex;
 
 	Map* current_map;
 
 	// item lists. Lots of them :-)
 	// items[x][y]
-	std::list<Item*>** items;
+	CurrentMapChunk** items;
 
 	ProcId egghatcher;
 
@@ -220,6 +256,8 @@ private:
 
 	int mapChunkSize;
 
+	WalkGrid* walkgrid;
+
 	void setChunkFast(sint32 cx, sint32 cy);
 	void unsetChunkFast(sint32 cx, sint32 cy);
 };
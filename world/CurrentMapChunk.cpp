@@ -0,0 +1,218 @@
+/*
+Copyright (C) 2003-2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "CurrentMapChunk.h"
+#include "Item.h"
+#include "ShapeInfo.h"
+
+#include <algorithm>
+
+void CurrentMapChunk::push_front(Item* item)
+{
+	insert(0, item);
+}
+
+void CurrentMapChunk::push_back(Item* item)
+{
+	insert(items.size(), item);
+}
+
+void CurrentMapChunk::insert(unsigned int i, Item* item)
+{
+	// Shift the collision index to make room for the new item
+	for (unsigned int b = 0; b < COLLISION_BUCKETS; ++b) {
+		std::vector<unsigned int>& bucket = collision[b];
+		for (unsigned int j = 0; j < bucket.size(); ++j)
+			if (bucket[j] >= i) bucket[j]++;
+	}
+
+	items.insert(items.begin() + i, item);
+	locx.insert(locx.begin() + i, 0);
+	locy.insert(locy.begin() + i, 0);
+	locz.insert(locz.begin() + i, 0);
+	fpx.insert(fpx.begin() + i, 0);
+	fpy.insert(fpy.begin() + i, 0);
+	fpz.insert(fpz.begin() + i, 0);
+	shapeflags.insert(shapeflags.begin() + i, 0);
+	objids.insert(objids.begin() + i, 0);
+	sprite.insert(sprite.begin() + i, 0);
+
+	set(i, item);
+}
+
+void CurrentMapChunk::set(unsigned int i, Item* item)
+{
+	unindexCollision(i);
+
+	item->getLocation(locx[i], locy[i], locz[i]);
+	item->getFootpadWorld(fpx[i], fpy[i], fpz[i]);
+	shapeflags[i] = item->getShapeInfo()->flags;
+	objids[i] = item->getObjId();
+	sprite[i] = (item->getExtFlags() & Item::EXT_SPRITE) ? 1 : 0;
+
+	indexCollision(i);
+}
+
+static inline bool IsCollisionItem(uint32 shapeflags, uint8 sprite)
+{
+	const uint32 flagmask = (ShapeInfo::SI_SOLID | ShapeInfo::SI_DAMAGING |
+							 ShapeInfo::SI_ROOF);
+
+	return !sprite && (shapeflags & flagmask);
+}
+
+unsigned int CurrentMapChunk::getCollisionBucket(sint32 z)
+{
+	if (z < 0) return 0;
+
+	unsigned int b = z / COLLISION_BUCKET_HEIGHT;
+	if (b >= COLLISION_BUCKETS) b = COLLISION_BUCKETS - 1;
+	return b;
+}
+
+// Actors move around too much to be part of the WalkGrid
+static inline bool IsWalkBlocker(uint32 shapeflags, ObjId objid)
+{
+	return (shapeflags & ShapeInfo::SI_SOLID) && (objid == 0 || objid >= 256);
+}
+
+bool CurrentMapChunk::isWalkBlocker(unsigned int i) const
+{
+	return !sprite[i] && IsWalkBlocker(shapeflags[i], objids[i]);
+}
+
+void CurrentMapChunk::indexCollision(unsigned int i)
+{
+	if (!IsCollisionItem(shapeflags[i], sprite[i])) return;
+
+	if (IsWalkBlocker(shapeflags[i], objids[i])) walkrevision++;
+
+	collision[getCollisionBucket(locz[i])].push_back(i);
+	if (fpz[i] > maxheight) maxheight = fpz[i];
+}
+
+void CurrentMapChunk::unindexCollision(unsigned int i)
+{
+	if (!IsCollisionItem(shapeflags[i], sprite[i])) return;
+
+	if (IsWalkBlocker(shapeflags[i], objids[i])) walkrevision++;
+
+	std::vector<unsigned int>& bucket = collision[getCollisionBucket(locz[i])];
+	for (unsigned int j = 0; j < bucket.size(); ++j) {
+		if (bucket[j] == i) {
+			bucket.erase(bucket.begin() + j);
+			return;
+		}
+	}
+}
+
+void CurrentMapChunk::getCollisionCandidates(sint32 zmin, sint32 zmax,
+									std::vector<unsigned int>& indices) const
+{
+	// An item's bottom has to be at most zmax, and its top at least zmin.
+	// Items are bucketed by bottom z, so the tallest item in the chunk
+	// bounds how far below zmin we have to look.
+	unsigned int first = getCollisionBucket(zmin - maxheight);
+	unsigned int last = getCollisionBucket(zmax);
+	unsigned int start = indices.size();
+
+	for (unsigned int b = first; b <= last; ++b) {
+		const std::vector<unsigned int>& bucket = collision[b];
+		for (unsigned int j = 0; j < bucket.size(); ++j) {
+			unsigned int i = bucket[j];
+			if (locz[i] <= zmax && locz[i] + fpz[i] >= zmin)
+				indices.push_back(i);
+		}
+	}
+
+	// Return them in list order, so results don't depend on the index
+	std::sort(indices.begin() + start, indices.end());
+}
+
+unsigned int CurrentMapChunk::getCollisionCount() const
+{
+	unsigned int count = 0;
+	for (unsigned int b = 0; b < COLLISION_BUCKETS; ++b)
+		count += collision[b].size();
+	return count;
+}
+
+void CurrentMapChunk::remove(Item* item)
+{
+	unsigned int i = 0;
+	while (i < items.size())
+	{
+		if (items[i] != item) {
+			++i;
+			continue;
+		}
+
+		unindexCollision(i);
+		for (unsigned int b = 0; b < COLLISION_BUCKETS; ++b) {
+			std::vector<unsigned int>& bucket = collision[b];
+			for (unsigned int j = 0; j < bucket.size(); ++j)
+				if (bucket[j] > i) bucket[j]--;
+		}
+
+		items.erase(items.begin() + i);
+		locx.erase(locx.begin() + i);
+		locy.erase(locy.begin() + i);
+		locz.erase(locz.begin() + i);
+		fpx.erase(fpx.begin() + i);
+		fpy.erase(fpy.begin() + i);
+		fpz.erase(fpz.begin() + i);
+		shapeflags.erase(shapeflags.begin() + i);
+		objids.erase(objids.begin() + i);
+		sprite.erase(sprite.begin() + i);
+	}
+}
+
+void CurrentMapChunk::update(Item* item)
+{
+	for (unsigned int i = 0; i < items.size(); ++i)
+	{
+		if (items[i] == item) {
+			set(i, item);
+			return;
+		}
+	}
+
+	perr << "CurrentMapChunk::update: item " << item->getObjId()
+		 << " not found in chunk" << std::endl;
+}
+
+void CurrentMapChunk::clear()
+{
+	items.clear();
+	locx.clear();
+	locy.clear();
+	locz.clear();
+	fpx.clear();
+	fpy.clear();
+	fpz.clear();
+	shapeflags.clear();
+	objids.clear();
+	sprite.clear();
+
+	for (unsigned int b = 0; b < COLLISION_BUCKETS; ++b)
+		collision[b].clear();
+	maxheight = 0;
+	walkrevision++;
+}
@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2003-2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef CURRENTMAPCHUNK_H
+#define CURRENTMAPCHUNK_H
+
+#include <vector>
+
+class Item;
+
+//! The items in a single chunk of the CurrentMap.
+//! Besides the Items themselves, the location, world footpad, ShapeInfo flags
+//! and objid of each item are kept in packed arrays, so collision detection
+//! and searches can skip items without dereferencing them.
+//! The arrays are kept up to date by CurrentMap::addItem/removeItemFromList
+//! and by Item whenever an item in the CurrentMap moves or changes shape.
+//!
+//! Items that can block, hurt or cover (SI_SOLID, SI_DAMAGING or SI_ROOF)
+//! are also entered in a collision index, bucketed by their bottom z, so
+//! collision queries can skip floors, decorations and other z levels.
+class CurrentMapChunk
+{
+public:
+	CurrentMapChunk() : maxheight(0), walkrevision(0) { }
+	~CurrentMapChunk() { }
+
+	unsigned int size() const { return items.size(); }
+	bool empty() const { return items.empty(); }
+
+	//! Add an item to the beginning of the chunk
+	void push_front(Item* item);
+
+	//! Add an item to the end of the chunk
+	void push_back(Item* item);
+
+	//! Remove all occurences of item from the chunk
+	void remove(Item* item);
+
+	//! Re-read the cached data of an item in the chunk
+	void update(Item* item);
+
+	void clear();
+
+	//! The items in this chunk, in list order
+	const std::vector<Item*>& getItems() const { return items; }
+
+	Item* getItem(unsigned int i) const { return items[i]; }
+	ObjId getObjId(unsigned int i) const { return objids[i]; }
+	uint32 getShapeFlags(unsigned int i) const { return shapeflags[i]; }
+	bool isSprite(unsigned int i) const { return sprite[i] != 0; }
+
+	//! Is the item solid, and not an actor?
+	bool isWalkBlocker(unsigned int i) const;
+
+	void getLocation(unsigned int i, sint32& x, sint32& y, sint32& z) const
+		{ x = locx[i]; y = locy[i]; z = locz[i]; }
+
+	void getFootpadWorld(unsigned int i, sint32& x, sint32& y, sint32& z) const
+		{ x = fpx[i]; y = fpy[i]; z = fpz[i]; }
+
+	//! Append the indices of the items in the collision index that may
+	//! overlap the z range [zmin, zmax] (inclusive) to indices.
+	//! This is a superset; callers still have to check the exact extents.
+	void getCollisionCandidates(sint32 zmin, sint32 zmax,
+								std::vector<unsigned int>& indices) const;
+
+	//! Number of items in the collision index
+	unsigned int getCollisionCount() const;
+
+	//! Changes whenever a solid item that isn't an actor is added to,
+	//! removed from or moved in the chunk. Used by the WalkGrid.
+	uint32 getWalkRevision() const { return walkrevision; }
+
+	enum {
+		COLLISION_BUCKET_HEIGHT = 16,
+		COLLISION_BUCKETS = 16
+	};
+
+private:
+	void insert(unsigned int i, Item* item);
+	void set(unsigned int i, Item* item);
+
+	void indexCollision(unsigned int i);
+	void unindexCollision(unsigned int i);
+	static unsigned int getCollisionBucket(sint32 z);
+
+	std::vector<Item*> items;
+
+	std::vector<sint32> locx, locy, locz;	//!< Item locations
+	std::vector<sint32> fpx, fpy, fpz;		//!< World footpads
+	std::vector<uint32> shapeflags;			//!< ShapeInfo::flags
+	std::vector<ObjId> objids;
+	std::vector<uint8> sprite;				//!< EXT_SPRITE set
+
+	//! Indices of the SI_SOLID/SI_DAMAGING/SI_ROOF items, by bottom z
+	std::vector<unsigned int> collision[COLLISION_BUCKETS];
+	sint32 maxheight;	//!< Tallest item ever indexed in this chunk
+
+	uint32 walkrevision;
+};
+
+#endif
@@ -48,7 +48,7 @@ void DestroyItemProcess::run()
 	if (item_num == 0) {
 		// need to get ObjId to use from process result. (We were apparently
 		// waiting for a process which returned the ObjId to delete.)
-		item_num = static_cast<ObjId>(result);
+		setItemNum(static_cast<ObjId>(result));
 	}
 
 	Item *it = getItem(item_num);
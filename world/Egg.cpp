@@ -43,6 +43,7 @@ uint16 Egg::hatch()
 {
 	if (hatched) return 0;
 	hatched = true;
+	setDirty();
 	return callUsecodeEvent_hatch();
 }
 
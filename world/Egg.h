@@ -35,8 +35,14 @@ public:
 	int getXRange() const { return (npcnum >> 4) & 0xF; }
 	int getYRange() const { return npcnum & 0xF; }
 
-	void setXRange(int r) { npcnum &= 0x0F; npcnum |= (r & 0xF) << 4; }
-	void setYRange(int r) { npcnum &= 0xF0; npcnum |= (r & 0xF); }
+	void setXRange(int r) {
+		setNpcNum(static_cast<uint16>((npcnum & 0x0F) | ((r & 0xF) << 4)));
+		updateCurrentMapEntry();
+	}
+	void setYRange(int r) {
+		setNpcNum(static_cast<uint16>((npcnum & 0xF0) | (r & 0xF)));
+		updateCurrentMapEntry();
+	}
 
 	//! hatch the egg
 	virtual uint16 hatch();
@@ -45,7 +51,7 @@ public:
 	virtual void leaveFastArea();
 
 	//! clear the 'hatched' flag
-	void reset() { hatched = false; }
+	void reset() { if (hatched) { hatched = false; setDirty(); } }
 
 	virtual void dumpInfo();
 
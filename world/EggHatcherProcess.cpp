@@ -22,14 +22,44 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Egg.h"
 #include "MainActor.h"
 #include "TeleportEgg.h"
+#include "World.h"
+#include "CurrentMap.h"
 #include "getObject.h"
 
 #include "IDataSource.h"
 #include "ODataSource.h"
 
+#include <algorithm>
+
 DEFINE_RUNTIME_CLASSTYPE_CODE(EggHatcherProcess,Process);
 
+// The area the avatar has to enter to hatch an egg
+static void getHatchArea(Egg* egg, sint32& x1, sint32& y1,
+						 sint32& x2, sint32& y2, sint32& z)
+{
+	sint32 x,y;
+	egg->getLocation(x,y,z);
+
+	//! constants
+	x1 = x - 32 * egg->getXRange();
+	x2 = x + 32 * egg->getXRange();
+	y1 = y - 32 * egg->getYRange();
+	y2 = y + 32 * egg->getYRange();
+}
+
+static inline sint32 chunkOf(sint32 c)
+{
+	if (c < 0) return 0;
+	return c / World::get_instance()->getCurrentMap()->getChunkSize();
+}
+
+static inline uint32 chunkKey(sint32 cx, sint32 cy)
+{
+	return (static_cast<uint32>(cx) << 16) | static_cast<uint32>(cy);
+}
+
 EggHatcherProcess::EggHatcherProcess()
+	: nextorder(0), runcount(0)
 {
 
 }
@@ -42,13 +72,78 @@ EggHatcherProcess::~EggHatcherProcess()
 
 void EggHatcherProcess::addEgg(uint16 egg)
 {
-	eggs.push_back(egg);
+	Egg* e = p_dynamic_cast<Egg*>(getObject(egg));
+	if (e) addEgg(e);
 }
 
 void EggHatcherProcess::addEgg(Egg* egg)
 {
 	assert(egg);
-	eggs.push_back(egg->getObjId());
+	ObjId id = egg->getObjId();
+
+	std::map<ObjId, EggEntry>::iterator it = eggs.find(id);
+	if (it != eggs.end() && it->second.egg == egg) {
+		// moved, so register it again
+		removeFromChunks(id, it->second);
+	} else {
+		if (it != eggs.end()) {
+			// an old egg with the same objID
+			removeFromChunks(id, it->second);
+			eggs.erase(it);
+		}
+
+		EggEntry entry;
+		entry.egg = egg;
+		entry.tegg = p_dynamic_cast<TeleportEgg*>(egg);
+		entry.order = nextorder++;
+		entry.lastrun = 0;
+		it = eggs.insert(std::make_pair(id, entry)).first;
+	}
+
+	EggEntry& entry = it->second;
+
+	sint32 x1,y1,x2,y2,z;
+	getHatchArea(egg, x1, y1, x2, y2, z);
+	entry.cx1 = chunkOf(x1);
+	entry.cy1 = chunkOf(y1);
+	entry.cx2 = chunkOf(x2);
+	entry.cy2 = chunkOf(y2);
+
+	for (sint32 cx = entry.cx1; cx <= entry.cx2; ++cx)
+		for (sint32 cy = entry.cy1; cy <= entry.cy2; ++cy)
+			chunks[chunkKey(cx, cy)].push_back(id);
+}
+
+void EggHatcherProcess::removeEgg(Egg* egg)
+{
+	assert(egg);
+	ObjId id = egg->getObjId();
+
+	std::map<ObjId, EggEntry>::iterator it = eggs.find(id);
+	if (it == eggs.end() || it->second.egg != egg) return;
+
+	removeFromChunks(id, it->second);
+	eggs.erase(it);
+}
+
+void EggHatcherProcess::removeFromChunks(ObjId id, const EggEntry& entry)
+{
+	for (sint32 cx = entry.cx1; cx <= entry.cx2; ++cx) {
+		for (sint32 cy = entry.cy1; cy <= entry.cy2; ++cy) {
+			std::map<uint32, std::vector<ObjId> >::iterator it;
+			it = chunks.find(chunkKey(cx, cy));
+			if (it == chunks.end()) continue;
+
+			std::vector<ObjId>& ids = it->second;
+			std::vector<ObjId>::iterator i;
+			i = std::find(ids.begin(), ids.end(), id);
+			if (i != ids.end()) {
+				*i = ids.back();
+				ids.pop_back();
+			}
+			if (ids.empty()) chunks.erase(it);
+		}
+	}
 }
 
 void EggHatcherProcess::run()
@@ -57,40 +152,67 @@ void EggHatcherProcess::run()
 	MainActor* av = getMainActor();
 	assert(av);
 
-	for (unsigned int i = 0; i < eggs.size(); i++) {
-		uint16 eggid = eggs[i];
-		Egg* egg = p_dynamic_cast<Egg*>(getObject(eggid));
-		if (!egg) continue; // egg gone
+	// get avatar location
+	sint32 ax,ay,az;
+	sint32 axs,ays,azs;
+	av->getLocation(ax,ay,az);
+	av->getFootpadWorld(axs,ays,azs);
+
+	runcount++;
+
+	// Find the eggs the avatar is in range of. Only the eggs registered
+	// in the chunks the avatar's footpad overlaps can be.
+	std::vector<std::pair<uint32, ObjId> > hatching;
+
+	for (sint32 cx = chunkOf(ax-axs); cx <= chunkOf(ax); ++cx) {
+		for (sint32 cy = chunkOf(ay-ays); cy <= chunkOf(ay); ++cy) {
+			std::map<uint32, std::vector<ObjId> >::iterator it;
+			it = chunks.find(chunkKey(cx, cy));
+			if (it == chunks.end()) continue;
+
+			const std::vector<ObjId>& ids = it->second;
+			for (unsigned int i = 0; i < ids.size(); ++i) {
+				std::map<ObjId, EggEntry>::iterator e = eggs.find(ids[i]);
+				if (e == eggs.end()) continue;
 
-		sint32 x,y,z;
-		egg->getLocation(x,y,z);
+				EggEntry& entry = e->second;
+				if (entry.lastrun == runcount) continue; // in another chunk
+				entry.lastrun = runcount;
 
-		//! constants
-		sint32 x1 = x - 32 * egg->getXRange();
-		sint32 x2 = x + 32 * egg->getXRange();
-		sint32 y1 = y - 32 * egg->getYRange();
-		sint32 y2 = y + 32 * egg->getYRange();
+				if (getObject(ids[i]) != entry.egg) continue; // egg gone
 
-		// get avatar location
-		sint32 ax,ay,az;
-		sint32 axs,ays,azs;
-		av->getLocation(ax,ay,az);
-		av->getFootpadWorld(axs,ays,azs);
+				sint32 x1,y1,x2,y2,z;
+				getHatchArea(entry.egg, x1, y1, x2, y2, z);
+
+				if (x1 <= ax && ax-axs < x2 && y1 <= ay && ay-ays < y2 &&
+					z - 48 < az && az <= z + 48) { // CONSTANTS!
+					if (entry.tegg && entry.tegg->isTeleporter())
+						nearteleporter = true;
+
+					hatching.push_back(std::make_pair(entry.order, ids[i]));
+				}
+			}
+		}
+	}
+
+	std::sort(hatching.begin(), hatching.end());
+
+	for (unsigned int i = 0; i < hatching.size(); ++i) {
+		std::map<ObjId, EggEntry>::iterator it;
+		it = eggs.find(hatching[i].second);
+		if (it == eggs.end()) continue;
+
+		// hatching an egg can teleport the avatar to another map
+		EggEntry& entry = it->second;
+		if (getObject(it->first) != entry.egg) continue;
 
 		// 'justTeleported':
 		// if the avatar teleports, set the 'justTeleported' flag.
 		// if this is set, don't hatch any teleport eggs
 		// unset it when you're out of range of any teleport eggs
-		TeleportEgg* tegg = p_dynamic_cast<TeleportEgg*>(egg);
-
-		if (x1 <= ax && ax-axs < x2 && y1 <= ay && ay-ays < y2 &&
-			z - 48 < az && az <= z + 48) { // CONSTANTS!
-			if (tegg && tegg->isTeleporter()) nearteleporter = true;
+		if (entry.tegg && av->hasJustTeleported()) continue;
 
-			if (tegg && av->hasJustTeleported()) continue;
-
-			egg->hatch();
-		}
+		entry.egg->hatch();
 	}
 
 	if (!nearteleporter) av->setJustTeleported(false); // clear flag
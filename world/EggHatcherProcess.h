@@ -21,10 +21,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Process.h"
 
+#include <map>
 #include <vector>
 
 class Egg;
+class TeleportEgg;
 
+//! Hatches the eggs in the CurrentMap when the avatar enters their range.
+//!
+//! The eggs are indexed by the map chunks their hatch areas overlap, so
+//! each tick only the eggs in the avatar's chunk have to be checked.
 class EggHatcherProcess : public Process
 {
 public:
@@ -36,14 +42,32 @@ public:
 
 	virtual void run();
 
+	//! Add an egg, or update it after it moved or its range changed
 	void addEgg(Egg* egg);
 	void addEgg(uint16 egg);
 
+	//! Remove an egg that was removed from the CurrentMap
+	void removeEgg(Egg* egg);
+
 	bool loadData(IDataSource* ids, uint32 version);
 private:
 	virtual void saveData(ODataSource* ods);
 
-	std::vector<uint16> eggs;
+	struct EggEntry
+	{
+		Egg* egg;
+		TeleportEgg* tegg;			//!< the egg if it's a TeleportEgg, or 0
+		uint32 order;				//!< eggs hatch in the order they're added
+		uint32 lastrun;				//!< the last run() that checked it
+		sint32 cx1, cy1, cx2, cy2;	//!< chunks its hatch area overlaps
+	};
+
+	void removeFromChunks(ObjId id, const EggEntry& entry);
+
+	std::map<ObjId, EggEntry> eggs;
+	std::map<uint32, std::vector<ObjId> > chunks;	//!< eggs by chunk
+	uint32 nextorder;
+	uint32 runcount;
 };
 
 
@@ -0,0 +1,252 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+#include "FixedItemCache.h"
+#include "IDataSource.h"
+#include "RawArchive.h"
+#include "GameData.h"
+
+FixedItemCache::FixedItemCache(unsigned int maxmaps_)
+	: maxmaps(maxmaps_), hits(0), misses(0), prefetched(0), evictions(0),
+	  thread(0), current(0), quit(false)
+{
+	mutex = SDL_CreateMutex();
+	jobcond = SDL_CreateCond();
+	idlecond = SDL_CreateCond();
+
+	thread = SDL_CreateThread(threadMain_Static, "FixedItemCache",
+							  static_cast<void*>(this));
+	if (!thread)
+		perr << "FixedItemCache: could not create thread: "
+			 << SDL_GetError() << std::endl;
+}
+
+FixedItemCache::~FixedItemCache()
+{
+	clear();
+
+	if (thread) {
+		SDL_mutexP(mutex);
+		quit = true;
+		SDL_CondSignal(jobcond);
+		SDL_mutexV(mutex);
+		SDL_WaitThread(thread, 0);
+	}
+
+	SDL_DestroyCond(idlecond);
+	SDL_DestroyCond(jobcond);
+	SDL_DestroyMutex(mutex);
+}
+
+const Map::ItemRecords& FixedItemCache::get(uint32 mapnum)
+{
+	collect();
+
+	// If it's still being prefetched, wait for it or take it over
+	if (requested.find(mapnum) != requested.end()) {
+		cancel(mapnum);
+		collect();
+	}
+
+	std::map<uint32, Entry>::iterator it = entries.find(mapnum);
+	if (it != entries.end()) {
+		hits++;
+		lru.splice(lru.begin(), lru, it->second.lru);
+		return *it->second.records;
+	}
+
+	misses++;
+
+	Job job;
+	job.mapnum = mapnum;
+	job.data = readRaw(mapnum, job.size);
+	decode(job);
+	add(mapnum, job.records);
+
+	return *job.records;
+}
+
+void FixedItemCache::prefetch(uint32 mapnum)
+{
+	if (!thread) return;
+	if (entries.find(mapnum) != entries.end()) return;
+	if (requested.find(mapnum) != requested.end()) return;
+
+	Job job;
+	job.mapnum = mapnum;
+	job.data = readRaw(mapnum, job.size);
+	job.records = 0;
+	if (!job.data) return;
+
+	SDL_mutexP(mutex);
+	queue.push_back(job);
+	SDL_CondSignal(jobcond);
+	SDL_mutexV(mutex);
+
+	requested.insert(mapnum);
+}
+
+void FixedItemCache::clear()
+{
+	SDL_mutexP(mutex);
+
+	std::list<Job>::iterator j;
+	for (j = queue.begin(); j != queue.end(); ++j)
+		delete [] j->data;
+	queue.clear();
+
+	while (current)
+		SDL_CondWait(idlecond, mutex);
+
+	for (j = done.begin(); j != done.end(); ++j)
+		delete j->records;
+	done.clear();
+
+	SDL_mutexV(mutex);
+
+	requested.clear();
+
+	while (!entries.empty())
+		remove(entries.begin());
+}
+
+void FixedItemCache::cancel(uint32 mapnum)
+{
+	SDL_mutexP(mutex);
+
+	std::list<Job>::iterator j;
+	for (j = queue.begin(); j != queue.end(); ) {
+		if (j->mapnum == mapnum) {
+			delete [] j->data;
+			j = queue.erase(j);
+			requested.erase(mapnum);
+		} else
+			++j;
+	}
+
+	// Nearly done, so wait for it instead of starting over
+	while (current && current->mapnum == mapnum)
+		SDL_CondWait(idlecond, mutex);
+
+	SDL_mutexV(mutex);
+}
+
+void FixedItemCache::collect()
+{
+	std::list<Job> finished;
+
+	SDL_mutexP(mutex);
+	finished.splice(finished.begin(), done);
+	SDL_mutexV(mutex);
+
+	std::list<Job>::iterator j;
+	for (j = finished.begin(); j != finished.end(); ++j) {
+		requested.erase(j->mapnum);
+		add(j->mapnum, j->records);
+		prefetched++;
+	}
+}
+
+void FixedItemCache::add(uint32 mapnum, Map::ItemRecords* records)
+{
+	std::map<uint32, Entry>::iterator it = entries.find(mapnum);
+	if (it != entries.end())
+		remove(it);
+
+	while (!entries.empty() && entries.size() >= maxmaps) {
+		remove(entries.find(lru.back()));
+		evictions++;
+	}
+
+	Entry entry;
+	entry.records = records;
+	entry.lru = lru.insert(lru.begin(), mapnum);
+	entries[mapnum] = entry;
+}
+
+void FixedItemCache::remove(std::map<uint32, Entry>::iterator it)
+{
+	lru.erase(it->second.lru);
+	delete it->second.records;
+	entries.erase(it);
+}
+
+uint8* FixedItemCache::readRaw(uint32 mapnum, uint32& size)
+{
+	size = 0;
+
+	RawArchive* fixed = GameData::get_instance()->getFixed();
+	if (!fixed) return 0;
+
+	size = fixed->get_size(mapnum);
+	if (size == 0) return 0;
+
+	return fixed->get_object(mapnum);
+}
+
+void FixedItemCache::decode(Job& job)
+{
+	job.records = new Map::ItemRecords;
+
+	if (job.data) {
+		IBufferDataSource ds(job.data, job.size);
+		Map::decodeFixedFormat(&ds, *job.records);
+		delete [] job.data;
+		job.data = 0;
+	}
+}
+
+int SDLCALL FixedItemCache::threadMain_Static(void* data)
+{
+	static_cast<FixedItemCache*>(data)->threadMain();
+	return 0;
+}
+
+void FixedItemCache::threadMain()
+{
+	SDL_mutexP(mutex);
+	while (!quit) {
+		if (queue.empty()) {
+			SDL_CondWait(jobcond, mutex);
+			continue;
+		}
+
+		Job job = queue.front();
+		queue.pop_front();
+		current = &job;
+		SDL_mutexV(mutex);
+
+		decode(job);
+
+		SDL_mutexP(mutex);
+		current = 0;
+		done.push_back(job);
+		SDL_CondBroadcast(idlecond);
+	}
+	SDL_mutexV(mutex);
+}
+
+void FixedItemCache::printStats()
+{
+	pout << "Fixed cache: " << entries.size() << "/" << maxmaps
+		 << " maps, " << requested.size() << " prefetching" << std::endl;
+	pout << "Fixed hits : " << hits << ", misses " << misses
+		 << ", prefetched " << prefetched << ", evictions " << evictions
+		 << std::endl;
+}
@@ -0,0 +1,104 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef FIXEDITEMCACHE_H
+#define FIXEDITEMCACHE_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include "Map.h"
+
+//! An LRU cache of the decoded fixed item records of recently used maps,
+//! so World::switchMap doesn't have to read and decode fixed.dat again.
+//!
+//! Maps that are likely to be entered next (the destinations of the
+//! current map's teleport eggs) can be prefetched: they're decoded on a
+//! background thread. The items themselves are still created on the main
+//! thread when the map is loaded.
+class FixedItemCache
+{
+public:
+	//! \param maxmaps maximum number of maps kept decoded
+	explicit FixedItemCache(unsigned int maxmaps);
+	~FixedItemCache();
+
+	//! Get the decoded fixed items of a map, decoding them now if they
+	//! aren't cached. The records stay valid until the next call.
+	const Map::ItemRecords& get(uint32 mapnum);
+
+	//! Queue a map to be decoded on the background thread
+	void prefetch(uint32 mapnum);
+
+	//! Forget all maps (and cancel any prefetches)
+	void clear();
+
+	//! Output some statistics
+	void printStats();
+
+private:
+	struct Job
+	{
+		uint32 mapnum;
+		uint8* data;
+		uint32 size;
+		Map::ItemRecords* records;
+	};
+
+	struct Entry
+	{
+		Map::ItemRecords* records;
+		std::list<uint32>::iterator lru;
+	};
+
+	//! Read the raw fixed items of a map from fixed.dat. Delete afterwards.
+	static uint8* readRaw(uint32 mapnum, uint32& size);
+	static void decode(Job& job);
+
+	static int SDLCALL threadMain_Static(void* data);
+	void threadMain();
+
+	//! Move the maps the decoder is done with into the cache
+	void collect();
+	//! Stop decoding a map, if it's queued or being decoded
+	void cancel(uint32 mapnum);
+	void add(uint32 mapnum, Map::ItemRecords* records);
+	void remove(std::map<uint32, Entry>::iterator it);
+
+	std::list<uint32> lru;			//!< most recently used first
+	std::map<uint32, Entry> entries;
+	std::set<uint32> requested;		//!< queued or being decoded
+
+	unsigned int maxmaps;
+	uint32 hits, misses, prefetched, evictions;
+
+	// Shared with the decoder thread, guarded by mutex
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* jobcond;			//!< signalled when a job is queued
+	SDL_cond* idlecond;			//!< signalled when a job is done
+	std::list<Job> queue;
+	std::list<Job> done;
+	Job* current;				//!< the job being decoded, or 0
+	bool quit;
+};
+
+#endif
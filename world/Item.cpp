@@ -129,11 +129,41 @@ Item* Item::getTopItem()
 	return parent;
 }
 
+void Item::setDirty()
+{
+	if (dirty) return;
+	dirty = true;
+
+	// A Container is saved with its contents, so it changes as well.
+	// (Items without an objID aren't saved separately, so don't bother.)
+	if (parent && objid != 0xFFFF) {
+		Container* p = getContainer(parent);
+		if (p) p->setDirty();
+	}
+}
+
 void Item::setLocation(sint32 X, sint32 Y, sint32 Z)
 {
 	x = X;
 	y = Y;
 	z = Z;
+	setDirty();
+}
+
+void Item::setShape(uint32 shape_)
+{
+	if (shape != shape_) setDirty();
+	shape = shape_;
+	cachedShapeInfo = 0;
+	cachedShape = 0;
+
+	updateCurrentMapEntry();
+}
+
+void Item::updateCurrentMapEntry()
+{
+	if (extendedflags & EXT_INCURMAP)
+		World::get_instance()->getCurrentMap()->updateItem(this);
 }
 
 void Item::move(sint32 X, sint32 Y, sint32 Z)
@@ -189,6 +219,7 @@ void Item::move(sint32 X, sint32 Y, sint32 Z)
 	x = X;
 	y = Y;
 	z = Z;
+	setDirty();
 
 	// Add it to the map if needed
 	if (!(extendedflags & EXT_INCURMAP))
@@ -200,6 +231,11 @@ void Item::move(sint32 X, sint32 Y, sint32 Z)
 		else
 			map->addItem(this);
 	}
+	else
+	{
+		// Still in the same chunk; only the location changed
+		map->updateItem(this);
+	}
 
 	// Call just moved
 	callUsecodeEvent_justMoved();
@@ -299,6 +335,7 @@ bool Item::moveToContainer(Container *container, bool checkwghtvol)
 
 	// Set us contained
 	flags |= FLG_CONTAINED;
+	setDirty();
 
 	// If moving to avatar, mark as OWNED
 	Item *p = this;
@@ -354,6 +391,7 @@ void Item::moveToEtherealVoid()
 
 	// Set the ETHEREAL Flag
 	flags |=  FLG_ETHEREAL;
+	setDirty();
 }
 
 void Item::returnFromEtherealVoid()
@@ -433,6 +471,7 @@ void Item::setGumpLocation(sint32 X, sint32 Y)
 	if (!parent) return;
 
 	y = (X & 0xFF) + ((Y & 0xFF) << 8);
+	setDirty();
 }
 
 void Item::randomGumpLocation()
@@ -442,6 +481,7 @@ void Item::randomGumpLocation()
 	// This sets the coordinates to (255,255) and lets the ContainerGump
 	// randomize the position when it is next opened.
 	y = 0xFFFF;
+	setDirty();
 }
 
 void Item::getCentre(sint32& X, sint32& Y, sint32& Z) const
@@ -1236,7 +1276,10 @@ void Item::setupLerp(sint32 gametick)
 	last_setup = gametick;
 
 	// Clear the flag
-	extendedflags &= ~EXT_LERP_NOPREV;
+	if (extendedflags & EXT_LERP_NOPREV) {
+		extendedflags &= ~EXT_LERP_NOPREV;
+		setDirty();
+	}
 
 	// Animate it, if needed
 	if ((gametick%3) == (objid%3)) animateItem();
@@ -1272,6 +1315,7 @@ void Item::animateItem()
 
 	int anim_data = info->animdata; 
 	bool dirty = false;
+	uint32 oldframe = frame;
 
 	if ((static_cast<int>(last_setup)%6) != (objid%6) && info->animtype != 1)
 		return;
@@ -1328,6 +1372,8 @@ void Item::animateItem()
 		pout << "type " << info->animtype << " data " << anim_data <<std::endl;
 		break;
 	}
+
+	if (frame != oldframe) setDirty();
 	//return dirty;
 }
 
@@ -1350,7 +1396,10 @@ void Item::enterFastArea()
 	}
 
 	// We're fast!
-	flags |= FLG_FASTAREA;
+	if (!(flags & FLG_FASTAREA)) {
+		flags |= FLG_FASTAREA;
+		setDirty();
+	}
 }
 
 // Called when an item is leaving the fast area
@@ -1369,7 +1418,10 @@ void Item::leaveFastArea()
 	}
 
 	// Unset the flag
-	flags &= ~FLG_FASTAREA;
+	if (flags & FLG_FASTAREA) {
+		flags &= ~FLG_FASTAREA;
+		setDirty();
+	}
 
 	// CHECKME: what do we need to do exactly?
 	// currently,  destroy object
@@ -1390,7 +1442,7 @@ void Item::leaveFastArea()
 		Process *p = Kernel::get_instance()->getProcess(gravitypid);
 		if (p) { 
 			p->terminateDeferred();
-			gravitypid = 0;
+			setGravityPID(0);
 			collideMove(x,y,0,true,false);
 		}
 	}
@@ -1419,6 +1471,7 @@ uint16 Item::openGump(uint32 gumpshape)
 	cgump->InitGump(0);
 	flags |= FLG_GUMP_OPEN;
 	gump = cgump->getObjId();
+	setDirty();
 
 	return gump;
 }
@@ -1439,8 +1492,11 @@ void Item::closeGump()
 
 void Item::clearGump()
 {
+	if (gump == 0 && !(flags & FLG_GUMP_OPEN)) return;
+
 	gump = 0;
 	flags &= ~FLG_GUMP_OPEN;
+	setDirty();
 }
 
 sint32 Item::ascend(int delta)
@@ -2206,7 +2262,7 @@ uint32 Item::I_orStatus(const uint8* args, unsigned int /*argsize*/)
 	ARG_UINT16(mask);
 	if (!item) return 0;
 
-	item->flags |= mask;
+	item->setFlag(mask);
 	return 0;
 }
 
@@ -2216,7 +2272,7 @@ uint32 Item::I_andStatus(const uint8* args, unsigned int /*argsize*/)
 	ARG_UINT16(mask);
 	if (!item) return 0;
 
-	item->flags &= mask;
+	item->clearFlag(static_cast<uint16>(~mask));
 	return 0;
 }
 
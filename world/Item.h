@@ -46,11 +46,17 @@ public:
 	ObjId getParent() const { return parent; }
 
 	//! Set the parent container of this item.
-	void setParent(ObjId p) { parent = p; }
+	void setParent(ObjId p) { if (parent != p) { parent = p; setDirty(); } }
 
 	//! Get the Container this Item is in, if any. (NULL if not in a Container)
 	Container *getParentAsContainer() const;
 
+	//! Mark this Item, and the Container it is in, as changed
+	virtual void setDirty();
+
+	//! Items mark themselves dirty whenever their saved state changes
+	virtual bool tracksDirty() const { return true; }
+
 	//! Get the top-most Container this Item is in, or the Item itself if not
 	//! in a container
 	Item* getTopItem();
@@ -90,7 +96,7 @@ public:
 	sint32 getZ() const;
 
 	//! Set this Item's Z coordinate
-	void setZ(sint32 z_) { z = z_; }
+	void setZ(sint32 z_) { if (z != z_) { z = z_; setDirty(); } }
 
 	//! Get this Item's location in a ContainerGump. Undefined if the Item 
 	//! is not in a Container.
@@ -123,43 +129,57 @@ public:
 	inline uint16 getFlags() const { return flags; }
 
 	//! Set the flags set in the given mask.
-	void setFlag(uint32 mask) { flags |= mask; }
+	void setFlag(uint32 mask) {
+		if ((flags | mask) != flags) { flags |= mask; setDirty(); }
+		if (mask & FLG_FLIPPED) updateCurrentMapEntry();
+	}
 
 	virtual void setFlagRecursively(uint32 mask) { setFlag(mask); }
 
 	//! Clear the flags set in the given mask.
-	void clearFlag(uint32 mask) { flags &= ~mask; }
+	void clearFlag(uint32 mask) {
+		if (flags & mask) { flags &= ~mask; setDirty(); }
+		if (mask & FLG_FLIPPED) updateCurrentMapEntry();
+	}
 
 	//! Set extendedflags
-	void setExtFlags(uint32 f) { extendedflags = f; }
+	void setExtFlags(uint32 f)
+		{ if (extendedflags != f) { extendedflags = f; setDirty(); } }
 
 	//! Get extendedflags
 	inline uint32 getExtFlags() const { return extendedflags; }
 
 	//! Set the extendedflags set in the given mask.
-	void setExtFlag(uint32 mask) { extendedflags |= mask; }
+	void setExtFlag(uint32 mask) {
+		if ((extendedflags | mask) != extendedflags) {
+			extendedflags |= mask;
+			setDirty();
+		}
+	}
 
 	//! Clear the extendedflags set in the given mask.
-	void clearExtFlag(uint32 mask) { extendedflags &= ~mask; }
+	void clearExtFlag(uint32 mask)
+		{ if (extendedflags & mask) { extendedflags &= ~mask; setDirty(); } }
 
 	//! Get this Item's shape number
 	uint32 getShape() const { return shape; }
 
 	//! Set this Item's shape number
-	void setShape(uint32 shape_)
-		{ shape = shape_; cachedShapeInfo = 0; cachedShape = 0; }
+	void setShape(uint32 shape_);
 
 	//! Get this Item's frame number
 	uint32 getFrame() const { return frame; }
 
 	//! Set this Item's frame number
-	void setFrame(uint32 frame_) { frame = frame_; }
+	void setFrame(uint32 frame_)
+		{ if (frame != frame_) { frame = frame_; setDirty(); } }
 
 	//! Get this Item's quality (a.k.a. 'Q')
 	uint16 getQuality() const { return quality; }
 
 	//! Set this Item's quality (a.k.a 'Q');
-	void setQuality(uint16 quality_) { quality = quality_; }
+	void setQuality(uint16 quality_)
+		{ if (quality != quality_) { quality = quality_; setDirty(); } }
 
 	//! Get the 'NpcNum' of this Item. Note that this can represent various
 	//! things depending on the family of this Item.
@@ -167,7 +187,8 @@ public:
 
 	//! Set the 'NpcNum' of this Item. Note that this can represent various
 	//! things depending on the family of this Item.
-	void setNpcNum(uint16 npcnum_) { npcnum = npcnum_; }
+	void setNpcNum(uint16 npcnum_)
+		{ if (npcnum != npcnum_) { npcnum = npcnum_; setDirty(); } }
 
 	//! Get the 'MapNum' of this Item. Note that this can represent various
 	//! things depending on the family of this Item.
@@ -175,7 +196,8 @@ public:
 
 	//! Set the 'NpcNum' of this Item. Note that this can represent various
 	//! things depending on the family of this Item.
-	void setMapNum(uint16 mapnum_) { mapnum = mapnum_; }
+	void setMapNum(uint16 mapnum_)
+		{ if (mapnum != mapnum_) { mapnum = mapnum_; setDirty(); } }
 
 	//! Get the ShapeInfo object for this Item. (The pointer will be cached.)
 	inline ShapeInfo* getShapeInfo() const;
@@ -272,7 +294,8 @@ public:
 	void hurl(int xs, int ys, int zs, int grav);
 
 	//! Set the PID of the GravityProcess for this Item
-	void setGravityPID(ProcId pid) { gravitypid = pid; }
+	void setGravityPID(ProcId pid)
+		{ if (gravitypid != pid) { gravitypid = pid; setDirty(); } }
 
 	//! Get the PID of the GravityProcess for this Item (or 0)
 	ProcId getGravityPID() const { return gravitypid; }
@@ -511,6 +534,11 @@ protected:
 	//! save the actual Item data 
 	virtual void saveData(ODataSource* ods);
 
+	//! Refresh the data the CurrentMap keeps about this item, if it is in
+	//! the CurrentMap. Call after changing location, shape or FLG_FLIPPED
+	//! (or an Egg's range).
+	void updateCurrentMapEntry();
+
 private:
 
 	//! Call a Usecode Event. Use the separate functions instead!
@@ -27,11 +27,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "RenderSurface.h"
 #include "Rect.h"
 #include "GameData.h"
+#include "ShapeCache.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
 
 // temp
 #include "WeaponOverlay.h"
 #include "MainActor.h"
 #include "getObject.h"
+#include "Profiler.h"
 // --
 
 using Pentagram::Rect;
@@ -39,7 +44,8 @@ using Pentagram::Rect;
 // This does NOT need to be in the header
 struct SortItem
 {
-	SortItem(SortItem *n) : next(n), prev(0), item_num(0), shape(0), order(-1), depends() { }
+	SortItem(SortItem *n) : next(n), prev(0), item_num(0), shape(0), order(-1),
+		add_order(0), visit(0), cache(0), depends() { }
 
 	SortItem				*next;
 	SortItem				*prev;
@@ -104,6 +110,12 @@ struct SortItem
 
 	sint32	order;		// Rendering order. -1 is not yet drawn
 
+	uint32	add_order;	// Order in which this was added to the display list
+	uint32	visit;		// add_order of the last item that compared against us
+
+	SortCacheEntry	*cache;	// Cached comparisons. 0 if not cachable
+	bool	unchanged;		// Same position, shape and flags as last list
+
 	// Note that std::priority_queue could be used here, BUT there is no guarentee that it's implementation
 	// will be friendly to insertions
 	// Alternatively i could use std::list, BUT there is no guarentee that it will keep wont delete
@@ -226,6 +238,49 @@ struct SortItem
 
 };
 
+// Display list order. Items that are equal by ListLessThan keep the order
+// in which they were added.
+struct SortItemListOrder
+{
+	bool operator()(const SortItem *si1, const SortItem *si2) const
+	{
+		if (si1->ListLessThan(si2)) return true;
+		if (si2->ListLessThan(si1)) return false;
+		return si1->add_order < si2->add_order;
+	}
+};
+
+// The result of comparing an item against one added before it. If neither
+// item changed since the last display list the result will be the same, so
+// it is kept per objid between frames.
+struct SortCacheEntry
+{
+	enum {
+		BEHIND = 1,			// We are behind the other item
+		OCCLUDED = 2		// The item in front occludes the other
+	};
+
+	struct Result {
+		uint16	other;		// objid of the item we were compared against
+		uint8	result;		// BEHIND | OCCLUDED
+	};
+
+	uint32	serial;			// display_serial this was last updated in
+	sint32	x, y, z;
+	uint32	shape_num;
+	uint32	frame;
+	uint32	flags;
+	uint32	ext_flags;
+
+	std::vector<Result>	prev;	// Results from the previous display list
+	std::vector<Result>	cur;	// Results from the current display list
+
+	SortCacheEntry() : serial(0) { }
+};
+
+// Screenspace size of an ItemSorter bin
+static const sint32 SORT_BIN_SIZE = 64;
+
 // Check to see if we overlap si2
 inline bool SortItem::overlap(const SortItem &si2) const
 {
@@ -596,10 +651,16 @@ inline bool SortItem::operator<<(const SortItem& si2) const
 //
 
 ItemSorter::ItemSorter() : 
-		shapes(0), surf(0), items(0), items_tail(0), items_unused(0), sort_limit(0)
+		shapes(0), surf(0), items(0), items_tail(0), items_unused(0), sort_limit(0),
+		items_sorted(true), add_counter(0), display_serial(0),
+		bins_x(0), bins_y(0), bins_w(0), bins_h(0),
+		overlay_shape(0), overlay_frame(0), overlay_xoff(0), overlay_yoff(0),
+		paint_pool(0)
 {
 	int i = 2048;
 	while (i--) items_unused = new SortItem(items_unused);
+
+	std::memset(&stats, 0, sizeof(stats));
 }
 
 ItemSorter::~ItemSorter()
@@ -619,6 +680,11 @@ ItemSorter::~ItemSorter()
 		items_unused = next;
 	}
 
+	for (unsigned int i = 0; i < sort_cache.size(); ++i)
+		delete sort_cache[i];
+
+	delete paint_pool;
+
 	delete [] items;
 }
 
@@ -639,11 +705,32 @@ void ItemSorter::BeginDisplayList(RenderSurface *rs,
 	// Set the RenderSurface, and reset the item list
 	surf = rs;
 	order_counter = 0;
+	items_sorted = true;
+	add_counter = 0;
+	display_serial++;
+	std::memset(&stats, 0, sizeof(stats));
 
 	// Screenspace bounding box bottom x coord (RNB x coord)
 	cam_sx = (camx - camy)/4;
 	// Screenspace bounding box bottom extent  (RNB y coord)
 	cam_sy = (camx + camy)/8 - camz;
+
+	// Cover the clipping rect with bins. Items outside of it get put in
+	// the edge bins, which is fine since that never separates two items
+	// that overlap.
+	Rect clip;
+	surf->GetClippingRect(clip);
+	bins_x = clip.x;
+	bins_y = clip.y;
+	bins_w = (clip.w + SORT_BIN_SIZE - 1) / SORT_BIN_SIZE;
+	bins_h = (clip.h + SORT_BIN_SIZE - 1) / SORT_BIN_SIZE;
+	if (bins_w < 1) bins_w = 1;
+	if (bins_h < 1) bins_h = 1;
+
+	if (bins.size() < static_cast<unsigned int>(bins_w * bins_h))
+		bins.resize(bins_w * bins_h);
+	for (unsigned int i = 0; i < bins.size(); ++i)
+		bins[i].clear();
 }
 
 void ItemSorter::AddItem(sint32 x, sint32 y, sint32 z, uint32 shape_num, uint32 frame_num, uint32 flags, uint32 ext_flags, uint16 item_num)
@@ -761,69 +848,7 @@ void ItemSorter::AddItem(sint32 x, sint32 y, sint32 z, uint32 shape_num, uint32
 	si->occluded = false;
 	si->order = -1;
 
-	// We will clear all the vector memory
-	// Stictly speaking the vector will sort of leak memory, since they
-	// are never deleted
-	si->depends.clear();
-	//si->depends.erase(si->depends.begin(), si->depends.end());	// MSVC.Netism
-
-	// Iterate the list and compare shapes
-
-	// Ok, 
-	SortItem *addpoint = 0;
-	for (SortItem * si2 = items; si2 != 0; si2 = si2->next)
-	{
-		// Get the insert point... which is before the first item that has higher z than us
-		if (!addpoint && si->ListLessThan(si2)) addpoint = si2;
-
-		// Doesn't overlap
-		if (si2->occluded || !si->overlap(*si2)) continue;
-
-		// Attempt to find which is infront
-		if (*si < *si2)
-		{
-			// si2 occludes si (us)
-			if (si2->occl && si2->occludes(*si))
-			{
-				// No need to do any more checks, this isn't visible
-				si->occluded = true;
-				break;
-			}
-
-			// si1 is behind si2, so add it to si2's dependency list
-			si2->depends.insert_sorted(si);
-		}
-		else
-		{
-			// ss occludes si2. Sadly, we can't remove it from the list.
-			if (si->occl && si->occludes(*si2)) si2->occluded = true;
-			// si2 is behind si1, so add it to si1's dependency list
-			else si->depends.push_back(si2);
-		}
-	}
-
-	// Add it to the list
-	items_unused = items_unused->next;
-
-	// have a position
-	//addpoint = 0;
-	if (addpoint)
-	{
-		si->next = addpoint;
-		si->prev = addpoint->prev;
-		addpoint->prev = si;
-		if (si->prev) si->prev->next = si;
-		else items = si;
-	}
-	// Add it to the end of the list
-	else 
-	{
-		if (items_tail) items_tail->next = si;
-		if (!items) items = si;
-		si->next = 0;
-		si->prev = items_tail;
-		items_tail = si;
-	}
+	AddSortItem(si);
 }
 
 void ItemSorter::AddItem(Item *add)
@@ -949,29 +974,148 @@ void ItemSorter::AddItem(Item *add)
 	si->occluded = false;
 	si->order = -1;
 
+	AddSortItem(si);
+#endif
+}
+
+void ItemSorter::AddSortItem(SortItem *si)
+{
 	// We will clear all the vector memory
 	// Stictly speaking the vector will sort of leak memory, since they
 	// are never deleted
 	si->depends.clear();
 	//si->depends.erase(si->depends.begin(), si->depends.end());	// MSVC.Netism
 
-	// Iterate the list and compare shapes
+	si->add_order = ++add_counter;
+	si->visit = 0;
+	stats.items++;
 
-	// Ok, 
-	SortItem *addpoint = 0;
-	for (SortItem * si2 = items; si2 != 0; si2 = si2->next)
+	// See if we can use the comparisons made in the previous display list
+	si->cache = 0;
+	si->unchanged = false;
+	if (si->item_num)
 	{
-		// Get the insert point... which is before the first item that has higher z than us
-		if (!addpoint && si->ListLessThan(si2)) addpoint = si2;
+		if (sort_cache.size() <= si->item_num)
+			sort_cache.resize(si->item_num + 1, 0);
+		SortCacheEntry *entry = sort_cache[si->item_num];
+		if (!entry) entry = sort_cache[si->item_num] = new SortCacheEntry;
+
+		// The same objid twice in one list (shouldn't happen) isn't cached
+		if (entry->serial != display_serial)
+		{
+			si->unchanged = entry->serial == display_serial - 1 &&
+				entry->x == si->x && entry->y == si->y && entry->z == si->z &&
+				entry->shape_num == si->shape_num &&
+				entry->frame == si->frame && entry->flags == si->flags &&
+				entry->ext_flags == si->ext_flags;
+
+			entry->prev.swap(entry->cur);
+			entry->cur.clear();
+			if (!si->unchanged) entry->prev.clear();
+
+			entry->serial = display_serial;
+			entry->x = si->x;
+			entry->y = si->y;
+			entry->z = si->z;
+			entry->shape_num = si->shape_num;
+			entry->frame = si->frame;
+			entry->flags = si->flags;
+			entry->ext_flags = si->ext_flags;
+			si->cache = entry;
+		}
+	}
+
+	// Find the bins our screenspace bounding box covers. overlap() can't be
+	// true for items whose boxes don't intersect.
+	sint32 bx1 = (si->sxleft - bins_x) / SORT_BIN_SIZE;
+	sint32 bx2 = (si->sxright - bins_x) / SORT_BIN_SIZE;
+	sint32 by1 = (si->sytop - bins_y) / SORT_BIN_SIZE;
+	sint32 by2 = (si->sybot - bins_y) / SORT_BIN_SIZE;
+	if (bx1 < 0) bx1 = 0; else if (bx1 >= bins_w) bx1 = bins_w - 1;
+	if (bx2 < 0) bx2 = 0; else if (bx2 >= bins_w) bx2 = bins_w - 1;
+	if (by1 < 0) by1 = 0; else if (by1 >= bins_h) by1 = bins_h - 1;
+	if (by2 < 0) by2 = 0; else if (by2 >= bins_h) by2 = bins_h - 1;
+
+	// Gather the items sharing a bin with us, each once
+	candidates.clear();
+	for (sint32 by = by1; by <= by2; ++by)
+	{
+		for (sint32 bx = bx1; bx <= bx2; ++bx)
+		{
+			std::vector<SortItem *> &bin = bins[by * bins_w + bx];
+			std::vector<SortItem *>::iterator it;
+			for (it = bin.begin(); it != bin.end(); ++it)
+			{
+				if ((*it)->visit == si->add_order) continue;
+				(*it)->visit = si->add_order;
+				candidates.push_back(*it);
+			}
+		}
+	}
+
+	// Compare them in display list order, the same order as a walk of the
+	// whole list would, so dependencies and occlusion come out the same
+	std::sort(candidates.begin(), candidates.end(), SortItemListOrder());
+
+	// Iterate the candidates and compare shapes
+	std::vector<SortItem *>::iterator cit;
+	for (cit = candidates.begin(); cit != candidates.end(); ++cit)
+	{
+		SortItem *si2 = *cit;
 
 		// Doesn't overlap
-		if (si2->occluded || !si->overlap(*si2)) continue;
+		if (si2->occluded) continue;
+		stats.overlap_tests++;
+		if (!si->overlap(*si2)) continue;
 
 		// Attempt to find which is infront
-		if (*si < *si2)
+		int result = -1;
+		if (si->unchanged && si2->unchanged)
+		{
+			std::vector<SortCacheEntry::Result> &prev = si->cache->prev;
+			for (unsigned int i = 0; i < prev.size(); ++i)
+			{
+				if (prev[i].other == si2->item_num)
+				{
+					result = prev[i].result;
+					break;
+				}
+			}
+		}
+
+		if (result >= 0)
+		{
+			stats.reused++;
+		}
+		else
 		{
-			// si2 occludes ss
-			if (si2->occl && si2->occludes(*si))
+			stats.comparisons++;
+			if (*si < *si2)
+			{
+				result = SortCacheEntry::BEHIND;
+				if (si2->occl && si2->occludes(*si))
+					result |= SortCacheEntry::OCCLUDED;
+			}
+			else
+			{
+				result = 0;
+				if (si->occl && si->occludes(*si2))
+					result |= SortCacheEntry::OCCLUDED;
+			}
+		}
+
+		if (si->cache && si2->item_num)
+		{
+			SortCacheEntry::Result r;
+			r.other = si2->item_num;
+			r.result = static_cast<uint8>(result);
+			si->cache->cur.push_back(r);
+		}
+
+		if (result & SortCacheEntry::BEHIND)
+		{
+			// si2 occludes si (us)
+			if (result & SortCacheEntry::OCCLUDED)
 			{
 				// No need to do any more checks, this isn't visible
 				si->occluded = true;
@@ -984,74 +1128,112 @@ void ItemSorter::AddItem(Item *add)
 		else
 		{
 			// ss occludes si2. Sadly, we can't remove it from the list.
-			if (si->occl && si->occludes(*si2)) si2->occluded = true;
+			if (result & SortCacheEntry::OCCLUDED) si2->occluded = true;
 			// si2 is behind si1, so add it to si1's dependency list
 			else si->depends.push_back(si2);
 		}
 	}
 
+	// Occluded items are skipped by everything after us, so only bin
+	// the visible ones
+	if (!si->occluded)
+	{
+		for (sint32 by = by1; by <= by2; ++by)
+			for (sint32 bx = bx1; bx <= bx2; ++bx)
+				bins[by * bins_w + bx].push_back(si);
+	}
+
 	// Add it to the list
 	items_unused = items_unused->next;
 
-	// have a position
-	//addpoint = 0;
-	if (addpoint)
-	{
-		si->next = addpoint;
-		si->prev = addpoint->prev;
-		addpoint->prev = si;
-		if (si->prev) si->prev->next = si;
-		else items = si;
+	// Add it to the end of the list. It's put in order by SortDisplayList
+	if (items_tail) {
+		items_tail->next = si;
+		if (si->ListLessThan(items_tail)) items_sorted = false;
 	}
-	// Add it to the end of the list
-	else 
+	if (!items) items = si;
+	si->next = 0;
+	si->prev = items_tail;
+	items_tail = si;
+}
+
+void ItemSorter::SortDisplayList()
+{
+	if (items_sorted) return;
+
+	Profiler::Scope sortscope(Profiler::SORT);
+
+	candidates.clear();
+	for (SortItem *si = items; si != 0; si = si->next)
+		candidates.push_back(si);
+
+	std::sort(candidates.begin(), candidates.end(), SortItemListOrder());
+
+	SortItem *last = 0;
+	std::vector<SortItem *>::iterator it;
+	for (it = candidates.begin(); it != candidates.end(); ++it)
 	{
-		if (items_tail) items_tail->next = si;
-		if (!items) items = si;
-		si->next = 0;
-		si->prev = items_tail;
-		items_tail = si;
+		(*it)->prev = last;
+		(*it)->next = 0;
+		if (last) last->next = *it;
+		else items = *it;
+		last = *it;
 	}
-#endif
+	items_tail = last;
+
+	items_sorted = true;
 }
 
 SortItem *prev = 0;
 
+// Paints the display list in one horizontal band of the surface
+class ItemSorter::PaintBandJob : public WorkerPool::Job
+{
+public:
+	PaintBandJob(ItemSorter* sorter_, RenderSurface* surf_,
+				 sint32 top_, sint32 bottom_, bool item_highlight_)
+		: sorter(sorter_), surf(surf_), top(top_), bottom(bottom_),
+		  item_highlight(item_highlight_) { }
+
+	virtual void run() {
+		sorter->PaintItems(surf, true, top, bottom, item_highlight);
+	}
+
+private:
+	ItemSorter* sorter;
+	RenderSurface* surf;
+	sint32 top, bottom;
+	bool item_highlight;
+};
+
 void ItemSorter::PaintDisplayList(bool item_highlight)
 {
+	SortDisplayList();
+
+	// Work out the painting order first
 	prev = 0;
+	paint_list.clear();
+	overlay_shape = 0;
 	SortItem *it = items;
 	SortItem *end = 0;
 	order_counter = 0;	// Reset the order_counter
 	while (it != end)
 	{
-		if (it->order == -1) if (PaintSortItem(it)) return;
+		// Stopped at the sort limit. Don't do item highlighting either.
+		if (it->order == -1) if (OrderSortItem(it)) {
+			item_highlight = false;
+			break;
+		}
 		it = it->next;
 	}
 
-	// Item highlighting. We redraw each 'item' transparent
-	if (item_highlight)
-	{
-		it = items;
-		while (it != end)
-		{
-			if (!(it->flags & (Item::FLG_DISPOSABLE|Item::FLG_FAST_ONLY)) && !it->fixed )
-			{
-				surf->PaintHighlightInvis(it->shape, 
-						it->frame, 
-						it->sxbot, 
-						it->sybot, 
-						it->trans, 
-						(it->flags&Item::FLG_FLIPPED)!=0, 0x1f00ffff);
-			}
-
-			it = it->next;
-		}
+	if (paint_pool && !sort_limit && PaintParallel(item_highlight))
+		return;
 
-	}
+	PaintItems(surf, false, 0, 0, item_highlight);
 }
 
-bool ItemSorter::PaintSortItem(SortItem	*si)
+bool ItemSorter::OrderSortItem(SortItem	*si)
 {
 	// Don't paint this, or dependencies if occluded
 	if (si->occluded) return false;
@@ -1067,7 +1249,7 @@ bool ItemSorter::PaintSortItem(SortItem	*si)
 		// Well, it can't. Implies infinite recursive sorting.
 		//if ((*it)->order == -2) CANT_HAPPEN_MSG("Detected cycle in the dependency graph");
 
-		if ((*it)->order == -1) if (PaintSortItem((*it))) return true;
+		if ((*it)->order == -1) if (OrderSortItem((*it))) return true;
 
 		++it;
 	}
@@ -1076,26 +1258,7 @@ bool ItemSorter::PaintSortItem(SortItem	*si)
 	si->order = order_counter;
 	order_counter++;
 
-	// Now paint us!
-
-//	if (wire) si->info->draw_box_back(s, dispx, dispy, 255);
-
-	if (si->ext_flags & Item::EXT_HIGHLIGHT && si->ext_flags & Item::EXT_TRANSPARENT)
-		surf->PaintHighlightInvis(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0, 0x7F00007F);
-	if (si->ext_flags & Item::EXT_HIGHLIGHT)
-		surf->PaintHighlight(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0, 0x7F00007F);
-	else if (si->ext_flags & Item::EXT_TRANSPARENT)
-		surf->PaintInvisible(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0);
-	else if (si->flags & Item::FLG_FLIPPED)
-		surf->PaintMirrored(si->shape, si->frame, si->sxbot, si->sybot, si->trans);
-	else if (si->trans)
-		surf->PaintTranslucent(si->shape, si->frame, si->sxbot, si->sybot);
-	else if (!si->clipped)
-		surf->PaintNoClip(si->shape, si->frame, si->sxbot, si->sybot);
-	else
-		surf->Paint(si->shape, si->frame, si->sxbot, si->sybot);
-		
-//	if (wire) si->info->draw_box_front(s, dispx, dispy, 255);
+	paint_list.push_back(si);
 
 	// weapon overlay
 	// FIXME: use highlight/invisibility, also add to Trace() ?
@@ -1105,10 +1268,10 @@ bool ItemSorter::PaintSortItem(SortItem	*si)
 		uint32 wo_shapenum;
 		av->getWeaponOverlay(wo_frame, wo_shapenum);
 		if (wo_frame) {
-			Shape* wo_shape = GameData::get_instance()->getMainShapes()->getShape(wo_shapenum);
-			surf->Paint(wo_shape, wo_frame->frame,
-						si->sxbot + wo_frame->xoff,
-						si->sybot + wo_frame->yoff);
+			overlay_shape = GameData::get_instance()->getMainShapes()->getShape(wo_shapenum);
+			overlay_frame = wo_frame->frame;
+			overlay_xoff = wo_frame->xoff;
+			overlay_yoff = wo_frame->yoff;
 		}
 	}
 
@@ -1133,6 +1296,166 @@ bool ItemSorter::PaintSortItem(SortItem	*si)
 	return false;
 }
 
+void ItemSorter::PaintItems(RenderSurface *s, bool banded,
+							sint32 top, sint32 bottom, bool item_highlight)
+{
+	std::vector<SortItem *>::iterator it = paint_list.begin();
+	std::vector<SortItem *>::iterator end = paint_list.end();
+	for (; it != end; ++it)
+	{
+		SortItem *si = *it;
+
+		// Skip items outside the band (but the weapon overlay isn't
+		// inside the avatar's frame)
+		if (banded && (si->sy2 <= top || si->sy >= bottom) &&
+			!(si->shape_num == 1 && si->item_num == 1))
+			continue;
+
+		PaintSortItem(s, si, banded);
+	}
+
+	// Item highlighting. We redraw each 'item' transparent
+	if (item_highlight)
+	{
+		SortItem *si = items;
+		while (si != 0)
+		{
+			if (!(si->flags & (Item::FLG_DISPOSABLE|Item::FLG_FAST_ONLY)) && !si->fixed &&
+				(!banded || (si->sy2 > top && si->sy < bottom)))
+			{
+				s->PaintHighlightInvis(si->shape, 
+						si->frame, 
+						si->sxbot, 
+						si->sybot, 
+						si->trans, 
+						(si->flags&Item::FLG_FLIPPED)!=0, 0x1f00ffff);
+			}
+
+			si = si->next;
+		}
+
+	}
+}
+
+void ItemSorter::PaintSortItem(RenderSurface *s, SortItem *si, bool banded)
+{
+//	if (wire) si->info->draw_box_back(s, dispx, dispy, 255);
+
+	if (si->ext_flags & Item::EXT_HIGHLIGHT && si->ext_flags & Item::EXT_TRANSPARENT)
+		s->PaintHighlightInvis(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0, 0x7F00007F);
+	if (si->ext_flags & Item::EXT_HIGHLIGHT)
+		s->PaintHighlight(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0, 0x7F00007F);
+	else if (si->ext_flags & Item::EXT_TRANSPARENT)
+		s->PaintInvisible(si->shape, si->frame, si->sxbot, si->sybot, si->trans, (si->flags&Item::FLG_FLIPPED)!=0);
+	else if (si->flags & Item::FLG_FLIPPED)
+		s->PaintMirrored(si->shape, si->frame, si->sxbot, si->sybot, si->trans);
+	else if (si->trans)
+		s->PaintTranslucent(si->shape, si->frame, si->sxbot, si->sybot);
+	else if (!si->clipped && !banded)
+		s->PaintNoClip(si->shape, si->frame, si->sxbot, si->sybot);
+	else
+		s->Paint(si->shape, si->frame, si->sxbot, si->sybot);
+		
+//	if (wire) si->info->draw_box_front(s, dispx, dispy, 255);
+
+	// weapon overlay
+	if (si->shape_num == 1 && si->item_num == 1 && overlay_shape) {
+		s->Paint(overlay_shape, overlay_frame,
+				 si->sxbot + overlay_xoff,
+				 si->sybot + overlay_yoff);
+	}
+}
+
+bool ItemSorter::PaintParallel(bool item_highlight)
+{
+	Rect clip;
+	surf->GetClippingRect(clip);
+
+	unsigned int bandcount = paint_pool->getThreadCount();
+	if (clip.h < static_cast<sint32>(bandcount)) bandcount = clip.h;
+	if (bandcount < 2) return false;
+
+	std::vector<RenderSurface *> bands;
+	for (unsigned int i = 0; i < bandcount; ++i)
+	{
+		RenderSurface *band = surf->CreateSharedSurface();
+		if (!band) break;
+		bands.push_back(band);
+	}
+
+	// Not a surface we can share
+	if (bands.size() < bandcount)
+	{
+		for (unsigned int i = 0; i < bands.size(); ++i)
+			delete bands[i];
+		return false;
+	}
+
+	// Decode all the frames up front, so the bands only have to read
+	// the ShapeCache
+	ShapeCache *shapecache = ShapeCache::get_instance();
+	if (shapecache)
+	{
+		std::vector<SortItem *>::iterator it = paint_list.begin();
+		std::vector<SortItem *>::iterator end = paint_list.end();
+		for (; it != end; ++it)
+			shapecache->getFrame((*it)->shape, (*it)->frame, false);
+
+		if (overlay_shape)
+			shapecache->getFrame(overlay_shape, overlay_frame, false);
+
+		if (item_highlight)
+			for (SortItem *si = items; si != 0; si = si->next)
+				shapecache->getFrame(si->shape, si->frame, false);
+
+		shapecache->setFrozen(true);
+	}
+
+	std::vector<WorkerPool::Job *> jobs;
+	for (unsigned int i = 0; i < bandcount; ++i)
+	{
+		sint32 top = clip.y + clip.h*i/bandcount;
+		sint32 bottom = clip.y + clip.h*(i+1)/bandcount;
+
+		bands[i]->SetClippingRect(Rect(clip.x, top, clip.w, bottom - top));
+		jobs.push_back(new PaintBandJob(this, bands[i], top, bottom,
+										item_highlight));
+	}
+
+	paint_pool->runJobs(jobs);
+
+	if (shapecache) shapecache->setFrozen(false);
+
+	for (unsigned int i = 0; i < bandcount; ++i)
+	{
+		delete jobs[i];
+		delete bands[i];
+	}
+
+	return true;
+}
+
+void ItemSorter::setPaintThreads(unsigned int count)
+{
+	delete paint_pool;
+	paint_pool = 0;
+
+	if (count != 1)
+		paint_pool = new WorkerPool(count, "PaintBand");
+
+	// Couldn't create any extra threads
+	if (paint_pool && paint_pool->getThreadCount() < 2)
+	{
+		delete paint_pool;
+		paint_pool = 0;
+	}
+}
+
+unsigned int ItemSorter::getPaintThreads() const
+{
+	return paint_pool ? paint_pool->getThreadCount() : 1;
+}
+
 bool ItemSorter::NullPaintSortItem(SortItem	*si)
 {
 	// Don't paint this, or dependencies if occluded
@@ -1167,6 +1490,8 @@ uint16 ItemSorter::Trace(sint32 x, sint32 y, HitFace* face, bool item_highlight)
 	SortItem *it;
 	SortItem *selected;
 
+	SortDisplayList();
+
 	if (!order_counter)	// If no order_counter we need to sort the items
 	{
 		it = items;
@@ -19,10 +19,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef ITEMSORTER_H
 #define ITEMSORTER_H
 
+#include <vector>
+
 class MainShapeArchive;
 class Item;
 class RenderSurface;
+class Shape;
+class WorkerPool;
 struct SortItem;
+struct SortCacheEntry;
 
 class ItemSorter
 {
@@ -38,6 +43,33 @@ class ItemSorter
 
 	sint32		cam_sx, cam_sy;
 
+	bool		items_sorted;	// Is the items list in ListLessThan order?
+	uint32		add_counter;	// Number of items added since BeginDisplayList
+	uint32		display_serial;	// Incremented each BeginDisplayList
+
+	// Screenspace bins of the items in the display list. Only items sharing
+	// a bin can overlap, so AddItem only has to compare against those.
+	std::vector< std::vector<SortItem *> > bins;
+	sint32		bins_x, bins_y;	// Screenspace origin of the bins
+	sint32		bins_w, bins_h;	// Number of bins in each direction
+
+	std::vector<SortItem *> candidates;
+
+	// Comparison results of the previous display list, indexed by objid
+	std::vector<SortCacheEntry *> sort_cache;
+
+	// The items to paint, in painting order
+	std::vector<SortItem *> paint_list;
+
+	// The avatar's weapon overlay
+	Shape		*overlay_shape;
+	uint32		overlay_frame;
+	sint32		overlay_xoff, overlay_yoff;
+
+	// Threads painting horizontal bands of the surface. 0 if not painting
+	// in parallel.
+	WorkerPool	*paint_pool;
+
 public:
 	ItemSorter();
 	~ItemSorter();
@@ -53,18 +85,51 @@ public:
 	void AddItem(sint32 x, sint32 y, sint32 z, uint32 shape_num, uint32 frame_num, uint32 item_flags, uint32 ext_flags, uint16 item_num=0);
 	void AddItem(Item *);					// Add an Item. SetupLerp() MUST have been called
 
+	void SortDisplayList();					// Put items in ListLessThan order
 	void PaintDisplayList(bool item_highlight=false);				// Finishes the display list and Paints
 
 	// Trace and find an object. Returns objid.
 	// If face is non-NULL, also return the face of the 3d bbox (x,y) is on
 	uint16 Trace(sint32 x, sint32 y, HitFace* face = 0, bool item_highlight=false );
 
+	//! Set the number of threads to paint with. 0 means one per CPU, and
+	//! 1 paints everything on the calling thread.
+	void setPaintThreads(unsigned int count);
+	unsigned int getPaintThreads() const;
+
 	void IncSortLimit() { sort_limit++; }
 	void DecSortLimit() { if (sort_limit > 0) sort_limit--; }
 
+	struct RenderStats {
+		uint32	items;			// Items added to the display list
+		uint32	overlap_tests;	// Number of SortItem::overlap calls
+		uint32	comparisons;	// Full ordering/occlusion comparisons made
+		uint32	reused;			// Comparisons reused from the previous list
+	};
+
+	//! Get the statistics of the current display list
+	const RenderStats &getRenderStats() const { return stats; }
+
 private:
-	bool PaintSortItem(SortItem	*);
+	RenderStats	stats;
+
+	void AddSortItem(SortItem *);			// Find dependencies and add to list
+
+	bool OrderSortItem(SortItem *);			// Add to paint_list in painting order
 	bool NullPaintSortItem(SortItem	*);
+
+	// Paint the items in paint_list. If banded, only items overlapping
+	// the lines [top,bottom) are painted, and they are always clipped.
+	void PaintItems(RenderSurface *, bool banded, sint32 top, sint32 bottom,
+					bool item_highlight);
+	void PaintSortItem(RenderSurface *, SortItem *, bool banded);
+
+	// Paint the bands of the surface on the paint_pool.
+	// Returns false if the surface can't be painted in parallel
+	bool PaintParallel(bool item_highlight);
+
+	class PaintBandJob;
+	friend class PaintBandJob;
 };
 
 
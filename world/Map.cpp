@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ItemFactory.h"
 #include "Item.h"
 #include "Container.h"
+#include "TeleportEgg.h"
 #include "ObjectManager.h"
 #include "CoreApp.h"
 #include "GameInfo.h"
@@ -37,7 +38,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 //#define DUMP_ITEMS
 
 Map::Map(uint32 mapnum_)
-	: mapnum(mapnum_)
+	: mapnum(mapnum_), dirty(true)
 {
 
 }
@@ -61,11 +62,15 @@ void Map::clear()
 		delete *iter;
 	}
 	dynamicitems.clear();
+	dirty = true;
 }
 
 void Map::loadNonFixed(IDataSource* ds)
 {
-	loadFixedFormatObjects(dynamicitems, ds, 0);
+	ItemRecords records;
+	decodeFixedFormat(ds, records);
+	loadFixedFormatObjects(dynamicitems, records, 0);
+	dirty = true;
 }
 
 
@@ -82,9 +87,9 @@ static void shiftCoordsToZ(sint32& x, sint32& y, sint32& z, sint32 newz)
 }
 
 
-void Map::loadFixed(IDataSource* ds)
+void Map::loadFixed(const ItemRecords& records)
 {
-	loadFixedFormatObjects(fixeditems, ds, Item::EXT_FIXED);
+	loadFixedFormatObjects(fixeditems, records, Item::EXT_FIXED);
 
 
 	// U8 hack for missing ground tiles on map 25. See docs/u8bugs.txt
@@ -311,37 +316,77 @@ void Map::unloadFixed()
 	fixeditems.clear();
 }
 
-void Map::loadFixedFormatObjects(std::list<Item*>& itemlist, IDataSource* ds,
-								 uint32 extendedflags)
+void Map::getTeleportDestinations(std::set<uint32>& dests) const
+{
+	const std::list<Item*>* lists[2] = { &fixeditems, &dynamicitems };
+
+	for (unsigned int l = 0; l < 2; ++l) {
+		std::list<Item*>::const_iterator iter;
+		for (iter = lists[l]->begin(); iter != lists[l]->end(); ++iter) {
+			TeleportEgg* egg = p_dynamic_cast<TeleportEgg*>(*iter);
+			if (!egg || !egg->isTeleporter()) continue;
+
+			// a teleporter's mapnum is the map it leads to
+			if (egg->getMapNum() != mapnum)
+				dests.insert(egg->getMapNum());
+		}
+	}
+}
+
+void Map::decodeFixedFormat(IDataSource* ds, ItemRecords& records)
 {
+	records.clear();
+
 	if (!ds) return;
 	uint32 size = ds->getSize();
 	if (size == 0) return;
 
 	uint32 itemcount = size / 16;
+	records.resize(itemcount);
 
+	for (uint32 i = 0; i < itemcount; ++i)
+	{
+		// These are ALL unsigned on disk
+		ItemRecord& r = records[i];
+		r.x = static_cast<uint16>(ds->readX(2));
+		r.y = static_cast<uint16>(ds->readX(2));
+		r.z = static_cast<uint8>(ds->readX(1));
+		r.shape = static_cast<uint16>(ds->read2());
+		r.frame = ds->read1();
+		r.flags = ds->read2();
+		r.quality = ds->read2();
+		r.npcnum = ds->read1();
+		r.mapnum = ds->read1();
+		r.next = ds->read2(); // do we need next for anything?
+	}
+}
+
+void Map::loadFixedFormatObjects(std::list<Item*>& itemlist,
+								 const ItemRecords& records,
+								 uint32 extendedflags)
+{
 	std::stack<Container*> cont;
 	int contdepth = 0;
 
-	for (uint32 i = 0; i < itemcount; ++i)
+	ItemRecords::const_iterator r;
+	for (r = records.begin(); r != records.end(); ++r)
 	{
-		// These are ALL unsigned on disk
-		sint32 x = static_cast<sint32>(ds->readX(2));
-		sint32 y = static_cast<sint32>(ds->readX(2));
-		sint32 z = static_cast<sint32>(ds->readX(1));
+		sint32 x = r->x;
+		sint32 y = r->y;
+		sint32 z = r->z;
 
 		if (GAME_IS_CRUSADER) {
 			x *= 2;
 			y *= 2;
 		}
 
-		uint32 shape = ds->read2();
-		uint32 frame = ds->read1();
-		uint16 flags = ds->read2();
-		uint16 quality = ds->read2();
-		uint16 npcnum = static_cast<uint16>(ds->read1());
-		uint16 mapnum = static_cast<uint16>(ds->read1());
-		uint16 next = ds->read2(); // do we need next for anything?
+		uint32 shape = r->shape;
+		uint32 frame = r->frame;
+		uint16 flags = r->flags;
+		uint16 quality = r->quality;
+		uint16 npcnum = r->npcnum;
+		uint16 mapnum = r->mapnum;
+		uint16 next = r->next;
 
 		// find container this item belongs to, if any.
 		// the x coordinate stores the container-depth of this item,
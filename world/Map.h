@@ -20,6 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define MAP_H
 
 #include <list>
+#include <vector>
+#include <set>
 
 class Item;
 class IDataSource;
@@ -29,25 +31,51 @@ class Map
 {
 	friend class CurrentMap;
 public:
+	//! An item record from something formatted like 'fixed.dat'
+	struct ItemRecord
+	{
+		uint16 x, y;		//!< x is the container depth for contents
+		uint16 shape;
+		uint16 flags;
+		uint16 quality;
+		uint16 next;
+		uint8 z, frame;
+		uint8 npcnum, mapnum;
+	};
+	typedef std::vector<ItemRecord> ItemRecords;
+
 	explicit Map(uint32 mapnum);
 	~Map();
 
 	void clear();
 
 	void loadNonFixed(IDataSource* ds);
-	void loadFixed(IDataSource* ds);
+	void loadFixed(const ItemRecords& records);
 	void unloadFixed();
 
+	//! Read the item records from something formatted like 'fixed.dat'.
+	//! This doesn't touch any game state, so it can run on any thread.
+	static void decodeFixedFormat(IDataSource* ds, ItemRecords& records);
+
 	bool isEmpty()
 		{ return fixeditems.size() == 0 && dynamicitems.size() == 0; }
 
+	//! get the maps the teleport eggs in this map lead to
+	void getTeleportDestinations(std::set<uint32>& dests) const;
+
 	void save(ODataSource* ods);
 	bool load(IDataSource* ids, uint32 version);
 
+	//! Have the dynamic items changed since the base savegame?
+	bool isDirty() const { return dirty; }
+	void setDirty() { dirty = true; }
+	void clearDirty() { dirty = false; }
+
 private:
 
-	// load items from something formatted like 'fixed.dat'
-	void loadFixedFormatObjects(std::list<Item*>& itemlist, IDataSource* ds,
+	// create items from records read from something formatted like 'fixed.dat'
+	void loadFixedFormatObjects(std::list<Item*>& itemlist,
+								const ItemRecords& records,
 								uint32 extendedflags);
 
 	// Q: How should we store the items in a map.
@@ -67,6 +95,8 @@ private:
 	std::list<Item*> dynamicitems;
 
 	uint32 mapnum;
+
+	bool dirty;
 };
 
 
@@ -151,7 +151,7 @@ bool MissileTracker::isPathClear()
 		std::list<CurrentMap::SweepItem> collisions;
 		std::list<CurrentMap::SweepItem>::iterator it;
 		map->sweepTest(start, end, dims, item->getShapeInfo()->flags, objid,
-					   false, &collisions);
+					   true, &collisions);
 
 		sint32 hit = 0x4000;
 		for (it = collisions.begin(); it != collisions.end(); it++)
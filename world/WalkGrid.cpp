@@ -0,0 +1,353 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "WalkGrid.h"
+#include "CurrentMap.h"
+#include "CurrentMapChunk.h"
+#include "ShapeInfo.h"
+
+#include <queue>
+#include <functional>
+#include <algorithm>
+
+// Cells around the start and target that the planner may use for detours
+static const sint32 SEARCH_MARGIN = 16;
+
+// Routes spanning more cells than this aren't planned at all
+static const sint32 MAX_SEARCH_SPAN = 320;
+
+static const unsigned int MAX_EXPANDED = 40000;
+
+// Costs of a step to an orthogonal and a diagonal neighbour
+static const uint32 STRAIGHT_COST = 32;
+static const uint32 DIAGONAL_COST = 45;
+
+static const int dirx[8] = {  0,  1, 1, 1, 0, -1, -1, -1 };
+static const int diry[8] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+
+struct WalkBlocker
+{
+	sint32 x0, y0, z0;
+	sint32 x1, y1, z1;
+};
+
+WalkGrid::WalkGrid(CurrentMap* map_)
+	: map(map_), computecount(0)
+{
+	chunksize = map->getChunkSize();
+	cellsPerChunk = chunksize / CELL_SIZE;
+	chunks.resize(MAP_NUM_CHUNKS * MAP_NUM_CHUNKS);
+	mutex = SDL_CreateMutex();
+}
+
+WalkGrid::~WalkGrid()
+{
+	SDL_DestroyMutex(mutex);
+}
+
+void WalkGrid::clear()
+{
+	for (unsigned int i = 0; i < chunks.size(); ++i) {
+		chunks[i].stamp = 0;
+		std::vector<sint16>().swap(chunks[i].floors);
+	}
+}
+
+uint32 WalkGrid::getStamp(sint32 cx, sint32 cy) const
+{
+	uint32 stamp = 0;
+	for (sint32 ncx = cx; ncx <= cx + 1; ++ncx) {
+		for (sint32 ncy = cy; ncy <= cy + 1; ++ncy) {
+			const CurrentMapChunk* chunk = map->getChunk(ncx, ncy);
+			if (chunk) stamp += chunk->getWalkRevision();
+		}
+	}
+	return stamp;
+}
+
+const sint16* WalkGrid::getFloors(sint32 gx, sint32 gy)
+{
+	if (gx < 0 || gy < 0) return 0;
+
+	sint32 cx = gx / cellsPerChunk;
+	sint32 cy = gy / cellsPerChunk;
+	if (cx >= MAP_NUM_CHUNKS || cy >= MAP_NUM_CHUNKS) return 0;
+
+	ChunkCells& cells = chunks[cy * MAP_NUM_CHUNKS + cx];
+	uint32 stamp = getStamp(cx, cy);
+	if (cells.floors.empty() || cells.stamp != stamp) {
+		computeChunk(cx, cy, cells);
+		cells.stamp = stamp;
+		computecount++;
+	}
+
+	sint32 i = gx % cellsPerChunk;
+	sint32 j = gy % cellsPerChunk;
+	return &cells.floors[(j * cellsPerChunk + i) * MAX_FLOORS];
+}
+
+int WalkGrid::findFloor(const sint16* floors, sint32 z, sint32 maxdiff)
+{
+	if (!floors) return -1;
+
+	int best = -1;
+	sint32 bestdiff = maxdiff + 1;
+	for (int f = 0; f < MAX_FLOORS && floors[f] != NO_FLOOR; ++f) {
+		sint32 diff = floors[f] - z;
+		if (diff < 0) diff = -diff;
+		if (diff < bestdiff) {
+			best = f;
+			bestdiff = diff;
+		}
+	}
+	return best;
+}
+
+void WalkGrid::computeChunk(sint32 cx, sint32 cy, ChunkCells& cells)
+{
+	const sint32 left = cx * chunksize;
+	const sint32 top = cy * chunksize;
+
+	// Items extend from their location towards -x and -y, so the items of
+	// the next chunks can reach into this one too
+	std::vector<WalkBlocker> blockers;
+	for (sint32 ncx = cx; ncx <= cx + 1; ++ncx) {
+		for (sint32 ncy = cy; ncy <= cy + 1; ++ncy) {
+			const CurrentMapChunk* chunk = map->getChunk(ncx, ncy);
+			if (!chunk) continue;
+
+			for (unsigned int i = 0; i < chunk->size(); ++i) {
+				if (!chunk->isWalkBlocker(i)) continue;
+
+				sint32 ix, iy, iz, ixd, iyd, izd;
+				chunk->getLocation(i, ix, iy, iz);
+				chunk->getFootpadWorld(i, ixd, iyd, izd);
+
+				WalkBlocker b;
+				b.x0 = ix - ixd; b.y0 = iy - iyd; b.z0 = iz;
+				b.x1 = ix; b.y1 = iy; b.z1 = iz + izd;
+
+				if (b.x1 <= left || b.x0 >= left + chunksize ||
+					b.y1 <= top || b.y0 >= top + chunksize)
+					continue;
+
+				blockers.push_back(b);
+			}
+		}
+	}
+
+	cells.floors.assign(cellsPerChunk * cellsPerChunk * MAX_FLOORS,
+						static_cast<sint16>(NO_FLOOR));
+
+	std::vector<const WalkBlocker*> local;
+	for (sint32 j = 0; j < cellsPerChunk; ++j) {
+		for (sint32 i = 0; i < cellsPerChunk; ++i) {
+			const sint32 x0 = left + i * CELL_SIZE, x1 = x0 + CELL_SIZE;
+			const sint32 y0 = top + j * CELL_SIZE, y1 = y0 + CELL_SIZE;
+			const sint32 px = x0 + CELL_SIZE / 2, py = y0 + CELL_SIZE / 2;
+
+			local.clear();
+			for (unsigned int k = 0; k < blockers.size(); ++k) {
+				const WalkBlocker& b = blockers[k];
+				if (b.x1 <= x0 || b.x0 >= x1 || b.y1 <= y0 || b.y0 >= y1)
+					continue;
+				local.push_back(&b);
+			}
+
+			sint16* floors = &cells.floors[(j * cellsPerChunk + i) * MAX_FLOORS];
+			int count = 0;
+
+			for (unsigned int k = 0; k < local.size(); ++k) {
+				const WalkBlocker* b = local[k];
+
+				// Floors have to be under the centre of the cell
+				if (b->x1 < px || b->x0 > px || b->y1 < py || b->y0 > py)
+					continue;
+
+				const sint32 z = b->z1;
+
+				bool known = false;
+				for (int f = 0; f < count; ++f)
+					if (floors[f] == z) known = true;
+				if (known) continue;
+
+				bool clear = true;
+				for (unsigned int l = 0; l < local.size() && clear; ++l) {
+					if (local[l]->z0 < z + CLEARANCE && local[l]->z1 > z)
+						clear = false;
+				}
+				if (!clear) continue;
+
+				// Keep the lowest MAX_FLOORS floors, in ascending order
+				int f = count;
+				while (f > 0 && floors[f-1] > z) {
+					if (f < MAX_FLOORS) floors[f] = floors[f-1];
+					--f;
+				}
+				if (f < MAX_FLOORS) {
+					floors[f] = static_cast<sint16>(z);
+					if (count < MAX_FLOORS) count++;
+				}
+			}
+		}
+	}
+}
+
+static inline uint32 RouteHeuristic(sint32 gx, sint32 gy, sint32 tgx, sint32 tgy)
+{
+	sint32 dx = gx - tgx; if (dx < 0) dx = -dx;
+	sint32 dy = gy - tgy; if (dy < 0) dy = -dy;
+	if (dx < dy) return dy * STRAIGHT_COST + dx * (DIAGONAL_COST - STRAIGHT_COST);
+	return dx * STRAIGHT_COST + dy * (DIAGONAL_COST - STRAIGHT_COST);
+}
+
+bool WalkGrid::planRoute(sint32 sx, sint32 sy, sint32 sz,
+						 sint32 tx, sint32 ty, sint32 tz,
+						 std::vector<Waypoint>& route)
+{
+	SDL_LockMutex(mutex);
+	bool found = findRoute(sx, sy, sz, tx, ty, tz, route);
+	SDL_UnlockMutex(mutex);
+	return found;
+}
+
+bool WalkGrid::findRoute(sint32 sx, sint32 sy, sint32 sz,
+						 sint32 tx, sint32 ty, sint32 tz,
+						 std::vector<Waypoint>& route)
+{
+	route.clear();
+
+	if (sx < 0 || sy < 0 || tx < 0 || ty < 0) return false;
+
+	const sint32 sgx = sx / CELL_SIZE, sgy = sy / CELL_SIZE;
+	const sint32 tgx = tx / CELL_SIZE, tgy = ty / CELL_SIZE;
+
+	// The start may not be a floor of the grid if the actor is standing on
+	// something small, or on another actor. Leave those to the Pathfinder.
+	const int slevel = findFloor(getFloors(sgx, sgy), sz, MAX_STEP);
+	const int tlevel = findFloor(getFloors(tgx, tgy), tz, MAX_STEP);
+	if (slevel < 0 || tlevel < 0) return false;
+
+	const sint32 gridsize = cellsPerChunk * MAP_NUM_CHUNKS;
+	sint32 mingx = (sgx < tgx ? sgx : tgx) - SEARCH_MARGIN;
+	sint32 maxgx = (sgx > tgx ? sgx : tgx) + SEARCH_MARGIN;
+	sint32 mingy = (sgy < tgy ? sgy : tgy) - SEARCH_MARGIN;
+	sint32 maxgy = (sgy > tgy ? sgy : tgy) + SEARCH_MARGIN;
+	if (mingx < 0) mingx = 0;
+	if (mingy < 0) mingy = 0;
+	if (maxgx >= gridsize) maxgx = gridsize - 1;
+	if (maxgy >= gridsize) maxgy = gridsize - 1;
+
+	const sint32 w = maxgx - mingx + 1;
+	const sint32 h = maxgy - mingy + 1;
+	if (w > MAX_SEARCH_SPAN || h > MAX_SEARCH_SPAN) return false;
+
+	// Nodes are (cell, floor) pairs in the search box
+	std::vector<uint32> cost(w * h * MAX_FLOORS, 0xFFFFFFFF);
+	std::vector<sint32> parent(w * h * MAX_FLOORS, -1);
+
+	typedef std::pair<uint32, sint32> OpenNode;	// estimated cost, node
+	std::priority_queue<OpenNode, std::vector<OpenNode>,
+						std::greater<OpenNode> > open;
+
+	const sint32 startnode = ((sgy - mingy) * w + (sgx - mingx)) * MAX_FLOORS + slevel;
+	const sint32 goalnode = ((tgy - mingy) * w + (tgx - mingx)) * MAX_FLOORS + tlevel;
+
+	cost[startnode] = 0;
+	open.push(OpenNode(RouteHeuristic(sgx, sgy, tgx, tgy), startnode));
+
+	unsigned int expanded = 0;
+	bool found = false;
+
+	while (!open.empty() && expanded < MAX_EXPANDED) {
+		const OpenNode top = open.top();
+		open.pop();
+
+		const sint32 node = top.second;
+		const int level = node % MAX_FLOORS;
+		const sint32 gx = mingx + (node / MAX_FLOORS) % w;
+		const sint32 gy = mingy + (node / MAX_FLOORS) / w;
+
+		// Already reached more cheaply
+		if (top.first > cost[node] + RouteHeuristic(gx, gy, tgx, tgy))
+			continue;
+
+		if (node == goalnode) {
+			found = true;
+			break;
+		}
+
+		expanded++;
+
+		const sint32 z = getFloors(gx, gy)[level];
+
+		for (int dir = 0; dir < 8; ++dir) {
+			const sint32 nx = gx + dirx[dir];
+			const sint32 ny = gy + diry[dir];
+			if (nx < mingx || nx > maxgx || ny < mingy || ny > maxgy)
+				continue;
+
+			const int nlevel = findFloor(getFloors(nx, ny), z, MAX_STEP);
+			if (nlevel < 0) continue;
+
+			const bool diagonal = (dirx[dir] != 0 && diry[dir] != 0);
+
+			// Don't cut corners
+			if (diagonal &&
+				(findFloor(getFloors(nx, gy), z, MAX_STEP) < 0 ||
+				 findFloor(getFloors(gx, ny), z, MAX_STEP) < 0))
+				continue;
+
+			const sint32 next = ((ny - mingy) * w + (nx - mingx)) * MAX_FLOORS + nlevel;
+			const uint32 c = cost[node] + (diagonal ? DIAGONAL_COST : STRAIGHT_COST);
+			if (c < cost[next]) {
+				cost[next] = c;
+				parent[next] = node;
+				open.push(OpenNode(c + RouteHeuristic(nx, ny, tgx, tgy), next));
+			}
+		}
+	}
+
+	if (!found) return false;
+
+	for (sint32 node = goalnode; node != startnode; node = parent[node]) {
+		const sint32 gx = mingx + (node / MAX_FLOORS) % w;
+		const sint32 gy = mingy + (node / MAX_FLOORS) / w;
+
+		Waypoint wp;
+		wp.x = gx * CELL_SIZE + CELL_SIZE / 2;
+		wp.y = gy * CELL_SIZE + CELL_SIZE / 2;
+		wp.z = getFloors(gx, gy)[node % MAX_FLOORS];
+		route.push_back(wp);
+	}
+	std::reverse(route.begin(), route.end());
+
+	return true;
+}
+
+void WalkGrid::getStats(unsigned int& chunkcount, unsigned int& computed) const
+{
+	SDL_LockMutex(mutex);
+	chunkcount = 0;
+	for (unsigned int i = 0; i < chunks.size(); ++i)
+		if (!chunks[i].floors.empty()) chunkcount++;
+	computed = computecount;
+	SDL_UnlockMutex(mutex);
+}
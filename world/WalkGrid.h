@@ -0,0 +1,108 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef WALKGRID_H
+#define WALKGRID_H
+
+#include <vector>
+#include <SDL.h>
+
+class CurrentMap;
+
+//! A coarse map of where actors can stand, for planning long routes.
+//!
+//! The CurrentMap is divided into CELL_SIZE x CELL_SIZE cells. For every
+//! cell the grid keeps the heights of up to MAX_FLOORS floors: the tops of
+//! solid items under the centre of the cell with CLEARANCE free space above
+//! them over the whole cell. Actors are left out, since they move around.
+//!
+//! The cells of a chunk are computed when they're first needed, and again
+//! once a solid item that can reach into the chunk has been added, removed
+//! or moved (see CurrentMapChunk::getWalkRevision).
+//!
+//! Routes can be planned from several threads at once, as long as the
+//! CurrentMap isn't changed meanwhile.
+class WalkGrid
+{
+public:
+	explicit WalkGrid(CurrentMap* map);
+	~WalkGrid();
+
+	//! Forget all computed cells
+	void clear();
+
+	struct Waypoint {
+		sint32 x, y, z;		//!< centre of a cell, on its floor
+	};
+
+	//! Plan a route between two footpad centres, one waypoint per cell.
+	//! The first waypoint is the cell after the start.
+	//! \return false if the grid doesn't connect start and target
+	bool planRoute(sint32 sx, sint32 sy, sint32 sz,
+				   sint32 tx, sint32 ty, sint32 tz,
+				   std::vector<Waypoint>& route);
+
+	//! Number of chunks with computed cells, and how often cells were
+	//! (re)computed
+	void getStats(unsigned int& chunks, unsigned int& computed) const;
+
+	enum {
+		CELL_SIZE = 32,
+		MAX_FLOORS = 4,
+		CLEARANCE = 40,		//!< free space needed above a floor
+		MAX_STEP = 16,		//!< height difference between adjacent floors
+		NO_FLOOR = -0x8000
+	};
+
+private:
+	struct ChunkCells {
+		ChunkCells() : stamp(0) { }
+		uint32 stamp;				//!< revisions the cells were computed at
+		std::vector<sint16> floors;	//!< MAX_FLOORS per cell; empty if unknown
+	};
+
+	//! The floors of cell (gx,gy), computing its chunk if needed.
+	//! Returns 0 if the cell is off the map.
+	const sint16* getFloors(sint32 gx, sint32 gy);
+
+	//! Index in floors of the floor closest to z, at most maxdiff away,
+	//! or -1 if there is none
+	static int findFloor(const sint16* floors, sint32 z, sint32 maxdiff);
+
+	//! Sum of the walk revisions of the chunks whose items can reach
+	//! into chunk (cx,cy)
+	uint32 getStamp(sint32 cx, sint32 cy) const;
+
+	void computeChunk(sint32 cx, sint32 cy, ChunkCells& cells);
+
+	//! planRoute, with the mutex held
+	bool findRoute(sint32 sx, sint32 sy, sint32 sz,
+				   sint32 tx, sint32 ty, sint32 tz,
+				   std::vector<Waypoint>& route);
+
+	CurrentMap* map;
+	sint32 chunksize;
+	sint32 cellsPerChunk;
+
+	std::vector<ChunkCells> chunks;		//!< [cy*MAP_NUM_CHUNKS + cx]
+	unsigned int computecount;
+
+	SDL_mutex* mutex;	//!< guards the cells while planning a route
+};
+
+#endif
@@ -39,18 +39,28 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "getObject.h"
 #include "MemoryManager.h"
 #include "AudioProcess.h"
+#include "FixedItemCache.h"
+
+#include <set>
+#include <SDL.h>
 
 //#define DUMP_ITEMS
 
 World* World::world = 0;
 
+// Number of maps whose decoded fixed items are kept
+static const unsigned int FIXEDCACHE_MAPS = 8;
+
 World::World()
-	: currentmap(0)
+	: currentmap(0), switchcount(0),
+	  switchlast(0), switchtotal(0), switchmax(0)
 {
 	con.Print(MM_INFO, "Creating World...\n");
 	assert(world == 0);
 
 	world = this;
+
+	fixedcache = new FixedItemCache(FIXEDCACHE_MAPS);
 }
 
 
@@ -59,6 +69,9 @@ World::~World()
 	con.Print(MM_INFO, "Destroying World...\n");
 	clear();
 
+	delete fixedcache;
+	fixedcache = 0;
+
 	world = 0;
 }
 
@@ -71,6 +84,7 @@ void World::clear()
 		delete maps[i];
 	}
 	maps.clear();
+	basemapoffsets.clear();
 
 	while (!ethereal.empty())
 		ethereal.pop_front();
@@ -78,6 +92,8 @@ void World::clear()
 	if (currentmap)
 		delete currentmap;
 	currentmap = 0;
+
+	fixedcache->clear();
 }
 
 void World::reset()
@@ -112,6 +128,8 @@ bool World::switchMap(uint32 newmap)
 	if (newmap >= maps.size() || maps[newmap] == 0)
 		return false; // no such map
 
+	Uint64 start = SDL_GetPerformanceCounter();
+
 	// Map switching procedure:
 
 	// get rid of camera
@@ -172,10 +190,9 @@ bool World::switchMap(uint32 newmap)
 	Kernel::get_instance()->killProcessesNotOfType(0, 1, true);
 
 	pout << "Loading Fixed items in map " << newmap << std::endl;
-	IDataSource *items = GameData::get_instance()->getFixed()
-		->get_datasource(newmap);
-	maps[newmap]->loadFixed(items);
-	delete items;
+	maps[newmap]->loadFixed(fixedcache->get(newmap));
+
+	prefetchTeleportDestinations(maps[newmap]);
 
 	currentmap->loadMap(maps[newmap]);
 
@@ -185,9 +202,28 @@ bool World::switchMap(uint32 newmap)
 
 	MemoryManager::get_instance()->freeResources();
 
+	double ms = static_cast<double>(SDL_GetPerformanceCounter() - start) *
+		1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	switchcount++;
+	switchlast = ms;
+	switchtotal += ms;
+	if (ms > switchmax) switchmax = ms;
+
 	return true;
 }
 
+void World::prefetchTeleportDestinations(Map* map)
+{
+	std::set<uint32> dests;
+	map->getTeleportDestinations(dests);
+
+	std::set<uint32>::iterator iter;
+	for (iter = dests.begin(); iter != dests.end(); ++iter) {
+		if (*iter < maps.size())
+			fixedcache->prefetch(*iter);
+	}
+}
+
 void World::loadNonFixed(IDataSource* ds)
 {
 	FlexFile* f = new FlexFile(ds);
@@ -340,6 +376,15 @@ void World::worldStats()
 	} else {
 		pout << "missing (null)" << std::endl;
 	}
+
+	pout << "Map switches: " << switchcount;
+	if (switchcount) {
+		pout << ", last " << switchlast << " ms, avg "
+			 << switchtotal / switchcount << " ms, max "
+			 << switchmax << " ms";
+	}
+	pout << std::endl;
+	fixedcache->printStats();
 }
 
 void World::save(ODataSource* ods)
@@ -382,22 +427,57 @@ bool World::load(IDataSource* ids, uint32 version)
 	return true;
 }
 
-void World::saveMaps(ODataSource* ods)
+void World::saveMaps(ODataSource* ods, bool delta)
 {
+	if (!delta) basemapoffsets.assign(maps.size(), 0);
+
 	ods->write4(static_cast<uint32>(maps.size()));
 	for (unsigned int i = 0; i < maps.size(); ++i) {
+		if (!delta) {
+			basemapoffsets[i] = ods->getPos();
+		} else if (!maps[i]->isDirty() && i < basemapoffsets.size()) {
+			// unchanged, so refer to the base savegame instead
+			ods->write1(0);
+			ods->write4(basemapoffsets[i]);
+			continue;
+		} else {
+			ods->write1(1);
+		}
+
 		maps[i]->save(ods);
+
+		// This is the new base savegame
+		if (!delta) maps[i]->clearDirty();
 	}
 }
 
 
-bool World::loadMaps(IDataSource* ids, uint32 version)
+bool World::loadMaps(IDataSource* ids, uint32 version,
+					 IDataSource* baseids, uint32 baseversion)
 {
 	uint32 mapcount = ids->read4();
 
+	basemapoffsets.assign(maps.size(), 0);
+
 	// Map objects have already been created by reset()
 	for (unsigned int i = 0; i < mapcount; ++i) {
-		bool res = maps[i]->load(ids, version);
+		bool res;
+
+		if (!baseids) {
+			basemapoffsets[i] = ids->getPos();
+			res = maps[i]->load(ids, version);
+			maps[i]->clearDirty();
+		} else if (ids->read1() == 0) {
+			// unchanged map, stored in the base savegame
+			basemapoffsets[i] = ids->read4();
+			baseids->seek(basemapoffsets[i]);
+			res = maps[i]->load(baseids, baseversion);
+			maps[i]->clearDirty();
+		} else {
+			res = maps[i]->load(ids, version);
+			maps[i]->setDirty();
+		}
+
 		if (!res) return false;
 	}
 
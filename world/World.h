@@ -63,6 +63,7 @@ class Actor;
 class MainActor;
 class Flex;
 class Item;
+class FixedItemCache;
 
 class World
 {
@@ -111,10 +112,14 @@ public:
 	void worldStats();
 
 	//! save the Maps in World.
-	void saveMaps(ODataSource* ods);
+	//! A delta save refers to the maps that haven't changed since the
+	//! last full save, instead of saving them again.
+	void saveMaps(ODataSource* ods, bool delta=false);
 
 	//! load Maps
-	bool loadMaps(IDataSource* ids, uint32 version);
+	//! \param baseids the MAPS of the base savegame, if this is a delta
+	bool loadMaps(IDataSource* ids, uint32 version,
+				  IDataSource* baseids=0, uint32 baseversion=0);
 
 	//! save the rest of the World data (ethereal items, current map number).
 	void save(ODataSource* ods);
@@ -123,12 +128,25 @@ public:
 	bool load(IDataSource* ids, uint32 version);
 
 private:
+	//! start decoding the fixed items of the maps the teleport eggs
+	//! in a map lead to
+	void prefetchTeleportDestinations(Map* map);
+
 	static World *world;
 
 	std::vector<Map*> maps;
 	CurrentMap* currentmap;
 
+	//! where each Map is in the MAPS of the base savegame
+	std::vector<uint32> basemapoffsets;
+
 	std::list<ObjId> ethereal;
+
+	FixedItemCache* fixedcache;
+
+	// map switch timing, in milliseconds
+	uint32 switchcount;
+	double switchlast, switchtotal, switchmax;
 };
 
 #endif
@@ -35,6 +35,10 @@ public:
 	Actor();
 	~Actor();
 
+	//! Actors change too often and in too many ways to be worth tracking,
+	//! so they're always saved in full
+	virtual bool tracksDirty() const { return false; }
+
 	sint16 getStr() const { return strength; }
 	void setStr(sint16 str) { strength = str; }
 	sint16 getDex() const { return dexterity; }
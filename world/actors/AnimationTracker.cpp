@@ -272,7 +272,7 @@ bool AnimationTracker::step()
 		std::list<CurrentMap::SweepItem> collisions;
 		std::list<CurrentMap::SweepItem>::iterator it;
 		cm->sweepTest(start, end, dims, a->getShapeInfo()->flags, a->getObjId(),
-		              false, &collisions);
+		              true, &collisions);
 
 
 		for (it = collisions.begin(); it != collisions.end(); it++)
@@ -20,8 +20,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Pathfinder.h"
 #include "Actor.h"
 #include "AnimationTracker.h"
+#include "Profiler.h"
+#include "World.h"
+#include "CurrentMap.h"
+#include "WalkGrid.h"
 #include "SDL_timer.h"
 #include <cmath>
+#include <algorithm>
 
 #include "RenderSurface.h"
 #include "GameMapGump.h"
@@ -41,8 +46,31 @@ struct PathNode
 	uint32 stepsfromparent;
 };
 
-// NOTE: this is just to keep some statistics
-static unsigned int expandednodes = 0;
+bool Pathfinder::useWalkGrid = true;
+
+// Targets further away than this are routed over the WalkGrid first
+static const sint32 LONG_ROUTE = 512;
+
+// How far along a WalkGrid route the detailed search goes at once
+static const sint32 SUBGOAL_RANGE = 384;
+
+// Positions closer than this to a visited position count as visited
+static const sint32 VISITED_RANGE = 8;
+
+// Cells of the visited hash are 1 << VISITED_CELL_SHIFT wide. That's at
+// least twice VISITED_RANGE, so a lookup needs at most two cells per axis.
+static const int VISITED_CELL_SHIFT = 4;
+static const uint32 VISITED_BUCKETS = 4096;	// power of two
+
+static const unsigned int NODEBLOCK_SIZE = 128;
+
+static inline uint32 visitedBucket(sint32 cx, sint32 cy, sint32 cz)
+{
+	uint32 h = static_cast<uint32>(cx) * 73856093U;
+	h ^= static_cast<uint32>(cy) * 19349663U;
+	h ^= static_cast<uint32>(cz) * 83492791U;
+	return h & (VISITED_BUCKETS - 1);
+}
 
 void PathfindingState::load(Actor* actor)
 {
@@ -115,23 +143,43 @@ bool PathNodeCmp::operator()(PathNode* n1, PathNode* n2)
 	return (n1->heuristicTotalCost > n2->heuristicTotalCost);
 }
 
-Pathfinder::Pathfinder()
+Pathfinder::Pathfinder() : partial(false), nodecount(0), expandednodes(0)
 {
-	expandednodes = 0;
+	visitedbuckets.resize(VISITED_BUCKETS, -1);
 }
 
 Pathfinder::~Pathfinder()
 {
 #if 1
-	pout << "~Pathfinder: " << nodelist.size() << " nodes, "
+	pout << "~Pathfinder: " << nodecount << " nodes, "
 		 << expandednodes << " expanded nodes in " << expandtime << "ms." << std::endl;
 #endif
 
 	// clean up nodes
-	std::list<PathNode*>::iterator iter;
-	for (iter = nodelist.begin(); iter != nodelist.end(); ++iter)
-		delete *iter;
-	nodelist.clear();
+	for (unsigned int i = 0; i < nodeblocks.size(); ++i)
+		delete [] nodeblocks[i];
+	nodeblocks.clear();
+}
+
+void Pathfinder::reset()
+{
+	while (!nodes.empty())
+		nodes.pop();
+	nodecount = 0;
+
+	if (!visited.empty()) {
+		visited.clear();
+		std::fill(visitedbuckets.begin(), visitedbuckets.end(), -1);
+	}
+}
+
+PathNode* Pathfinder::allocNode()
+{
+	unsigned int block = nodecount / NODEBLOCK_SIZE;
+	if (block == nodeblocks.size())
+		nodeblocks.push_back(new PathNode[NODEBLOCK_SIZE]);
+
+	return &nodeblocks[block][nodecount++ % NODEBLOCK_SIZE];
 }
 
 void Pathfinder::init(Actor* actor_, PathfindingState* state)
@@ -182,17 +230,44 @@ bool Pathfinder::canReach()
 
 bool Pathfinder::alreadyVisited(sint32 x, sint32 y, sint32 z)
 {
-	//! this may need optimization
-
-	std::list<PathfindingState>::iterator iter;
-
-	for (iter = visited.begin(); iter != visited.end(); ++iter)
-		if (iter->checkPoint(x,y,z,8))
-			return true;
+	// Only the cells within VISITED_RANGE of (x,y,z) can hold a match
+	const sint32 r = VISITED_RANGE - 1;
+	sint32 cx0 = (x - r) >> VISITED_CELL_SHIFT, cx1 = (x + r) >> VISITED_CELL_SHIFT;
+	sint32 cy0 = (y - r) >> VISITED_CELL_SHIFT, cy1 = (y + r) >> VISITED_CELL_SHIFT;
+	sint32 cz0 = (z - r) >> VISITED_CELL_SHIFT, cz1 = (z + r) >> VISITED_CELL_SHIFT;
+
+	for (sint32 cz = cz0; cz <= cz1; ++cz)
+	for (sint32 cy = cy0; cy <= cy1; ++cy)
+	for (sint32 cx = cx0; cx <= cx1; ++cx)
+	{
+		sint32 i = visitedbuckets[visitedBucket(cx, cy, cz)];
+		while (i != -1) {
+			// Other cells can share the bucket, so always check the distance
+			const VisitedPos& v = visited[i];
+			sint32 dx = v.x - x, dy = v.y - y, dz = v.z - z;
+			if (dx*dx + dy*dy + dz*dz < VISITED_RANGE*VISITED_RANGE)
+				return true;
+			i = v.next;
+		}
+	}
 
 	return false;
 }
 
+void Pathfinder::addVisited(sint32 x, sint32 y, sint32 z)
+{
+	uint32 bucket = visitedBucket(x >> VISITED_CELL_SHIFT,
+								  y >> VISITED_CELL_SHIFT,
+								  z >> VISITED_CELL_SHIFT);
+	VisitedPos v;
+	v.x = x;
+	v.y = y;
+	v.z = z;
+	v.next = visitedbuckets[bucket];
+	visitedbuckets[bucket] = static_cast<sint32>(visited.size());
+	visited.push_back(v);
+}
+
 bool Pathfinder::checkTarget(PathNode* node)
 {
 	// TODO: these ranges are probably a bit too high,
@@ -370,8 +445,7 @@ static void drawpath(PathNode* to, uint32 rgb, bool done)
 void Pathfinder::newNode(PathNode* oldnode, PathfindingState& state,
 						 unsigned int steps)
 {
-	PathNode* newnode = new PathNode();
-	nodelist.push_back(newnode); // for garbage collection
+	PathNode* newnode = allocNode();
 	newnode->state = state;
 	newnode->parent = oldnode;
 	newnode->depth = oldnode->depth + 1;
@@ -503,14 +577,14 @@ void Pathfinder::expandNode(PathNode* node)
 			tracker.updateState(state);
 			if (!alreadyVisited(state.x, state.y, state.z)) {
 				newNode(node, state, 0);
-				visited.push_back(state);
+				addVisited(state.x, state.y, state.z);
 			}
 		}
 		else
 		{
 			// an obstruction was encountered, so generate a visited node to block
 			// future evaluation at the endpoint.
-			visited.push_back(state);
+			addVisited(state.x, state.y, state.z);
 		}
 
 		// TODO: maybe only allow partial steps close to target?
@@ -518,12 +592,88 @@ void Pathfinder::expandNode(PathNode* node)
 							   (!tracker.isDone() && targetitem)))
 		{
 			newNode(node, closeststate, beststeps);
-			visited.push_back(closeststate);
+			addVisited(closeststate.x, closeststate.y, closeststate.z);
 		}
 	}
 }
 
 bool Pathfinder::pathfind(std::vector<PathfindingAction>& path)
+{
+	Profiler::Scope profile(Profiler::PATHFINDING);
+
+	partial = false;
+
+	sint32 subx, suby, subz;
+	if (useWalkGrid && findSubgoal(subx, suby, subz)) {
+		// Search for a path to the waypoint instead
+		Item* item = targetitem;
+		bool hit = hitmode;
+		sint32 tx = targetx, ty = targety, tz = targetz;
+
+		targetitem = 0;
+		hitmode = false;
+		targetx = subx;
+		targety = suby;
+		targetz = subz;
+
+		bool found = search(path);
+
+		targetitem = item;
+		hitmode = hit;
+		targetx = tx;
+		targety = ty;
+		targetz = tz;
+
+		if (found && !path.empty()) {
+			partial = true;
+			return true;
+		}
+
+		// The grid is only an approximation, so try the whole way
+	}
+
+	return search(path);
+}
+
+bool Pathfinder::findSubgoal(sint32& x, sint32& y, sint32& z)
+{
+	// Footpad centre of the actor
+	sint32 sx = start.x - actor_xd/2;
+	sint32 sy = start.y - actor_yd/2;
+
+	sint32 dx = targetx - sx, dy = targety - sy;
+	if (dx*dx + dy*dy <= LONG_ROUTE*LONG_ROUTE)
+		return false;
+
+	CurrentMap* cm = World::get_instance()->getCurrentMap();
+	std::vector<WalkGrid::Waypoint> route;
+	if (!cm->getWalkGrid()->planRoute(sx, sy, start.z,
+									  targetx, targety, targetz, route))
+		return false;
+
+	// Take the last waypoint within SUBGOAL_RANGE along the route
+	sint32 length = 0, px = sx, py = sy;
+	unsigned int i;
+	for (i = 0; i < route.size(); ++i) {
+		sint32 ddx = route[i].x - px, ddy = route[i].y - py;
+		length += (ddx && ddy) ? 45 : 32;
+		if (length > SUBGOAL_RANGE) break;
+		px = route[i].x;
+		py = route[i].y;
+	}
+
+	// Close enough to search for the target itself
+	if (i == route.size() || i == 0)
+		return false;
+
+	// Waypoints are footpad centres; the Pathfinder works with locations
+	x = route[i-1].x + actor_xd/2;
+	y = route[i-1].y + actor_yd/2;
+	z = route[i-1].z;
+	return true;
+}
+
+bool Pathfinder::search(std::vector<PathfindingAction>& path)
 {
 #if 0
 	pout << "Actor " << actor->getObjId();
@@ -550,23 +700,23 @@ bool Pathfinder::pathfind(std::vector<PathfindingAction>& path)
 
 
 	path.clear();
+	reset();
 
-	PathNode* startnode = new PathNode();
+	PathNode* startnode = allocNode();
 	startnode->state = start;
 	startnode->cost = 0;
 	startnode->parent = 0;
 	startnode->depth = 0;
 	startnode->stepsfromparent = 0;
-	nodelist.push_back(startnode);
 	nodes.push(startnode);
 
-	unsigned int expandednodes = 0;
+	unsigned int expanded = 0;
 	const unsigned int NODELIMIT_MIN = 30;	//! constant
-	const unsigned int NODELIMIT_MAX = 200;	//! constant
+	const unsigned int NODELIMIT_MAX = 600;	//! constant
 	bool found = false;
 	Uint32 starttime = SDL_GetTicks();
 
-	while (expandednodes < NODELIMIT_MAX && !nodes.empty() && !found) {
+	while (expanded < NODELIMIT_MAX && !nodes.empty() && !found) {
 		PathNode* node = nodes.top(); nodes.pop();
 
 #if 0
@@ -626,9 +776,9 @@ bool Pathfinder::pathfind(std::vector<PathfindingAction>& path)
 		}
 
 		expandNode(node);
-		expandednodes++;
+		expanded++;
 
-		if(expandednodes >= NODELIMIT_MIN && ((expandednodes) % 5) == 0)
+		if(expanded >= NODELIMIT_MIN && ((expanded) % 5) == 0)
 		{
 			Uint32 elapsed_ms = SDL_GetTicks() - starttime;
 			if(elapsed_ms > 350) break;
@@ -648,6 +798,18 @@ bool Pathfinder::pathfind(std::vector<PathfindingAction>& path)
 	return false;
 }
 
+void Pathfinder::ConCmd_toggleWalkGrid(const Console::ArgvType &argv)
+{
+	useWalkGrid = !useWalkGrid;
+
+	unsigned int chunks = 0, computed = 0;
+	CurrentMap* cm = World::get_instance()->getCurrentMap();
+	cm->getWalkGrid()->getStats(chunks, computed);
+
+	pout << "Pathfinder::useWalkGrid = " << useWalkGrid << " ("
+		 << chunks << " chunks cached, " << computed << " computed)"
+		 << std::endl;
+}
 
 #ifdef DEBUG
 void Pathfinder::ConCmd_visualDebug(const Console::ArgvType &argv)
@@ -72,6 +72,13 @@ public:
 	//! pathfind. If true, the found path is returned in path
 	bool pathfind(std::vector<PathfindingAction>& path);
 
+	//! Does the last path found only lead to a waypoint on the way to
+	//! the target? (See WalkGrid)
+	bool isPartial() const { return partial; }
+
+	//! "Pathfinder::toggleWalkGrid" console command
+	static void ConCmd_toggleWalkGrid(const Console::ArgvType &argv);
+
 #ifdef DEBUG
 	//! "visualDebug" console command
 	static void ConCmd_visualDebug(const Console::ArgvType &argv);
@@ -86,15 +93,46 @@ protected:
 	Item* targetitem;
 	bool hitmode;
 	sint32 expandtime;
+	bool partial;
+
+	//! Plan long routes on the WalkGrid, and only search for a detailed
+	//! path to a waypoint on the way
+	static bool useWalkGrid;
 
 	sint32 actor_xd,actor_yd,actor_zd;
 
-	std::list<PathfindingState> visited;
+	//! Visited positions, hashed on the cell of a coarse grid they're in.
+	//! Each entry links to the next entry in the same hash bucket.
+	struct VisitedPos {
+		sint32 x, y, z;
+		sint32 next;
+	};
+	std::vector<VisitedPos> visited;
+	std::vector<sint32> visitedbuckets;		//!< first entry, or -1
+
 	std::priority_queue<PathNode*,std::vector<PathNode*>,PathNodeCmp> nodes;
 
-	std::list<PathNode*> nodelist;
+	//! PathNodes are handed out from blocks of nodes, which are kept
+	//! for the next search.
+	std::vector<PathNode*> nodeblocks;
+	unsigned int nodecount;
+
+	//! Number of nodes expanded, for statistics
+	unsigned int expandednodes;
+
+	//! Forget the nodes and visited positions of the previous search
+	void reset();
+	PathNode* allocNode();
+
+	//! The detailed search
+	bool search(std::vector<PathfindingAction>& path);
+
+	//! If the target is far away, pick a waypoint on the way to it from
+	//! the WalkGrid
+	bool findSubgoal(sint32& x, sint32& y, sint32& z);
 
 	bool alreadyVisited(sint32 x, sint32 y, sint32 z);
+	void addVisited(sint32 x, sint32 y, sint32 z);
 	void newNode(PathNode* oldnode,PathfindingState& state,unsigned int steps);
 	void expandNode(PathNode* node);
 	unsigned int costHeuristic(PathNode* node);
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Actor.h"
 #include "Pathfinder.h"
+#include "PathfinderQueue.h"
 #include "getObject.h"
 
 #include "IDataSource.h"
@@ -32,7 +33,7 @@ static const unsigned int PATH_FAILED = 0;
 // p_dynamic_cast stuff
 DEFINE_RUNTIME_CLASSTYPE_CODE(PathfinderProcess,Process);
 
-PathfinderProcess::PathfinderProcess() : Process()
+PathfinderProcess::PathfinderProcess() : Process(), partial(false)
 {
 
 }
@@ -41,6 +42,7 @@ PathfinderProcess::PathfinderProcess(Actor* actor_, ObjId item_, bool hit)
 {
 	assert(actor_);
 	item_num = actor_->getObjId();
+	partial = false;
 	type = 0x0204; // CONSTANT !
 
 
@@ -60,13 +62,11 @@ PathfinderProcess::PathfinderProcess(Actor* actor_, ObjId item_, bool hit)
 
 	item->getLocation(targetx, targety, targetz);
 
-	Pathfinder pf;
-	pf.init(actor_);
-	pf.setTarget(item, hit);
-
-	bool ok = pf.pathfind(path);
-
-	if (!ok) {
+	// If searching asynchronously, the search is submitted when the
+	// process first runs
+	if (isAsync())
+		partial = true;
+	else if (!pathfind()) {
 		perr << "PathfinderProcess: actor " << item_num
 			 << " failed to find path" << std::endl;
 		// can't get there...
@@ -84,6 +84,7 @@ PathfinderProcess::PathfinderProcess(Actor* actor_,
 {
 	assert(actor_);
 	item_num = actor_->getObjId();
+	partial = false;
 
 	targetx = x;
 	targety = y;
@@ -91,14 +92,11 @@ PathfinderProcess::PathfinderProcess(Actor* actor_,
 	targetitem = 0;
 
 	currentstep = 0;
+	hitmode = false;
 
-	Pathfinder pf;
-	pf.init(actor_);
-	pf.setTarget(targetx, targety, targetz);
-
-	bool ok = pf.pathfind(path);
-
-	if (!ok) {
+	if (isAsync())
+		partial = true;
+	else if (!pathfind()) {
 		perr << "PathfinderProcess: actor " << item_num
 			 << " failed to find path" << std::endl;
 		// can't get there...
@@ -118,6 +116,9 @@ PathfinderProcess::~PathfinderProcess()
 
 void PathfinderProcess::terminate()
 {
+	PathfinderQueue* queue = PathfinderQueue::get_instance();
+	if (queue) queue->cancel(getPid());
+
 	Actor* actor = getActor(item_num);
 	if (actor) {
 		// TODO: only clear if it was set by us?
@@ -157,6 +158,11 @@ void PathfinderProcess::run()
 		}
 	}
 
+	if (ok && currentstep >= path.size() && partial) {
+		// reached the waypoint; on to the next one
+		ok = false;
+	}
+
 	if (ok && currentstep >= path.size()) {
 		// done
 #if 0
@@ -194,28 +200,17 @@ void PathfinderProcess::run()
 #endif
 
 		// need to redetermine path
-		ok = true;
-		Pathfinder pf;
-		pf.init(actor);
-		if (targetitem) {
-			Item* item = getItem(targetitem);
-			if (!item)
-				ok = false;
-			else {
-				if(hitmode && !actor->isInCombat()) {
-					// Actor exited combat mode
-					hitmode = false;
-				}
-				pf.setTarget(item, hitmode);
-				item->getLocation(targetx, targety, targetz);
-			}
-		} else {
-			pf.setTarget(targetx, targety, targetz);
+		if (hitmode && !actor->isInCombat()) {
+			// Actor exited combat mode
+			hitmode = false;
+		}
+
+		ok = pathfind();
+		if (ok && is_suspended()) {
+			// pathfindDone() will wake us up
+			return;
 		}
-		if (ok)
-			ok = pf.pathfind(path);
 
-		currentstep = 0;
 		if (!ok) {
 			perr << "PathfinderProcess: actor " << item_num
 				 << " failed to find path" << std::endl;
@@ -249,6 +244,78 @@ void PathfinderProcess::run()
 	waitFor(animpid);
 }
 
+bool PathfinderProcess::isAsync() const
+{
+	PathfinderQueue* queue = PathfinderQueue::get_instance();
+	if (!queue || !queue->isAsync()) return false;
+
+#ifdef DEBUG
+	// The visual debugger draws on the screen while searching
+	if (item_num == Pathfinder::visualdebug_actor) return false;
+#endif
+
+	return true;
+}
+
+bool PathfinderProcess::setupPathfinder(Pathfinder& pf)
+{
+	Actor* actor = getActor(item_num);
+	if (!actor) return false;
+
+	pf.init(actor);
+	if (targetitem) {
+		Item* item = getItem(targetitem);
+		if (!item) return false;
+
+		pf.setTarget(item, hitmode);
+		item->getLocation(targetx, targety, targetz);
+	} else {
+		pf.setTarget(targetx, targety, targetz);
+	}
+
+	return true;
+}
+
+bool PathfinderProcess::pathfind()
+{
+	currentstep = 0;
+
+	if (isAsync()) {
+		path.clear();
+		PathfinderQueue::get_instance()->submit(this);
+		suspend();
+		return true;
+	}
+
+	Pathfinder pf;
+	if (!setupPathfinder(pf)) return false;
+
+	bool ok = pf.pathfind(path);
+	partial = pf.isPartial();
+	return ok;
+}
+
+void PathfinderProcess::pathfindDone(bool ok,
+									 const std::vector<PathfindingAction>& path_,
+									 bool partial_)
+{
+	currentstep = 0;
+
+	if (!ok) {
+		perr << "PathfinderProcess: actor " << item_num
+			 << " failed to find path" << std::endl;
+		// can't get there (anymore)
+		terminateDeferred();
+		wakeUp(PATH_FAILED);
+		return;
+	}
+
+	path = path_;
+	partial = partial_;
+
+	wakeUp(result);
+}
+
 void PathfinderProcess::saveData(ODataSource* ods)
 {
 	Process::saveData(ods);
@@ -278,6 +345,10 @@ bool PathfinderProcess::loadData(IDataSource* ids, uint32 version)
 	hitmode = (ids->read1() != 0);
 	currentstep = ids->read2();
 
+	// Not saved. If the path was partial, the actor would stop at its end,
+	// so check for the rest of the way there instead.
+	partial = true;
+
 	unsigned int pathsize = ids->read2();
 	path.resize(pathsize);
 	for (unsigned int i = 0; i < pathsize; ++i) {
@@ -40,8 +40,23 @@ public:
 
 //	virtual void terminate();
 
+	//! Set up a Pathfinder for the current target.
+	//! \return false if the target no longer exists
+	bool setupPathfinder(Pathfinder& pf);
+
+	//! Called by the PathfinderQueue when a submitted search is done
+	void pathfindDone(bool ok, const std::vector<PathfindingAction>& path,
+					  bool partial);
+
 	bool loadData(IDataSource* ids, uint32 version);
 protected:
+	//! Should the search be submitted to the PathfinderQueue?
+	bool isAsync() const;
+
+	//! Find a path right away, or submit the search and suspend
+	//! \return false if no path was found
+	bool pathfind();
+
 	virtual void saveData(ODataSource* ods);
 
 	sint32 targetx, targety, targetz;
@@ -50,6 +65,9 @@ protected:
 
 	std::vector<PathfindingAction> path;
 	unsigned int currentstep;
+
+	//! path only leads to a waypoint, so pathfind again at its end
+	bool partial;
 };
 
 
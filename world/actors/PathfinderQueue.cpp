@@ -0,0 +1,146 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "pent_include.h"
+
+#include "PathfinderQueue.h"
+#include "PathfinderProcess.h"
+#include "Pathfinder.h"
+#include "Kernel.h"
+
+PathfinderQueue* PathfinderQueue::pathfinderqueue = 0;
+
+class PathfinderQueue::Job : public WorkerPool::Job
+{
+public:
+	explicit Job(ProcId pid_) : pid(pid_), pf(0), ok(false), partial(false) { }
+	virtual ~Job() { delete pf; }
+
+	virtual void run() {
+		if (pf) {
+			ok = pf->pathfind(path);
+			partial = pf->isPartial();
+		}
+	}
+
+	ProcId pid;			//!< 0 if the process was cancelled
+	Pathfinder* pf;		//!< 0 if the search couldn't be set up
+	std::vector<PathfindingAction> path;
+	bool ok;
+	bool partial;
+};
+
+PathfinderQueue::PathfinderQueue(unsigned int threadcount)
+	: pool(0)
+{
+	assert(pathfinderqueue == 0);
+	pathfinderqueue = this;
+
+	// The main thread only helps out with searches that are still
+	// running at the next tick
+	if (threadcount > 0)
+		pool = new WorkerPool(threadcount + 1, "Pathfinder");
+}
+
+PathfinderQueue::~PathfinderQueue()
+{
+	discard();
+	delete pool;
+
+	pathfinderqueue = 0;
+}
+
+void PathfinderQueue::submit(PathfinderProcess* proc)
+{
+	queued.push_back(proc->getPid());
+}
+
+void PathfinderQueue::cancel(ProcId pid)
+{
+	unsigned int i;
+	for (i = 0; i < queued.size(); ++i)
+		if (queued[i] == pid) queued[i] = 0;
+	for (i = 0; i < running.size(); ++i)
+		if (static_cast<Job*>(running[i])->pid == pid)
+			static_cast<Job*>(running[i])->pid = 0;
+}
+
+void PathfinderQueue::start()
+{
+	if (queued.empty() || !running.empty()) return;
+
+	Kernel* kernel = Kernel::get_instance();
+	for (unsigned int i = 0; i < queued.size(); ++i) {
+		if (!queued[i]) continue;
+
+		PathfinderProcess* proc = p_dynamic_cast<PathfinderProcess*>(
+			kernel->getProcess(queued[i]));
+		if (!proc) continue;
+
+		// The Pathfinder keeps pointers to the actor and target, so set
+		// it up only now that they can't go away until finish()
+		Job* job = new Job(queued[i]);
+		job->pf = new Pathfinder();
+		if (!proc->setupPathfinder(*job->pf)) {
+			delete job->pf;
+			job->pf = 0;
+		}
+		running.push_back(job);
+	}
+	queued.clear();
+
+	if (pool && !running.empty())
+		pool->startJobs(running);
+}
+
+void PathfinderQueue::finish()
+{
+	// Searches submitted since the last start() are run right away
+	start();
+	finishJobs(true);
+}
+
+void PathfinderQueue::discard()
+{
+	queued.clear();
+	finishJobs(false);
+}
+
+void PathfinderQueue::finishJobs(bool apply)
+{
+	if (running.empty()) return;
+
+	if (pool)
+		pool->finishJobs();
+	else
+		for (unsigned int i = 0; i < running.size(); ++i)
+			running[i]->run();
+
+	Kernel* kernel = Kernel::get_instance();
+	for (unsigned int i = 0; i < running.size(); ++i) {
+		Job* job = static_cast<Job*>(running[i]);
+		PathfinderProcess* proc = 0;
+		if (apply && job->pid)
+			proc = p_dynamic_cast<PathfinderProcess*>(
+				kernel->getProcess(job->pid));
+		if (proc)
+			proc->pathfindDone(job->ok, job->path, job->partial);
+		delete job;
+	}
+	running.clear();
+}
@@ -0,0 +1,78 @@
+/*
+Copyright (C) 2007 The Pentagram team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef PATHFINDERQUEUE_H
+#define PATHFINDERQUEUE_H
+
+#include <vector>
+#include "WorkerPool.h"
+
+class PathfinderProcess;
+
+//! Runs the searches of PathfinderProcesses on worker threads.
+//!
+//! A PathfinderProcess submits itself and suspends. Its search is set up
+//! and handed to the workers by start(), just before the screen is painted,
+//! and runs while the world isn't changed. finish() waits for the searches
+//! before the next kernel tick and passes the results to the processes in
+//! the order they were submitted, so the outcome doesn't depend on how the
+//! threads were scheduled.
+class PathfinderQueue
+{
+public:
+	//! \param threadcount number of worker threads. 0 means PathfinderProcesses
+	//!                    search right away on the main thread.
+	explicit PathfinderQueue(unsigned int threadcount);
+	~PathfinderQueue();
+
+	static PathfinderQueue* get_instance() { return pathfinderqueue; }
+
+	//! Should PathfinderProcesses submit their searches?
+	bool isAsync() const { return pool != 0; }
+
+	//! Queue a search for a PathfinderProcess
+	void submit(PathfinderProcess* proc);
+
+	//! Forget a process that's terminating
+	void cancel(ProcId pid);
+
+	//! Set up the queued searches and hand them to the workers.
+	//! The world must not change until finish() is called.
+	void start();
+
+	//! Wait for the searches (running any that weren't started) and pass
+	//! the results to their processes.
+	void finish();
+
+	//! Wait for the searches and drop them, before the world is reset
+	void discard();
+
+private:
+	class Job;
+
+	//! Wait for the running jobs, and delete them
+	void finishJobs(bool apply);
+
+	std::vector<ProcId> queued;
+	std::vector<WorkerPool::Job*> running;	//!< all PathfinderQueue::Jobs
+	WorkerPool* pool;
+
+	static PathfinderQueue* pathfinderqueue;
+};
+
+#endif